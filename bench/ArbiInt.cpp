@@ -0,0 +1,84 @@
+#include "QuBLAS.h"
+#include <benchmark/benchmark.h>
+
+using namespace QuBLAS;
+
+constexpr size_t length = 4096;
+
+template <size_t N>
+std::vector<ArbiInt<N>> randomInputs(bool nonZero = false)
+{
+    std::vector<ArbiInt<N>> res(length);
+    for (auto &x : res)
+    {
+        x.fill();
+        if (nonZero && x == ArbiInt<N>(0))
+        {
+            x = ArbiInt<N>(1);
+        }
+    }
+    return res;
+}
+
+// 16、48 位为原生整数，96 位为两个字，200 位为四个字
+template <size_t N, typename Op>
+static void run(benchmark::State &state, Op op, bool nonZero = false)
+{
+    const auto a = randomInputs<N>();
+    const auto b = randomInputs<N>(nonZero);
+    std::vector<decltype(op(a[0], b[0]))> c(length);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            c[i] = op(a[i], b[i]);
+        }
+        benchmark::DoNotOptimize(c.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * length);
+}
+
+template <size_t N>
+static void BM_add(benchmark::State &state)
+{
+    run<N>(state, [](const auto &a, const auto &b) { return a + b; });
+}
+
+template <size_t N>
+static void BM_mul(benchmark::State &state)
+{
+    run<N>(state, [](const auto &a, const auto &b) { return a * b; });
+}
+
+template <size_t N>
+static void BM_shift(benchmark::State &state)
+{
+    run<N>(state, [](const auto &a, const auto &) { return staticShiftRight<5>(staticShiftLeft<3>(a)); });
+}
+
+template <size_t N>
+static void BM_div(benchmark::State &state)
+{
+    run<N>(state, [](const auto &a, const auto &b) { return a / b; }, true);
+}
+
+BENCHMARK(BM_add<16>)->Name("ArbiInt/add/16");
+BENCHMARK(BM_add<48>)->Name("ArbiInt/add/48");
+BENCHMARK(BM_add<96>)->Name("ArbiInt/add/96");
+BENCHMARK(BM_add<200>)->Name("ArbiInt/add/200");
+BENCHMARK(BM_mul<16>)->Name("ArbiInt/mul/16");
+BENCHMARK(BM_mul<48>)->Name("ArbiInt/mul/48");
+BENCHMARK(BM_mul<96>)->Name("ArbiInt/mul/96");
+BENCHMARK(BM_mul<200>)->Name("ArbiInt/mul/200");
+BENCHMARK(BM_shift<16>)->Name("ArbiInt/shift/16");
+BENCHMARK(BM_shift<48>)->Name("ArbiInt/shift/48");
+BENCHMARK(BM_shift<96>)->Name("ArbiInt/shift/96");
+BENCHMARK(BM_shift<200>)->Name("ArbiInt/shift/200");
+BENCHMARK(BM_div<16>)->Name("ArbiInt/div/16");
+BENCHMARK(BM_div<48>)->Name("ArbiInt/div/48");
+BENCHMARK(BM_div<96>)->Name("ArbiInt/div/96");
+BENCHMARK(BM_div<200>)->Name("ArbiInt/div/200");
+
+BENCHMARK_MAIN();
@@ -0,0 +1,68 @@
+#include "QuBLAS.h"
+#include <benchmark/benchmark.h>
+
+using namespace QuBLAS;
+
+using elem_t = Qu<intBits<4>, fracBits<9>>;
+using vec_t = Qu<dim<24, 16>, elem_t>;
+
+static void BM_encode(benchmark::State &state)
+{
+    vec_t x;
+    x.fillRandom(1);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(BitStream<r2l<3>, r2l<2>>(x));
+    }
+    state.SetItemsProcessed(state.iterations() * vec_t::elemSize);
+}
+
+static void BM_decode(benchmark::State &state)
+{
+    vec_t x;
+    x.fillRandom(1);
+    const auto bits = BitStream<r2l<3>, r2l<2>>(x);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(BitStream<vec_t, r2l<3>, r2l<2>>(bits));
+    }
+    state.SetItemsProcessed(state.iterations() * vec_t::elemSize);
+}
+
+static void BM_pack(benchmark::State &state)
+{
+    vec_t x;
+    x.fillRandom(1);
+    std::vector<uint64_t> packed(BitPackWords<vec_t, uint64_t>);
+
+    for (auto _ : state)
+    {
+        BitPack<r2l<3>, r2l<2>>(x, packed);
+        benchmark::DoNotOptimize(packed.data());
+    }
+    state.SetItemsProcessed(state.iterations() * vec_t::elemSize);
+}
+
+static void BM_unpack(benchmark::State &state)
+{
+    vec_t x, y;
+    x.fillRandom(1);
+    std::vector<uint64_t> packed(BitPackWords<vec_t, uint64_t>);
+    BitPack<r2l<3>, r2l<2>>(x, packed);
+
+    for (auto _ : state)
+    {
+        BitUnpack<r2l<3>, r2l<2>>(packed, y);
+        benchmark::DoNotOptimize(y.data.data());
+    }
+    state.SetItemsProcessed(state.iterations() * vec_t::elemSize);
+}
+
+BENCHMARK(BM_encode)->Name("BitStream/encode");
+BENCHMARK(BM_decode)->Name("BitStream/decode");
+BENCHMARK(BM_pack)->Name("BitStream/pack");
+BENCHMARK(BM_unpack)->Name("BitStream/unpack");
+
+BENCHMARK_MAIN();
@@ -0,0 +1,82 @@
+#include "QuBLAS.h"
+#include <benchmark/benchmark.h>
+
+using namespace QuBLAS;
+
+using x_t = Qu<intBits<3>, fracBits<9>>;
+using h_t = Qu<intBits<1>, fracBits<12>, QuMode<RND::CONV>>;
+using mul_t = Qu<intBits<4>, fracBits<12>, QuMode<RND::INF>>;
+using add_t = Qu<intBits<8>, fracBits<10>>;
+using y_t = Qu<intBits<8>, fracBits<7>>;
+
+constexpr size_t taps = 64;
+constexpr size_t block = 1024;
+
+// 每个输出先拷贝出窗口内的乘积再 Qreduce
+static void BM_firNaive(benchmark::State &state)
+{
+    Qu<dim<taps>, h_t> h;
+    Qu<dim<taps + block>, x_t> x;
+    h.fillRandom(1, 0);
+    x.fillRandom(1, 1);
+    std::vector<y_t> y(block);
+
+    for (auto _ : state)
+    {
+        for (size_t n = 0; n < block; n++)
+        {
+            Qu<dim<taps>, mul_t> products;
+            for (size_t k = 0; k < taps; k++)
+            {
+                products[k] = Qmul<mul_t>(h[k], x[taps + n - k]);
+            }
+            y[n] = Qreduce<add_t>(products);
+        }
+        benchmark::DoNotOptimize(y.data());
+    }
+    state.SetItemsProcessed(state.iterations() * block);
+}
+
+template <typename policy>
+static void BM_fir(benchmark::State &state)
+{
+    Qu<dim<taps>, h_t> h;
+    Qu<dim<block>, x_t> x;
+    Qu<dim<block>, y_t> y;
+    h.fillRandom(1, 0);
+    x.fillRandom(1, 1);
+
+    Qfir<decltype(h), x_t, QfirMulArgs<mul_t>, QfirAddArgs<add_t>, QuExec<policy>> fir(h);
+
+    for (auto _ : state)
+    {
+        fir.process(y, x);
+        benchmark::DoNotOptimize(y.data.data());
+    }
+    state.SetItemsProcessed(state.iterations() * block);
+}
+
+template <typename policy>
+static void BM_conv2d(benchmark::State &state)
+{
+    Qu<dim<32, 32, 16>, x_t> x;
+    Qu<dim<3, 3, 16, 16>, h_t> w;
+    Qu<dim<32, 32, 16>, y_t> y;
+    x.fillRandom(2, 0);
+    w.fillRandom(2, 1);
+
+    for (auto _ : state)
+    {
+        Qconv2d<QconvPadding<1>, QgemulMulArgs<mul_t>, QgemulAddArgs<add_t>, QuExec<policy>>(y, x, w);
+        benchmark::DoNotOptimize(y.data.data());
+    }
+    state.SetItemsProcessed(state.iterations() * y.elemSize);
+}
+
+BENCHMARK(BM_firNaive)->Name("Qfir/naive");
+BENCHMARK(BM_fir<Serial>)->Name("Qfir/serial");
+BENCHMARK(BM_fir<Parallel<>>)->Name("Qfir/parallel");
+BENCHMARK(BM_conv2d<Serial>)->Name("Qconv2d/serial");
+BENCHMARK(BM_conv2d<Parallel<>>)->Name("Qconv2d/parallel");
+
+BENCHMARK_MAIN();
@@ -0,0 +1,71 @@
+#include "QuBLAS.h"
+#include <benchmark/benchmark.h>
+
+using namespace QuBLAS;
+
+using a_t = Qu<intBits<3>, fracBits<9>>;
+using b_t = Qu<intBits<2>, fracBits<10>, QuMode<RND::CONV>>;
+using mul_t = Qu<intBits<5>, fracBits<12>, QuMode<RND::INF>>;
+using l0_t = Qu<intBits<6>, fracBits<10>>;
+using l1_t = Qu<intBits<7>, fracBits<8>, QuMode<RND::CONV>>;
+using l2_t = Qu<intBits<9>, fracBits<6>, OfMode<SAT::TCPL>>;
+
+constexpr size_t K = 256;
+
+// 先生成乘积张量再 Qreduce
+static void BM_mulThenReduce(benchmark::State &state)
+{
+    Qu<dim<K>, a_t> a;
+    Qu<dim<K>, b_t> b;
+    a.fill();
+    b.fill();
+
+    for (auto _ : state)
+    {
+        Qu<dim<K>, mul_t> products;
+        for (size_t k = 0; k < K; k++)
+        {
+            products[k] = Qmul<mul_t>(a[k], b[k]);
+        }
+        benchmark::DoNotOptimize(Qreduce<l0_t, l1_t, l2_t>(products));
+    }
+    state.SetItemsProcessed(state.iterations() * K);
+}
+
+static void BM_Qdot(benchmark::State &state)
+{
+    Qu<dim<K>, a_t> a;
+    Qu<dim<K>, b_t> b;
+    a.fill();
+    b.fill();
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(Qdot<QdotMulArgs<mul_t>, QdotAddArgs<l0_t, l1_t, l2_t>>(a, b));
+    }
+    state.SetItemsProcessed(state.iterations() * K);
+}
+
+static void BM_Qgemv(benchmark::State &state)
+{
+    constexpr size_t M = 64;
+    Qu<dim<M, K>, a_t> A;
+    Qu<dim<K>, b_t> x;
+    Qu<dim<M>, l2_t> y;
+    A.fill();
+    x.fill();
+
+    for (auto _ : state)
+    {
+        Qgemv<QuExec<Serial>, QdotMulArgs<mul_t>, QdotAddArgs<l0_t, l1_t, l2_t>>(y, A, x);
+        benchmark::DoNotOptimize(y);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * M * K);
+}
+
+BENCHMARK(BM_mulThenReduce)->Name("dot/mulThenReduce");
+BENCHMARK(BM_Qdot)->Name("dot/Qdot");
+BENCHMARK(BM_Qgemv)->Name("Qgemv");
+
+BENCHMARK_MAIN();
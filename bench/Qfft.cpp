@@ -0,0 +1,83 @@
+#include "QuBLAS.h"
+#include <benchmark/benchmark.h>
+
+using namespace QuBLAS;
+
+using part_t = Qu<intBits<1>, fracBits<10>>;
+using in_t = Qcomplex<part_t, part_t>;
+using tw_t = Qu<intBits<1>, fracBits<12>, QuMode<RND::INF>>;
+using stage_t = Qu<intBits<4>, fracBits<10>, QuMode<RND::CONV>, OfMode<SAT::TCPL>>;
+using c_t = Qcomplex<stage_t, stage_t>;
+using w_t = Qcomplex<tw_t, tw_t>;
+using mul_t = BasicComplexMul<acT<FullPrec>, bdT<FullPrec>, adT<FullPrec>, bcT<FullPrec>, acbdT<FullPrec>, adbcT<FullPrec>>;
+
+constexpr size_t N = 256;
+
+// 手写的基 2 蝶形，每次调用都在运行时计算并量化旋转因子
+static void BM_handButterflies(benchmark::State &state)
+{
+    Qu<dim<N>, in_t> x;
+    x.fillRandom(1);
+    std::vector<c_t> a(N), next(N);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < N; i++)
+        {
+            a[Qfft_s<N>::bitReverse(i)] = c_t(x[i]);
+        }
+        for (size_t span = 2; span <= N; span *= 2)
+        {
+            for (size_t base = 0; base < N; base += span)
+            {
+                for (size_t j = 0; j < span / 2; j++)
+                {
+                    const double angle = -2.0 * std::numbers::pi * static_cast<double>(j) / span;
+                    const auto t = Qmul<mul_t>(w_t(std::cos(angle), std::sin(angle)), a[base + j + span / 2]);
+                    next[base + j] = c_t(Qadd<realT<FullPrec>, imagT<FullPrec>>(a[base + j], t));
+                    next[base + j + span / 2] = c_t(Qsub<realT<FullPrec>, imagT<FullPrec>>(a[base + j], t));
+                }
+            }
+            std::swap(a, next);
+        }
+        benchmark::DoNotOptimize(a.data());
+    }
+    state.SetItemsProcessed(state.iterations() * N);
+}
+
+template <size_t radix>
+static void BM_Qfft(benchmark::State &state)
+{
+    Qu<dim<N>, in_t> x;
+    Qu<dim<N>, c_t> y;
+    x.fillRandom(1);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(Qfft<N, StageTypes<stage_t>, TwiddleT<tw_t>, Radix<radix>>(y, x));
+    }
+    state.SetItemsProcessed(state.iterations() * N);
+}
+
+template <typename policy>
+static void BM_QfftBatch(benchmark::State &state)
+{
+    constexpr size_t symbols = 64;
+    Qu<dim<N, symbols>, in_t> x;
+    Qu<dim<N, symbols>, c_t> y;
+    x.fillRandom(1);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(QfftBatch<QuExec<policy>, StageTypes<stage_t>, TwiddleT<tw_t>, Radix<4>>(y, x));
+    }
+    state.SetItemsProcessed(state.iterations() * N * symbols);
+}
+
+BENCHMARK(BM_handButterflies)->Name("fft/handButterflies");
+BENCHMARK(BM_Qfft<2>)->Name("fft/Qfft/radix2");
+BENCHMARK(BM_Qfft<4>)->Name("fft/Qfft/radix4");
+BENCHMARK(BM_QfftBatch<Serial>)->Name("fft/batch/serial");
+BENCHMARK(BM_QfftBatch<Parallel<>>)->Name("fft/batch/parallel");
+
+BENCHMARK_MAIN();
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "QuBLAS.h"
+#include <benchmark/benchmark.h>
+
+using namespace QuBLAS;
+
+using in_t = Qu<intBits<5>, fracBits<12>>;
+using l0_t = Qu<intBits<6>, fracBits<10>>;
+using l1_t = Qu<intBits<7>, fracBits<8>, QuMode<RND::CONV>>;
+using l2_t = Qu<intBits<9>, fracBits<6>, OfMode<SAT::TCPL>>;
+
+template <size_t K>
+static void BM_perLayer(benchmark::State &state)
+{
+    Qu<dim<K>, in_t> x;
+    x.fill();
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(Qreduce<l0_t, l1_t, l2_t>(x));
+    }
+    state.SetItemsProcessed(state.iterations() * K);
+}
+
+template <size_t K>
+static void BM_fullPrecision(benchmark::State &state)
+{
+    Qu<dim<K>, in_t> x;
+    x.fill();
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(Qreduce(x));
+    }
+    state.SetItemsProcessed(state.iterations() * K);
+}
+
+constexpr size_t rows = 64, cols = 256;
+
+// 每一行先拷贝成向量再归约
+static void BM_rowsByCopy(benchmark::State &state)
+{
+    Qu<dim<rows, cols>, in_t> m;
+    m.fillRandom(1);
+    Qu<dim<rows>, l2_t> res;
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < rows; i++)
+        {
+            Qu<dim<cols>, in_t> row;
+            for (size_t k = 0; k < cols; k++)
+            {
+                row[k] = m[i, k];
+            }
+            res[i] = Qreduce<l0_t, l1_t, l2_t>(row);
+        }
+        benchmark::DoNotOptimize(res.data.data());
+    }
+    state.SetItemsProcessed(state.iterations() * rows * cols);
+}
+
+template <typename policy>
+static void BM_rowsByAxis(benchmark::State &state)
+{
+    Qu<dim<rows, cols>, in_t> m;
+    m.fillRandom(1);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(Qreduce<Axis<1>, QuExec<policy>, l0_t, l1_t, l2_t>(m));
+    }
+    state.SetItemsProcessed(state.iterations() * rows * cols);
+}
+
+BENCHMARK(BM_perLayer<64>)->Name("Qreduce/perLayer/64");
+BENCHMARK(BM_perLayer<1024>)->Name("Qreduce/perLayer/1024");
+BENCHMARK(BM_fullPrecision<64>)->Name("Qreduce/fullPrecision/64");
+BENCHMARK(BM_fullPrecision<1024>)->Name("Qreduce/fullPrecision/1024");
+BENCHMARK(BM_rowsByCopy)->Name("Qreduce/rows/copy");
+BENCHMARK(BM_rowsByAxis<Serial>)->Name("Qreduce/rows/axis");
+BENCHMARK(BM_rowsByAxis<Parallel<>>)->Name("Qreduce/rows/axisParallel");
+
+BENCHMARK_MAIN();
@@ -0,0 +1,76 @@
+#include "QuBLAS.h"
+#include <benchmark/benchmark.h>
+
+using namespace QuBLAS;
+
+using a_t = Qu<intBits<4>, fracBits<10>>;
+using b_t = Qu<intBits<6>, fracBits<6>, isSigned<false>>;
+using out_t = Qu<intBits<5>, fracBits<8>, QuMode<RND::CONV>, OfMode<SAT::TCPL>>;
+
+constexpr size_t length = 4096;
+
+static void BM_staticMul(benchmark::State &state)
+{
+    Qu<dim<length>, a_t> a;
+    Qu<dim<length>, b_t> b;
+    Qu<dim<length>, out_t> out;
+    a.fillRandom(42, 0);
+    b.fillRandom(42, 1);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            out.data[i] = Qmul<out_t>(a.data[i], b.data[i]);
+        }
+        benchmark::DoNotOptimize(out.data.data());
+    }
+    state.SetItemsProcessed(state.iterations() * length);
+}
+
+// 张量核每次调用只分派一次
+static void BM_dynTensorMul(benchmark::State &state)
+{
+    Qu<dim<length>, a_t> a;
+    Qu<dim<length>, b_t> b;
+    a.fillRandom(42, 0);
+    b.fillRandom(42, 1);
+
+    const QuDynTensor dA(a), dB(b);
+    QuDynTensor out(QuDynFormat::of<out_t>(), {length});
+
+    for (auto _ : state)
+    {
+        QdynMul(out, dA, dB);
+        benchmark::DoNotOptimize(out.data.data());
+    }
+    state.SetItemsProcessed(state.iterations() * length);
+}
+
+// 逐元素的标量运算，每个元素都要分派
+static void BM_dynScalarMul(benchmark::State &state)
+{
+    Qu<dim<length>, a_t> a;
+    Qu<dim<length>, b_t> b;
+    a.fillRandom(42, 0);
+    b.fillRandom(42, 1);
+
+    std::vector<QuDyn> dA(a.data.begin(), a.data.end()), dB(b.data.begin(), b.data.end()), out(length);
+    const QuDynFormat fmt = QuDynFormat::of<out_t>();
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            out[i] = QdynMul(fmt, dA[i], dB[i]);
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * length);
+}
+
+BENCHMARK(BM_staticMul)->Name("QuDyn/static");
+BENCHMARK(BM_dynTensorMul)->Name("QuDyn/tensor");
+BENCHMARK(BM_dynScalarMul)->Name("QuDyn/scalar");
+
+BENCHMARK_MAIN();
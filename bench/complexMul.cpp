@@ -0,0 +1,98 @@
+#include "QuBLAS.h"
+#include <benchmark/benchmark.h>
+
+using namespace QuBLAS;
+
+using part_t = Qu<intBits<3>, fracBits<12>>;
+using c_t = Qcomplex<part_t, part_t>;
+using mul_t = Qu<intBits<5>, fracBits<14>, QuMode<RND::CONV>>;
+using add_t = Qu<intBits<6>, fracBits<12>, QuMode<RND::CONV>, OfMode<SAT::TCPL>>;
+
+constexpr size_t length = 1024;
+
+// 四个乘法器与两个加法器
+using basic_t = BasicComplexMul<acT<mul_t>, bdT<mul_t>, adT<mul_t>, bcT<mul_t>, acbdT<add_t>, adbcT<add_t>>;
+
+// 三个乘法器与五个加法器
+using tf_t = TFComplexMul<abT<mul_t>, cdT<mul_t>, baT<mul_t>, badT<mul_t>, ABT<add_t>, BCT<add_t>>;
+
+template <typename Method>
+static void BM_complexMul(benchmark::State &state)
+{
+    Qu<dim<length>, c_t> a, b;
+    a.fillRandom(1);
+    b.fillRandom(2);
+    std::vector<decltype(Qmul<Method>(c_t(), c_t()))> c(length);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            c[i] = Qmul<Method>(a[i], b[i]);
+        }
+        benchmark::DoNotOptimize(c.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * length);
+}
+
+BENCHMARK(BM_complexMul<basic_t>)->Name("complexMul/basic");
+BENCHMARK(BM_complexMul<tf_t>)->Name("complexMul/TF");
+
+constexpr size_t gemulM = 32, gemulN = 32, gemulK = 64;
+
+// 逐元素 Qmul 后 Qreduce，Qgemul 与之逐位一致
+template <typename Method>
+static void BM_complexGemulElementwise(benchmark::State &state)
+{
+    Qu<dim<gemulM, gemulK>, c_t> A;
+    Qu<dim<gemulK, gemulN>, c_t> B;
+    A.fillRandom(1);
+    B.fillRandom(2);
+    using prod_t = decltype(Qmul<Method>(c_t(), c_t()));
+    Qu<dim<gemulM, gemulN>, Qcomplex<add_t, add_t>> C;
+
+    for (auto _ : state)
+    {
+        for (size_t j = 0; j < gemulN; j++)
+        {
+            for (size_t i = 0; i < gemulM; i++)
+            {
+                Qu<dim<gemulK>, prod_t> products;
+                for (size_t k = 0; k < gemulK; k++)
+                {
+                    products[k] = Qmul<Method>(A[i, k], B[k, j]);
+                }
+                C[i, j] = Qreduce<Qcomplex<add_t, add_t>>(products);
+            }
+        }
+        benchmark::DoNotOptimize(C.data.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * gemulM * gemulN * gemulK);
+}
+
+template <typename Method>
+static void BM_complexGemul(benchmark::State &state)
+{
+    Qu<dim<gemulM, gemulK>, c_t> A;
+    Qu<dim<gemulK, gemulN>, c_t> B;
+    A.fillRandom(1);
+    B.fillRandom(2);
+    Qu<dim<gemulM, gemulN>, Qcomplex<add_t, add_t>> C;
+
+    for (auto _ : state)
+    {
+        Qgemul<QuExec<Serial>, QgemulMulArgs<Method>, QgemulAddArgs<Qcomplex<add_t, add_t>>>(C, A, B);
+        benchmark::DoNotOptimize(C.data.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * gemulM * gemulN * gemulK);
+}
+
+BENCHMARK(BM_complexGemulElementwise<basic_t>)->Name("complexGemul/elementwise/basic");
+BENCHMARK(BM_complexGemulElementwise<tf_t>)->Name("complexGemul/elementwise/TF");
+BENCHMARK(BM_complexGemul<basic_t>)->Name("complexGemul/basic");
+BENCHMARK(BM_complexGemul<tf_t>)->Name("complexGemul/TF");
+
+BENCHMARK_MAIN();
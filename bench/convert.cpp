@@ -0,0 +1,88 @@
+#include "QuBLAS.h"
+#include <benchmark/benchmark.h>
+#include <random>
+
+using namespace QuBLAS;
+
+using from_t = Qu<intBits<10>, fracBits<14>>;
+
+constexpr size_t length = 4096;
+
+std::vector<double> randomDoubles()
+{
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> dist(-1000.0, 1000.0);
+
+    std::vector<double> res(length);
+    for (auto &x : res)
+    {
+        x = dist(rng);
+    }
+    return res;
+}
+
+// 舍去 6 位小数、丢掉 4 位整数，舍入与溢出都会发生
+template <typename QuM, typename OfM>
+static void BM_convert(benchmark::State &state)
+{
+    using to_t = Qu<intBits<6>, fracBits<8>, QuMode<QuM>, OfMode<OfM>>;
+
+    const auto values = randomDoubles();
+    std::vector<from_t> a(length);
+    for (size_t i = 0; i < length; i++)
+    {
+        a[i] = from_t(values[i]);
+    }
+    std::vector<to_t> c(length);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            c[i] = to_t(a[i]);
+        }
+        benchmark::DoNotOptimize(c.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * length);
+}
+
+template <typename QuT>
+static void BM_fromDouble(benchmark::State &state)
+{
+    const auto values = randomDoubles();
+    std::vector<QuT> c(length);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            c[i] = QuT(values[i]);
+        }
+        benchmark::DoNotOptimize(c.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * length);
+}
+
+#define QUBLAS_BENCH_CONVERT(QuM, OfM) BENCHMARK(BM_convert<QuM, OfM>)->Name("convert/" #QuM "/" #OfM)
+
+#define QUBLAS_BENCH_CONVERT_ALL_OF(QuM)       \
+    QUBLAS_BENCH_CONVERT(QuM, SAT::TCPL);      \
+    QUBLAS_BENCH_CONVERT(QuM, SAT::ZERO);      \
+    QUBLAS_BENCH_CONVERT(QuM, SAT::SMGN);      \
+    QUBLAS_BENCH_CONVERT(QuM, WRP::TCPL)
+
+QUBLAS_BENCH_CONVERT_ALL_OF(RND::POS_INF);
+QUBLAS_BENCH_CONVERT_ALL_OF(RND::NEG_INF);
+QUBLAS_BENCH_CONVERT_ALL_OF(RND::ZERO);
+QUBLAS_BENCH_CONVERT_ALL_OF(RND::INF);
+QUBLAS_BENCH_CONVERT_ALL_OF(RND::CONV);
+QUBLAS_BENCH_CONVERT_ALL_OF(TRN::TCPL);
+QUBLAS_BENCH_CONVERT_ALL_OF(TRN::SMGN);
+
+BENCHMARK(BM_fromDouble<Qu<intBits<12>, fracBits<12>>>)->Name("fromDouble/24");
+BENCHMARK(BM_fromDouble<Qu<intBits<12>, fracBits<12>, QuMode<RND::CONV>, OfMode<SAT::TCPL>>>)->Name("fromDouble/24/CONV");
+BENCHMARK(BM_fromDouble<Qu<intBits<40>, fracBits<40>>>)->Name("fromDouble/80");
+
+BENCHMARK_MAIN();
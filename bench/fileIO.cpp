@@ -0,0 +1,71 @@
+#include "QuBLAS.h"
+#include <benchmark/benchmark.h>
+#include <filesystem>
+
+using namespace QuBLAS;
+
+using tensor_t = Qu<dim<512, 512>, Qu<intBits<8>, fracBits<8>>>;
+
+static std::string tempFile(const std::string &name)
+{
+    return (std::filesystem::temp_directory_path() / ("QuBLAS_bench_" + name)).string();
+}
+
+// 逐元素 toDouble 写成文本
+static void BM_toMatlab(benchmark::State &state)
+{
+    tensor_t t;
+    t.fill();
+
+    for (auto _ : state)
+    {
+        t.toMatlab(tempFile("matlab.txt"));
+    }
+    state.SetBytesProcessed(state.iterations() * tensor_t::elemSize * sizeof(tensor_t::elem_t));
+}
+
+static void BM_toNpy(benchmark::State &state)
+{
+    tensor_t t;
+    t.fill();
+
+    for (auto _ : state)
+    {
+        t.toNpy(tempFile("tensor.npy"));
+    }
+    state.SetBytesProcessed(state.iterations() * tensor_t::elemSize * sizeof(tensor_t::elem_t));
+}
+
+static void BM_fromRaw(benchmark::State &state)
+{
+    tensor_t t;
+    t.fill();
+    t.toRaw(tempFile("tensor.bin"));
+
+    for (auto _ : state)
+    {
+        t.fromRaw(tempFile("tensor.bin"));
+        benchmark::DoNotOptimize(t);
+    }
+    state.SetBytesProcessed(state.iterations() * tensor_t::elemSize * sizeof(tensor_t::elem_t));
+}
+
+static void BM_mapped(benchmark::State &state)
+{
+    tensor_t t;
+    t.fill();
+    t.toRaw(tempFile("tensor.bin"));
+
+    for (auto _ : state)
+    {
+        QuMapped<tensor_t> mapped(tempFile("tensor.bin"));
+        benchmark::DoNotOptimize(mapped[511, 511]);
+    }
+}
+
+BENCHMARK(BM_toMatlab)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_toNpy)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_fromRaw)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_mapped)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
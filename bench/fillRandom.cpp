@@ -0,0 +1,46 @@
+#include "QuBLAS.h"
+#include <benchmark/benchmark.h>
+
+using namespace QuBLAS;
+
+using tensor_t = Qu<dim<256, 256>, Qu<intBits<5>, fracBits<6>>>;
+
+// 共享的 mt19937 与分布，逐元素串行
+static void BM_fill(benchmark::State &state)
+{
+    tensor_t t;
+    for (auto _ : state)
+    {
+        t.fill();
+        benchmark::DoNotOptimize(t);
+    }
+    state.SetItemsProcessed(state.iterations() * tensor_t::elemSize);
+}
+
+static void BM_fillRandom(benchmark::State &state)
+{
+    tensor_t t;
+    for (auto _ : state)
+    {
+        t.fillRandom(42);
+        benchmark::DoNotOptimize(t);
+    }
+    state.SetItemsProcessed(state.iterations() * tensor_t::elemSize);
+}
+
+static void BM_QfillRandomParallel(benchmark::State &state)
+{
+    tensor_t t;
+    for (auto _ : state)
+    {
+        QfillRandom<QuExec<Parallel<>>>(t, 42);
+        benchmark::DoNotOptimize(t);
+    }
+    state.SetItemsProcessed(state.iterations() * tensor_t::elemSize);
+}
+
+BENCHMARK(BM_fill)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_fillRandom)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_QfillRandomParallel)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
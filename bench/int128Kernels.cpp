@@ -0,0 +1,67 @@
+#include "QuBLAS.h"
+#include <benchmark/benchmark.h>
+
+using namespace QuBLAS;
+
+constexpr size_t length = 4096;
+
+template <size_t N>
+std::vector<ArbiInt<N>> randomInputs()
+{
+    std::vector<ArbiInt<N>> res(length);
+    for (auto &x : res)
+    {
+        x.fill();
+    }
+    return res;
+}
+
+// 70 位乘 50 位、累加到 121 位，是全精度乘积与树形归约里最常见的宽度
+template <bool words>
+static void BM_mulAdd(benchmark::State &state)
+{
+    const auto a = randomInputs<70>();
+    const auto b = randomInputs<50>();
+    std::vector<ArbiInt<121>> c(length);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            if constexpr (words)
+            {
+                c[i] = addSubWords<false, 121>(mulWords<120>(a[i], b[i]), a[i]);
+            }
+            else
+            {
+                c[i] = a[i] * b[i] + a[i];
+            }
+        }
+        benchmark::DoNotOptimize(c.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * length);
+}
+
+static void BM_compare(benchmark::State &state)
+{
+    const auto a = randomInputs<100>();
+    const auto b = randomInputs<90>();
+
+    for (auto _ : state)
+    {
+        size_t count = 0;
+        for (size_t i = 0; i < length; i++)
+        {
+            count += a[i] < b[i];
+        }
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetItemsProcessed(state.iterations() * length);
+}
+
+BENCHMARK(BM_mulAdd<true>)->Name("mulAdd/words");
+BENCHMARK(BM_mulAdd<false>)->Name("mulAdd/int128");
+BENCHMARK(BM_compare)->Name("compare");
+
+BENCHMARK_MAIN();
@@ -0,0 +1,62 @@
+#include "QuBLAS.h"
+#include <benchmark/benchmark.h>
+#include <random>
+
+using namespace QuBLAS;
+
+using a_t = Qu<intBits<12>, fracBits<12>>;
+using b_t = Qu<intBits<8>, fracBits<16>>;
+using out_t = Qu<intBits<14>, fracBits<10>, QuMode<RND::CONV>, OfMode<SAT::TCPL>>;
+
+using mul_t = Qmul_s<a_t, b_t, MergerArgsWrapper<out_t>>;
+using add_t = Qadd_s<a_t, b_t, MergerArgsWrapper<out_t>>;
+
+// 33 位乘 33 位，ArbiInt 实现需要多字乘法
+using w_t = Qu<intBits<16>, fracBits<16>>;
+using wOut_t = Qu<intBits<20>, fracBits<24>, QuMode<RND::CONV>, OfMode<SAT::TCPL>>;
+
+using wideMul_t = Qmul_s<w_t, w_t, MergerArgsWrapper<wOut_t>>;
+
+constexpr size_t length = 4096;
+
+template <typename QuT>
+std::vector<QuT> randomInputs()
+{
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> dist(-8.0, 8.0);
+
+    std::vector<QuT> res(length);
+    for (auto &x : res)
+    {
+        x = QuT(dist(rng));
+    }
+    return res;
+}
+
+template <auto op, typename A = a_t, typename B = b_t, typename C = out_t>
+static void BM_binary(benchmark::State &state)
+{
+    const auto a = randomInputs<A>();
+    const auto b = randomInputs<B>();
+    std::vector<C> c(length);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            c[i] = op(a[i], b[i]);
+        }
+        benchmark::DoNotOptimize(c.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * length);
+}
+
+BENCHMARK(BM_binary<mul_t::mulWide>)->Name("Qmul/wide");
+BENCHMARK(BM_binary<mul_t::mul>)->Name("Qmul/native");
+BENCHMARK(BM_binary<add_t::addWide>)->Name("Qadd/wide");
+BENCHMARK(BM_binary<add_t::add>)->Name("Qadd/native");
+BENCHMARK(BM_binary<wideMul_t::mulWide, w_t, w_t, wOut_t>)->Name("Qmul33/wide");
+BENCHMARK(BM_binary<wideMul_t::mul, w_t, w_t, wOut_t>)->Name("Qmul33/native");
+
+BENCHMARK_MAIN();
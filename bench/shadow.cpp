@@ -0,0 +1,91 @@
+#include "QuBLAS.h"
+#include <benchmark/benchmark.h>
+#include <random>
+
+using namespace QuBLAS;
+
+using a_t = Qu<intBits<4>, fracBits<10>>;
+using out_t = Qu<intBits<6>, fracBits<8>, QuMode<RND::CONV>, OfMode<SAT::TCPL>>;
+using as_t = Qu<a_t, Shadow<double>>;
+
+constexpr size_t length = 4096;
+
+std::vector<double> randomDoubles()
+{
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> dist(-8.0, 8.0);
+
+    std::vector<double> res(2 * length);
+    for (auto &x : res)
+    {
+        x = dist(rng);
+    }
+    return res;
+}
+
+template <typename T>
+Qu<dim<length>, T> makeTensor(const std::vector<double> &x, size_t offset)
+{
+    Qu<dim<length>, T> res;
+    for (size_t i = 0; i < length; i++)
+    {
+        res[i] = T(x[offset + i]);
+    }
+    return res;
+}
+
+// y = a * b + a，先跑定点版本、再跑 double 版本，然后逐个比较两次运算的结果，得到与影子相同的统计
+static void BM_twoPasses(benchmark::State &state)
+{
+    constexpr double scale = std::ldexp(1.0, -out_t::fracB);
+    constexpr double hi = std::ldexp(1.0, out_t::intB) - scale;
+    constexpr double lo = -std::ldexp(1.0, out_t::intB);
+
+    const auto x = randomDoubles();
+    const auto a = makeTensor<a_t>(x, 0);
+    const auto b = makeTensor<a_t>(x, length);
+    Qu<dim<length>, out_t> prod, y;
+    std::vector<double> refProd(length), refY(length);
+
+    for (auto _ : state)
+    {
+        Qassign(prod, Qmul<out_t>(a, b));
+        Qassign(y, Qadd<out_t>(prod, a));
+        for (size_t i = 0; i < length; i++)
+        {
+            refProd[i] = x[i] * x[length + i];
+            refY[i] = refProd[i] + x[i];
+        }
+
+        QuShadowStats stats;
+        for (size_t i = 0; i < length; i++)
+        {
+            stats.record(prod[i].toDouble(), refProd[i], lo, hi);
+            stats.record(y[i].toDouble(), refY[i], lo, hi);
+        }
+        benchmark::DoNotOptimize(stats.mse());
+    }
+    state.SetItemsProcessed(state.iterations() * length);
+}
+
+static void BM_shadow(benchmark::State &state)
+{
+    const auto x = randomDoubles();
+    const auto a = makeTensor<as_t>(x, 0);
+    const auto b = makeTensor<as_t>(x, length);
+    Qu<dim<length>, Qu<out_t, Shadow<double>>> prod, y;
+
+    for (auto _ : state)
+    {
+        QuShadow::reset();
+        Qassign(prod, Qmul<out_t>(a, b));
+        Qassign(y, Qadd<out_t>(prod, a));
+        benchmark::DoNotOptimize(QuShadow::stats().mse());
+    }
+    state.SetItemsProcessed(state.iterations() * length);
+}
+
+BENCHMARK(BM_twoPasses)->Name("shadow/twoPasses");
+BENCHMARK(BM_shadow)->Name("shadow/onePass");
+
+BENCHMARK_MAIN();
@@ -0,0 +1,45 @@
+#include "QuBLAS.h"
+#include <benchmark/benchmark.h>
+
+using namespace QuBLAS;
+
+using elem_t = Qu<intBits<8>, fracBits<8>>;
+using tensor_t = Qu<dim<64, 32, 8>, elem_t>;
+
+// 按线性下标逐元素读取视图，与普通表达式的拷贝方式相同
+static void BM_elementCopy(benchmark::State &state)
+{
+    tensor_t t;
+    t.fill();
+    auto view = Qslice<sr<1, 8, 24>, sr<2, 2, 6>>(t);
+
+    for (auto _ : state)
+    {
+        Qu<dim<64, 16, 4>, elem_t> res;
+        for (size_t i = 0; i < res.elemSize; i++)
+        {
+            res[i] = view[i];
+        }
+        benchmark::DoNotOptimize(res);
+    }
+    state.SetItemsProcessed(state.iterations() * 64 * 16 * 4);
+}
+
+// 视图的每一段 16 * 64 个元素在根张量中连续，整段复制
+static void BM_viewCopy(benchmark::State &state)
+{
+    tensor_t t;
+    t.fill();
+
+    for (auto _ : state)
+    {
+        Qu<dim<64, 16, 4>, elem_t> res = Qslice<sr<1, 8, 24>, sr<2, 2, 6>>(t);
+        benchmark::DoNotOptimize(res);
+    }
+    state.SetItemsProcessed(state.iterations() * 64 * 16 * 4);
+}
+
+BENCHMARK(BM_elementCopy);
+BENCHMARK(BM_viewCopy);
+
+BENCHMARK_MAIN();
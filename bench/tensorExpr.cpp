@@ -0,0 +1,47 @@
+#include "QuBLAS.h"
+#include <benchmark/benchmark.h>
+
+using namespace QuBLAS;
+
+using a_t = Qu<intBits<4>, fracBits<10>>;
+using out_t = Qu<intBits<6>, fracBits<8>, QuMode<RND::CONV>, OfMode<SAT::TCPL>>;
+
+using mat_t = Qu<dim<64, 64>, a_t>;
+using outMat_t = Qu<dim<64, 64>, out_t>;
+
+// 先生成临时张量再拷贝
+static void BM_eager(benchmark::State &state)
+{
+    mat_t a, b;
+    a.fillRandom(1);
+    b.fillRandom(2);
+
+    for (auto _ : state)
+    {
+        outMat_t c = Qmul<out_t>(a, b);
+        benchmark::DoNotOptimize(c.data.data());
+    }
+    state.SetItemsProcessed(state.iterations() * mat_t::elemSize);
+}
+
+template <typename policy>
+static void BM_Qassign(benchmark::State &state)
+{
+    mat_t a, b;
+    outMat_t c;
+    a.fillRandom(1);
+    b.fillRandom(2);
+
+    for (auto _ : state)
+    {
+        Qassign<QuExec<policy>>(c, Qmul<out_t>(a, b));
+        benchmark::DoNotOptimize(c.data.data());
+    }
+    state.SetItemsProcessed(state.iterations() * mat_t::elemSize);
+}
+
+BENCHMARK(BM_eager)->Name("tensorExpr/eager");
+BENCHMARK(BM_Qassign<Serial>)->Name("tensorExpr/Qassign/serial");
+BENCHMARK(BM_Qassign<Parallel<>>)->Name("tensorExpr/Qassign/parallel");
+
+BENCHMARK_MAIN();
@@ -0,0 +1,338 @@
+// C++20 模块接口：import QuBLAS; 与 #include "QuBLAS.h" 提供相同的名称
+// 头文件只在构建本模块时解析一次，导入方直接读取编译好的模块接口，不再重复解析与实例化头文件中的模板机制
+// 需要 CMake 3.28+ 与支持模块的编译器（GCC 14+、Clang 17+、MSVC 17.8+），见 CMakeLists.txt 中的 QUBLAS_BUILD_MODULE
+// 头文件新增命名空间作用域的名称时需要在这里一并导出
+
+module;
+
+#include "QuBLAS.h"
+
+export module QuBLAS;
+
+export inline namespace QuBLAS {
+
+// ArbiInt 的运算符通过 ADL 查找，也必须导出
+
+using QuBLAS::operator+;
+using QuBLAS::operator-;
+using QuBLAS::operator*;
+using QuBLAS::operator/;
+using QuBLAS::operator&;
+using QuBLAS::operator|;
+using QuBLAS::operator^;
+using QuBLAS::operator~;
+using QuBLAS::operator==;
+using QuBLAS::operator!=;
+using QuBLAS::operator<=>;
+
+using QuBLAS::abcT;
+using QuBLAS::AbsExpression;
+using QuBLAS::absWords;
+using QuBLAS::ABT;
+using QuBLAS::abT;
+using QuBLAS::acbdT;
+using QuBLAS::acT;
+using QuBLAS::adbcT;
+using QuBLAS::addCarry;
+using QuBLAS::AddExpression;
+using QuBLAS::AddMerger;
+using QuBLAS::addSubWords;
+using QuBLAS::adT;
+using QuBLAS::AoS;
+using QuBLAS::ArbiInt;
+using QuBLAS::ArbiIntLanes;
+using QuBLAS::autoCall;
+using QuBLAS::Axis;
+using QuBLAS::badT;
+using QuBLAS::Banded;
+using QuBLAS::BasicComplexMul;
+using QuBLAS::baT;
+using QuBLAS::BCT;
+using QuBLAS::bcT;
+using QuBLAS::bdT;
+using QuBLAS::big_integer_to_string;
+using QuBLAS::BitPack;
+using QuBLAS::BitPack_s;
+using QuBLAS::BitPackWords;
+using QuBLAS::BitStream;
+using QuBLAS::BitStream_s;
+using QuBLAS::BitUnpack;
+using QuBLAS::BlockDiagonal;
+using QuBLAS::cdbT;
+using QuBLAS::cdT;
+using QuBLAS::ComplexMulMethod;
+using QuBLAS::CSC;
+using QuBLAS::CSR;
+using QuBLAS::defaultFracBits;
+using QuBLAS::defaultIntBits;
+using QuBLAS::defaultIsSigned;
+using QuBLAS::defaultOfMode;
+using QuBLAS::defaultQuMode;
+using QuBLAS::dim;
+using QuBLAS::dimArrayExtractor;
+using QuBLAS::dimExtractor;
+using QuBLAS::dimRemoveAxis_s;
+using QuBLAS::DivExpression;
+using QuBLAS::divide_by_uint64;
+using QuBLAS::divideWords;
+using QuBLAS::doubleConvert;
+using QuBLAS::dynAddPlan;
+using QuBLAS::dynAddSub;
+using QuBLAS::dynCheckKernel;
+using QuBLAS::dynCheckShapes;
+using QuBLAS::dynFromDouble;
+using QuBLAS::dynModeDispatch;
+using QuBLAS::dynMulPlan;
+using QuBLAS::dynOverflow;
+using QuBLAS::dynPlan;
+using QuBLAS::dynRound;
+using QuBLAS::dynWidthDispatch;
+using QuBLAS::FftInverse;
+using QuBLAS::FftScale;
+using QuBLAS::FftScaling;
+using QuBLAS::fitsInt128;
+using QuBLAS::fracBits;
+using QuBLAS::fracConvert;
+using QuBLAS::FullPrec;
+using QuBLAS::gen;
+using QuBLAS::hasSoaRefOperand;
+using QuBLAS::imagT;
+using QuBLAS::intBits;
+using QuBLAS::intConvert;
+using QuBLAS::isA;
+using QuBLAS::isA_s;
+using QuBLAS::isParallel;
+using QuBLAS::isQuView;
+using QuBLAS::isScalar;
+using QuBLAS::isScalar_s;
+using QuBLAS::isShadow;
+using QuBLAS::isShadowBatch;
+using QuBLAS::isSigned;
+using QuBLAS::isSoaRef;
+using QuBLAS::isSoaRef_s;
+using QuBLAS::isSparse;
+using QuBLAS::isSparseLayout;
+using QuBLAS::isSquareBracketIndexable;
+using QuBLAS::l2r;
+using QuBLAS::laneAbsLimbs;
+using QuBLAS::laneAddSub;
+using QuBLAS::laneForEach;
+using QuBLAS::laneLess;
+using QuBLAS::laneLoad;
+using QuBLAS::laneMul32;
+using QuBLAS::laneSign;
+using QuBLAS::laneSplat;
+using QuBLAS::laneStore;
+using QuBLAS::laneSVec_t;
+using QuBLAS::laneVec_t;
+using QuBLAS::laneVectorBytes;
+using QuBLAS::laneVecWidth;
+using QuBLAS::laneWord;
+using QuBLAS::layout;
+using QuBLAS::loadInt128;
+using QuBLAS::MergerArgsWrapper;
+using QuBLAS::MergerArgsWrapper_s;
+using QuBLAS::MulExpression;
+using QuBLAS::MulMerger;
+using QuBLAS::mulWide;
+using QuBLAS::mulWords;
+using QuBLAS::nativeInt_t;
+using QuBLAS::nativeKernel;
+using QuBLAS::nativeOverflow;
+using QuBLAS::nativeRound;
+using QuBLAS::NegExpression;
+using QuBLAS::NormRand;
+using QuBLAS::OfMode;
+using QuBLAS::ofModeName;
+using QuBLAS::PackedBitReader;
+using QuBLAS::PackedBitWriter;
+using QuBLAS::PackedElement_s;
+using QuBLAS::PackedElementOrder_s;
+using QuBLAS::PackedTensorOrder_s;
+using QuBLAS::packIndex;
+using QuBLAS::Parallel;
+using QuBLAS::payloadWords;
+using QuBLAS::Philox4x32;
+using QuBLAS::pipelineArgs_s;
+using QuBLAS::pipelineStage_s;
+using QuBLAS::probeConvert;
+using QuBLAS::probeInexact;
+using QuBLAS::probeRecord;
+using QuBLAS::Qabs;
+using QuBLAS::Qabs_s;
+using QuBLAS::QabsTensor_s;
+using QuBLAS::Qadd;
+using QuBLAS::Qadd_s;
+using QuBLAS::QaddTensor_s;
+using QuBLAS::Qassign;
+using QuBLAS::Qcmp_s;
+using QuBLAS::Qcomplex;
+using QuBLAS::QcomplexPlanes;
+using QuBLAS::Qconv2d;
+using QuBLAS::Qconv2d_s;
+using QuBLAS::QconvPadding;
+using QuBLAS::QconvStride;
+using QuBLAS::Qdiv;
+using QuBLAS::Qdiv_s;
+using QuBLAS::QdivTensor_s;
+using QuBLAS::Qdot;
+using QuBLAS::Qdot_s;
+using QuBLAS::QdotAddArgs;
+using QuBLAS::QdotKernel;
+using QuBLAS::QdotLeaves;
+using QuBLAS::QdotMulArgs;
+using QuBLAS::QdynAdd;
+using QuBLAS::QdynConvert;
+using QuBLAS::QdynMul;
+using QuBLAS::QdynSub;
+using QuBLAS::Qeq;
+using QuBLAS::Qeq_s;
+using QuBLAS::Qfft;
+using QuBLAS::Qfft_s;
+using QuBLAS::QfftBatch;
+using QuBLAS::QfftResult;
+using QuBLAS::QfillRandom;
+using QuBLAS::Qfir;
+using QuBLAS::QfirAddArgs;
+using QuBLAS::QfirMulArgs;
+using QuBLAS::QfirWindow;
+using QuBLAS::Qgemul;
+using QuBLAS::Qgemul_s;
+using QuBLAS::QgemulAddArgs;
+using QuBLAS::QgemulMulArgs;
+using QuBLAS::QgemulTransposedA;
+using QuBLAS::QgemulTransposedB;
+using QuBLAS::Qgemv;
+using QuBLAS::QgemvTransposedA;
+using QuBLAS::Qmul;
+using QuBLAS::Qmul_s;
+using QuBLAS::QmulTensor_s;
+using QuBLAS::Qneg;
+using QuBLAS::Qneg_s;
+using QuBLAS::QnegTensor_s;
+using QuBLAS::Qpipeline;
+using QuBLAS::QpipelineDepth;
+using QuBLAS::QpipelineEdge;
+using QuBLAS::QpipelineStage;
+using QuBLAS::QpipelineStage_s;
+using QuBLAS::Qreduce;
+using QuBLAS::QreduceAxis_s;
+using QuBLAS::Qslice;
+using QuBLAS::QsparseBlas_s;
+using QuBLAS::Qsub;
+using QuBLAS::Qsub_s;
+using QuBLAS::QsubTensor_s;
+using QuBLAS::Qu;
+using QuBLAS::Qu_s;
+using QuBLAS::QuArena;
+using QuBLAS::QuAsyncBuffer;
+using QuBLAS::QuAsyncFileWriter;
+using QuBLAS::QuAsyncStream;
+using QuBLAS::QuCoo;
+using QuBLAS::QuDyn;
+using QuBLAS::QuDynFormat;
+using QuBLAS::QuDynTensor;
+using QuBLAS::QuExec;
+using QuBLAS::QuFile;
+using QuBLAS::QuFile_s;
+using QuBLAS::QuFileElement_s;
+using QuBLAS::QuFileWriter;
+using QuBLAS::quFormatName;
+using QuBLAS::QuHeapBuffer;
+using QuBLAS::quHeapThreshold;
+using QuBLAS::QuHugePageResource;
+using QuBLAS::QuInputHelper;
+using QuBLAS::QuMapped;
+using QuBLAS::QuMemory;
+using QuBLAS::QuMemoryScope;
+using QuBLAS::QuMode;
+using QuBLAS::quModeName;
+using QuBLAS::QuMpmcRing;
+using QuBLAS::QuProbe;
+using QuBLAS::QuProbeSite;
+using QuBLAS::QuProbeStats;
+using QuBLAS::QuShadow;
+using QuBLAS::QuShadowStats;
+using QuBLAS::QuSparseLines;
+using QuBLAS::QuSpscRing;
+using QuBLAS::QuSweep;
+using QuBLAS::QuSweepResult;
+using QuBLAS::QuSweepSample;
+using QuBLAS::QuSweepShards;
+using QuBLAS::QuThreadPool;
+using QuBLAS::quTypeName_s;
+using QuBLAS::QuView;
+using QuBLAS::r2l;
+using QuBLAS::Radix;
+using QuBLAS::rd;
+using QuBLAS::realT;
+using QuBLAS::Reducer;
+using QuBLAS::ReducerInputHelper;
+using QuBLAS::RND;
+using QuBLAS::SAT;
+using QuBLAS::Serial;
+using QuBLAS::Shadow;
+using QuBLAS::shadowOf;
+using QuBLAS::shadowOf_s;
+using QuBLAS::shadowRef;
+using QuBLAS::shadowRef_t;
+using QuBLAS::shadowValue;
+using QuBLAS::signExtWord;
+using QuBLAS::SingleString_s;
+using QuBLAS::sizeMerger;
+using QuBLAS::SliceExpression;
+using QuBLAS::sliceView_s;
+using QuBLAS::SoA;
+using QuBLAS::soaPlanes;
+using QuBLAS::soaRef;
+using QuBLAS::soaRefBase;
+using QuBLAS::sr;
+using QuBLAS::srd;
+using QuBLAS::StageTypes;
+using QuBLAS::staticDivide;
+using QuBLAS::staticShiftLeft;
+using QuBLAS::staticShiftRight;
+using QuBLAS::storeInt128;
+using QuBLAS::str2Qcomplex;
+using QuBLAS::string_to_big_integer;
+using QuBLAS::subBorrow;
+using QuBLAS::SubExpression;
+using QuBLAS::tagExtractor;
+using QuBLAS::TensorString_s;
+using QuBLAS::TFComplexMul;
+using QuBLAS::toTuple;
+using QuBLAS::TRN;
+using QuBLAS::TwiddleT;
+using QuBLAS::TypeAt;
+using QuBLAS::TypeAt_s;
+using QuBLAS::TypeList;
+using QuBLAS::UniRand;
+using QuBLAS::unwrapRef;
+using QuBLAS::useInt128;
+using QuBLAS::useProbe;
+using QuBLAS::viewStride;
+using QuBLAS::viewTraits;
+using QuBLAS::wordAt;
+using QuBLAS::WRP;
+
+namespace ANUS {
+
+using QuBLAS::ANUS::Qapprox;
+using QuBLAS::ANUS::Qapprox_s;
+using QuBLAS::ANUS::QapproxDispatcher;
+using QuBLAS::ANUS::Qmemo;
+using QuBLAS::ANUS::Qmemo_s;
+using QuBLAS::ANUS::QmemoMaxBits;
+using QuBLAS::ANUS::Qpoly;
+using QuBLAS::ANUS::Qtable;
+using QuBLAS::ANUS::Qtable_s;
+using QuBLAS::ANUS::QtableIndexBits;
+using QuBLAS::ANUS::quMemoMaxBits;
+using QuBLAS::ANUS::reciprocalFunc;
+using QuBLAS::ANUS::rsqrtFunc;
+using QuBLAS::ANUS::Segment;
+using QuBLAS::ANUS::sqrtFunc;
+
+} // namespace ANUS
+
+} // namespace QuBLAS
@@ -2,34 +2,132 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
 #include <bitset>
 #include <cmath>
 #include <complex>
+#include <condition_variable>
 #include <csignal>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <deque>
+#include <fcntl.h>
 #include <fstream>
 #include <functional>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <numbers>
 #include <numeric>
+#include <optional>
 #include <random>
 #include <ranges>
+#include <span>
+#include <sstream>
 #include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <sys/mman.h>
 #include <sys/resource.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <type_traits>
+#include <typeinfo>
+#include <unistd.h>
 #include <utility>
+#include <vector>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 inline namespace QuBLAS {
 
 // ------------------- Random -------------------
 
-static std::random_device rd;
-static std::mt19937 gen(1);
-static std::uniform_int_distribution<uint64_t> UniRand(std::numeric_limits<uint64_t>::min(), std::numeric_limits<uint64_t>::max()); // 整数的全范围分布
-static std::normal_distribution<double> NormRand(0, 1);                                                                             // 正态分布
+inline std::random_device rd;
+inline std::mt19937 gen(1);
+inline std::uniform_int_distribution<uint64_t> UniRand(std::numeric_limits<uint64_t>::min(), std::numeric_limits<uint64_t>::max()); // 整数的全范围分布
+inline std::normal_distribution<double> NormRand(0, 1);                                                                             // 正态分布
+
+// 计数器随机数 Philox4x32-10 (Salmon et al., SC'11)：输出只取决于 (key, counter)，没有内部状态，可以按任意顺序在任意线程生成
+struct Philox4x32
+{
+    using counter_t = std::array<uint32_t, 4>;
+    using key_t = std::array<uint32_t, 2>;
+
+    static constexpr counter_t block(counter_t ctr, key_t key)
+    {
+        for (int round = 0; round < 10; round++)
+        {
+            const uint64_t p0 = uint64_t(0xD2511F53) * ctr[0];
+            const uint64_t p1 = uint64_t(0xCD9E8D57) * ctr[2];
+            ctr = {uint32_t(p1 >> 32) ^ ctr[1] ^ key[0], uint32_t(p1), uint32_t(p0 >> 32) ^ ctr[3] ^ key[1], uint32_t(p0)};
+            key[0] += 0x9E3779B9;
+            key[1] += 0xBB67AE85;
+        }
+        return ctr;
+    }
+
+    // 第 index 个元素的 count 个 64 位随机字，计数器为 (index, 块序号, stream)
+    static constexpr void words(uint64_t seed, uint32_t stream, uint64_t index, uint64_t *out, size_t count)
+    {
+        for (size_t j = 0; j < count; j += 2)
+        {
+            const counter_t r = block({uint32_t(index), uint32_t(index >> 32), uint32_t(j / 2), stream}, {uint32_t(seed), uint32_t(seed >> 32)});
+            out[j] = r[0] | uint64_t(r[1]) << 32;
+            if (j + 1 < count)
+            {
+                out[j + 1] = r[2] | uint64_t(r[3]) << 32;
+            }
+        }
+    }
+
+    // 从 first 开始的 lanes 个元素各自的第一个随机字，与 words 的结果相同
+    // 计数器按通道分开存放，每一轮都是同样的标量运算，便于编译器向量化
+    template <size_t lanes>
+    static constexpr void firstWords(uint64_t seed, uint32_t stream, uint64_t first, uint64_t *out)
+    {
+        uint32_t c0[lanes], c1[lanes], c2[lanes], c3[lanes];
+        for (size_t l = 0; l < lanes; l++)
+        {
+            c0[l] = uint32_t(first + l);
+            c1[l] = uint32_t((first + l) >> 32);
+            c2[l] = 0;
+            c3[l] = stream;
+        }
+
+        key_t key = {uint32_t(seed), uint32_t(seed >> 32)};
+        for (int round = 0; round < 10; round++)
+        {
+            for (size_t l = 0; l < lanes; l++)
+            {
+                const uint64_t p0 = uint64_t(0xD2511F53) * c0[l];
+                const uint64_t p1 = uint64_t(0xCD9E8D57) * c2[l];
+                c0[l] = uint32_t(p1 >> 32) ^ c1[l] ^ key[0];
+                c1[l] = uint32_t(p1);
+                c2[l] = uint32_t(p0 >> 32) ^ c3[l] ^ key[1];
+                c3[l] = uint32_t(p0);
+            }
+            key[0] += 0x9E3779B9;
+            key[1] += 0xBB67AE85;
+        }
+
+        for (size_t l = 0; l < lanes; l++)
+        {
+            out[l] = c0[l] | uint64_t(c1[l]) << 32;
+        }
+    }
+};
 
 // ------------------- TypeList -------------------
 
@@ -535,6 +633,26 @@ public:
         return *this;
     }
 
+    // 取随机字的高 bits 位，isSigned 时符号扩展，否则零扩展
+    template <size_t bits, bool isSigned>
+    constexpr auto &fillBits(const uint64_t *words)
+    {
+        static_assert(bits <= N, "too many random bits");
+        if constexpr (bits == 0)
+        {
+            data = 0;
+        }
+        else if constexpr (isSigned)
+        {
+            data = static_cast<data_t>(static_cast<int64_t>(words[0]) >> (64 - bits));
+        }
+        else
+        {
+            data = static_cast<data_t>(words[0] >> (64 - bits));
+        }
+        return *this;
+    }
+
     constexpr auto toString() const
     {
         return std::to_string(data);
@@ -583,7 +701,10 @@ public:
     {
         ArbiInt<N> result;
         result.data.fill(~uint64_t(0));
-        result.data[num_words - 1] = ~uint64_t(0) >> (64 - N % 64);
+        if constexpr (N % 64 != 0)
+        {
+            result.data[num_words - 1] = ~uint64_t(0) >> (64 - N % 64);
+        }
         return result;
     }
 
@@ -594,8 +715,8 @@ public:
         result.data.fill(~uint64_t(0));
 
         // how many last bits are set to 1 in the last uint64_t
-        size_t oneBits = N % 64 - 1;
-        result.data[num_words - 1] = (oneBits == 0) ? ~uint64_t(0) : ~(~uint64_t(0) << oneBits);
+        constexpr size_t oneBits = (N - 1) % 64;
+        result.data[num_words - 1] = (oneBits == 0) ? uint64_t(0) : ~(~uint64_t(0) << oneBits);
 
         return result;
     }
@@ -605,7 +726,10 @@ public:
     {
         ArbiInt<N> result;
         result.data.fill(0);
-        result.data[num_words - 1] = ~uint64_t(0) << (N % 64);
+        if constexpr (N % 64 != 0)
+        {
+            result.data[num_words - 1] = ~uint64_t(0) << (N % 64);
+        }
         return result;
     }
 
@@ -812,9 +936,32 @@ public:
                 data[i] = UniRand(gen);
             }
 
-            // generate a random number with the full range of - 2^(N%64-1) to 2^(N%64-1) - 1
-            static std::uniform_int_distribution<uint64_t> dist(-(int64_t(1) << (N % 64 - 1)), (int64_t(1) << (N % 64 - 1)) - 1);
-            data[num_words - 1] = dist(gen);
+            // generate a random number with the full range of - 2^(N%64-1) to 2^(N%64-1) - 1, sign extended to the whole word
+            data[num_words - 1] = static_cast<uint64_t>(static_cast<int64_t>(UniRand(gen) << (64 - N % 64)) >> (64 - N % 64));
+        }
+        return *this;
+    }
+
+    // 低位的字直接取随机字，最高的部分字取高位并扩展
+    template <size_t bits, bool isSigned>
+    constexpr auto &fillBits(const uint64_t *words)
+    {
+        static_assert(bits <= N, "too many random bits");
+        for (size_t i = 0; i < num_words; ++i)
+        {
+            if (64 * (i + 1) <= bits)
+            {
+                data[i] = words[i];
+            }
+            else if (64 * i < bits)
+            {
+                const size_t shift = 64 * (i + 1) - bits;
+                data[i] = isSigned ? static_cast<uint64_t>(static_cast<int64_t>(words[i]) >> shift) : words[i] >> shift;
+            }
+            else
+            {
+                data[i] = isSigned && i > 0 ? static_cast<uint64_t>(static_cast<int64_t>(data[i - 1]) >> 63) : 0;
+            }
         }
         return *this;
     }
@@ -911,6 +1058,200 @@ public:
     }
 };
 
+// ------------------- Word kernels -------------------
+// Carry chains and 64x64->128 products used by the multi-word operators. The intrinsics are only used at runtime, constant evaluation takes the
+// portable __uint128_t path.
+
+// a + b + carry, the carry out (0 or 1) is written back to carry
+inline constexpr uint64_t addCarry(uint64_t a, uint64_t b, uint64_t &carry)
+{
+#if defined(__x86_64__)
+    if !consteval
+    {
+        unsigned long long out;
+        carry = _addcarry_u64(static_cast<unsigned char>(carry), a, b, &out);
+        return out;
+    }
+#endif
+    __uint128_t sum = static_cast<__uint128_t>(a) + b + carry;
+    carry = static_cast<uint64_t>(sum >> 64);
+    return static_cast<uint64_t>(sum);
+}
+
+// a - b - borrow, the borrow out (0 or 1) is written back to borrow
+inline constexpr uint64_t subBorrow(uint64_t a, uint64_t b, uint64_t &borrow)
+{
+#if defined(__x86_64__)
+    if !consteval
+    {
+        unsigned long long out;
+        borrow = _subborrow_u64(static_cast<unsigned char>(borrow), a, b, &out);
+        return out;
+    }
+#endif
+    __uint128_t diff = static_cast<__uint128_t>(a) - b - borrow;
+    borrow = static_cast<uint64_t>(diff >> 64) & 1;
+    return static_cast<uint64_t>(diff);
+}
+
+// full 128-bit product, returns the lower word and writes the higher one to hi
+inline constexpr uint64_t mulWide(uint64_t a, uint64_t b, uint64_t &hi)
+{
+#if defined(__x86_64__) && defined(__BMI2__)
+    if !consteval
+    {
+        unsigned long long high;
+        uint64_t low = _mulx_u64(a, b, &high);
+        hi = high;
+        return low;
+    }
+#endif
+    __uint128_t product = static_cast<__uint128_t>(a) * b;
+    hi = static_cast<uint64_t>(product >> 64);
+    return static_cast<uint64_t>(product);
+}
+
+// the i-th word of x sign extended to any number of words
+template <size_t N>
+inline constexpr uint64_t wordAt(const ArbiInt<N> &x, size_t i)
+{
+    if constexpr (N <= 64)
+    {
+        return i == 0 ? static_cast<uint64_t>(static_cast<int64_t>(x.data)) : static_cast<uint64_t>(static_cast<int64_t>(x.data) >> 63);
+    }
+    else
+    {
+        return i < ArbiInt<N>::num_words ? x.data[i] : static_cast<uint64_t>(static_cast<int64_t>(x.data[ArbiInt<N>::num_words - 1]) >> 63);
+    }
+}
+
+// ------------------- Two-word kernels -------------------
+// An ArbiInt<N> with 64 < N <= 128 keeps its two-word storage, but the operators load it into a __int128_t and finish in a few instructions instead
+// of running the word loops. Define QUBLAS_NO_INT128 to take the word loops in these kernels, e.g. to compare the two paths; it only disables this
+// fast path, the header still uses __int128_t elsewhere (addCarry, mulWide, divideWords, the native kernel and QuDyn) and needs a compiler that has it.
+
+#if defined(QUBLAS_NO_INT128)
+inline constexpr bool useInt128 = false;
+#else
+inline constexpr bool useInt128 = true;
+#endif
+
+// every operand and the result fit in a __int128_t
+template <size_t... Ns>
+inline constexpr bool fitsInt128 = useInt128 && ((Ns <= 128) && ...);
+
+template <size_t N>
+    requires(N <= 128)
+inline constexpr __int128_t loadInt128(const ArbiInt<N> &x)
+{
+    return static_cast<__int128_t>((static_cast<__uint128_t>(wordAt(x, 1)) << 64) | wordAt(x, 0));
+}
+
+template <size_t R>
+    requires(R > 64 && R <= 128)
+inline constexpr ArbiInt<R> storeInt128(__int128_t val)
+{
+    ArbiInt<R> result;
+    result.data[0] = static_cast<uint64_t>(val);
+    result.data[1] = static_cast<uint64_t>(static_cast<__uint128_t>(val) >> 64);
+    return result;
+}
+
+// lhs + rhs or lhs - rhs over the words of the result, both operands are sign extended
+template <bool isSub, size_t R, size_t N, size_t M>
+inline constexpr ArbiInt<R> addSubWords(const ArbiInt<N> &lhs, const ArbiInt<M> &rhs)
+{
+    ArbiInt<R> result;
+
+    uint64_t carry = 0;
+    for (size_t i = 0; i < ArbiInt<R>::num_words; ++i)
+    {
+        if constexpr (isSub)
+        {
+            result.data[i] = subBorrow(wordAt(lhs, i), wordAt(rhs, i), carry);
+        }
+        else
+        {
+            result.data[i] = addCarry(wordAt(lhs, i), wordAt(rhs, i), carry);
+        }
+    }
+
+    return result;
+}
+
+// the magnitude of a two's complement number of W words, in place, returns whether it was negative
+template <size_t W>
+inline constexpr bool absWords(std::array<uint64_t, W> &words)
+{
+    const bool negative = words[W - 1] >> 63;
+    if (negative)
+    {
+        uint64_t carry = 1;
+        for (auto &word : words)
+        {
+            word = addCarry(~word, 0, carry);
+        }
+    }
+    return negative;
+}
+
+// signed schoolbook product of two sign extended word arrays, truncated to R bits
+template <size_t R, size_t N, size_t M>
+inline constexpr ArbiInt<R> mulWords(const ArbiInt<N> &lhs, const ArbiInt<M> &rhs)
+{
+    constexpr size_t lhs_words = (N + 63) / 64;
+    constexpr size_t rhs_words = (M + 63) / 64;
+    constexpr size_t res_words = ArbiInt<R>::num_words;
+
+    std::array<uint64_t, lhs_words> a{};
+    std::array<uint64_t, rhs_words> b{};
+    for (size_t i = 0; i < lhs_words; ++i)
+    {
+        a[i] = wordAt(lhs, i);
+    }
+    for (size_t i = 0; i < rhs_words; ++i)
+    {
+        b[i] = wordAt(rhs, i);
+    }
+
+    const bool negative = absWords(a) ^ absWords(b);
+
+    ArbiInt<R> result;
+    for (size_t i = 0; i < lhs_words && i < res_words; ++i)
+    {
+        // one row of the product, the row carry is stored in the next free word
+        uint64_t rowCarry = 0;
+        for (size_t j = 0; j < rhs_words && i + j < res_words; ++j)
+        {
+            uint64_t hi;
+            uint64_t lo = mulWide(a[i], b[j], hi);
+
+            uint64_t carry = 0;
+            lo = addCarry(lo, rowCarry, carry);
+            hi += carry;
+
+            carry = 0;
+            result.data[i + j] = addCarry(result.data[i + j], lo, carry);
+            rowCarry = hi + carry;
+        }
+        if (i + rhs_words < res_words)
+        {
+            result.data[i + rhs_words] = rowCarry;
+        }
+    }
+
+    if (negative)
+    {
+        uint64_t carry = 1;
+        for (auto &word : result.data)
+        {
+            word = addCarry(~word, 0, carry);
+        }
+    }
+
+    return result;
+}
+
 // operator+
 
 // special case for each input smaller than 64 bits and the result is also smaller than 64 bits
@@ -945,28 +1286,14 @@ template <size_t N, size_t M>
     requires(N > 64 && M <= 64)
 constexpr auto operator+(const ArbiInt<N> &lhs, const ArbiInt<M> rhs)
 {
-    constexpr size_t R = N + 1;
-    ArbiInt<R> result;
-
-    constexpr size_t res_words = ArbiInt<R>::num_words;
-    constexpr size_t lhs_words = ArbiInt<N>::num_words;
-
-    // Compute sign extensions using arithmetic right shift
-    int64_t lhs_sign_extension = static_cast<int64_t>(lhs.data[lhs_words - 1]) >> 63;
-    int64_t rhs_sign_extension = static_cast<int64_t>(rhs.data) >> 63;
-
-    __uint128_t carry = 0;
-    for (size_t i = 0; i < res_words; ++i)
+    if constexpr (fitsInt128<N + 1>)
     {
-        uint64_t lhs_word = (i < lhs_words) ? lhs.data[i] : static_cast<uint64_t>(lhs_sign_extension);
-        uint64_t rhs_word = (i == 0) ? rhs.data : static_cast<uint64_t>(rhs_sign_extension);
-
-        __uint128_t sum = static_cast<__uint128_t>(lhs_word) + rhs_word + carry;
-        result.data[i] = static_cast<uint64_t>(sum);
-        carry = sum >> 64;
+        return storeInt128<N + 1>(loadInt128(lhs) + loadInt128(rhs));
+    }
+    else
+    {
+        return addSubWords<false, N + 1>(lhs, rhs);
     }
-
-    return result;
 }
 
 // general case for a integer smaller than 64 bits with a integer larger than 64 bits
@@ -982,31 +1309,14 @@ template <size_t N, size_t M>
 constexpr auto operator+(const ArbiInt<N> &lhs, const ArbiInt<M> &rhs)
 {
     // The result may need one more bit to store potential overflow
-    constexpr size_t R = std::max(N, M) + 1;
-    ArbiInt<R> result;
-
-    constexpr size_t res_words = ArbiInt<R>::num_words;
-    constexpr size_t lhs_words = ArbiInt<N>::num_words;
-    constexpr size_t rhs_words = ArbiInt<M>::num_words;
-
-    // Compute sign extensions using arithmetic right shift
-    int64_t lhs_sign_extension = static_cast<int64_t>(lhs.data[lhs_words - 1]) >> 63;
-    int64_t rhs_sign_extension = static_cast<int64_t>(rhs.data[rhs_words - 1]) >> 63;
-
-    __uint128_t carry = 0;
-    for (size_t i = 0; i < res_words; ++i)
+    if constexpr (fitsInt128<std::max(N, M) + 1>)
     {
-        uint64_t lhs_word = (i < lhs_words) ? lhs.data[i] : static_cast<uint64_t>(lhs_sign_extension);
-        uint64_t rhs_word = (i < rhs_words) ? rhs.data[i] : static_cast<uint64_t>(rhs_sign_extension);
-
-        __uint128_t sum = static_cast<__uint128_t>(lhs_word) + rhs_word + carry;
-
-        result.data[i] = static_cast<uint64_t>(sum);
-
-        carry = sum >> 64;
+        return storeInt128<std::max(N, M) + 1>(loadInt128(lhs) + loadInt128(rhs));
+    }
+    else
+    {
+        return addSubWords<false, std::max(N, M) + 1>(lhs, rhs);
     }
-
-    return result;
 }
 
 // operator-
@@ -1038,30 +1348,14 @@ template <size_t N, size_t M>
     requires(N > 64 && M <= 64)
 constexpr auto operator-(const ArbiInt<N> &lhs, const ArbiInt<M> rhs)
 {
-    constexpr size_t R = N + 1;
-    ArbiInt<R> result;
-
-    constexpr size_t res_words = ArbiInt<R>::num_words;
-    constexpr size_t lhs_words = ArbiInt<N>::num_words;
-
-    // Precompute sign bit positions
-    constexpr size_t lhs_sign_bit_pos = N - 1;
-    constexpr size_t lhs_sign_word_index = lhs_sign_bit_pos / 64;
-    constexpr size_t lhs_sign_bit_in_word = lhs_sign_bit_pos % 64;
-    int64_t lhs_sign_extension = static_cast<int64_t>(lhs.data[lhs_sign_word_index]) >> lhs_sign_bit_in_word;
-
-    __int128_t borrow = 0;
-    for (size_t i = 0; i < res_words; ++i)
+    if constexpr (fitsInt128<N + 1>)
     {
-        uint64_t lhs_word = (i < lhs_words) ? lhs.data[i] : static_cast<uint64_t>(lhs_sign_extension);
-        uint64_t rhs_word = (i == 0) ? rhs.data : 0;
-
-        __int128_t diff = static_cast<__int128_t>(lhs_word) - rhs_word - borrow;
-        result.data[i] = static_cast<uint64_t>(diff);
-        borrow = (diff < 0) ? 1 : 0;
+        return storeInt128<N + 1>(loadInt128(lhs) - loadInt128(rhs));
+    }
+    else
+    {
+        return addSubWords<true, N + 1>(lhs, rhs);
     }
-
-    return result;
 }
 
 // General case for N <= 64 and M > 64
@@ -1069,9 +1363,14 @@ template <size_t N, size_t M>
     requires(N <= 64 && M > 64)
 constexpr auto operator-(const ArbiInt<N> lhs, const ArbiInt<M> &rhs)
 {
-    constexpr size_t R = M + 1;
-    ArbiInt<R> lhs_promoted = lhs; // Promote lhs to match the size of rhs
-    return lhs_promoted - rhs;
+    if constexpr (fitsInt128<M + 1>)
+    {
+        return storeInt128<M + 1>(loadInt128(lhs) - loadInt128(rhs));
+    }
+    else
+    {
+        return addSubWords<true, M + 1>(lhs, rhs);
+    }
 }
 
 // General case for N > 64 and M > 64
@@ -1079,35 +1378,14 @@ template <size_t N, size_t M>
     requires(N > 64 && M > 64)
 constexpr auto operator-(const ArbiInt<N> &lhs, const ArbiInt<M> &rhs)
 {
-    constexpr size_t R = std::max(N, M) + 1;
-    ArbiInt<R> result;
-
-    constexpr size_t res_words = ArbiInt<R>::num_words;
-    constexpr size_t lhs_words = ArbiInt<N>::num_words;
-    constexpr size_t rhs_words = ArbiInt<M>::num_words;
-
-    // Precompute sign bit positions
-    constexpr size_t lhs_sign_bit_pos = N - 1;
-    constexpr size_t lhs_sign_word_index = lhs_sign_bit_pos / 64;
-    constexpr size_t lhs_sign_bit_in_word = lhs_sign_bit_pos % 64;
-    constexpr size_t rhs_sign_bit_pos = M - 1;
-    constexpr size_t rhs_sign_word_index = rhs_sign_bit_pos / 64;
-    constexpr size_t rhs_sign_bit_in_word = rhs_sign_bit_pos % 64;
-    int64_t lhs_sign_extension = static_cast<int64_t>(lhs.data[lhs_sign_word_index]) >> lhs_sign_bit_in_word;
-    int64_t rhs_sign_extension = static_cast<int64_t>(rhs.data[rhs_sign_word_index]) >> rhs_sign_bit_in_word;
-
-    __int128_t borrow = 0;
-    for (size_t i = 0; i < res_words; ++i)
+    if constexpr (fitsInt128<std::max(N, M) + 1>)
     {
-        uint64_t lhs_word = (i < lhs_words) ? lhs.data[i] : static_cast<uint64_t>(lhs_sign_extension);
-        uint64_t rhs_word = (i < rhs_words) ? rhs.data[i] : static_cast<uint64_t>(rhs_sign_extension);
-
-        __int128_t diff = static_cast<__int128_t>(lhs_word) - rhs_word - borrow;
-        result.data[i] = static_cast<uint64_t>(diff);
-        borrow = (diff < 0) ? 1 : 0;
+        return storeInt128<std::max(N, M) + 1>(loadInt128(lhs) - loadInt128(rhs));
+    }
+    else
+    {
+        return addSubWords<true, std::max(N, M) + 1>(lhs, rhs);
     }
-
-    return result;
 }
 
 // Unary minus operator for ArbiInt<N>
@@ -1135,6 +1413,11 @@ template <size_t N>
     requires(N > 64)
 constexpr auto operator-(const ArbiInt<N> &x)
 {
+    if constexpr (fitsInt128<N + 1>)
+    {
+        return storeInt128<N + 1>(-loadInt128(x));
+    }
+
     ArbiInt<N + 1> result;
 
     uint64_t carry = 1;
@@ -1217,149 +1500,28 @@ template <size_t N, size_t M>
     requires(N > 64 && M <= 64)
 constexpr auto operator*(const ArbiInt<N> &lhs, const ArbiInt<M> rhs)
 {
-    constexpr size_t R = N + M;
-    using ResultType = ArbiInt<R>;
-    ResultType result;
-    result.data.fill(0);
-
-    // Sign extraction
-    bool lhs_negative = (lhs.data[lhs.num_words - 1] >> ((N - 1) % 64)) & 1;
-    bool rhs_negative = rhs.data < 0;
-    bool result_negative = lhs_negative ^ rhs_negative;
-
-    // Compute absolute value of rhs
-    uint64_t rhs_abs = static_cast<uint64_t>(rhs.data);
-    if (rhs_negative)
-    {
-        rhs_abs = (~rhs_abs) + 1ULL;
-    }
-
-    __uint128_t carry = 0;
-    uint64_t lhs_carry = lhs_negative ? 1ULL : 0ULL;
-
-    for (size_t i = 0; i < lhs.num_words; ++i)
+    if constexpr (fitsInt128<N + M>)
     {
-        uint64_t lhs_val = lhs.data[i];
-        if (lhs_negative)
-        {
-            uint64_t temp = ~lhs_val + lhs_carry;
-            lhs_carry = (temp < lhs_carry) ? 1ULL : 0ULL;
-            lhs_val = temp;
-        }
-
-        __uint128_t prod = (__uint128_t)lhs_val * rhs_abs + carry;
-        result.data[i] = static_cast<uint64_t>(prod);
-        carry = prod >> 64;
-    }
-
-    // Handle the final carry from multiplication
-    size_t result_size = result.num_words;
-    size_t next_index = lhs.num_words;
-    if (next_index < result_size)
-    {
-        result.data[next_index] = static_cast<uint64_t>(carry);
-    }
-    else if (carry != 0)
-    {
-        // Optional: Handle overflow (e.g., throw an exception or set an overflow flag)
+        return storeInt128<N + M>(loadInt128(lhs) * loadInt128(rhs));
     }
-
-    // Convert result to two's complement if the resulting sign is negative
-    if (result_negative)
+    else
     {
-        uint64_t carry = 1;
-        for (size_t i = 0; i < result.num_words; ++i)
-        {
-            uint64_t temp = ~result.data[i] + carry;
-            carry = (temp < carry) ? 1ULL : 0ULL;
-            result.data[i] = temp;
-        }
+        return mulWords<N + M>(lhs, rhs);
     }
-
-    return result;
 }
 
 template <size_t N, size_t M>
     requires(N > 64 && M > 64)
 constexpr auto operator*(const ArbiInt<N> &lhs, const ArbiInt<M> &rhs)
 {
-    constexpr size_t R = N + M;
-    using ResultType = ArbiInt<R>;
-    ResultType result{};
-
-    // Determine if the operands are negative
-    bool lhs_negative = (lhs.data[lhs.num_words - 1] >> ((N - 1) % 64)) & 1;
-    bool rhs_negative = (rhs.data[rhs.num_words - 1] >> ((M - 1) % 64)) & 1;
-    bool result_negative = lhs_negative ^ rhs_negative;
-
-    // Variables to hold carry-over for lhs and rhs during two's complement conversion
-    uint64_t lhs_carry = lhs_negative ? 1 : 0;
-    uint64_t rhs_carry = rhs_negative ? 1 : 0;
-
-    // Perform multiplication
-    for (size_t i = 0; i < lhs.num_words; ++i)
+    if constexpr (fitsInt128<N + M>)
     {
-        // Compute lhs_val with inversion and carry, if negative
-        uint64_t lhs_val = lhs.data[i];
-        if (lhs_negative)
-        {
-            uint64_t temp = ~lhs_val + lhs_carry;
-            lhs_carry = (temp < lhs_carry) ? 1 : 0;
-            lhs_val = temp;
-        }
-
-        uint64_t inner_rhs_carry = rhs_negative ? 1 : 0;
-        for (size_t j = 0; j < rhs.num_words; ++j)
-        {
-            // Compute rhs_val with inversion and carry, if negative
-            uint64_t rhs_val = rhs.data[j];
-            if (rhs_negative)
-            {
-                uint64_t temp = ~rhs_val + inner_rhs_carry;
-                inner_rhs_carry = (temp < inner_rhs_carry) ? 1 : 0;
-                rhs_val = temp;
-            }
-
-            __uint128_t product = __uint128_t(lhs_val) * rhs_val;
-            size_t k = i + j;
-            if (k < result.num_words)
-            {
-                __uint128_t sum = product + result.data[k];
-                result.data[k] = static_cast<uint64_t>(sum);
-                __uint128_t carry = sum >> 64;
-
-                // Propagate carry
-                size_t m = k + 1;
-                while (carry && m < result.num_words)
-                {
-                    __uint128_t temp = result.data[m] + carry;
-                    result.data[m] = static_cast<uint64_t>(temp);
-                    carry = temp >> 64;
-                    ++m;
-                }
-            }
-        }
+        return storeInt128<N + M>(loadInt128(lhs) * loadInt128(rhs));
     }
-
-    // Apply two's complement to the result if it should be negative
-    if (result_negative)
+    else
     {
-        // Invert all bits
-        for (size_t i = 0; i < result.num_words; ++i)
-        {
-            result.data[i] = ~result.data[i];
-        }
-        // Add 1 and propagate carry
-        uint64_t carry = 1;
-        for (size_t i = 0; i < result.num_words; ++i)
-        {
-            uint64_t temp = result.data[i] + carry;
-            carry = (temp < carry) ? 1 : 0;
-            result.data[i] = temp;
-        }
+        return mulWords<N + M>(lhs, rhs);
     }
-
-    return result;
 }
 
 // operator /
@@ -1372,114 +1534,266 @@ constexpr auto operator/(const ArbiInt<N> lhs, const ArbiInt<M> rhs)
     return result;
 }
 
-// 辅助函数：比较两个大数的绝对值大小
-inline int compareAbs(const std::string &a, const std::string &b)
+// magnitude division of word arrays, Knuth's algorithm D (TAOCP vol. 2, 4.3.1) with the single-word divisor handled by divide_by_uint64
+// the quotient has as many words as the dividend, the remainder as many as the divisor
+template <size_t W, size_t D>
+constexpr void divideWords(const std::array<uint64_t, W> &u, const std::array<uint64_t, D> &v, std::array<uint64_t, W> &quotient, std::array<uint64_t, D> &remainder)
 {
-    if (a.size() != b.size())
-        return a.size() > b.size() ? 1 : -1;
-    for (size_t i = 0; i < a.size(); i++)
+    quotient.fill(0);
+    remainder.fill(0);
+
+    size_t n = D;
+    while (n > 0 && v[n - 1] == 0)
     {
-        if (a[i] != b[i])
-            return a[i] > b[i] ? 1 : -1;
+        --n;
     }
-    return 0;
-}
-
-// 辅助函数：大数减法
-inline std::string subtract(const std::string &a, const std::string &b)
-{
-    std::string result;
-    int carry = 0;
-    int i = (int)a.size() - 1;
-    int j = (int)b.size() - 1;
-
-    while (i >= 0 || j >= 0 || carry)
+    if (n == 0)
     {
-        int digitA = i >= 0 ? a[i] - '0' : 0;
-        int digitB = j >= 0 ? b[j] - '0' : 0;
-        int diff = digitA - digitB - carry;
+        throw std::runtime_error("Division by zero.");
+    }
 
-        if (diff < 0)
+    size_t m = W;
+    while (m > 0 && u[m - 1] == 0)
+    {
+        --m;
+    }
+    if (m < n)
+    {
+        std::copy(u.begin(), u.begin() + std::min(W, D), remainder.begin());
+        return;
+    }
+
+    if (n == 1)
+    {
+        divide_by_uint64(u.data(), m, v[0], quotient.data(), remainder[0]);
+        return;
+    }
+
+    // normalize so that the top word of the divisor has its highest bit set
+    const int s = std::countl_zero(v[n - 1]);
+    std::array<uint64_t, D> vn{};
+    std::array<uint64_t, W + 1> un{};
+    for (size_t i = n - 1; i > 0; --i)
+    {
+        vn[i] = (v[i] << s) | (s ? v[i - 1] >> (64 - s) : 0);
+    }
+    vn[0] = v[0] << s;
+    un[m] = s ? u[m - 1] >> (64 - s) : 0;
+    for (size_t i = m - 1; i > 0; --i)
+    {
+        un[i] = (u[i] << s) | (s ? u[i - 1] >> (64 - s) : 0);
+    }
+    un[0] = u[0] << s;
+
+    for (size_t j = m - n + 1; j-- > 0;)
+    {
+        // estimate the quotient word from the top two words, it is at most 2 too large after the correction
+        const __uint128_t top = (static_cast<__uint128_t>(un[j + n]) << 64) | un[j + n - 1];
+        __uint128_t qhat = top / vn[n - 1];
+        __uint128_t rhat = top % vn[n - 1];
+
+        while (qhat >> 64 || qhat * vn[n - 2] > ((rhat << 64) | un[j + n - 2]))
+        {
+            --qhat;
+            rhat += vn[n - 1];
+            if (rhat >> 64)
+            {
+                break;
+            }
+        }
+
+        // multiply and subtract
+        uint64_t mulCarry = 0;
+        uint64_t borrow = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            uint64_t hi;
+            uint64_t lo = mulWide(static_cast<uint64_t>(qhat), vn[i], hi);
+            uint64_t carry = 0;
+            lo = addCarry(lo, mulCarry, carry);
+            mulCarry = hi + carry;
+            un[i + j] = subBorrow(un[i + j], lo, borrow);
+        }
+        un[j + n] = subBorrow(un[j + n], mulCarry, borrow);
+
+        // add back when the estimate was one too large
+        if (borrow)
+        {
+            --qhat;
+            uint64_t carry = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                un[i + j] = addCarry(un[i + j], vn[i], carry);
+            }
+            un[j + n] += carry;
+        }
+
+        quotient[j] = static_cast<uint64_t>(qhat);
+    }
+
+    // unnormalize the remainder
+    for (size_t i = 0; i < n; ++i)
+    {
+        remainder[i] = (un[i] >> s) | (s ? un[i + 1] << (64 - s) : 0);
+    }
+}
+
+// signed division truncated toward zero like the builtin one, the quotient needs one more bit than the dividend for minimum() / -1
+template <size_t N, size_t M>
+    requires(N > 64 || M > 64)
+constexpr auto operator/(const ArbiInt<N> &lhs, const ArbiInt<M> &rhs)
+{
+    if constexpr (fitsInt128<N + 1, M>)
+    {
+        // throw like the multi-word division instead of letting __int128_t divide by zero
+        const __int128_t divisor = loadInt128(rhs);
+        if (divisor == 0)
+        {
+            throw std::runtime_error("Division by zero.");
+        }
+
+        // __int128_t division also rounds toward zero
+        const __int128_t quotient = loadInt128(lhs) / divisor;
+        if constexpr (N + 1 <= 64)
         {
-            diff += 10;
-            carry = 1;
+            ArbiInt<N + 1> result;
+            result.data = static_cast<typename ArbiInt<N + 1>::data_t>(quotient);
+            return result;
         }
         else
         {
-            carry = 0;
+            return storeInt128<N + 1>(quotient);
         }
+    }
+
+    constexpr size_t W = (N + 1 + 63) / 64;
+    constexpr size_t D = (M + 63) / 64;
+
+    std::array<uint64_t, W> u{};
+    std::array<uint64_t, D> v{};
+    for (size_t i = 0; i < W; ++i)
+    {
+        u[i] = wordAt(lhs, i);
+    }
+    for (size_t i = 0; i < D; ++i)
+    {
+        v[i] = wordAt(rhs, i);
+    }
+
+    const bool negative = absWords(u) ^ absWords(v);
+
+    std::array<uint64_t, W> q;
+    std::array<uint64_t, D> r;
+    divideWords(u, v, q, r);
 
-        result = char(diff + '0') + result;
-        i--;
-        j--;
+    if (negative)
+    {
+        uint64_t carry = 1;
+        for (auto &word : q)
+        {
+            word = addCarry(~word, 0, carry);
+        }
     }
 
-    // 移除前导零
-    auto start = result.find_first_not_of('0');
-    if (start != std::string::npos)
+    ArbiInt<N + 1> result;
+    if constexpr (N + 1 <= 64)
     {
-        return result.substr(start);
+        result.data = static_cast<typename ArbiInt<N + 1>::data_t>(q[0]);
     }
     else
     {
-        return "0";
+        result.data = q;
     }
+    return result;
 }
 
-// 执行大数除法
-inline std::string divideString(const std::string &dividend, const std::string &divisor)
+// division by a compile-time constant through a precomputed reciprocal (Moller and Granlund, "Improved division by invariant integers", 2011),
+// each quotient word costs two multiplications instead of a hardware division, rounded toward zero like operator/
+template <auto divisor, size_t N>
+    requires std::is_integral_v<decltype(divisor)> && (divisor != 0)
+constexpr auto staticDivide(const ArbiInt<N> &x)
 {
-    if (divisor == "0")
+    constexpr uint64_t d = divisor < 0 ? uint64_t(0) - static_cast<uint64_t>(divisor) : static_cast<uint64_t>(divisor);
+    constexpr bool divisorNegative = divisor < 0;
+
+    constexpr size_t W = (N + 1 + 63) / 64;
+    std::array<uint64_t, W> u{};
+    for (size_t i = 0; i < W; ++i)
     {
-        throw std::runtime_error("Division by zero.");
+        u[i] = wordAt(x, i);
     }
+    const bool negative = absWords(u) ^ divisorNegative;
 
-    // 处理符号
-    bool negResult = (dividend[0] == '-') ^ (divisor[0] == '-');
-    std::string absDividend = dividend[0] == '-' ? dividend.substr(1) : dividend;
-    std::string absDivisor = divisor[0] == '-' ? divisor.substr(1) : divisor;
-
-    if (compareAbs(absDividend, absDivisor) < 0)
+    std::array<uint64_t, W> q{};
+    if constexpr (std::has_single_bit(d))
     {
-        return "0"; // 被除数比除数小，商为0
+        // a power of two is a plain shift of the magnitude
+        constexpr int s = std::countr_zero(d);
+        for (size_t i = 0; i < W; ++i)
+        {
+            q[i] = s ? (u[i] >> s) | (i + 1 < W ? u[i + 1] << (64 - s) : 0) : u[i];
+        }
     }
-
-    std::string result;
-    std::string current = "";
-    for (char digit : absDividend)
+    else
     {
-        current += digit; // 逐个数字处理
-        current.erase(0, current.find_first_not_of('0'));
-        if (current.empty())
-            current = "0";
+        constexpr int s = std::countl_zero(d);
+        constexpr uint64_t dn = d << s;
+        // v = floor((2^128 - 1) / dn) - 2^64
+        constexpr uint64_t v = static_cast<uint64_t>(~static_cast<__uint128_t>(0) / dn);
 
-        int count = 0;
-        while (compareAbs(current, absDivisor) >= 0)
+        // the normalized dividend has one more word which is always smaller than dn
+        std::array<uint64_t, W + 1> un{};
+        un[W] = s ? u[W - 1] >> (64 - s) : 0;
+        for (size_t i = W - 1; i > 0; --i)
         {
-            current = subtract(current, absDivisor);
-            count++;
+            un[i] = (u[i] << s) | (s ? u[i - 1] >> (64 - s) : 0);
         }
-        result += char(count + '0');
-    }
+        un[0] = u[0] << s;
 
-    result.erase(0, result.find_first_not_of('0')); // 移除结果的前导零
-    if (result.empty())
-        result = "0";
+        uint64_t r = un[W];
+        for (size_t i = W; i-- > 0;)
+        {
+            const uint64_t u1 = r;
+            const uint64_t u0 = un[i];
 
-    return negResult ? '-' + result : result;
-}
+            uint64_t q0 = mulWide(v, u1, q[i]);
+            uint64_t carry = 0;
+            q0 = addCarry(q0, u0, carry);
+            q[i] += u1 + 1 + carry;
 
-template <size_t N, size_t M>
-    requires(N > 64 || M > 64)
-[[deprecated("Division for large integers is currently implemented using string conversion. It is not efficient and may be slow for large numbers.")]]
-auto operator/(const ArbiInt<N> &lhs, const ArbiInt<M> &rhs)
-{
-    auto dividend = lhs.toString();
-    auto divisor = rhs.toString();
+            r = u0 - q[i] * dn;
+            if (r > q0)
+            {
+                --q[i];
+                r += dn;
+            }
+            if (r >= dn)
+            {
+                ++q[i];
+                r -= dn;
+            }
+        }
+    }
 
-    std::string result = divideString(dividend, divisor);
+    if (negative)
+    {
+        uint64_t carry = 1;
+        for (auto &word : q)
+        {
+            word = addCarry(~word, 0, carry);
+        }
+    }
 
-    return ArbiInt<N - M>(result);
+    ArbiInt<N + 1> result;
+    if constexpr (N + 1 <= 64)
+    {
+        result.data = static_cast<typename ArbiInt<N + 1>::data_t>(q[0]);
+    }
+    else
+    {
+        result.data = q;
+    }
+    return result;
 }
 
 // operator <<
@@ -1502,7 +1816,7 @@ constexpr auto staticShiftLeft(const ArbiInt<N> &x)
     ArbiInt<N + shift> result;
 
     // check if the shifted bits will occupy 2 uint64_t
-    if ((N + shift) / 64 == shift / 64)
+    if constexpr ((N + shift - 1) / 64 == shift / 64)
     {
         result.data[shift / 64] = static_cast<uint64_t>(x.data) << (shift % 64);
     }
@@ -1537,6 +1851,11 @@ constexpr auto staticShiftLeft(const ArbiInt<N> &x)
     constexpr size_t word_shift = shift / 64;
     constexpr size_t bit_shift = shift % 64;
 
+    if constexpr (fitsInt128<N + shift>)
+    {
+        return storeInt128<N + shift>(static_cast<__int128_t>(static_cast<__uint128_t>(loadInt128(x)) << shift));
+    }
+
     ArbiInt<N + shift> result;
 
     // 判断x是否为负数
@@ -1711,34 +2030,53 @@ template <size_t N, size_t M>
     requires(N > 64 && M <= 64)
 constexpr bool operator==(const ArbiInt<N> &lhs, const ArbiInt<M> rhs)
 {
-    return static_cast<int64_t>(lhs.data[0]) == static_cast<int64_t>(rhs.data);
+    if constexpr (fitsInt128<N>)
+    {
+        return loadInt128(lhs) == loadInt128(rhs);
+    }
+    else
+    {
+        // the higher words of lhs must be the sign extension of rhs
+        for (size_t i = ArbiInt<N>::num_words; i-- > 0;)
+        {
+            if (lhs.data[i] != wordAt(rhs, i))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
 }
 
 template <size_t N, size_t M>
     requires(N <= 64 && M > 64)
 constexpr bool operator==(const ArbiInt<N> lhs, const ArbiInt<M> &rhs)
 {
-    return static_cast<int64_t>(lhs.data) == static_cast<int64_t>(rhs.data[0]);
+    return rhs == lhs;
 }
 
 template <size_t N, size_t M>
     requires(N > 64 && M > 64)
 constexpr bool operator==(const ArbiInt<N> &lhs, const ArbiInt<M> &rhs)
 {
-    constexpr size_t num_words_N = ArbiInt<N>::num_words;
-    constexpr size_t num_words_M = ArbiInt<M>::num_words;
-
-    constexpr size_t min_words = (num_words_N < num_words_M) ? num_words_N : num_words_M;
-
-    // check the uint64_t within the range of min_words
-    for (size_t i = 0; i < min_words; ++i)
+    if constexpr (fitsInt128<N, M>)
+    {
+        return loadInt128(lhs) == loadInt128(rhs);
+    }
+    else
     {
-        if (lhs.data[i] != rhs.data[i])
+        constexpr size_t max_words = std::max(ArbiInt<N>::num_words, ArbiInt<M>::num_words);
+
+        // the shorter operand is sign extended
+        for (size_t i = 0; i < max_words; ++i)
         {
-            return false;
+            if (wordAt(lhs, i) != wordAt(rhs, i))
+            {
+                return false;
+            }
         }
+        return true;
     }
-    return true;
 }
 
 template <size_t N, size_t M>
@@ -1781,6 +2119,11 @@ template <size_t N, size_t M>
     requires(N > 64 && M <= 64)
 constexpr auto operator<=>(const ArbiInt<N> &lhs, const ArbiInt<M> rhs)
 {
+    if constexpr (fitsInt128<N>)
+    {
+        return loadInt128(lhs) <=> loadInt128(rhs);
+    }
+
     int64_t rhs_ext = (rhs.data < 0) ? -1LL : 0LL; // 符号扩展rhs的值
     for (int i = ArbiInt<N>::num_words - 1; i > 0; --i)
     {
@@ -1789,7 +2132,8 @@ constexpr auto operator<=>(const ArbiInt<N> &lhs, const ArbiInt<M> rhs)
             return static_cast<int64_t>(lhs.data[i]) <=> rhs_ext;
         }
     }
-    return static_cast<int64_t>(lhs.data[0]) <=> static_cast<int64_t>(rhs.data);
+    // 高位字相同，低位字按无符号比较
+    return lhs.data[0] <=> static_cast<uint64_t>(static_cast<int64_t>(rhs.data));
 }
 
 // For lhs <= 64 bits and rhs > 64 bits
@@ -1797,6 +2141,11 @@ template <size_t N, size_t M>
     requires(N <= 64 && M > 64)
 constexpr auto operator<=>(const ArbiInt<N> lhs, const ArbiInt<M> &rhs)
 {
+    if constexpr (fitsInt128<M>)
+    {
+        return loadInt128(lhs) <=> loadInt128(rhs);
+    }
+
     int64_t lhs_ext = (lhs.data < 0) ? -1LL : 0LL; // 符号扩展lhs的值
     for (int i = ArbiInt<M>::num_words - 1; i > 0; --i)
     {
@@ -1805,7 +2154,8 @@ constexpr auto operator<=>(const ArbiInt<N> lhs, const ArbiInt<M> &rhs)
             return lhs_ext <=> static_cast<int64_t>(rhs.data[i]);
         }
     }
-    return static_cast<int64_t>(lhs.data) <=> static_cast<int64_t>(rhs.data[0]);
+    // 高位字相同，低位字按无符号比较
+    return static_cast<uint64_t>(static_cast<int64_t>(lhs.data)) <=> rhs.data[0];
 }
 
 // For both lhs and rhs > 64 bits
@@ -1813,6 +2163,11 @@ template <size_t N, size_t M>
     requires(N > 64 && M > 64)
 constexpr auto operator<=>(const ArbiInt<N> &lhs, const ArbiInt<M> &rhs)
 {
+    if constexpr (fitsInt128<N, M>)
+    {
+        return loadInt128(lhs) <=> loadInt128(rhs);
+    }
+
     uint64_t lhs_ext = (lhs.data[ArbiInt<N>::num_words - 1] >> 63) ? -1ULL : 0ULL;
     uint64_t rhs_ext = (rhs.data[ArbiInt<M>::num_words - 1] >> 63) ? -1ULL : 0ULL;
 
@@ -1833,6 +2188,20 @@ constexpr auto operator<=>(const ArbiInt<N> &lhs, const ArbiInt<M> &rhs)
     return lhs_ext <=> rhs_ext;
 }
 
+// the word used to sign extend x beyond its own words
+template <size_t N>
+constexpr uint64_t signExtWord(const ArbiInt<N> &x)
+{
+    if constexpr (N <= 64)
+    {
+        return static_cast<uint64_t>(static_cast<int64_t>(x.data) >> 63);
+    }
+    else
+    {
+        return static_cast<uint64_t>(static_cast<int64_t>(x.data[ArbiInt<N>::num_words - 1]) >> 63);
+    }
+}
+
 // operator ^
 template <size_t N, size_t M>
     requires(N <= 64 && M <= 64)
@@ -1849,6 +2218,13 @@ constexpr auto operator^(const ArbiInt<N> &lhs, const ArbiInt<M> rhs)
 {
     ArbiInt<N> result = lhs;
     result.data[0] ^= static_cast<uint64_t>(rhs.data);
+
+    // the shorter operand is sign extended
+    const uint64_t ext = signExtWord(rhs);
+    for (size_t i = 1; i < ArbiInt<N>::num_words; ++i)
+    {
+        result.data[i] ^= ext;
+    }
     return result;
 }
 
@@ -1856,25 +2232,30 @@ template <size_t N, size_t M>
     requires(N <= 64 && M > 64)
 constexpr auto operator^(const ArbiInt<N> lhs, const ArbiInt<M> &rhs)
 {
-    ArbiInt<M> result = rhs;
-    result.data[0] ^= static_cast<uint64_t>(lhs.data);
-    return result;
+    return rhs ^ lhs;
 }
 
 template <size_t N, size_t M>
     requires(N > 64 && M > 64)
 constexpr auto operator^(const ArbiInt<N> &lhs, const ArbiInt<M> &rhs)
 {
-    ArbiInt<std::max(N, M)> result = M > N ? rhs : lhs;
-    for (size_t i = 0; i < std::min(ArbiInt<N>::num_words, ArbiInt<M>::num_words); ++i)
+    if constexpr (ArbiInt<N>::num_words < ArbiInt<M>::num_words)
     {
-        result.data[i] = lhs.data[i] ^ rhs.data[i];
+        return rhs ^ lhs;
+    }
+    else
+    {
+        ArbiInt<std::max(N, M)> result;
+        const uint64_t ext = signExtWord(rhs);
+        for (size_t i = 0; i < ArbiInt<N>::num_words; ++i)
+        {
+            result.data[i] = lhs.data[i] ^ (i < ArbiInt<M>::num_words ? rhs.data[i] : ext);
+        }
+        return result;
     }
-    return result;
 }
 
 // operator &
-
 template <size_t N, size_t M>
     requires(N <= 64 && M <= 64)
 constexpr auto operator&(const ArbiInt<N> lhs, const ArbiInt<M> rhs)
@@ -1888,8 +2269,15 @@ template <size_t N, size_t M>
     requires(N > 64 && M <= 64)
 constexpr auto operator&(const ArbiInt<N> &lhs, const ArbiInt<M> rhs)
 {
-    ArbiInt<N> result;
-    result.data[0] = lhs.data[0] & static_cast<uint64_t>(rhs.data);
+    ArbiInt<N> result = lhs;
+    result.data[0] &= static_cast<uint64_t>(rhs.data);
+
+    // the shorter operand is sign extended
+    const uint64_t ext = signExtWord(rhs);
+    for (size_t i = 1; i < ArbiInt<N>::num_words; ++i)
+    {
+        result.data[i] &= ext;
+    }
     return result;
 }
 
@@ -1897,25 +2285,30 @@ template <size_t N, size_t M>
     requires(N <= 64 && M > 64)
 constexpr auto operator&(const ArbiInt<N> lhs, const ArbiInt<M> &rhs)
 {
-    ArbiInt<M> result;
-    result.data[0] = static_cast<uint64_t>(lhs.data) & rhs.data[0];
-    return result;
+    return rhs & lhs;
 }
 
 template <size_t N, size_t M>
     requires(N > 64 && M > 64)
 constexpr auto operator&(const ArbiInt<N> &lhs, const ArbiInt<M> &rhs)
 {
-    ArbiInt<std::max(N, M)> result;
-    for (size_t i = 0; i < std::min(ArbiInt<N>::num_words, ArbiInt<M>::num_words); ++i)
+    if constexpr (ArbiInt<N>::num_words < ArbiInt<M>::num_words)
     {
-        result.data[i] = lhs.data[i] & rhs.data[i];
+        return rhs & lhs;
+    }
+    else
+    {
+        ArbiInt<std::max(N, M)> result;
+        const uint64_t ext = signExtWord(rhs);
+        for (size_t i = 0; i < ArbiInt<N>::num_words; ++i)
+        {
+            result.data[i] = lhs.data[i] & (i < ArbiInt<M>::num_words ? rhs.data[i] : ext);
+        }
+        return result;
     }
-    return result;
 }
 
 // operator |
-
 template <size_t N, size_t M>
     requires(N <= 64 && M <= 64)
 constexpr auto operator|(const ArbiInt<N> lhs, const ArbiInt<M> rhs)
@@ -1931,6 +2324,13 @@ constexpr auto operator|(const ArbiInt<N> &lhs, const ArbiInt<M> rhs)
 {
     ArbiInt<N> result = lhs;
     result.data[0] |= static_cast<uint64_t>(rhs.data);
+
+    // the shorter operand is sign extended
+    const uint64_t ext = signExtWord(rhs);
+    for (size_t i = 1; i < ArbiInt<N>::num_words; ++i)
+    {
+        result.data[i] |= ext;
+    }
     return result;
 }
 
@@ -1938,21 +2338,27 @@ template <size_t N, size_t M>
     requires(N <= 64 && M > 64)
 constexpr auto operator|(const ArbiInt<N> lhs, const ArbiInt<M> &rhs)
 {
-    ArbiInt<M> result = rhs;
-    result.data[0] |= static_cast<uint64_t>(lhs.data);
-    return result;
+    return rhs | lhs;
 }
 
 template <size_t N, size_t M>
     requires(N > 64 && M > 64)
 constexpr auto operator|(const ArbiInt<N> &lhs, const ArbiInt<M> &rhs)
 {
-    ArbiInt<std::max(N, M)> result = M > N ? rhs : lhs;
-    for (size_t i = 0; i < std::min(ArbiInt<N>::num_words, ArbiInt<M>::num_words); ++i)
+    if constexpr (ArbiInt<N>::num_words < ArbiInt<M>::num_words)
     {
-        result.data[i] = lhs.data[i] | rhs.data[i];
+        return rhs | lhs;
+    }
+    else
+    {
+        ArbiInt<std::max(N, M)> result;
+        const uint64_t ext = signExtWord(rhs);
+        for (size_t i = 0; i < ArbiInt<N>::num_words; ++i)
+        {
+            result.data[i] = lhs.data[i] | (i < ArbiInt<M>::num_words ? rhs.data[i] : ext);
+        }
+        return result;
     }
-    return result;
 }
 
 // operator ~
@@ -1977,111 +2383,401 @@ constexpr auto operator~(const ArbiInt<N> &x)
     return result;
 }
 
-// ------------------- Qu -------------------
-
-template <typename T>
-struct QuMode;
-
-// clang-format off
-struct RND
-{
-    struct POS_INF{inline static constexpr int value = 0;};
-    struct NEG_INF{inline static constexpr int value = 1;};
-    struct ZERO{inline static constexpr int value = 2;};
-    struct INF{inline static constexpr int value = 3;};
-    struct CONV{inline static constexpr int value = 4;};
-};
+// ------------------- ArbiInt lanes -------------------
+// A batch of L independent ArbiInt<N> stored word-major: words[w][l] is the w-th word of the l-th lane, so each step of a carry chain is one vector
+// operation over the lanes. The vector width follows the target (AVX-512, AVX2, SSE2 or NEON), constant evaluation and the lane tail use scalar words.
 
-struct TRN
-{
-    struct TCPL{inline static constexpr int value = 5;};
-    struct SMGN{inline static constexpr int value = 6;};
-};
-// clang-format on
+#if defined(__AVX512F__)
+inline constexpr size_t laneVectorBytes = 64;
+#elif defined(__AVX2__)
+inline constexpr size_t laneVectorBytes = 32;
+#else
+inline constexpr size_t laneVectorBytes = 16;
+#endif
 
-template <int fromFrac, int toFrac, typename QuMode>
-struct fracConvert;
+using laneVec_t = uint64_t __attribute__((vector_size(laneVectorBytes)));
+using laneSVec_t = int64_t __attribute__((vector_size(laneVectorBytes)));
+inline constexpr size_t laneVecWidth = laneVectorBytes / sizeof(uint64_t);
 
-template <int fromFrac, int toFrac>
-struct fracConvert<fromFrac, toFrac, QuMode<RND::POS_INF>>
+template <size_t N, size_t L>
+struct ArbiIntLanes
 {
-    template <size_t N>
-    inline static constexpr auto convert(ArbiInt<N> val)
-    {
-        if constexpr (fromFrac <= toFrac)
-        {
-            return staticShiftLeft<toFrac - fromFrac>(val);
-        }
-        else
-        {
-
-            auto Xh = staticShiftRight<fromFrac - toFrac>(val);
-
-            constexpr auto mask = ArbiInt<fromFrac - toFrac>::allOnes();
-
-            auto Xl = val & mask;
+    static_assert(N > 0 && L > 0, "ArbiIntLanes needs at least one bit and one lane");
 
-            constexpr auto T = staticShiftLeft<fromFrac - toFrac - 1>(ArbiInt<1>::allOnes());
+    static constexpr size_t num_bits = N;
+    static constexpr size_t num_words = (N + 63) / 64;
+    static constexpr size_t lanes = L;
 
-            bool flag = Xl >= T;
+    std::array<std::array<uint64_t, L>, num_words> words{};
 
-            auto oneOrZero = ArbiInt<1>(flag);
+    constexpr ArbiIntLanes() = default;
 
-            return Xh + oneOrZero;
+    template <size_t M>
+    inline constexpr void set(size_t lane, const ArbiInt<M> &x)
+    {
+        for (size_t w = 0; w < num_words; ++w)
+        {
+            words[w][lane] = wordAt(x, w);
         }
     }
-};
 
-template <int fromFrac, int toFrac>
-struct fracConvert<fromFrac, toFrac, QuMode<RND::NEG_INF>>
-{
-    template <size_t N>
-    inline static constexpr auto convert(ArbiInt<N> val)
+    inline constexpr ArbiInt<N> get(size_t lane) const
     {
-        if constexpr (fromFrac <= toFrac)
+        ArbiInt<N> result;
+        if constexpr (N <= 64)
         {
-            return staticShiftLeft<toFrac - fromFrac>(val);
+            result.data = static_cast<typename ArbiInt<N>::data_t>(words[0][lane]);
         }
         else
         {
-
-            auto Xh = staticShiftRight<fromFrac - toFrac>(val);
-
-            constexpr auto mask = ArbiInt<fromFrac - toFrac>::allOnes();
-
-            auto Xl = val & mask;
-
-            constexpr auto T = staticShiftLeft<fromFrac - toFrac - 1>(ArbiInt<1>::allOnes());
-
-            bool flag = Xl > T;
-
-            auto oneOrZero = ArbiInt<1>(flag);
-
-            return Xh + oneOrZero;
+            for (size_t w = 0; w < num_words; ++w)
+            {
+                result.data[w] = words[w][lane];
+            }
         }
+        return result;
     }
-};
 
-template <int fromFrac, int toFrac>
-struct fracConvert<fromFrac, toFrac, QuMode<RND::ZERO>>
-{
-    template <size_t N>
-    inline static constexpr auto convert(ArbiInt<N> val)
+    // gather from / scatter to L consecutive scalars
+    template <size_t M>
+    inline constexpr void load(const ArbiInt<M> *src)
     {
-        if constexpr (fromFrac <= toFrac)
+        for (size_t l = 0; l < L; ++l)
         {
-            return staticShiftLeft<toFrac - fromFrac>(val);
+            set(l, src[l]);
         }
-        else
+    }
+
+    template <size_t M>
+    inline constexpr void store(ArbiInt<M> *dst) const
+    {
+        for (size_t l = 0; l < L; ++l)
         {
+            dst[l] = get(l);
+        }
+    }
+};
 
-            auto Xh = staticShiftRight<fromFrac - toFrac>(val);
+// the primitive operations on either one uint64_t or one laneVec_t of lanes, so the kernels below are written once
+template <typename V>
+inline V laneLoad(const uint64_t *p)
+{
+    V v;
+    std::memcpy(&v, p, sizeof(V));
+    return v;
+}
 
-            constexpr auto mask = ArbiInt<fromFrac - toFrac>::allOnes();
+template <typename V>
+inline void laneStore(uint64_t *p, V v)
+{
+    std::memcpy(p, &v, sizeof(V));
+}
+
+template <typename V>
+inline constexpr V laneSplat(uint64_t x)
+{
+    return V{} + x;
+}
+
+// 1 where a < b (unsigned), otherwise 0
+template <typename V>
+inline constexpr V laneLess(V a, V b)
+{
+    if constexpr (std::is_same_v<V, uint64_t>)
+    {
+        return a < b;
+    }
+    else
+    {
+        return reinterpret_cast<V>(a < b) & 1;
+    }
+}
+
+// all ones where the word is negative, otherwise 0
+template <typename V>
+inline constexpr V laneSign(V a)
+{
+    if constexpr (std::is_same_v<V, uint64_t>)
+    {
+        return static_cast<uint64_t>(static_cast<int64_t>(a) >> 63);
+    }
+    else
+    {
+        return reinterpret_cast<V>(reinterpret_cast<laneSVec_t>(a) >> 63);
+    }
+}
+
+// (a mod 2^32) * (b mod 2^32), the widening 32-bit multiply every SIMD ISA has
+template <typename V>
+inline V laneMul32(V a, V b)
+{
+    if constexpr (std::is_same_v<V, uint64_t>)
+    {
+        return (a & 0xFFFFFFFFull) * (b & 0xFFFFFFFFull);
+    }
+    else
+    {
+#if defined(__AVX512F__)
+        return reinterpret_cast<V>(_mm512_mul_epu32(reinterpret_cast<__m512i>(a), reinterpret_cast<__m512i>(b)));
+#elif defined(__AVX2__)
+        return reinterpret_cast<V>(_mm256_mul_epu32(reinterpret_cast<__m256i>(a), reinterpret_cast<__m256i>(b)));
+#elif defined(__SSE2__)
+        return reinterpret_cast<V>(_mm_mul_epu32(reinterpret_cast<__m128i>(a), reinterpret_cast<__m128i>(b)));
+#elif defined(__ARM_NEON)
+        return reinterpret_cast<V>(vmull_u32(vmovn_u64(reinterpret_cast<uint64x2_t>(a)), vmovn_u64(reinterpret_cast<uint64x2_t>(b))));
+#else
+        return (a & 0xFFFFFFFFull) * (b & 0xFFFFFFFFull);
+#endif
+    }
+}
+
+// run kernel.template operator()<V>(l) over the lanes, vectors first and scalar words for the tail
+template <size_t L>
+inline void laneForEach(auto &&kernel)
+{
+    size_t l = 0;
+    for (; l + laneVecWidth <= L; l += laneVecWidth)
+    {
+        kernel.template operator()<laneVec_t>(l);
+    }
+    for (; l < L; ++l)
+    {
+        kernel.template operator()<uint64_t>(l);
+    }
+}
+
+// the w-th word of the lanes starting at l, sign extended beyond the words of x
+template <typename V, size_t N, size_t L>
+inline V laneWord(const ArbiIntLanes<N, L> &x, size_t w, size_t l)
+{
+    if (w < ArbiIntLanes<N, L>::num_words)
+    {
+        return laneLoad<V>(&x.words[w][l]);
+    }
+    return laneSign(laneLoad<V>(&x.words[ArbiIntLanes<N, L>::num_words - 1][l]));
+}
+
+template <bool isSub, size_t R, size_t N, size_t M, size_t L>
+inline ArbiIntLanes<R, L> laneAddSub(const ArbiIntLanes<N, L> &lhs, const ArbiIntLanes<M, L> &rhs)
+{
+    ArbiIntLanes<R, L> result;
+
+    laneForEach<L>([&]<typename V>(size_t l) {
+        V carry = V{};
+        for (size_t w = 0; w < ArbiIntLanes<R, L>::num_words; ++w)
+        {
+            const V a = laneWord<V>(lhs, w, l);
+            const V b = laneWord<V>(rhs, w, l);
+
+            V res;
+            if constexpr (isSub)
+            {
+                const V diff = a - b;
+                res = diff - carry;
+                carry = laneLess(a, b) | laneLess(diff, carry);
+            }
+            else
+            {
+                const V sum = a + b;
+                res = sum + carry;
+                carry = laneLess(sum, a) | laneLess(res, sum);
+            }
+            laneStore(&result.words[w][l], res);
+        }
+    });
+
+    return result;
+}
+
+template <size_t N, size_t M, size_t L>
+inline auto operator+(const ArbiIntLanes<N, L> &lhs, const ArbiIntLanes<M, L> &rhs)
+{
+    return laneAddSub<false, std::max(N, M) + 1>(lhs, rhs);
+}
+
+template <size_t N, size_t M, size_t L>
+inline auto operator-(const ArbiIntLanes<N, L> &lhs, const ArbiIntLanes<M, L> &rhs)
+{
+    return laneAddSub<true, std::max(N, M) + 1>(lhs, rhs);
+}
+
+// the magnitudes of the lanes split into 32-bit limbs, the sign mask is written to sign
+template <typename V, size_t N, size_t L>
+inline auto laneAbsLimbs(const ArbiIntLanes<N, L> &x, size_t l, V &sign)
+{
+    constexpr size_t W = ArbiIntLanes<N, L>::num_words;
+    std::array<V, 2 * W> limbs;
+
+    sign = laneSign(laneLoad<V>(&x.words[W - 1][l]));
+    V carry = sign & 1;
+    for (size_t w = 0; w < W; ++w)
+    {
+        // conditional negation, (x ^ sign) + carry
+        const V flipped = laneLoad<V>(&x.words[w][l]) ^ sign;
+        const V word = flipped + carry;
+        carry = laneLess(word, carry);
+
+        limbs[2 * w] = word & 0xFFFFFFFFull;
+        limbs[2 * w + 1] = word >> 32;
+    }
+    return limbs;
+}
+
+// signed product through sign and magnitude, each column of 32-bit partial products is accumulated in two 64-bit halves so it can not overflow
+template <size_t N, size_t M, size_t L>
+inline auto operator*(const ArbiIntLanes<N, L> &lhs, const ArbiIntLanes<M, L> &rhs)
+{
+    constexpr size_t R = N + M;
+    constexpr size_t res_words = ArbiIntLanes<R, L>::num_words;
+    ArbiIntLanes<R, L> result;
+
+    laneForEach<L>([&]<typename V>(size_t l) {
+        V lhsSign, rhsSign;
+        const auto a = laneAbsLimbs<V>(lhs, l, lhsSign);
+        const auto b = laneAbsLimbs<V>(rhs, l, rhsSign);
+        constexpr size_t la = std::tuple_size_v<std::remove_cvref_t<decltype(a)>>;
+        constexpr size_t lb = std::tuple_size_v<std::remove_cvref_t<decltype(b)>>;
+
+        const V negative = lhsSign ^ rhsSign;
+        V negCarry = negative & 1;
+
+        V accLo = V{}, accHi = V{};
+        V lowLimb = V{};
+        for (size_t k = 0; k < 2 * res_words; ++k)
+        {
+            for (size_t i = (k >= lb ? k - lb + 1 : 0); i < la && i <= k; ++i)
+            {
+                const V p = laneMul32(a[i], b[k - i]);
+                accLo += p & 0xFFFFFFFFull;
+                accHi += p >> 32;
+            }
+
+            const V limb = accLo & 0xFFFFFFFFull;
+            accLo = (accLo >> 32) + (accHi & 0xFFFFFFFFull);
+            accHi = accHi >> 32;
+
+            if (k % 2 == 0)
+            {
+                lowLimb = limb;
+            }
+            else
+            {
+                const V word = ((limb << 32) | lowLimb) ^ negative;
+                const V res = word + negCarry;
+                negCarry = laneLess(res, negCarry);
+                laneStore(&result.words[k / 2][l], res);
+            }
+        }
+    });
+
+    return result;
+}
+
+// ------------------- Qu -------------------
+
+template <typename T>
+struct QuMode;
+
+// clang-format off
+struct RND
+{
+    struct POS_INF{inline static constexpr int value = 0;};
+    struct NEG_INF{inline static constexpr int value = 1;};
+    struct ZERO{inline static constexpr int value = 2;};
+    struct INF{inline static constexpr int value = 3;};
+    struct CONV{inline static constexpr int value = 4;};
+};
+
+struct TRN
+{
+    struct TCPL{inline static constexpr int value = 5;};
+    struct SMGN{inline static constexpr int value = 6;};
+};
+// clang-format on
+
+template <int fromFrac, int toFrac, typename QuMode>
+struct fracConvert;
+
+template <int fromFrac, int toFrac>
+struct fracConvert<fromFrac, toFrac, QuMode<RND::POS_INF>>
+{
+    template <size_t N>
+    inline static constexpr auto convert(ArbiInt<N> val)
+    {
+        if constexpr (fromFrac <= toFrac)
+        {
+            return staticShiftLeft<toFrac - fromFrac>(val);
+        }
+        else
+        {
+
+            auto Xh = staticShiftRight<fromFrac - toFrac>(val);
+
+            constexpr auto mask = ArbiInt<fromFrac - toFrac + 1>::maximum();
+
+            auto Xl = val & mask;
+
+            constexpr auto T = staticShiftLeft<fromFrac - toFrac - 1>(ArbiInt<2>(1));
+
+            bool flag = Xl >= T;
+
+            auto oneOrZero = ArbiInt<1>(flag);
+
+            return Xh + oneOrZero;
+        }
+    }
+};
+
+template <int fromFrac, int toFrac>
+struct fracConvert<fromFrac, toFrac, QuMode<RND::NEG_INF>>
+{
+    template <size_t N>
+    inline static constexpr auto convert(ArbiInt<N> val)
+    {
+        if constexpr (fromFrac <= toFrac)
+        {
+            return staticShiftLeft<toFrac - fromFrac>(val);
+        }
+        else
+        {
+
+            auto Xh = staticShiftRight<fromFrac - toFrac>(val);
+
+            constexpr auto mask = ArbiInt<fromFrac - toFrac + 1>::maximum();
+
+            auto Xl = val & mask;
+
+            constexpr auto T = staticShiftLeft<fromFrac - toFrac - 1>(ArbiInt<2>(1));
+
+            bool flag = Xl > T;
+
+            auto oneOrZero = ArbiInt<1>(flag);
+
+            return Xh + oneOrZero;
+        }
+    }
+};
+
+template <int fromFrac, int toFrac>
+struct fracConvert<fromFrac, toFrac, QuMode<RND::ZERO>>
+{
+    template <size_t N>
+    inline static constexpr auto convert(ArbiInt<N> val)
+    {
+        if constexpr (fromFrac <= toFrac)
+        {
+            return staticShiftLeft<toFrac - fromFrac>(val);
+        }
+        else
+        {
+
+            auto Xh = staticShiftRight<fromFrac - toFrac>(val);
+
+            constexpr auto mask = ArbiInt<fromFrac - toFrac + 1>::maximum();
 
             auto Xl = val & mask;
 
-            constexpr auto T = staticShiftLeft<fromFrac - toFrac - 1>(ArbiInt<1>::allOnes());
+            constexpr auto T = staticShiftLeft<fromFrac - toFrac - 1>(ArbiInt<2>(1));
 
             bool flag = Xl > T || (Xl == T && (val.isNegative()));
 
@@ -2107,11 +2803,11 @@ struct fracConvert<fromFrac, toFrac, QuMode<RND::INF>>
 
             auto Xh = staticShiftRight<fromFrac - toFrac>(val);
 
-            constexpr auto mask = ArbiInt<fromFrac - toFrac>::allOnes();
+            constexpr auto mask = ArbiInt<fromFrac - toFrac + 1>::maximum();
 
             auto Xl = val & mask;
 
-            constexpr auto T = staticShiftLeft<fromFrac - toFrac - 1>(ArbiInt<1>::allOnes());
+            constexpr auto T = staticShiftLeft<fromFrac - toFrac - 1>(ArbiInt<2>(1));
 
             bool flag = Xl > T || (Xl == T && (val.isPositive()));
 
@@ -2134,8 +2830,8 @@ struct fracConvert<fromFrac, toFrac, QuMode<RND::CONV>>
         }
         else
         {
-            constexpr auto mask = ArbiInt<fromFrac - toFrac>::allZeros();
-            auto floor_raw = val & mask;
+            // allZeros() 在 32 与 64 位时是 0，不能当作掩码，直接清掉低位
+            const auto floor_raw = ArbiInt<N>(staticShiftLeft<fromFrac - toFrac>(staticShiftRight<fromFrac - toFrac>(val)));
 
             auto ceil = ArbiInt<N + 1> (floor_raw + staticShiftLeft<fromFrac - toFrac>(ArbiInt<1>::allOnes()));
             ArbiInt<N + 1> floor = floor_raw;
@@ -2309,7 +3005,7 @@ struct intConvert<toInt, toFrac, toIsSigned, OfMode<WRP::TCPL>>
     {
         if constexpr (toIsSigned)
         {
-            constexpr auto mask = ArbiInt<toInt + toFrac + 1>::allOnes();
+            constexpr auto mask = ArbiInt<toInt + toFrac + 2>::maximum();
 
             auto maskedVal = val & mask;
 
@@ -2326,7 +3022,7 @@ struct intConvert<toInt, toFrac, toIsSigned, OfMode<WRP::TCPL>>
         }
         else
         {
-            constexpr auto mask = ArbiInt<toInt + toFrac>::allOnes();
+            constexpr auto mask = ArbiInt<toInt + toFrac + 1>::maximum();
 
             return val & mask;
         }
@@ -2343,2678 +3039,9890 @@ struct intConvert<toInt, toFrac, toIsSigned, OfMode<WRP::TCPL_SAT<N>>>
     }
 };
 
-template <int Value>
-struct intBits;
-
-template <int Value>
-struct fracBits;
-
-template <bool Value>
-struct isSigned;
+// ------------------- Probe -------------------
+// 转换插桩：定义 QUBLAS_PROBE 后，每次把值转换到静态格式（Qmul、Qadd、Qsub、Qdiv、类型转换与 double 转换）时，按目标格式统计
+// 饱和次数、回绕次数、舍弃了非零小数位的次数以及溢出处理前的最大绝对值；QuProbeSite 作用域内的转换同时记到该站点名下
+// 每个线程只写自己的计数槽，QuProbe::report() 合并所有线程；未定义 QUBLAS_PROBE 时转换路径上的钩子在编译期被丢弃
 
-constexpr int defaultIntBits = 8;
-constexpr int defaultFracBits = 8;
-constexpr bool defaultIsSigned = true;
-using defaultQuMode = TRN::TCPL;
-using defaultOfMode = SAT::TCPL;
+#if defined(QUBLAS_PROBE)
+inline constexpr bool useProbe = true;
+#else
+inline constexpr bool useProbe = false;
+#endif
 
-template <typename... Args>
-class Qu_s
+struct QuProbeStats
 {
-    static_assert(sizeof...(Args) >= 0, "You shall not pass");
+    uint64_t conversions = 0;
+    uint64_t saturations = 0;
+    uint64_t wraps = 0;
+    uint64_t inexact = 0; // 舍弃的小数位不全为零
+    double maxMagnitude = 0;
+
+    inline void merge(const QuProbeStats &other)
+    {
+        conversions += other.conversions;
+        saturations += other.saturations;
+        wraps += other.wraps;
+        inexact += other.inexact;
+        maxMagnitude = std::max(maxMagnitude, other.maxMagnitude);
+    }
 };
 
-// the basic Qu type for a single fixed-point number
-template <int intBitsInput, int fracBitsInput, bool isSignedInput, typename QuModeInput, typename OfModeInput>
-class Qu_s<intBits<intBitsInput>, fracBits<fracBitsInput>, isSigned<isSignedInput>, QuMode<QuModeInput>, OfMode<OfModeInput>>
+template <typename QuM>
+inline std::string quModeName()
 {
-public:
-    static_assert(0 <= (intBitsInput + fracBitsInput), "The total number of bits must be non-negative.");
+    if constexpr (std::is_same_v<QuM, RND::POS_INF>)
+        return "RND::POS_INF";
+    else if constexpr (std::is_same_v<QuM, RND::NEG_INF>)
+        return "RND::NEG_INF";
+    else if constexpr (std::is_same_v<QuM, RND::ZERO>)
+        return "RND::ZERO";
+    else if constexpr (std::is_same_v<QuM, RND::INF>)
+        return "RND::INF";
+    else if constexpr (std::is_same_v<QuM, RND::CONV>)
+        return "RND::CONV";
+    else if constexpr (std::is_same_v<QuM, TRN::TCPL>)
+        return "TRN::TCPL";
+    else
+        return "TRN::SMGN";
+}
 
-    inline static constexpr int intB = intBitsInput;
-    inline static constexpr int fracB = fracBitsInput;
-    inline static constexpr bool isS = isSignedInput;
-    inline static constexpr int width = intB + fracB + static_cast<int>(isS);
-    using QuM_t = QuModeInput;
-    using OfM_t = OfModeInput;
-    inline static constexpr int QuM = QuModeInput::value;
-    inline static constexpr int OfM = OfModeInput::value;
-    inline static constexpr bool is_complex = false;
+template <typename OfM>
+inline std::string ofModeName()
+{
+    if constexpr (std::is_same_v<OfM, SAT::TCPL>)
+        return "SAT::TCPL";
+    else if constexpr (std::is_same_v<OfM, SAT::ZERO>)
+        return "SAT::ZERO";
+    else if constexpr (std::is_same_v<OfM, SAT::SMGN>)
+        return "SAT::SMGN";
+    else if constexpr (std::is_same_v<OfM, WRP::TCPL>)
+        return "WRP::TCPL";
+    else
+        return "WRP::TCPL_SAT";
+}
 
-    // no matter whether the sign bit is commanded by the user, the actual implementation will always have a sign bit
-    ArbiInt<1 + intB + fracB> data;
+template <int toInt, int toFrac, bool toIsSigned, typename QuM, typename OfM>
+inline std::string quFormatName()
+{
+    return "Qu<intBits<" + std::to_string(toInt) + ">, fracBits<" + std::to_string(toFrac) + ">, isSigned<" + (toIsSigned ? "true" : "false") + ">, QuMode<" + quModeName<QuM>() + ">, OfMode<" + ofModeName<OfM>() + ">>";
+}
 
-    inline constexpr Qu_s(double val)
+class QuProbe
+{
+public:
+    // 一次转换：inexact 为舍弃了非零小数位，overflow 为溢出处理改变了值，magnitude 为溢出处理前的绝对值
+    template <int toInt, int toFrac, bool toIsSigned, typename QuM, typename OfM>
+    static void record(bool inexact, bool overflow, double magnitude)
     {
-        ArbiInt<1200 + 1200> buffer;
-        buffer.template loadFromDouble<1200 + fracB>(val);
-
-        data = intConvert<intB, fracB, isS, OfMode<OfM_t>>::convert(fracConvert<1200 + fracB, fracB, QuMode<QuM_t>>::convert(buffer));
-    }
+        static const size_t formatSlot = slotOf(false, quFormatName<toInt, toFrac, toIsSigned, QuM, OfM>());
 
-    inline constexpr Qu_s() : data() {}
+        constexpr bool isSat = std::is_same_v<OfM, SAT::TCPL> || std::is_same_v<OfM, SAT::ZERO> || std::is_same_v<OfM, SAT::SMGN>;
 
-    // from another static Qu_s
-    template <int intBitsFrom, int fracBitsFrom, bool isSignedFrom, typename QuModeFrom, typename OfModeFrom>
-    inline constexpr Qu_s(const Qu_s<intBits<intBitsFrom>, fracBits<fracBitsFrom>, isSigned<isSignedFrom>, QuMode<QuModeFrom>, OfMode<OfModeFrom>> &val)
-    {
-        if constexpr (intBitsFrom == intBitsInput && fracBitsFrom == fracBitsInput && isSignedFrom == isSignedInput && std::is_same_v<QuModeFrom, QuModeInput> && std::is_same_v<OfModeFrom, OfModeInput>)
+        threadSlots &local = localSlots();
+        local.add(formatSlot, inexact, overflow && isSat, overflow && !isSat, magnitude);
+        if (local.site != noSite)
         {
-            data = val.data;
+            local.add(local.site, inexact, overflow && isSat, overflow && !isSat, magnitude);
         }
-        else
-        {
-            data = intConvert<intB, fracB, isS, OfMode<OfM_t>>::convert(fracConvert<fracBitsFrom, fracBitsInput, QuMode<QuM_t>>::convert(val.data));
+    }
 
-            // data = fracConvert<fracBitsFrom, fracBitsInput, QuMode<QuM_t>>::convert(val.data);
-        }
+    // 各格式与各站点的合并结果，按名称排序
+    static std::vector<std::pair<std::string, QuProbeStats>> formats()
+    {
+        return collect(false);
     }
 
-    inline double toDouble() const
+    static std::vector<std::pair<std::string, QuProbeStats>> sites()
     {
-        return data.toDouble() / std::pow(2, fracB);
+        return collect(true);
     }
 
-    inline void display(const std::string &name = "") const
+    // {"formats": {name: {...}}, "sites": {name: {...}}}
+    static std::string toJson()
     {
-        if (name != "")
-        {
-            std::cout << name << " :" << '\n';
-        }
+        auto section = [](const std::vector<std::pair<std::string, QuProbeStats>> &entries) {
+            std::string out = "{";
+            for (size_t i = 0; i < entries.size(); i++)
+            {
+                const auto &[name, s] = entries[i];
+                std::ostringstream magnitude;
+                magnitude << std::setprecision(17) << s.maxMagnitude;
 
-        std::cout << "intBits: " << intB << " fracBits: " << fracB << " isSigned: " << isS << '\n';
+                out += (i == 0 ? "\n    \"" : ",\n    \"") + name + "\": {\"conversions\": " + std::to_string(s.conversions) + ", \"saturations\": " + std::to_string(s.saturations) +
+                       ", \"wraps\": " + std::to_string(s.wraps) + ", \"inexact\": " + std::to_string(s.inexact) + ", \"maxMagnitude\": " + magnitude.str() + "}";
+            }
+            return out + (entries.empty() ? "}" : "\n  }");
+        };
 
-        std::cout << "Binary: " << this->toString() << " " << this->data.toString() << '\n';
-
-        std::cout << "Decimal: " << this->toDouble() << '\n';
-        std::cout << '\n';
-    }
-
-    inline constexpr auto toString() const
-    {
-        std::string originalBinary = this->data.toBinary();
-        std::string binary = originalBinary.substr(originalBinary.size() - isS - intB - fracB, intB + fracB + isS);
-        return binary;
-    }
-
-    inline auto fill()
-    {
-        this->data.fill();
-
-        return *this;
+        return "{\n  \"formats\": " + section(formats()) + ",\n  \"sites\": " + section(sites()) + "\n}\n";
     }
 
-    inline auto fill(int val)
+    static void dumpJson(const std::string &path)
     {
-        this->data = val;
-
-        return *this;
+        std::ofstream file(path);
+        if (!file)
+        {
+            throw std::runtime_error("Cannot open " + path + " for writing.");
+        }
+        file << toJson();
     }
 
-    // overload for std::cout
-    friend std::ostream &operator<<(std::ostream &os, const Qu_s &qu)
+    // 清零所有计数，调用时不应有其他线程正在转换
+    static void reset()
     {
-        os << qu.toDouble();
-        return os;
+        registry &reg = global();
+        std::lock_guard lock(reg.mutex);
+        reg.retired.clear();
+        for (threadSlots *t : reg.threads)
+        {
+            std::lock_guard growth(t->growth);
+            for (slot &s : t->slots)
+            {
+                s.clear();
+            }
+        }
     }
 
-    Qu_s &operator+=(Qu_s const &other)
-    {
-        *this = Qadd(*this, other);
-        return *this;
-    }
+private:
+    friend class QuProbeSite;
 
-    Qu_s &operator-=(Qu_s const &other)
-    {
-        *this = Qsub(*this, other);
-        return *this;
-    }
+    inline static constexpr size_t noSite = std::numeric_limits<size_t>::max();
 
-    Qu_s &operator*=(Qu_s const &other)
+    // 只有所属线程写入，读者用 relaxed 原子读取，不需要加锁
+    struct slot
     {
-        *this = Qmul(*this, other);
-        return *this;
-    }
-};
+        std::atomic<uint64_t> conversions{0};
+        std::atomic<uint64_t> saturations{0};
+        std::atomic<uint64_t> wraps{0};
+        std::atomic<uint64_t> inexact{0};
+        std::atomic<double> maxMagnitude{0};
 
-template <typename... Args>
-struct QuInputHelper
-{
-    inline static constexpr auto intB = tagExtractor<intBits<defaultIntBits>, Args...>::value;
-    inline static constexpr auto fracB = tagExtractor<fracBits<defaultFracBits>, Args...>::value;
-    inline static constexpr auto isS = tagExtractor<isSigned<defaultIsSigned>, Args...>::value;
+        inline static void bump(std::atomic<uint64_t> &counter, bool hit)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + hit, std::memory_order_relaxed);
+        }
 
-    using QuM = tagExtractor<QuMode<defaultQuMode>, Args...>::type;
-    using OfM = tagExtractor<OfMode<defaultOfMode>, Args...>::type;
+        inline QuProbeStats load() const
+        {
+            return {conversions.load(std::memory_order_relaxed), saturations.load(std::memory_order_relaxed), wraps.load(std::memory_order_relaxed), inexact.load(std::memory_order_relaxed), maxMagnitude.load(std::memory_order_relaxed)};
+        }
 
-    using type = Qu_s<intBits<intB>, fracBits<fracB>, isSigned<isS>, QuMode<QuM>, OfMode<OfM>>;
-};
+        inline void clear()
+        {
+            conversions = 0;
+            saturations = 0;
+            wraps = 0;
+            inexact = 0;
+            maxMagnitude = 0;
+        }
+    };
 
-template <typename... Args>
-struct QuInputHelper<Qu_s<Args...>> : QuInputHelper<Args...>
-{};
+    struct threadSlots;
 
-template <typename... Args>
-using Qu = typename QuInputHelper<Args...>::type;
+    struct registry
+    {
+        std::mutex mutex;
+        std::map<std::pair<bool, std::string>, size_t> ids; // (是否为站点, 名称) -> 槽号
+        std::vector<threadSlots *> threads;
+        std::vector<QuProbeStats> retired; // 已退出线程的计数
+    };
 
-// ------------------- Complex -------------------
-template <typename... realArgs, typename... imagArgs>
-class Qu_s<Qu_s<realArgs...>, Qu_s<imagArgs...>>
-{
-public:
-    using realType = Qu_s<realArgs...>;
-    using imagType = Qu_s<imagArgs...>;
-    inline static constexpr int realWidth = realType::width;
-    inline static constexpr int imagWidth = imagType::width;
-    inline static constexpr int width = realWidth + imagWidth;
-    inline static constexpr bool is_complex = true;
+    struct threadSlots
+    {
+        std::mutex growth; // 只在增加槽与读取时加锁，deque 增长时已有元素不会移动
+        std::deque<slot> slots;
+        size_t site = noSite;
 
-    realType real;
-    imagType imag;
+        threadSlots()
+        {
+            registry &reg = global();
+            std::lock_guard lock(reg.mutex);
+            reg.threads.push_back(this);
+        }
 
-    // basic constructor
-    Qu_s() = default;
+        // 线程退出时把计数并入 retired
+        ~threadSlots()
+        {
+            registry &reg = global();
+            std::lock_guard lock(reg.mutex);
+            reg.retired.resize(std::max(reg.retired.size(), slots.size()));
+            for (size_t i = 0; i < slots.size(); i++)
+            {
+                reg.retired[i].merge(slots[i].load());
+            }
+            std::erase(reg.threads, this);
+        }
 
-    // use = {a, b} to initialize
-    template <typename T1, typename T2>
-    inline constexpr Qu_s(T1 a, T2 b) : real(a), imag(b) {}
+        inline void add(size_t id, bool inexactHit, bool saturated, bool wrapped, double magnitude)
+        {
+            if (id >= slots.size())
+            {
+                std::lock_guard lock(growth);
+                slots.resize(id + 1);
+            }
 
-    // use = a to initialize
-    template <typename T>
-    inline constexpr Qu_s(T a) : real(a), imag(0)
-    {}
+            slot &s = slots[id];
+            slot::bump(s.conversions, true);
+            slot::bump(s.saturations, saturated);
+            slot::bump(s.wraps, wrapped);
+            slot::bump(s.inexact, inexactHit);
+            if (magnitude > s.maxMagnitude.load(std::memory_order_relaxed))
+            {
+                s.maxMagnitude.store(magnitude, std::memory_order_relaxed);
+            }
+        }
+    };
 
-    template <typename fromRealType, typename fromImagType>
-    inline constexpr Qu_s(const Qu_s<fromRealType, fromImagType> &val) : real(val.real), imag(val.imag)
+    // 永不析构：静态线程池的工作线程在其他静态对象析构之后才退出，threadSlots 的析构仍要访问它
+    static registry &global()
     {
+        static registry &reg = *new registry;
+        return reg;
     }
 
-    template <typename T>
-    inline constexpr Qu_s(const std::complex<T> &val) : real(val.real()), imag(val.imag()) {}
-
-    void display(const std::string &name = "") const
+    static threadSlots &localSlots()
     {
-        if (name != "")
-        {
-            std::cout << name << " :";
-        }
-        std::cout << '\n';
-        std::cout << "Real part: " << '\n';
-        real.display();
-        std::cout << "Imaginary part: " << '\n';
-        imag.display();
+        thread_local threadSlots local;
+        return local;
     }
 
-    inline constexpr std::complex<double> toDouble() const
+    static size_t slotOf(bool isSite, const std::string &name)
     {
-        return std::complex<double>(real.toDouble(), imag.toDouble());
+        registry &reg = global();
+        std::lock_guard lock(reg.mutex);
+        return reg.ids.try_emplace({isSite, name}, reg.ids.size()).first->second;
     }
 
-    inline constexpr auto toString() const
+    static std::vector<std::pair<std::string, QuProbeStats>> collect(bool isSite)
     {
-        return "(" + real.toString() + ", " + imag.toString() + ")";
+        registry &reg = global();
+        std::lock_guard lock(reg.mutex);
+
+        std::vector<QuProbeStats> merged = reg.retired;
+        merged.resize(reg.ids.size());
+        for (threadSlots *t : reg.threads)
+        {
+            std::lock_guard growth(t->growth);
+            for (size_t i = 0; i < t->slots.size(); i++)
+            {
+                merged[i].merge(t->slots[i].load());
+            }
+        }
+
+        std::vector<std::pair<std::string, QuProbeStats>> result;
+        for (const auto &[key, id] : reg.ids)
+        {
+            if (key.first == isSite)
+            {
+                result.emplace_back(key.second, merged[id]);
+            }
+        }
+        return result;
     }
+};
 
-    // NOTE: 将原先用约束写一个函数改为手动重载两个函数。因为clangd似乎有bug，
-    //       在此处用requires会导致之后代码的code highlighting显示错误
-    inline auto fill()
+// 作用域内当前线程的转换同时记到 name 名下，可以嵌套；未定义 QUBLAS_PROBE 时为空
+class QuProbeSite
+{
+public:
+    inline explicit QuProbeSite([[maybe_unused]] const std::string &name)
     {
-        real.fill();
-        imag.fill();
-        return *this;
+        if constexpr (useProbe)
+        {
+            previous = QuProbe::localSlots().site;
+            QuProbe::localSlots().site = QuProbe::slotOf(true, name);
+        }
     }
 
-    inline auto fill(auto dis)
+    inline ~QuProbeSite()
     {
-        real.fill(dis);
-        imag.fill(dis);
-        return *this;
+        if constexpr (useProbe)
+        {
+            QuProbe::localSlots().site = previous;
+        }
     }
 
-    inline auto fill(auto realInput, auto imagInput)
+    QuProbeSite(const QuProbeSite &) = delete;
+    QuProbeSite &operator=(const QuProbeSite &) = delete;
+
+private:
+    size_t previous = QuProbe::noSite;
+};
+
+// 舍去 d 位小数时被舍去的部分是否非零，full 可以是 ArbiInt 或原生整数
+template <int d, typename FullT>
+inline constexpr bool probeInexact([[maybe_unused]] const FullT &full)
+{
+    if constexpr (d <= 0)
     {
-        real.fill(realInput);
-        imag.fill(imagInput);
-        return *this;
+        return false;
     }
-
-    // overload for std::cout
-    friend std::ostream &operator<<(std::ostream &os, const Qu_s &val)
+    else if constexpr (std::is_integral_v<FullT> || std::is_same_v<FullT, __int128_t>)
     {
-        os << val.toDouble();
-        return os;
+        return (full & ((FullT(1) << d) - 1)) != 0;
     }
-
-    Qu_s &operator+=(Qu_s const &other)
+    else
     {
-        *this = Qadd(*this, other);
-        return *this;
+        return static_cast<bool>(full & ArbiInt<d + 1>::maximum());
     }
+}
 
-    Qu_s &operator-=(Qu_s const &other)
+template <int toInt, int toFrac, bool toIsSigned, typename QuM, typename OfM>
+inline constexpr void probeRecord([[maybe_unused]] bool inexact, [[maybe_unused]] bool overflow, [[maybe_unused]] double magnitude)
+{
+    if constexpr (useProbe)
     {
-        *this = Qsub(*this, other);
-        return *this;
+        if !consteval
+        {
+            QuProbe::record<toInt, toFrac, toIsSigned, QuM, OfM>(inexact, overflow, magnitude);
+        }
     }
+}
 
-    Qu_s &operator*=(Qu_s const &other)
+// inexact 为是否舍去了非零的位，rounded 为舍入后、溢出处理前的值，res 为最终结果
+template <int toInt, int toFrac, bool toIsSigned, typename QuM, typename OfM, typename RoundedT, typename ResT>
+inline constexpr void probeResult([[maybe_unused]] bool inexact, [[maybe_unused]] const RoundedT &rounded, [[maybe_unused]] const ResT &res)
+{
+    if constexpr (useProbe)
     {
-        *this = Qmul(*this, other);
-        return *this;
+        double magnitude;
+        if constexpr (std::is_integral_v<RoundedT> || std::is_same_v<RoundedT, __int128_t>)
+        {
+            magnitude = static_cast<double>(rounded);
+        }
+        else
+        {
+            magnitude = rounded.toDouble();
+        }
+
+        probeRecord<toInt, toFrac, toIsSigned, QuM, OfM>(inexact, rounded != res, std::abs(std::ldexp(magnitude, -toFrac)));
     }
-};
+}
 
-template <typename... realArgs, typename... imagArgs>
-struct QuInputHelper<Qu_s<realArgs...>, Qu_s<imagArgs...>>
+// full 为含 d 位待舍去小数的原始值
+template <int d, int toInt, int toFrac, bool toIsSigned, typename QuM, typename OfM, typename FullT, typename RoundedT, typename ResT>
+inline constexpr void probeConvert([[maybe_unused]] const FullT &full, [[maybe_unused]] const RoundedT &rounded, [[maybe_unused]] const ResT &res)
 {
-    using realType = Qu_s<realArgs...>;
-    using imagType = Qu_s<imagArgs...>;
-
-    using type = Qu_s<realType, imagType>;
-};
+    if constexpr (useProbe)
+    {
+        probeResult<toInt, toFrac, toIsSigned, QuM, OfM>(probeInexact<d>(full), rounded, res);
+    }
+}
 
-template <typename realType, typename imagType>
-using Qcomplex = typename QuInputHelper<realType, imagType>::type;
+// ------------------- Double Convert -------------------
+// Convert a double into the raw ArbiInt of a static Qu_s.
+// The magnitude is loaded into a buffer with 2 extra frac bits (the lower one holds the sticky bit of the discarded mantissa bits) and 2 extra int bits, which is
+// the least precision that makes every QuMode and SAT mode behave as if the exact value was used. The 2400-bit buffer is kept for the wrapping modes when the
+// value overflows the buffer.
 
-// ------------------- Vector and Matrix -------------------
+template <int toInt, int toFrac, bool toIsSigned, typename QuMode, typename OfMode>
+struct doubleConvert;
 
-// std::mdspan only available in clang 18, we need to support gcc
-template <size_t... dims>
-struct dim
+template <int toInt, int toFrac, bool toIsSigned, typename QuM, typename OfM>
+struct doubleConvert<toInt, toFrac, toIsSigned, QuMode<QuM>, OfMode<OfM>>
 {
-    static inline constexpr size_t dimSize = sizeof...(dims);
-    static inline constexpr size_t elemSize = (dims * ...);
+    inline static constexpr int bufFrac = toFrac + 2;
+    inline static constexpr size_t bufN = 1 + (toInt + 2) + bufFrac;
+    inline static constexpr bool isSat = std::is_same_v<OfM, SAT::TCPL> || std::is_same_v<OfM, SAT::ZERO> || std::is_same_v<OfM, SAT::SMGN>;
+    inline static constexpr bool hasFastPath = isSat || std::is_same_v<OfM, WRP::TCPL>;
 
-    static inline constexpr std::array<size_t, dimSize> dimArray = {dims...};
+    using resType = ArbiInt<1 + toInt + toFrac>;
 
-    // NOTE: 将约束改为static_assert，原因同上，
-    //       在此处用requires会导致之后代码的code highlighting显示错误
-    template <size_t index>
-    struct dimAt_s
+    inline static constexpr resType convertWide(double val)
     {
-        static_assert(index < dimSize, "dimension out of range!");
-        static inline constexpr size_t value = dimArray[index];
-    };
+        ArbiInt<1200 + 1200> buffer;
+        buffer.template loadFromDouble<1200 + toFrac>(val);
 
-    template <size_t index>
-    static inline constexpr size_t dimAt = dimAt_s<index>::value;
+        const auto rounded = fracConvert<1200 + toFrac, toFrac, QuMode<QuM>>::convert(buffer);
+        const auto res = intConvert<toInt, toFrac, toIsSigned, OfMode<OfM>>::convert(rounded);
+        probeConvert<1200, toInt, toFrac, toIsSigned, QuM, OfM>(buffer, rounded, res);
 
-    template <size_t index2>
-    struct elemSizeForIndexHead
-    {
-        static inline constexpr size_t value = std::accumulate(dimArray.begin(), dimArray.begin() + index2, 1, std::multiplies<size_t>());
-    };
+        return res;
+    }
 
-    template <size_t... index>
-        requires(sizeof...(index) == dimSize)
-    struct absoluteIndex_s
+    inline static constexpr resType convert(double val)
     {
-        template <size_t loc, size_t... index2>
-        struct compute;
-
-        template <size_t loc, size_t firstIndex, size_t... indexLeft>
-        struct compute<loc, firstIndex, indexLeft...>
+        if constexpr (!hasFastPath)
         {
-            static inline constexpr size_t value = firstIndex * elemSizeForIndexHead<loc>::value + compute<loc + 1, indexLeft...>::value;
-        };
-
-        template <size_t firstIndex>
-        struct compute<dimSize - 1, firstIndex>
+            return convertWide(val);
+        }
+        else
         {
-            static inline constexpr size_t value = firstIndex * elemSizeForIndexHead<dimSize - 1>::value;
-        };
+            if (val == 0.0 || std::isnan(val) || std::isinf(val))
+            {
+                probeRecord<toInt, toFrac, toIsSigned, QuM, OfM>(false, false, 0.0);
+                return resType();
+            }
 
-        static inline constexpr size_t value = compute<0, index...>::value;
-    };
+            const uint64_t doubleAsUint64 = std::bit_cast<uint64_t>(val);
+            const bool sign = (doubleAsUint64 >> 63) != 0;
+            const int biasedExponent = static_cast<int>((doubleAsUint64 >> 52) & 0x7FF);
+            uint64_t mantissa = doubleAsUint64 & 0xFFFFFFFFFFFFFull;
 
-    template <size_t... index>
-        requires(sizeof...(index) == dimSize)
-    using absoluteIndex = absoluteIndex_s<index...>::value;
-};
+            // val = mantissa * 2^exponent, subnormals have no implicit leading 1
+            int exponent = -1074;
+            if (biasedExponent != 0)
+            {
+                mantissa |= 0x10000000000000ull;
+                exponent = biasedExponent - 1075;
+            }
 
-template <size_t... dims, typename Arg>
-    requires(isA<Arg, Qu_s<>>)
-class Qu_s<dim<dims...>, Arg>
-{
-public:
-    template <typename First, typename... Rest>
-    inline static constexpr size_t calculateIndex(size_t accum, First first, Rest... rest)
-    {
-        if constexpr (sizeof...(Rest) == 0)
-        {
-            return accum + first * dim<dims...>::template elemSizeForIndexHead<sizeof...(dims) - 1>::value;
-        }
-        else
-        {
-            static constexpr size_t nextDimProduct = dim<dims...>::template elemSizeForIndexHead<sizeof...(dims) - sizeof...(Rest) - 1>::value;
-            return calculateIndex(accum + first * nextDimProduct, rest...);
-        }
-    }
+            // the magnitude in buffer units is mantissa * 2^shift
+            const int shift = exponent + bufFrac;
 
-    inline static constexpr bool onHeap = dim<dims...>::elemSize > 1000;
+            ArbiInt<bufN> buffer;
 
-    // when the size is too large, use std::vector instead of std::array
-    using storage_t = std::conditional_t<onHeap, std::vector<Arg>, std::array<Arg, dim<dims...>::elemSize>>;
+            uint64_t bits = mantissa;
+            if (shift < 0)
+            {
+                const int rshift = -shift;
+                const uint64_t kept = rshift < 64 ? mantissa >> rshift : 0;
+                const bool sticky = rshift < 64 ? (mantissa & ((uint64_t(1) << rshift) - 1)) != 0 : true;
 
-    storage_t data;
+                bits = kept | static_cast<uint64_t>(sticky);
+            }
 
-    using size = dim<dims...>;
-    static constexpr size_t elemSize = size::elemSize;
-    static constexpr size_t dimSize = size::dimSize;
-    using elem_t = Arg;
+            // the kept bits of a right shift can also exceed a narrow buffer
+            if (std::bit_width(bits) + std::max(shift, 0) > static_cast<int>(bufN) - 1)
+            {
+                if constexpr (isSat)
+                {
+                    // anything beyond the buffer saturates in the same way, clamp to 2^(toInt + 1)
+                    setBits(buffer, 1, bufN - 2);
+                    return finish(buffer, sign, val);
+                }
+                else
+                {
+                    return convertWide(val);
+                }
+            }
 
-    // 构造函数
-    constexpr Qu_s()
-    {
-        if constexpr (onHeap)
-        {
-            data.resize(dim<dims...>::elemSize);
+            setBits(buffer, bits, std::max(shift, 0));
+
+            return finish(buffer, sign, val);
         }
     }
 
-    constexpr Qu_s(auto... values)
+    // write bits << shift into the zeroed buffer, the bits never cross the top of the buffer
+    inline static constexpr void setBits(ArbiInt<bufN> &buffer, uint64_t bits, int shift)
     {
-        if constexpr (onHeap)
-        {
-            data.resize(dim<dims...>::elemSize);
-        }
-
-        if constexpr (sizeof...(values) == dim<dims...>::elemSize)
+        if constexpr (bufN <= 64)
         {
-            data = {values...};
+            buffer.data = static_cast<typename ArbiInt<bufN>::data_t>(bits << shift);
         }
         else
         {
-            throw std::invalid_argument("The number of values does not match the size of the Qu_s.");
+            const int wordShift = shift / 64;
+            const int bitShift = shift % 64;
+
+            buffer.data[wordShift] = bits << bitShift;
+            if (bitShift != 0 && wordShift + 1 < static_cast<int>(ArbiInt<bufN>::num_words))
+            {
+                buffer.data[wordShift + 1] = bits >> (64 - bitShift);
+            }
         }
     }
 
-    template <typename SquareBracketIndexableType>
-        requires isSquareBracketIndexable<SquareBracketIndexableType>
-    constexpr Qu_s(const SquareBracketIndexableType &val)
+    inline static constexpr resType finish(ArbiInt<bufN> buffer, bool sign, [[maybe_unused]] double val)
     {
-        if constexpr (onHeap)
+        if (sign)
         {
-            data.resize(dim<dims...>::elemSize);
+            if constexpr (bufN <= 64)
+            {
+                buffer.data = -buffer.data;
+            }
+            else
+            {
+                // two's complement negation
+                uint64_t carry = 1;
+                for (auto &word : buffer.data)
+                {
+                    word = ~word + carry;
+                    carry = carry && word == 0;
+                }
+            }
         }
 
-        for (size_t i = 0; i < dim<dims...>::elemSize; i++)
+        const auto rounded = fracConvert<bufFrac, toFrac, QuMode<QuM>>::convert(buffer);
+        const auto res = intConvert<toInt, toFrac, toIsSigned, OfMode<OfM>>::convert(rounded);
+        // 超出缓冲区的值已被钳位，最大绝对值直接取输入
+        if constexpr (useProbe)
         {
-            data[i] = val[i];
+            probeRecord<toInt, toFrac, toIsSigned, QuM, OfM>(probeInexact<bufFrac - toFrac>(buffer), rounded != res, std::abs(val));
         }
+
+        return res;
     }
+};
 
-    // 拷贝构造函数
-    constexpr Qu_s(const Qu_s<dim<dims...>, Arg> &val)
-    {
-        if constexpr (onHeap)
-        {
-            data.resize(dim<dims...>::elemSize);
-        }
+template <int Value>
+struct intBits;
 
-        std::copy(val.data.begin(), val.data.end(), data.begin());
-    }
+template <int Value>
+struct fracBits;
 
-    // 来自不同类型的Qu_s，逐个元素转换
-    template <typename fromArg>
-    constexpr Qu_s(const Qu_s<dim<dims...>, fromArg> &val)
-    {
-        if constexpr (onHeap)
-        {
-            data.resize(dim<dims...>::elemSize);
-        }
+template <bool Value>
+struct isSigned;
 
-        for (size_t i = 0; i < dim<dims...>::elemSize; i++)
-        {
-            data[i] = val.data[i];
-        }
-    }
+constexpr int defaultIntBits = 8;
+constexpr int defaultFracBits = 8;
+constexpr bool defaultIsSigned = true;
+using defaultQuMode = TRN::TCPL;
+using defaultOfMode = SAT::TCPL;
 
-    // // 移动构造函数
-    // // 来自相同类型的Qu_s, 直接移动std::array
-    // constexpr Qu_s(Qu_s<dim<dims...>, Arg> &&val) : data(std::move(val.data)) {}
+template <typename... Args>
+class Qu_s
+{
+    static_assert(sizeof...(Args) >= 0, "You shall not pass");
+};
 
-    // 移动构造函数
-    // 来自相同类型的Qu_s, 直接移动std::array或者std::vector
-    constexpr Qu_s(Qu_s<dim<dims...>, Arg> &&val)
+// the basic Qu type for a single fixed-point number
+template <int intBitsInput, int fracBitsInput, bool isSignedInput, typename QuModeInput, typename OfModeInput>
+class Qu_s<intBits<intBitsInput>, fracBits<fracBitsInput>, isSigned<isSignedInput>, QuMode<QuModeInput>, OfMode<OfModeInput>>
+{
+public:
+    static_assert(0 <= (intBitsInput + fracBitsInput), "The total number of bits must be non-negative.");
+
+    inline static constexpr int intB = intBitsInput;
+    inline static constexpr int fracB = fracBitsInput;
+    inline static constexpr bool isS = isSignedInput;
+    inline static constexpr int width = intB + fracB + static_cast<int>(isS);
+    using QuM_t = QuModeInput;
+    using OfM_t = OfModeInput;
+    inline static constexpr int QuM = QuModeInput::value;
+    inline static constexpr int OfM = OfModeInput::value;
+    inline static constexpr bool is_complex = false;
+
+    // no matter whether the sign bit is commanded by the user, the actual implementation will always have a sign bit
+    ArbiInt<1 + intB + fracB> data;
+
+    inline constexpr Qu_s(double val)
     {
-        data = std::move(val.data);
+        data = doubleConvert<intB, fracB, isS, QuMode<QuM_t>, OfMode<OfM_t>>::convert(val);
     }
 
-    // 来自不同类型的Qu_s，逐个元素转换
-    template <typename fromArg>
-    constexpr Qu_s(Qu_s<dim<dims...>, fromArg> &&val)
+    inline constexpr Qu_s() : data() {}
+
+    // from another static Qu_s
+    template <int intBitsFrom, int fracBitsFrom, bool isSignedFrom, typename QuModeFrom, typename OfModeFrom>
+    inline constexpr Qu_s(const Qu_s<intBits<intBitsFrom>, fracBits<fracBitsFrom>, isSigned<isSignedFrom>, QuMode<QuModeFrom>, OfMode<OfModeFrom>> &val)
     {
-        for (size_t i = 0; i < dim<dims...>::elemSize; i++)
+        if constexpr (intBitsFrom == intBitsInput && fracBitsFrom == fracBitsInput && isSignedFrom == isSignedInput && std::is_same_v<QuModeFrom, QuModeInput> && std::is_same_v<OfModeFrom, OfModeInput>)
         {
-            data[i] = val.data[i];
+            data = val.data;
+        }
+        else
+        {
+            const auto rounded = fracConvert<fracBitsFrom, fracBitsInput, QuMode<QuM_t>>::convert(val.data);
+            const auto res = intConvert<intB, fracB, isS, OfMode<OfM_t>>::convert(rounded);
+            probeConvert<fracBitsFrom - fracBitsInput, intB, fracB, isS, QuM_t, OfM_t>(val.data, rounded, res);
+            data = res;
+
+            // data = fracConvert<fracBitsFrom, fracBitsInput, QuMode<QuM_t>>::convert(val.data);
         }
     }
 
-    // 拷贝赋值运算符
-    // 来自相同类型的Qu_s, 直接拷贝std::array或者std::vector
-    constexpr Qu_s &operator=(const Qu_s<dim<dims...>, Arg> &val)
+    inline double toDouble() const
     {
-        std::copy(val.data.begin(), val.data.end(), data.begin());
-        return *this;
+        return data.toDouble() / std::pow(2, fracB);
     }
 
-    // 来自不同类型的Qu_s，逐个元素转换
-    template <typename fromArg>
-    constexpr Qu_s &operator=(const Qu_s<dim<dims...>, fromArg> &val)
+    inline void display(const std::string &name = "") const
     {
-        for (size_t i = 0; i < dim<dims...>::elemSize; i++)
+        if (name != "")
         {
-            data[i] = val.data[i];
+            std::cout << name << " :" << '\n';
         }
-        return *this;
+
+        std::cout << "intBits: " << intB << " fracBits: " << fracB << " isSigned: " << isS << '\n';
+
+        std::cout << "Binary: " << this->toString() << " " << this->data.toString() << '\n';
+
+        std::cout << "Decimal: " << this->toDouble() << '\n';
+        std::cout << '\n';
     }
 
-    // 移动赋值运算符
-    // 来自相同类型的Qu_s, 直接移动std::array
-    constexpr Qu_s &operator=(Qu_s<dim<dims...>, Arg> &&val)
+    inline constexpr auto toString() const
     {
-        data = std::move(val.data);
-        return *this;
+        std::string originalBinary = this->data.toBinary();
+        std::string binary = originalBinary.substr(originalBinary.size() - isS - intB - fracB, intB + fracB + isS);
+        return binary;
     }
 
-    // 来自不同类型的Qu_s，逐个元素转换
-    template <typename fromArg>
-    constexpr Qu_s &operator=(Qu_s<dim<dims...>, fromArg> &&val)
+    inline auto fill()
     {
-        for (size_t i = 0; i < dim<dims...>::elemSize; i++)
-        {
-            data[i] = std::move(val.data[i]);
-        }
+        this->data.fill();
+
         return *this;
     }
 
-    inline void clear()
+    inline auto fill(int val)
     {
-        memset(data.data(), 0, dim<dims...>::elemSize * sizeof(Arg));
-    }
+        this->data = val;
 
-    inline auto fill(auto... dis)
-    {
-        for (size_t i = 0; i < dim<dims...>::elemSize; i++)
-        {
-            data[i].fill(dis...);
-        }
         return *this;
     }
 
-    inline auto shuffle()
+    // 由随机字生成格式内均匀分布的原始值，无符号数只取 intB + fracB 位
+    inline static constexpr size_t randomWords = (width + 63) / 64;
+
+    inline constexpr auto &fillBits(const uint64_t *words)
     {
-        std::shuffle(data.begin(), data.end(), gen);
+        this->data.template fillBits<width, isS>(words);
         return *this;
     }
 
-    // get
-    template <auto... index>
-    inline constexpr auto &get()
+    // overload for std::cout
+    friend std::ostream &operator<<(std::ostream &os, const Qu_s &qu)
     {
-        return std::get<dim<dims...>::template absoluteIndex_s<index...>::value>(data);
+        os << qu.toDouble();
+        return os;
     }
 
-    template <auto... index>
-    inline constexpr const auto &get() const
+    Qu_s &operator+=(Qu_s const &other)
     {
-        return std::get<dim<dims...>::template absoluteIndex_s<index...>::value>(data);
+        *this = Qadd(*this, other);
+        return *this;
     }
 
-    // operator[]
-    inline constexpr auto &operator[](auto... index)
-        requires(sizeof...(index) == dim<dims...>::dimSize && sizeof...(index) > 1)
+    Qu_s &operator-=(Qu_s const &other)
     {
-        return data[calculateIndex(0, index...)];
+        *this = Qsub(*this, other);
+        return *this;
     }
 
-    inline constexpr const auto &operator[](auto... index) const
-        requires(sizeof...(index) == dim<dims...>::dimSize && sizeof...(index) > 1)
+    Qu_s &operator*=(Qu_s const &other)
     {
-        return data[calculateIndex(0, index...)];
+        *this = Qmul(*this, other);
+        return *this;
     }
+};
 
-    inline constexpr auto &operator[](size_t index)
-    {
-        return data[index];
-    }
+// Qu<..., Shadow<double>> 在定点值之外携带一个全精度的参考值，见 Shadow 一节
+template <typename RefT>
+struct Shadow
+{
+};
 
-    inline constexpr const auto &operator[](size_t index) const
-    {
-        return data[index];
-    }
+template <typename... Args>
+struct QuInputHelper
+{
+    inline static constexpr auto intB = tagExtractor<intBits<defaultIntBits>, Args...>::value;
+    inline static constexpr auto fracB = tagExtractor<fracBits<defaultFracBits>, Args...>::value;
+    inline static constexpr auto isS = tagExtractor<isSigned<defaultIsSigned>, Args...>::value;
 
-    inline std::array<double, dim<dims...>::elemSize> toDouble() const
-    {
-        std::array<double, dim<dims...>::elemSize> result;
-        for (size_t i = 0; i < dim<dims...>::elemSize; i++)
-        {
-            result[i] = data[i].toDouble();
-        }
-        return result;
-    }
+    using QuM = tagExtractor<QuMode<defaultQuMode>, Args...>::type;
+    using OfM = tagExtractor<OfMode<defaultOfMode>, Args...>::type;
+    using ShadowRef = tagExtractor<Shadow<void>, Args...>::type;
 
-    void display(std::string const &name = "") const
-    {
-        if (name != "")
-        {
-            std::cout << name << " :";
-        }
+    using plain = Qu_s<intBits<intB>, fracBits<fracB>, isSigned<isS>, QuMode<QuM>, OfMode<OfM>>;
+    using type = std::conditional_t<std::is_void_v<ShadowRef>, plain, Qu_s<Shadow<ShadowRef>, plain>>;
+};
 
-        for (size_t i = 0; i < dim<dims...>::elemSize; i++)
-        {
-            data[i].display();
-        }
-    }
+template <typename... Args>
+struct QuInputHelper<Qu_s<Args...>> : QuInputHelper<Args...>
+{};
 
-    // overload for std::cout
-    // output the double value in matrix form if it is a matrix
-    friend std::ostream &operator<<(std::ostream &os, const Qu_s &val)
+// Qu<type, Shadow<double>> 保留 type 的格式
+template <typename RefT, typename... Args>
+struct QuInputHelper<Qu_s<Args...>, Shadow<RefT>> : QuInputHelper<Args..., Shadow<RefT>>
+{};
+
+template <typename... Args>
+using Qu = typename QuInputHelper<Args...>::type;
+
+// ------------------- Complex -------------------
+template <typename... realArgs, typename... imagArgs>
+class Qu_s<Qu_s<realArgs...>, Qu_s<imagArgs...>>
+{
+public:
+    using realType = Qu_s<realArgs...>;
+    using imagType = Qu_s<imagArgs...>;
+    inline static constexpr int realWidth = realType::width;
+    inline static constexpr int imagWidth = imagType::width;
+    inline static constexpr int width = realWidth + imagWidth;
+    inline static constexpr bool is_complex = true;
+
+    realType real;
+    imagType imag;
+
+    // basic constructor
+    Qu_s() = default;
+
+    // use = {a, b} to initialize
+    template <typename T1, typename T2>
+    inline constexpr Qu_s(T1 a, T2 b) : real(a), imag(b) {}
+
+    // use = a to initialize
+    template <typename T>
+    inline constexpr Qu_s(T a) : real(a), imag(0)
+    {}
+
+    template <typename fromRealType, typename fromImagType>
+    inline constexpr Qu_s(const Qu_s<fromRealType, fromImagType> &val) : real(val.real), imag(val.imag)
+    {
+    }
+
+    template <typename T>
+    inline constexpr Qu_s(const std::complex<T> &val) : real(val.real()), imag(val.imag()) {}
+
+    void display(const std::string &name = "") const
+    {
+        if (name != "")
+        {
+            std::cout << name << " :";
+        }
+        std::cout << '\n';
+        std::cout << "Real part: " << '\n';
+        real.display();
+        std::cout << "Imaginary part: " << '\n';
+        imag.display();
+    }
+
+    inline constexpr std::complex<double> toDouble() const
+    {
+        return std::complex<double>(real.toDouble(), imag.toDouble());
+    }
+
+    inline constexpr auto toString() const
+    {
+        return "(" + real.toString() + ", " + imag.toString() + ")";
+    }
+
+    // NOTE: 将原先用约束写一个函数改为手动重载两个函数。因为clangd似乎有bug，
+    //       在此处用requires会导致之后代码的code highlighting显示错误
+    inline auto fill()
+    {
+        real.fill();
+        imag.fill();
+        return *this;
+    }
+
+    inline auto fill(auto dis)
+    {
+        real.fill(dis);
+        imag.fill(dis);
+        return *this;
+    }
+
+    inline auto fill(auto realInput, auto imagInput)
+    {
+        real.fill(realInput);
+        imag.fill(imagInput);
+        return *this;
+    }
+
+    inline static constexpr size_t randomWords = realType::randomWords + imagType::randomWords;
+
+    inline constexpr auto &fillBits(const uint64_t *words)
+    {
+        real.fillBits(words);
+        imag.fillBits(words + realType::randomWords);
+        return *this;
+    }
+
+    // overload for std::cout
+    friend std::ostream &operator<<(std::ostream &os, const Qu_s &val)
+    {
+        os << val.toDouble();
+        return os;
+    }
+
+    Qu_s &operator+=(Qu_s const &other)
+    {
+        *this = Qadd(*this, other);
+        return *this;
+    }
+
+    Qu_s &operator-=(Qu_s const &other)
+    {
+        *this = Qsub(*this, other);
+        return *this;
+    }
+
+    Qu_s &operator*=(Qu_s const &other)
+    {
+        *this = Qmul(*this, other);
+        return *this;
+    }
+};
+
+template <typename... realArgs, typename... imagArgs>
+struct QuInputHelper<Qu_s<realArgs...>, Qu_s<imagArgs...>>
+{
+    using realType = Qu_s<realArgs...>;
+    using imagType = Qu_s<imagArgs...>;
+
+    using type = Qu_s<realType, imagType>;
+};
+
+template <typename realType, typename imagType>
+using Qcomplex = typename QuInputHelper<realType, imagType>::type;
+
+// ------------------- Shadow -------------------
+// 影子精度：Qu_s<Shadow<RefT>, Qu_s<...>> 保存定点值与按 RefT 计算的参考值，Qmul、Qadd、Qsub、Qdiv 与 Qreduce 同时计算两者
+// 每个影子运算的结果把误差记入当前线程的累加器，QuShadow::stats() 合并所有线程，一次运行即可得到 SQNR，不用再跑一遍 double 版本
+// 输入的构造与格式转换不计入；张量表达式写入张量时分块整批记录写入的结果，见 QuShadow::assign
+// 不使用 Shadow 时类型与运算都与原来完全相同；目前只支持实数
+
+struct QuShadowStats
+{
+    size_t count = 0;
+    size_t overflows = 0; // 参考值超出结果类型的表示范围
+    double maxAbsError = 0;
+    double sumSqError = 0;
+    double sumSqRef = 0;
+
+    inline void record(double value, double ref, double lo, double hi)
+    {
+        const double err = value - ref;
+        count++;
+        overflows += ref < lo || ref > hi;
+        maxAbsError = std::max(maxAbsError, std::abs(err));
+        sumSqError += err * err;
+        sumSqRef += ref * ref;
+    }
+
+    inline void merge(const QuShadowStats &other)
+    {
+        count += other.count;
+        overflows += other.overflows;
+        maxAbsError = std::max(maxAbsError, other.maxAbsError);
+        sumSqError += other.sumSqError;
+        sumSqRef += other.sumSqRef;
+    }
+
+    inline double mse() const
+    {
+        return count == 0 ? 0.0 : sumSqError / static_cast<double>(count);
+    }
+
+    // 单位为 dB
+    inline double sqnr() const
+    {
+        return 10.0 * std::log10(sumSqRef / sumSqError);
+    }
+};
+
+class QuShadow
+{
+public:
+    // 一个标量运算的结果，lo 与 hi 为结果类型的表示范围
+    inline static void record(double value, double ref, double lo, double hi)
+    {
+        localStats().stats.record(value, ref, lo, hi);
+    }
+
+    // dst[begin, end) = src[begin, end)，src 是影子运算的张量表达式，见 isShadowBatch
+    // 不逐个记录地算出每个结果，写入的同时在局部累加，最后一次并入当前线程
+    template <typename DstT, typename SrcT>
+    static void assign(DstT &dst, const SrcT &src, size_t begin, size_t end)
+    {
+        using elem_t = std::remove_cvref_t<decltype(src.unrecorded(begin))>;
+
+        // 分块累加，可能溢出时只需重新检查所在的块
+        batchStats<elem_t> batch;
+        for (size_t first = begin; first < end; first += blockSize)
+        {
+            const size_t n = std::min(blockSize, end - first);
+            if constexpr (std::is_same_v<decltype(dst[begin]), elem_t &>)
+            {
+                // 结果类型与 dst 的元素相同，直接写入 dst
+                batch.add(
+                    n,
+                    [&](size_t i) {
+                        const elem_t x = src.unrecorded(first + i);
+                        dst[first + i] = x;
+                        return x;
+                    },
+                    [&](size_t i) -> const elem_t & { return dst[first + i]; });
+            }
+            else
+            {
+                // 先放在局部的缓冲区中，记录的是运算结果而不是转换到 dst 之后的值
+                std::array<elem_t, blockSize> results;
+                batch.add(
+                    n,
+                    [&](size_t i) {
+                        const elem_t x = src.unrecorded(first + i);
+                        results[i] = x;
+                        return x;
+                    },
+                    [&](size_t i) -> const elem_t & { return results[i]; });
+                for (size_t i = 0; i < n; i++)
+                {
+                    dst[first + i] = results[i];
+                }
+            }
+        }
+        localStats().stats.merge(batch.finish());
+    }
+
+    // 所有线程（包括已退出的线程）的合并结果，调用时不应有其他线程正在进行影子运算
+    static QuShadowStats stats()
+    {
+        registry &reg = global();
+        std::lock_guard lock(reg.mutex);
+
+        QuShadowStats merged = reg.retired;
+        for (threadStats *t : reg.threads)
+        {
+            merged.merge(t->stats);
+        }
+        return merged;
+    }
+
+    // 清零所有线程的统计，调用时不应有其他线程正在进行影子运算
+    static void reset()
+    {
+        registry &reg = global();
+        std::lock_guard lock(reg.mutex);
+        reg.retired = QuShadowStats();
+        for (threadStats *t : reg.threads)
+        {
+            t->stats = QuShadowStats();
+        }
+    }
+
+private:
+    inline static constexpr size_t blockSize = 64;
+
+    // ElemT 结果的统计，按 laneVectorBytes 宽的 double 向量累加
+    // 误差平方的最大值在结束时开方得到最大绝对误差；逐个比较溢出的代价较高，只有参考值可能越界时才逐块重新计数
+    template <typename ElemT>
+    class batchStats
+    {
+        using vec_t = double __attribute__((vector_size(laneVectorBytes)));
+        inline static constexpr size_t width = laneVectorBytes / sizeof(double);
+        inline static constexpr double scale = std::ldexp(1.0, -ElemT::fracB);
+        inline static constexpr double hi = std::ldexp(1.0, ElemT::intB) - scale;
+        inline static constexpr double lo = ElemT::isS ? -std::ldexp(1.0, ElemT::intB) : 0.0;
+
+        vec_t sumSqError = {}, sumSqRef = {}, maxSqError = {};
+        QuShadowStats stats;
+
+    public:
+        // 依次累加 n 个结果：write(i) 写入第 i 个结果并返回它的副本，stored(i) 返回已写入的第 i 个结果
+        template <typename WriteT, typename StoredT>
+        inline void add(size_t n, WriteT &&write, StoredT &&stored)
+        {
+            // 用 ref 的平方粗筛溢出，只有可能溢出时才逐个检查
+            vec_t maxSqRef = {};
+            const size_t full = n / width * width;
+            for (size_t i = 0; i < full; i += width)
+            {
+                vec_t value, ref;
+                for (size_t l = 0; l < width; l++)
+                {
+                    const ElemT x = write(i + l);
+                    value[l] = x.value.data.toDouble();
+                    ref[l] = static_cast<double>(x.ref);
+                }
+                const vec_t err = value * scale - ref;
+                const vec_t sqError = err * err, sqRef = ref * ref;
+                sumSqError += sqError;
+                sumSqRef += sqRef;
+                maxSqError = sqError > maxSqError ? sqError : maxSqError;
+                maxSqRef = sqRef > maxSqRef ? sqRef : maxSqRef;
+            }
+            stats.count += full;
+
+            bool mayOverflow = false;
+            for (size_t l = 0; l < width; l++)
+            {
+                mayOverflow |= maxSqRef[l] > std::min(lo * lo, hi * hi);
+            }
+            if (mayOverflow)
+            {
+                for (size_t i = 0; i < full; i++)
+                {
+                    const double ref = static_cast<double>(stored(i).ref);
+                    stats.overflows += ref < lo || ref > hi;
+                }
+            }
+
+            for (size_t i = full; i < n; i++)
+            {
+                const ElemT x = write(i);
+                stats.record(x.value.data.toDouble() * scale, static_cast<double>(x.ref), lo, hi);
+            }
+        }
+
+        inline QuShadowStats finish() const
+        {
+            QuShadowStats res = stats;
+            for (size_t l = 0; l < width; l++)
+            {
+                res.sumSqError += sumSqError[l];
+                res.sumSqRef += sumSqRef[l];
+                res.maxAbsError = std::max(res.maxAbsError, std::sqrt(maxSqError[l]));
+            }
+            return res;
+        }
+    };
+
+    struct threadStats;
+
+    struct registry
+    {
+        std::mutex mutex;
+        std::vector<threadStats *> threads;
+        QuShadowStats retired; // 已退出线程的统计
+    };
+
+    struct threadStats
+    {
+        QuShadowStats stats;
+
+        threadStats()
+        {
+            registry &reg = global();
+            std::lock_guard lock(reg.mutex);
+            reg.threads.push_back(this);
+        }
+
+        // 线程退出时把统计并入 retired
+        ~threadStats()
+        {
+            registry &reg = global();
+            std::lock_guard lock(reg.mutex);
+            reg.retired.merge(stats);
+            std::erase(reg.threads, this);
+        }
+    };
+
+    // 永不析构：静态线程池的工作线程在其他静态对象析构之后才退出，threadStats 的析构仍要访问它
+    static registry &global()
+    {
+        static registry &reg = *new registry;
+        return reg;
+    }
+
+    static threadStats &localStats()
+    {
+        thread_local threadStats local;
+        return local;
+    }
+};
+
+template <typename RefT, typename... QuArgs>
+class Qu_s<Shadow<RefT>, Qu_s<QuArgs...>>
+{
+public:
+    using value_t = Qu_s<QuArgs...>;
+    using ref_t = RefT;
+
+    static_assert(!value_t::is_complex, "Shadow only supports real types.");
+
+    inline static constexpr int intB = value_t::intB;
+    inline static constexpr int fracB = value_t::fracB;
+    inline static constexpr bool isS = value_t::isS;
+    inline static constexpr int width = value_t::width;
+    using QuM_t = typename value_t::QuM_t;
+    using OfM_t = typename value_t::OfM_t;
+    inline static constexpr bool is_complex = false;
+
+    value_t value;
+    RefT ref{};
+
+    inline constexpr Qu_s() = default;
+
+    // 参考值为未量化的输入
+    inline Qu_s(double val) : value(val), ref(static_cast<RefT>(val)) {}
+
+    // 定点值与参考值
+    inline Qu_s(const value_t &val, RefT reference) : value(val), ref(reference) {}
+
+    inline constexpr Qu_s(const Qu_s &) = default;
+    inline constexpr Qu_s &operator=(const Qu_s &) = default;
+
+    // 来自其他影子类型，参考值保持不变、定点值按本类型量化
+    template <typename RefFrom, typename... ArgsFrom>
+    inline Qu_s(const Qu_s<Shadow<RefFrom>, Qu_s<ArgsFrom...>> &val) : value(val.value), ref(static_cast<RefT>(val.ref)) {}
+
+    // 来自普通定点数，参考值即其数值
+    template <int intBitsFrom, int fracBitsFrom, bool isSignedFrom, typename QuModeFrom, typename OfModeFrom>
+    inline Qu_s(const Qu_s<intBits<intBitsFrom>, fracBits<fracBitsFrom>, isSigned<isSignedFrom>, QuMode<QuModeFrom>, OfMode<OfModeFrom>> &val) : value(val), ref(static_cast<RefT>(val.toDouble())) {}
+
+    inline double toDouble() const
+    {
+        return value.toDouble();
+    }
+
+    inline double error() const
+    {
+        return value.toDouble() - static_cast<double>(ref);
+    }
+
+    inline std::string toString() const
+    {
+        return value.toString();
+    }
+
+    inline void display(const std::string &name = "") const
+    {
+        value.display(name);
+        std::cout << "Reference: " << static_cast<double>(ref) << " Error: " << error() << '\n';
+        std::cout << '\n';
+    }
+
+    // 作为运算结果记入 QuShadow
+    inline const Qu_s &record() const
+    {
+        constexpr double scale = std::ldexp(1.0, -fracB);
+        constexpr double hi = std::ldexp(1.0, intB) - scale;
+        constexpr double lo = isS ? -std::ldexp(1.0, intB) : 0.0;
+        QuShadow::record(value.data.toDouble() * scale, static_cast<double>(ref), lo, hi);
+        return *this;
+    }
+};
+
+template <typename RefT, typename... QuArgs>
+struct QuInputHelper<Qu_s<Shadow<RefT>, Qu_s<QuArgs...>>>
+{
+    using type = Qu_s<Shadow<RefT>, Qu_s<QuArgs...>>;
+};
+
+template <typename T>
+inline constexpr bool isShadow = false;
+
+template <typename RefT, typename... QuArgs>
+inline constexpr bool isShadow<Qu_s<Shadow<RefT>, Qu_s<QuArgs...>>> = true;
+
+// 写入影子张量时整批记录：T 是逐元素运算的表达式，它的每个元素都是一个影子运算的结果
+template <typename T>
+concept isShadowBatch = isShadow<std::remove_cvref_t<decltype(std::declval<const T &>()[0])>> && requires(const T &t) { t.unrecorded(size_t{}); };
+
+// 与 T 同为影子（或同为普通）的 QuT 类型，归约树的每一层据此保留影子
+template <typename T, typename QuT>
+struct shadowOf_s
+{
+    using type = QuT;
+};
+
+template <typename RefT, typename... QuArgs, typename QuT>
+    requires(!std::is_same_v<QuT, std::nullptr_t> && !isShadow<QuT>)
+struct shadowOf_s<Qu_s<Shadow<RefT>, Qu_s<QuArgs...>>, QuT>
+{
+    using type = Qu_s<Shadow<RefT>, QuT>;
+};
+
+template <typename T, typename QuT>
+using shadowOf = typename shadowOf_s<T, QuT>::type;
+
+template <typename T>
+inline constexpr const auto &shadowValue(const T &x)
+{
+    if constexpr (isShadow<T>)
+    {
+        return x.value;
+    }
+    else
+    {
+        return x;
+    }
+}
+
+template <typename RefT, typename T>
+inline constexpr RefT shadowRef(const T &x)
+{
+    if constexpr (isShadow<T>)
+    {
+        return static_cast<RefT>(x.ref);
+    }
+    else
+    {
+        return static_cast<RefT>(x.toDouble());
+    }
+}
+
+// ------------------- Vector and Matrix -------------------
+
+// std::mdspan only available in clang 18, we need to support gcc
+template <size_t... dims>
+struct dim
+{
+    static inline constexpr size_t dimSize = sizeof...(dims);
+    static inline constexpr size_t elemSize = (dims * ...);
+
+    static inline constexpr std::array<size_t, dimSize> dimArray = {dims...};
+
+    // NOTE: 将约束改为static_assert，原因同上，
+    //       在此处用requires会导致之后代码的code highlighting显示错误
+    template <size_t index>
+    struct dimAt_s
+    {
+        static_assert(index < dimSize, "dimension out of range!");
+        static inline constexpr size_t value = dimArray[index];
+    };
+
+    template <size_t index>
+    static inline constexpr size_t dimAt = dimAt_s<index>::value;
+
+    template <size_t index2>
+    struct elemSizeForIndexHead
+    {
+        static inline constexpr size_t value = std::accumulate(dimArray.begin(), dimArray.begin() + index2, 1, std::multiplies<size_t>());
+    };
+
+    template <size_t... index>
+        requires(sizeof...(index) == dimSize)
+    struct absoluteIndex_s
+    {
+        template <size_t loc, size_t... index2>
+        struct compute;
+
+        template <size_t loc, size_t firstIndex, size_t... indexLeft>
+        struct compute<loc, firstIndex, indexLeft...>
+        {
+            static inline constexpr size_t value = firstIndex * elemSizeForIndexHead<loc>::value + compute<loc + 1, indexLeft...>::value;
+        };
+
+        template <size_t firstIndex>
+        struct compute<dimSize - 1, firstIndex>
+        {
+            static inline constexpr size_t value = firstIndex * elemSizeForIndexHead<dimSize - 1>::value;
+        };
+
+        static inline constexpr size_t value = compute<0, index...>::value;
+    };
+
+    template <size_t... index>
+        requires(sizeof...(index) == dimSize)
+    using absoluteIndex = absoluteIndex_s<index...>::value;
+};
+
+// ------------------- Tensor storage -------------------
+// 元素个数超过 quHeapThreshold（可用 QUBLAS_HEAP_THRESHOLD 修改）的张量放在堆上的 QuHeapBuffer 中
+// 堆内存来自当前线程的 memory_resource，默认为 new/delete；QuMemoryScope 在作用域内换成 QuArena、QuHugePageResource 或任意 std::pmr 资源
+// 例如每次迭代的临时张量放在 QuArena 中，迭代结束后 reset()，稳态下不再有堆分配
+
+#if defined(QUBLAS_HEAP_THRESHOLD)
+inline constexpr size_t quHeapThreshold = QUBLAS_HEAP_THRESHOLD;
+#else
+inline constexpr size_t quHeapThreshold = 1000;
+#endif
+
+class QuMemory
+{
+public:
+    // 当前线程新建的堆张量从这里分配
+    static std::pmr::memory_resource *resource()
+    {
+        return current();
+    }
+
+private:
+    friend class QuMemoryScope;
+
+    static std::pmr::memory_resource *&current()
+    {
+        thread_local std::pmr::memory_resource *res = std::pmr::new_delete_resource();
+        return res;
+    }
+};
+
+// 作用域内当前线程的堆张量从 res 分配，可以嵌套；张量不能比 res 活得更久
+class QuMemoryScope
+{
+public:
+    explicit QuMemoryScope(std::pmr::memory_resource &res) : previous(std::exchange(QuMemory::current(), &res)) {}
+
+    ~QuMemoryScope()
+    {
+        QuMemory::current() = previous;
+    }
+
+    QuMemoryScope(const QuMemoryScope &) = delete;
+    QuMemoryScope &operator=(const QuMemoryScope &) = delete;
+
+private:
+    std::pmr::memory_resource *previous;
+};
+
+// 用 mmap 申请并建议内核使用透明大页，适合长期存在的大张量
+class QuHugePageResource : public std::pmr::memory_resource
+{
+public:
+    inline static constexpr size_t hugePageSize = size_t(2) << 20;
+
+private:
+    static size_t mappedSize(size_t bytes)
+    {
+        return (std::max<size_t>(bytes, 1) + hugePageSize - 1) / hugePageSize * hugePageSize;
+    }
+
+    void *do_allocate(size_t bytes, size_t alignment) override
+    {
+        if (alignment > hugePageSize)
+        {
+            throw std::bad_alloc();
+        }
+
+        void *p = mmap(nullptr, mappedSize(bytes), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+        {
+            throw std::bad_alloc();
+        }
+#if defined(MADV_HUGEPAGE)
+        madvise(p, mappedSize(bytes), MADV_HUGEPAGE);
+#endif
+        return p;
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t) override
+    {
+        munmap(p, mappedSize(bytes));
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return dynamic_cast<const QuHugePageResource *>(&other) != nullptr;
+    }
+};
+
+// 单调分配的内存池：容量在构造时从 upstream 一次申请，deallocate 不回收，reset() 整体回绕
+// 超出容量的请求转给 upstream 并计入 overflows()，据此可以调大容量直到稳态下没有额外的堆分配
+class QuArena : public std::pmr::memory_resource
+{
+public:
+    explicit QuArena(size_t capacity, std::pmr::memory_resource *upstreamResource = std::pmr::new_delete_resource())
+        : upstream(upstreamResource), bytes(capacity), base(static_cast<std::byte *>(upstreamResource->allocate(capacity, alignof(std::max_align_t) > 64 ? alignof(std::max_align_t) : 64)))
+    {
+    }
+
+    ~QuArena() override
+    {
+        upstream->deallocate(base, bytes, alignof(std::max_align_t) > 64 ? alignof(std::max_align_t) : 64);
+    }
+
+    QuArena(const QuArena &) = delete;
+    QuArena &operator=(const QuArena &) = delete;
+
+    // 之前分配的张量都必须已经析构
+    inline void reset()
+    {
+        offset = 0;
+    }
+
+    inline size_t capacity() const
+    {
+        return bytes;
+    }
+
+    inline size_t used() const
+    {
+        return offset;
+    }
+
+    inline size_t peak() const
+    {
+        return high;
+    }
+
+    inline size_t overflows() const
+    {
+        return overflowCount;
+    }
+
+private:
+    std::pmr::memory_resource *upstream;
+    size_t bytes;
+    std::byte *base;
+    size_t offset = 0;
+    size_t high = 0;
+    size_t overflowCount = 0;
+
+    void *do_allocate(size_t n, size_t alignment) override
+    {
+        const size_t begin = (offset + alignment - 1) / alignment * alignment;
+        if (begin + n <= bytes)
+        {
+            offset = begin + n;
+            high = std::max(high, offset);
+            return base + begin;
+        }
+
+        overflowCount++;
+        return upstream->allocate(n, alignment);
+    }
+
+    void do_deallocate(void *p, size_t n, size_t alignment) override
+    {
+        if (p < base || p >= base + bytes)
+        {
+            upstream->deallocate(p, n, alignment);
+        }
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+// 定长的堆数组，记住分配它的资源；元素可以直接按字节复制时跳过多余的初始化
+template <typename T>
+class QuHeapBuffer
+{
+public:
+    inline static constexpr size_t alignment = std::max<size_t>(64, alignof(T));
+    inline static constexpr bool implicitLifetime = std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>;
+
+    QuHeapBuffer() = default;
+
+    // zero 为 false 时元素的值未指定，调用者随后会逐个写入
+    QuHeapBuffer(size_t n, bool zero) : ptr(allocate(n)), count(n), resource(QuMemory::resource())
+    {
+        if (!implicitLifetime || zero)
+        {
+            std::uninitialized_value_construct_n(ptr, n);
+        }
+    }
+
+    QuHeapBuffer(const QuHeapBuffer &other) : ptr(allocate(other.count)), count(other.count), resource(QuMemory::resource())
+    {
+        std::uninitialized_copy_n(other.ptr, other.count, ptr);
+    }
+
+    QuHeapBuffer(QuHeapBuffer &&other) noexcept : ptr(std::exchange(other.ptr, nullptr)), count(std::exchange(other.count, 0)), resource(other.resource) {}
+
+    // 大小相同时原地复制，不重新分配
+    QuHeapBuffer &operator=(const QuHeapBuffer &other)
+    {
+        if (this != &other)
+        {
+            if (count == other.count)
+            {
+                std::copy_n(other.ptr, count, ptr);
+            }
+            else
+            {
+                QuHeapBuffer copy(other);
+                swap(copy);
+            }
+        }
+        return *this;
+    }
+
+    QuHeapBuffer &operator=(QuHeapBuffer &&other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    ~QuHeapBuffer()
+    {
+        if (ptr != nullptr)
+        {
+            std::destroy_n(ptr, count);
+            resource->deallocate(ptr, count * sizeof(T), alignment);
+        }
+    }
+
+    inline void swap(QuHeapBuffer &other) noexcept
+    {
+        std::swap(ptr, other.ptr);
+        std::swap(count, other.count);
+        std::swap(resource, other.resource);
+    }
+
+    inline T *data()
+    {
+        return ptr;
+    }
+
+    inline const T *data() const
+    {
+        return ptr;
+    }
+
+    inline size_t size() const
+    {
+        return count;
+    }
+
+    inline T *begin()
+    {
+        return ptr;
+    }
+
+    inline const T *begin() const
+    {
+        return ptr;
+    }
+
+    inline T *end()
+    {
+        return ptr + count;
+    }
+
+    inline const T *end() const
+    {
+        return ptr + count;
+    }
+
+    inline T &operator[](size_t i)
+    {
+        return ptr[i];
+    }
+
+    inline const T &operator[](size_t i) const
+    {
+        return ptr[i];
+    }
+
+private:
+    T *ptr = nullptr;
+    size_t count = 0;
+    std::pmr::memory_resource *resource = nullptr;
+
+    static T *allocate(size_t n)
+    {
+        return static_cast<T *>(QuMemory::resource()->allocate(n * sizeof(T), alignment));
+    }
+};
+
+// 张量文件的格式，见 Tensor file I/O
+enum class QuFile
+{
+    npy,
+    raw
+};
+
+template <typename TensorT>
+struct QuFile_s;
+
+template <size_t... dims, typename Arg>
+    requires(isA<Arg, Qu_s<>>)
+class Qu_s<dim<dims...>, Arg>
+{
+public:
+    template <typename First, typename... Rest>
+    inline static constexpr size_t calculateIndex(size_t accum, First first, Rest... rest)
+    {
+        if constexpr (sizeof...(Rest) == 0)
+        {
+            return accum + first * dim<dims...>::template elemSizeForIndexHead<sizeof...(dims) - 1>::value;
+        }
+        else
+        {
+            static constexpr size_t nextDimProduct = dim<dims...>::template elemSizeForIndexHead<sizeof...(dims) - sizeof...(Rest) - 1>::value;
+            return calculateIndex(accum + first * nextDimProduct, rest...);
+        }
+    }
+
+    inline static constexpr bool onHeap = dim<dims...>::elemSize > quHeapThreshold;
+
+    // when the size is too large, store the elements in a QuHeapBuffer instead of std::array
+    using storage_t = std::conditional_t<onHeap, QuHeapBuffer<Arg>, std::array<Arg, dim<dims...>::elemSize>>;
+
+    storage_t data;
+
+    using size = dim<dims...>;
+    static constexpr size_t elemSize = size::elemSize;
+    static constexpr size_t dimSize = size::dimSize;
+    using elem_t = Arg;
+
+    // zero 为 false 时调用者随后会写入每个元素，堆上的存储不再预先清零
+    inline static constexpr storage_t makeStorage(bool zero)
+    {
+        if constexpr (onHeap)
+        {
+            return storage_t(dim<dims...>::elemSize, zero);
+        }
+        else
+        {
+            return storage_t();
+        }
+    }
+
+    // 构造函数
+    constexpr Qu_s() : data(makeStorage(true)) {}
+
+    constexpr Qu_s(auto... values) : data(makeStorage(false))
+    {
+        if constexpr (sizeof...(values) == dim<dims...>::elemSize)
+        {
+            size_t i = 0;
+            ((data[i++] = values), ...);
+        }
+        else
+        {
+            throw std::invalid_argument("The number of values does not match the size of the Qu_s.");
+        }
+    }
+
+    template <typename SquareBracketIndexableType>
+        requires isSquareBracketIndexable<SquareBracketIndexableType>
+    constexpr Qu_s(const SquareBracketIndexableType &val) : data(makeStorage(false))
+    {
+        // 同元素类型的视图按连续段整段复制
+        if constexpr (requires { { val.copyTo(data.begin()) }; requires std::is_same_v<typename SquareBracketIndexableType::elem_t, Arg>; })
+        {
+            val.copyTo(data.begin());
+        }
+        else if constexpr (isShadowBatch<SquareBracketIndexableType>)
+        {
+            QuShadow::assign(*this, val, 0, dim<dims...>::elemSize);
+        }
+        else
+        {
+            for (size_t i = 0; i < dim<dims...>::elemSize; i++)
+            {
+                data[i] = val[i];
+            }
+        }
+    }
+
+    // 拷贝构造函数
+    constexpr Qu_s(const Qu_s<dim<dims...>, Arg> &val) : data(val.data) {}
+
+    // 来自不同类型的Qu_s，逐个元素转换
+    template <typename fromArg>
+    constexpr Qu_s(const Qu_s<dim<dims...>, fromArg> &val) : data(makeStorage(false))
+    {
+        for (size_t i = 0; i < dim<dims...>::elemSize; i++)
+        {
+            data[i] = val.data[i];
+        }
+    }
+
+    // 移动构造函数
+    // 来自相同类型的Qu_s, 直接移动std::array或者接管堆上的存储
+    constexpr Qu_s(Qu_s<dim<dims...>, Arg> &&val) : data(std::move(val.data)) {}
+
+    // 来自不同类型的Qu_s，逐个元素转换
+    template <typename fromArg>
+    constexpr Qu_s(Qu_s<dim<dims...>, fromArg> &&val) : data(makeStorage(false))
+    {
+        for (size_t i = 0; i < dim<dims...>::elemSize; i++)
+        {
+            data[i] = val.data[i];
+        }
+    }
+
+    // 拷贝赋值运算符
+    // 来自相同类型的Qu_s, 直接拷贝std::array或者原地拷贝堆上的存储
+    constexpr Qu_s &operator=(const Qu_s<dim<dims...>, Arg> &val)
+    {
+        data = val.data;
+        return *this;
+    }
+
+    // 来自不同类型的Qu_s，逐个元素转换
+    template <typename fromArg>
+    constexpr Qu_s &operator=(const Qu_s<dim<dims...>, fromArg> &val)
+    {
+        reclaim();
+        for (size_t i = 0; i < dim<dims...>::elemSize; i++)
+        {
+            data[i] = val.data[i];
+        }
+        return *this;
+    }
+
+    // 移动赋值运算符
+    // 来自相同类型的Qu_s, 直接移动std::array或者交换堆上的存储
+    constexpr Qu_s &operator=(Qu_s<dim<dims...>, Arg> &&val)
+    {
+        data = std::move(val.data);
+        return *this;
+    }
+
+    // 来自不同类型的Qu_s，逐个元素转换
+    template <typename fromArg>
+    constexpr Qu_s &operator=(Qu_s<dim<dims...>, fromArg> &&val)
+    {
+        reclaim();
+        for (size_t i = 0; i < dim<dims...>::elemSize; i++)
+        {
+            data[i] = std::move(val.data[i]);
+        }
+        return *this;
+    }
+
+    // 被移动走的堆张量在再次逐个写入前重新分配存储
+    inline constexpr void reclaim()
+    {
+        if constexpr (onHeap)
+        {
+            if (data.size() != dim<dims...>::elemSize)
+            {
+                data = makeStorage(false);
+            }
+        }
+    }
+
+    inline void clear()
+    {
+        memset(data.data(), 0, dim<dims...>::elemSize * sizeof(Arg));
+    }
+
+    inline auto fill(auto... dis)
+    {
+        for (size_t i = 0; i < dim<dims...>::elemSize; i++)
+        {
+            data[i].fill(dis...);
+        }
+        return *this;
+    }
+
+    // 计数器随机数填充原始比特：元素 i 只取决于 (seed, stream, i)，分段或用 QfillRandom 并行填充的结果逐位一致
+    inline auto &fillRandom(uint64_t seed, uint32_t stream = 0, size_t begin = 0, size_t end = dim<dims...>::elemSize)
+    {
+        // 窄元素每次生成一批随机字
+        constexpr size_t lanes = Arg::randomWords == 1 ? 64 : 1;
+        const size_t batched = Arg::randomWords == 1 && end > begin ? begin + (end - begin) / lanes * lanes : begin;
+        if constexpr (Arg::randomWords == 1)
+        {
+            std::array<uint64_t, lanes> batch;
+            for (size_t first = begin; first < batched; first += lanes)
+            {
+                Philox4x32::firstWords<lanes>(seed, stream, first, batch.data());
+                for (size_t l = 0; l < lanes; l++)
+                {
+                    data[first + l].fillBits(&batch[l]);
+                }
+            }
+        }
+
+        std::array<uint64_t, (Arg::randomWords + 1) / 2 * 2> words;
+        for (size_t i = batched; i < end; i++)
+        {
+            Philox4x32::words(seed, stream, i, words.data(), Arg::randomWords);
+            data[i].fillBits(words.data());
+        }
+        return *this;
+    }
+
+    inline auto shuffle()
+    {
+        std::shuffle(data.begin(), data.end(), gen);
+        return *this;
+    }
+
+    // get
+    template <auto... index>
+    inline constexpr auto &get()
+    {
+        return std::get<dim<dims...>::template absoluteIndex_s<index...>::value>(data);
+    }
+
+    template <auto... index>
+    inline constexpr const auto &get() const
+    {
+        return std::get<dim<dims...>::template absoluteIndex_s<index...>::value>(data);
+    }
+
+    // operator[]
+    inline constexpr auto &operator[](auto... index)
+        requires(sizeof...(index) == dim<dims...>::dimSize && sizeof...(index) > 1)
+    {
+        return data[calculateIndex(0, index...)];
+    }
+
+    inline constexpr const auto &operator[](auto... index) const
+        requires(sizeof...(index) == dim<dims...>::dimSize && sizeof...(index) > 1)
+    {
+        return data[calculateIndex(0, index...)];
+    }
+
+    inline constexpr auto &operator[](size_t index)
+    {
+        return data[index];
+    }
+
+    inline constexpr const auto &operator[](size_t index) const
+    {
+        return data[index];
+    }
+
+    // 堆上的张量返回 std::vector，避免在栈上放下整个结果
+    inline auto toDouble() const
+    {
+        std::conditional_t<onHeap, std::vector<double>, std::array<double, dim<dims...>::elemSize>> result;
+        if constexpr (onHeap)
+        {
+            result.resize(dim<dims...>::elemSize);
+        }
+        for (size_t i = 0; i < dim<dims...>::elemSize; i++)
+        {
+            result[i] = data[i].toDouble();
+        }
+        return result;
+    }
+
+    // batched conversion into caller-owned doubles, complex elements write interleaved (real, imag) pairs
+    inline void toDouble(std::span<double> out) const
+    {
+        constexpr size_t stride = Arg::is_complex ? 2 : 1;
+
+        if (out.size() != dim<dims...>::elemSize * stride)
+        {
+            throw std::invalid_argument("The number of doubles does not match the size of the Qu_s.");
+        }
+
+        for (size_t i = 0; i < dim<dims...>::elemSize; i++)
+        {
+            if constexpr (Arg::is_complex)
+            {
+                const auto v = data[i].toDouble();
+                out[2 * i] = v.real();
+                out[2 * i + 1] = v.imag();
+            }
+            else
+            {
+                out[i] = data[i].toDouble();
+            }
+        }
+    }
+
+    // batched conversion from doubles, complex elements take interleaved (real, imag) pairs
+    inline constexpr auto &fromDoubles(std::span<const double> vals)
+    {
+        constexpr size_t stride = Arg::is_complex ? 2 : 1;
+
+        if (vals.size() != dim<dims...>::elemSize * stride)
+        {
+            throw std::invalid_argument("The number of doubles does not match the size of the Qu_s.");
+        }
+
+        for (size_t i = 0; i < dim<dims...>::elemSize; i++)
+        {
+            if constexpr (Arg::is_complex)
+            {
+                data[i] = Arg(vals[2 * i], vals[2 * i + 1]);
+            }
+            else
+            {
+                data[i] = Arg(vals[i]);
+            }
+        }
+        return *this;
+    }
+
+    void display(std::string const &name = "") const
+    {
+        if (name != "")
+        {
+            std::cout << name << " :";
+        }
+
+        for (size_t i = 0; i < dim<dims...>::elemSize; i++)
+        {
+            data[i].display();
+        }
+    }
+
+    // overload for std::cout
+    // output the double value in matrix form if it is a matrix
+    friend std::ostream &operator<<(std::ostream &os, const Qu_s &val)
+    {
+        // 保存原始格式状态
+        std::ios_base::fmtflags original_flags = os.flags();
+        std::streamsize original_precision = os.precision();
+
+        // 遍历以找出最大数字，以便设置输出宽度
+        int max_width = 0;
+        for (size_t i = 0; i < dim<dims...>::elemSize; i++)
+        {
+            std::stringstream ss;
+            ss << std::fixed << std::setprecision(4) << val.data[i].toDouble();
+
+            max_width = std::max(max_width, static_cast<int>(ss.str().size()));
+        }
+
+        // 设置固定小数点表示法和小数点后两位
+        os << std::fixed << std::setprecision(4);
+
+        os << "[";
+        if constexpr (dim<dims...>::dimSize == 2)
+        {
+            size_t row = dim<dims...>::template dimAt<0>;
+            size_t col = dim<dims...>::template dimAt<1>;
+
+            for (size_t i = 0; i < row; i++)
+            {
+                if (i != 0)
+                {
+                    os << ' ';
+                }
+                for (size_t j = 0; j < col; j++)
+                {
+                    os << std::setw(max_width) << std::right << val[i, j].toDouble();
+
+                    if (j != col - 1)
+                    {
+                        os << ", ";
+                    }
+                }
+
+                if (i != row - 1)
+                {
+                    os << '\n';
+                }
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < dim<dims...>::elemSize; i++)
+            {
+                os << val[i];
+                if (i != dim<dims...>::elemSize - 1)
+                {
+                    os << ", ";
+                }
+            }
+        }
+        os << "]";
+
+        // 恢复原始格式状态
+        os.flags(original_flags);
+        os.precision(original_precision);
+
+        return os;
+    }
+
+    void toMatlab(std::string filename)
+    {
+        // 如果没有带后缀，自动加上.txt
+        if (filename.find('.') == std::string::npos)
+        {
+            filename += ".txt";
+        }
+
+        std::ofstream file(filename);
+
+        // output to file in the matlab format
+        file << "[";
+        if constexpr (dim<dims...>::dimSize == 2)
+        {
+            size_t row = dim<dims...>::template dimAt<0>;
+            size_t col = dim<dims...>::template dimAt<1>;
+
+            for (size_t i = 0; i < row; i++)
+            {
+                if (i != 0)
+                {
+                    file << ' ';
+                }
+                for (size_t j = 0; j < col; j++)
+                {
+                    file << this->operator[](i, j).toDouble();
+
+                    if (j != col - 1)
+                    {
+                        file << ", ";
+                    }
+                    else
+                    {
+                        file << ";";
+                    }
+                }
+
+                if (i != row - 1)
+                {
+                    file << '\n';
+                }
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < dim<dims...>::elemSize; i++)
+            {
+                file << data[i].toDouble();
+                if (i != dim<dims...>::elemSize - 1)
+                {
+                    file << ", ";
+                }
+            }
+        }
+        file << "]";
+        file.close();
+    }
+
+    // 以原始整数比特保存与读取，见 Tensor file I/O
+    void toNpy(const std::string &filename) const;
+    void fromNpy(const std::string &filename);
+    void toRaw(const std::string &filename) const;
+    void fromRaw(const std::string &filename);
+};
+
+template <typename... Args, size_t... dims>
+struct QuInputHelper<dim<dims...>, Args...>
+{
+    using type = Qu_s<dim<dims...>, Qu<Args...>>;
+};
+
+template <typename... Args, size_t... dims>
+struct QuInputHelper<dim<dims...>, TypeList<Args...>>
+{
+    using type = Qu_s<dim<dims...>, TypeList<Args...>>;
+};
+
+template <typename T>
+struct isScalar_s
+{
+    static inline constexpr bool value = false;
+};
+
+template <int intBitsInput, int fracBitsInput, bool isSignedInput, typename QuModeInput, typename OfModeInput>
+struct isScalar_s<Qu_s<intBits<intBitsInput>, fracBits<fracBitsInput>, isSigned<isSignedInput>, QuMode<QuModeInput>, OfMode<OfModeInput>>>
+{
+    static inline constexpr bool value = true;
+};
+
+template <typename... realArgs, typename... imagArgs>
+struct isScalar_s<Qu_s<Qu_s<realArgs...>, Qu_s<imagArgs...>>>
+{
+    static inline constexpr bool value = true;
+};
+
+template <typename RefT, typename... QuArgs>
+struct isScalar_s<Qu_s<Shadow<RefT>, Qu_s<QuArgs...>>>
+{
+    static inline constexpr bool value = true;
+};
+
+template <typename QuT, size_t... dims>
+struct isScalar_s<Qu_s<dim<dims...>, QuT>>
+{
+    static inline constexpr bool value = false;
+};
+
+template <typename T>
+inline constexpr bool isScalar = isScalar_s<T>::value;
+
+// ------------------- SoA layout -------------------
+// Qu<dim<dims...>, layout<SoA>, Args...> keeps the raw payloads of the elements in planes: one plane per word of the ArbiInt, and separate planes
+// for the real and the imaginary part of complex elements, so the elementwise loops work on contiguous integers. operator[] returns a proxy.
+
+struct AoS;
+struct SoA;
+
+template <typename T>
+struct layout;
+
+// the word type and the number of words of the payload of ArbiInt<N>
+template <size_t N>
+struct payloadWords
+{
+    using word_t = typename ArbiInt<N>::data_t;
+    inline static constexpr size_t count = 1;
+};
+
+template <size_t N>
+    requires(N > 64)
+struct payloadWords<N>
+{
+    using word_t = uint64_t;
+    inline static constexpr size_t count = ArbiInt<N>::num_words;
+};
+
+template <typename QuT, size_t Size, bool onHeap>
+struct soaPlanes;
+
+// planes of a real element type
+template <typename... Args, size_t Size, bool onHeap>
+    requires isScalar<Qu_s<Args...>> && (!Qu_s<Args...>::is_complex)
+struct soaPlanes<Qu_s<Args...>, Size, onHeap>
+{
+    using elem_t = Qu_s<Args...>;
+    using payload = payloadWords<decltype(elem_t::data)::num_bits>;
+    using word_t = typename payload::word_t;
+    inline static constexpr size_t num_planes = payload::count;
+
+    // every plane starts on a 64-byte boundary
+    inline static constexpr size_t stride = (Size * sizeof(word_t) + 63) / 64 * 64 / sizeof(word_t);
+
+    // 堆上的平面与 AoS 一样放在 QuHeapBuffer 中，从 QuMemory::resource() 分配，按 64 字节对齐
+    using storage_t = std::conditional_t<onHeap, QuHeapBuffer<word_t>, std::array<word_t, stride * num_planes>>;
+    alignas(64) storage_t words = makeStorage();
+
+    inline static constexpr storage_t makeStorage()
+    {
+        if constexpr (onHeap)
+        {
+            return storage_t(stride * num_planes, true);
+        }
+        else
+        {
+            return storage_t{};
+        }
+    }
+
+    inline constexpr word_t *plane(size_t p)
+    {
+        return words.data() + p * stride;
+    }
+
+    inline constexpr const word_t *plane(size_t p) const
+    {
+        return words.data() + p * stride;
+    }
+
+    inline constexpr elem_t load(size_t i) const
+    {
+        elem_t res;
+        if constexpr (num_planes == 1)
+        {
+            res.data.data = plane(0)[i];
+        }
+        else
+        {
+            for (size_t p = 0; p < num_planes; ++p)
+            {
+                res.data.data[p] = plane(p)[i];
+            }
+        }
+        return res;
+    }
+
+    inline constexpr void store(size_t i, const elem_t &val)
+    {
+        if constexpr (num_planes == 1)
+        {
+            plane(0)[i] = val.data.data;
+        }
+        else
+        {
+            for (size_t p = 0; p < num_planes; ++p)
+            {
+                plane(p)[i] = val.data.data[p];
+            }
+        }
+    }
+};
+
+// planes of a complex element type, the real planes and the imaginary planes
+template <typename... realArgs, typename... imagArgs, size_t Size, bool onHeap>
+struct soaPlanes<Qu_s<Qu_s<realArgs...>, Qu_s<imagArgs...>>, Size, onHeap>
+{
+    using elem_t = Qu_s<Qu_s<realArgs...>, Qu_s<imagArgs...>>;
+
+    soaPlanes<Qu_s<realArgs...>, Size, onHeap> real;
+    soaPlanes<Qu_s<imagArgs...>, Size, onHeap> imag;
+
+    inline constexpr elem_t load(size_t i) const
+    {
+        elem_t res;
+        res.real = real.load(i);
+        res.imag = imag.load(i);
+        return res;
+    }
+
+    inline constexpr void store(size_t i, const elem_t &val)
+    {
+        real.store(i, val.real);
+        imag.store(i, val.imag);
+    }
+};
+
+// proxy reference to one element of a SoA tensor
+template <typename PlanesT>
+struct soaRef;
+
+template <typename PlanesT>
+struct soaRefBase
+{
+    using value_type = typename PlanesT::elem_t;
+
+    PlanesT *planes;
+    size_t index;
+
+    inline constexpr soaRefBase(PlanesT *p, size_t i) : planes(p), index(i) {}
+
+    inline constexpr operator value_type() const
+    {
+        return planes->load(index);
+    }
+
+    inline constexpr value_type get() const
+    {
+        return planes->load(index);
+    }
+
+    inline constexpr void set(const value_type &val)
+    {
+        planes->store(index, val);
+    }
+
+    inline auto toDouble() const
+    {
+        return get().toDouble();
+    }
+
+    inline auto toString() const
+    {
+        return get().toString();
+    }
+
+    inline void display(const std::string &name = "") const
+    {
+        get().display(name);
+    }
+
+    inline auto fill(auto... dis)
+    {
+        value_type val;
+        val.fill(dis...);
+        set(val);
+        return val;
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const soaRefBase &ref)
+    {
+        return os << ref.get();
+    }
+};
+
+template <typename PlanesT>
+struct soaRef : soaRefBase<PlanesT>
+{
+    using soaRefBase<PlanesT>::soaRefBase;
+    using value_type = typename PlanesT::elem_t;
+
+    // assigning a proxy to a proxy copies the value, not the reference
+    inline constexpr soaRef &operator=(const soaRef &other)
+    {
+        this->set(other.get());
+        return *this;
+    }
+
+    template <typename T>
+    inline constexpr soaRef &operator=(const T &val)
+    {
+        this->set(value_type(val));
+        return *this;
+    }
+
+    inline soaRef &operator+=(const value_type &other)
+    {
+        this->set(this->get() += other);
+        return *this;
+    }
+
+    inline soaRef &operator-=(const value_type &other)
+    {
+        this->set(this->get() -= other);
+        return *this;
+    }
+
+    inline soaRef &operator*=(const value_type &other)
+    {
+        this->set(this->get() *= other);
+        return *this;
+    }
+};
+
+// the complex proxy also exposes the real and imaginary parts as proxies
+template <typename... realArgs, typename... imagArgs, size_t Size, bool onHeap>
+struct soaRef<soaPlanes<Qu_s<Qu_s<realArgs...>, Qu_s<imagArgs...>>, Size, onHeap>> : soaRefBase<soaPlanes<Qu_s<Qu_s<realArgs...>, Qu_s<imagArgs...>>, Size, onHeap>>
+{
+    using planes_t = soaPlanes<Qu_s<Qu_s<realArgs...>, Qu_s<imagArgs...>>, Size, onHeap>;
+    using value_type = typename planes_t::elem_t;
+
+    soaRef<soaPlanes<Qu_s<realArgs...>, Size, onHeap>> real;
+    soaRef<soaPlanes<Qu_s<imagArgs...>, Size, onHeap>> imag;
+
+    inline constexpr soaRef(planes_t *p, size_t i) : soaRefBase<planes_t>(p, i), real(&p->real, i), imag(&p->imag, i) {}
+
+    inline constexpr soaRef(const soaRef &other) = default;
+
+    inline constexpr soaRef &operator=(const soaRef &other)
+    {
+        this->set(other.get());
+        return *this;
+    }
+
+    template <typename T>
+    inline constexpr soaRef &operator=(const T &val)
+    {
+        this->set(value_type(val));
+        return *this;
+    }
+};
+
+template <typename T>
+struct isSoaRef_s
+{
+    static inline constexpr bool value = false;
+};
+
+template <typename PlanesT>
+struct isSoaRef_s<soaRef<PlanesT>>
+{
+    static inline constexpr bool value = true;
+};
+
+template <typename T>
+inline constexpr bool isSoaRef = isSoaRef_s<std::remove_cvref_t<T>>::value;
+
+// the value behind a proxy, anything else is passed through
+template <typename T>
+inline constexpr decltype(auto) unwrapRef(const T &val)
+{
+    if constexpr (isSoaRef<T>)
+    {
+        return val.get();
+    }
+    else
+    {
+        return val;
+    }
+}
+
+template <size_t... dims, typename Arg>
+    requires(isA<Arg, Qu_s<>>)
+class Qu_s<dim<dims...>, layout<SoA>, Arg>
+{
+public:
+    using size = dim<dims...>;
+    static constexpr size_t elemSize = size::elemSize;
+    static constexpr size_t dimSize = size::dimSize;
+    using elem_t = Arg;
+
+    inline static constexpr bool onHeap = dim<dims...>::elemSize > quHeapThreshold;
+
+    using planes_t = soaPlanes<Arg, elemSize, onHeap>;
+    using ref_t = soaRef<planes_t>;
+
+    planes_t planes;
+
+    constexpr Qu_s() = default;
+
+    // from another tensor or an expression, elementwise
+    template <typename SquareBracketIndexableType>
+        requires isSquareBracketIndexable<SquareBracketIndexableType> && (!std::is_same_v<SquareBracketIndexableType, Qu_s>)
+    constexpr Qu_s(const SquareBracketIndexableType &val)
+    {
+        for (size_t i = 0; i < elemSize; i++)
+        {
+            planes.store(i, Arg(unwrapRef(val[i])));
+        }
+    }
+
+    template <typename SquareBracketIndexableType>
+        requires isSquareBracketIndexable<SquareBracketIndexableType> && (!std::is_same_v<SquareBracketIndexableType, Qu_s>)
+    constexpr Qu_s &operator=(const SquareBracketIndexableType &val)
+    {
+        for (size_t i = 0; i < elemSize; i++)
+        {
+            planes.store(i, Arg(unwrapRef(val[i])));
+        }
+        return *this;
+    }
+
+    inline constexpr ref_t operator[](size_t index)
+    {
+        return ref_t(&planes, index);
+    }
+
+    inline constexpr Arg operator[](size_t index) const
+    {
+        return planes.load(index);
+    }
+
+    inline constexpr ref_t operator[](auto... index)
+        requires(sizeof...(index) == dimSize && sizeof...(index) > 1)
+    {
+        return ref_t(&planes, Qu_s<dim<dims...>, Arg>::calculateIndex(0, index...));
+    }
+
+    inline constexpr Arg operator[](auto... index) const
+        requires(sizeof...(index) == dimSize && sizeof...(index) > 1)
+    {
+        return planes.load(Qu_s<dim<dims...>, Arg>::calculateIndex(0, index...));
+    }
+
+    template <auto... index>
+    inline constexpr ref_t get()
+    {
+        return ref_t(&planes, dim<dims...>::template absoluteIndex_s<index...>::value);
+    }
+
+    template <auto... index>
+    inline constexpr Arg get() const
+    {
+        return planes.load(dim<dims...>::template absoluteIndex_s<index...>::value);
+    }
+
+    inline void clear()
+    {
+        *this = Qu_s();
+    }
+
+    inline auto fill(auto... dis)
+    {
+        for (size_t i = 0; i < elemSize; i++)
+        {
+            Arg val;
+            val.fill(dis...);
+            planes.store(i, val);
+        }
+        return *this;
+    }
+
+    // 与默认布局的 fillRandom 结果相同
+    inline auto &fillRandom(uint64_t seed, uint32_t stream = 0, size_t begin = 0, size_t end = elemSize)
+    {
+        std::array<uint64_t, (Arg::randomWords + 1) / 2 * 2> words;
+        for (size_t i = begin; i < end; i++)
+        {
+            Philox4x32::words(seed, stream, i, words.data(), Arg::randomWords);
+            Arg val;
+            val.fillBits(words.data());
+            planes.store(i, val);
+        }
+        return *this;
+    }
+
+    // 与默认布局相同，堆上的张量返回 std::vector
+    inline auto toDouble() const
+    {
+        std::conditional_t<onHeap, std::vector<double>, std::array<double, elemSize>> result;
+        if constexpr (onHeap)
+        {
+            result.resize(elemSize);
+        }
+        for (size_t i = 0; i < elemSize; i++)
+        {
+            result[i] = planes.load(i).toDouble();
+        }
+        return result;
+    }
+
+    // batched conversion into caller-owned doubles, complex elements write interleaved (real, imag) pairs
+    inline void toDouble(std::span<double> out) const
+    {
+        constexpr size_t stride = Arg::is_complex ? 2 : 1;
+
+        if (out.size() != elemSize * stride)
+        {
+            throw std::invalid_argument("The number of doubles does not match the size of the Qu_s.");
+        }
+
+        for (size_t i = 0; i < elemSize; i++)
+        {
+            if constexpr (Arg::is_complex)
+            {
+                const auto v = planes.load(i).toDouble();
+                out[2 * i] = v.real();
+                out[2 * i + 1] = v.imag();
+            }
+            else
+            {
+                out[i] = planes.load(i).toDouble();
+            }
+        }
+    }
+
+    inline constexpr auto &fromDoubles(std::span<const double> vals)
+    {
+        Qu_s<dim<dims...>, Arg> aos;
+        aos.fromDoubles(vals);
+        *this = aos;
+        return *this;
+    }
+
+    // the same element order as the default layout
+    inline auto toAoS() const
+    {
+        return Qu_s<dim<dims...>, Arg>(*this);
+    }
+
+    void display(std::string const &name = "") const
+    {
+        toAoS().display(name);
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const Qu_s &val)
+    {
+        return os << val.toAoS();
+    }
+
+    void toMatlab(std::string filename)
+    {
+        toAoS().toMatlab(filename);
+    }
+
+    void toNpy(const std::string &filename) const
+    {
+        toAoS().toNpy(filename);
+    }
+
+    void toRaw(const std::string &filename) const
+    {
+        toAoS().toRaw(filename);
+    }
+};
+
+template <typename... Args, size_t... dims>
+struct QuInputHelper<dim<dims...>, layout<SoA>, Args...>
+{
+    using type = Qu_s<dim<dims...>, layout<SoA>, Qu<Args...>>;
+};
+
+template <typename... Args, size_t... dims>
+struct QuInputHelper<dim<dims...>, layout<AoS>, Args...>
+{
+    using type = Qu_s<dim<dims...>, Qu<Args...>>;
+};
+
+// ------------------- Sparse layout -------------------
+// Qu<dim<M, N>, layout<CSR>, Args...> 等稀疏矩阵只存结构非零元：按主方向（CSR、Banded、BlockDiagonal 为行，CSC 为列）压缩为 ptr / idx / vals
+// CSR 与 CSC 的结构在运行期由稠密张量或坐标表决定，Banded 与 BlockDiagonal 的结构由布局决定，带内或块内的零也会存下来
+// Qgemv 与 Qgemul 只对结构非零元做乘法，并按 Reducer 的逐层顺序归约，见 Sparse BLAS
+
+struct CSR;
+struct CSC;
+
+// 对角线下方 lower 条、上方 upper 条对角线
+template <size_t lower, size_t upper>
+struct Banded
+{
+};
+
+// 第 b 个块覆盖行 [b * blockRows, (b + 1) * blockRows) 与列 [b * blockCols, (b + 1) * blockCols)
+template <size_t blockRows, size_t blockCols = blockRows>
+struct BlockDiagonal
+{
+};
+
+template <typename T>
+inline constexpr bool isSparseLayout = false;
+
+template <>
+inline constexpr bool isSparseLayout<CSR> = true;
+
+template <>
+inline constexpr bool isSparseLayout<CSC> = true;
+
+template <size_t lower, size_t upper>
+inline constexpr bool isSparseLayout<Banded<lower, upper>> = true;
+
+template <size_t blockRows, size_t blockCols>
+inline constexpr bool isSparseLayout<BlockDiagonal<blockRows, blockCols>> = true;
+
+// 坐标表中的一项
+template <typename Arg>
+struct QuCoo
+{
+    size_t row;
+    size_t col;
+    Arg val;
+};
+
+// 某个方向上压缩的视图，方向与存储不同时持有转置后的副本
+// 持有副本时 span 指向自身的 vector：移动保留 vector 的缓冲区，复制则会让 span 仍指向原对象，因此禁止复制
+template <typename Arg>
+struct QuSparseLines
+{
+    std::span<const size_t> ptr;
+    std::span<const uint32_t> idx;
+    std::span<const Arg> vals;
+
+    std::vector<size_t> ownPtr;
+    std::vector<uint32_t> ownIdx;
+    std::vector<Arg> ownVals;
+
+    QuSparseLines() = default;
+    QuSparseLines(const QuSparseLines &) = delete;
+    QuSparseLines &operator=(const QuSparseLines &) = delete;
+    QuSparseLines(QuSparseLines &&) = default;
+    QuSparseLines &operator=(QuSparseLines &&) = default;
+};
+
+template <size_t M, size_t N, typename L, typename Arg>
+    requires isSparseLayout<L>
+class Qu_s<dim<M, N>, layout<L>, Arg>
+{
+public:
+    using size = dim<M, N>;
+    static constexpr size_t elemSize = size::elemSize;
+    static constexpr size_t dimSize = size::dimSize;
+    using elem_t = Arg;
+    using layout_t = L;
+
+    static constexpr bool byRows = !std::is_same_v<L, CSC>;
+    static constexpr bool structured = !std::is_same_v<L, CSR> && !std::is_same_v<L, CSC>;
+    static constexpr size_t majorSize = byRows ? M : N;
+    static constexpr size_t minorSize = byRows ? N : M;
+
+    static_assert(M <= std::numeric_limits<uint32_t>::max() && N <= std::numeric_limits<uint32_t>::max(), "The indices of a sparse matrix are stored in 32 bits.");
+
+    std::vector<size_t> ptr;
+    std::vector<uint32_t> idx;
+    std::vector<Arg> vals;
+
+    // 结构化布局中第 i 行的列区间 [first, last)
+    inline static constexpr std::pair<size_t, size_t> band(size_t i)
+    {
+        return bandOf(std::type_identity<L>(), i);
+    }
+
+    // 全零矩阵，结构化布局的结构已经确定
+    Qu_s() : ptr(majorSize + 1, 0)
+    {
+        if constexpr (structured)
+        {
+            for (size_t i = 0; i < M; i++)
+            {
+                const auto [first, last] = band(i);
+                ptr[i + 1] = ptr[i] + (last - first);
+                for (size_t j = first; j < last; j++)
+                {
+                    idx.push_back(static_cast<uint32_t>(j));
+                }
+            }
+            vals.resize(idx.size());
+        }
+    }
+
+    // 从稠密张量或表达式构造，下标为列主序，CSR 与 CSC 只保留非零元
+    template <typename DenseT>
+        requires isSquareBracketIndexable<DenseT> && (!std::is_same_v<DenseT, Qu_s>) && (DenseT::elemSize == M * N)
+    explicit Qu_s(const DenseT &dense) : Qu_s()
+    {
+        if constexpr (structured)
+        {
+            for (size_t i = 0; i < M; i++)
+            {
+                for (size_t j = 0; j < N; j++)
+                {
+                    const Arg v = Arg(dense[i + j * M]);
+                    if (contains(i, j))
+                    {
+                        vals[position(i, j)] = v;
+                    }
+                    else if (!isZero(v))
+                    {
+                        throw std::invalid_argument("A non-zero element lies outside the structure of the sparse layout.");
+                    }
+                }
+            }
+        }
+        else
+        {
+            for (size_t maj = 0; maj < majorSize; maj++)
+            {
+                for (size_t min = 0; min < minorSize; min++)
+                {
+                    const Arg v = Arg(byRows ? dense[maj + min * M] : dense[min + maj * M]);
+                    if (!isZero(v))
+                    {
+                        idx.push_back(static_cast<uint32_t>(min));
+                        vals.push_back(v);
+                    }
+                }
+                ptr[maj + 1] = idx.size();
+            }
+        }
+    }
+
+    // 从坐标表构造，顺序任意，重复的坐标与越界的坐标抛出 std::invalid_argument
+    explicit Qu_s(std::span<const QuCoo<Arg>> entries) : Qu_s()
+    {
+        if constexpr (structured)
+        {
+            std::vector<bool> seen(vals.size(), false);
+            for (const auto &e : entries)
+            {
+                checkCoordinate(e);
+                if (!contains(e.row, e.col))
+                {
+                    if (isZero(e.val))
+                    {
+                        continue;
+                    }
+                    throw std::invalid_argument("A non-zero element lies outside the structure of the sparse layout.");
+                }
+                const size_t p = position(e.row, e.col);
+                if (seen[p])
+                {
+                    throw std::invalid_argument("Duplicate coordinate in the coordinate list.");
+                }
+                seen[p] = true;
+                vals[p] = e.val;
+            }
+        }
+        else
+        {
+            // 按主方向计数排序，再在每条线内按次方向排序
+            for (const auto &e : entries)
+            {
+                checkCoordinate(e);
+                ptr[(byRows ? e.row : e.col) + 1]++;
+            }
+            for (size_t maj = 0; maj < majorSize; maj++)
+            {
+                ptr[maj + 1] += ptr[maj];
+            }
+
+            std::vector<size_t> order(entries.size());
+            std::vector<size_t> fill(ptr.begin(), ptr.end() - 1);
+            for (size_t e = 0; e < entries.size(); e++)
+            {
+                order[fill[byRows ? entries[e].row : entries[e].col]++] = e;
+            }
+
+            idx.resize(entries.size());
+            vals.resize(entries.size());
+            for (size_t maj = 0; maj < majorSize; maj++)
+            {
+                auto minorOf = [&](size_t e) { return byRows ? entries[e].col : entries[e].row; };
+                std::sort(order.begin() + ptr[maj], order.begin() + ptr[maj + 1], [&](size_t a, size_t b) { return minorOf(a) < minorOf(b); });
+                for (size_t p = ptr[maj]; p < ptr[maj + 1]; p++)
+                {
+                    if (p > ptr[maj] && minorOf(order[p]) == idx[p - 1])
+                    {
+                        throw std::invalid_argument("Duplicate coordinate in the coordinate list.");
+                    }
+                    idx[p] = static_cast<uint32_t>(minorOf(order[p]));
+                    vals[p] = entries[order[p]].val;
+                }
+            }
+        }
+    }
+
+    explicit Qu_s(const std::vector<QuCoo<Arg>> &entries) : Qu_s(std::span<const QuCoo<Arg>>(entries)) {}
+
+    // 存储的元素个数
+    inline size_t nnz() const
+    {
+        return vals.size();
+    }
+
+    inline static constexpr bool contains(size_t i, size_t j)
+    {
+        if constexpr (structured)
+        {
+            const auto [first, last] = band(i);
+            return j >= first && j < last;
+        }
+        else
+        {
+            return true;
+        }
+    }
+
+    // (i, j) 处的值，结构零返回零
+    inline Arg operator[](size_t i, size_t j) const
+    {
+        const size_t maj = byRows ? i : j;
+        const size_t min = byRows ? j : i;
+        const auto begin = idx.begin() + ptr[maj];
+        const auto end = idx.begin() + ptr[maj + 1];
+        const auto it = std::lower_bound(begin, end, static_cast<uint32_t>(min));
+        if (it != end && *it == min)
+        {
+            return vals[it - idx.begin()];
+        }
+        return Arg();
+    }
+
+    // 列主序的线性下标，与稠密张量相同
+    inline Arg operator[](size_t index) const
+    {
+        return (*this)[index % M, index / M];
+    }
+
+    // 对每个存储的元素做 func，结构不变，func 应把零映射为零
+    template <typename OutArg = void>
+    inline auto apply(const auto &func) const
+    {
+        using out_t = std::conditional_t<std::is_void_v<OutArg>, std::remove_cvref_t<decltype(func(std::declval<const Arg &>()))>, OutArg>;
+
+        Qu_s<dim<M, N>, layout<L>, out_t> res;
+        res.ptr = ptr;
+        res.idx = idx;
+        res.vals.resize(vals.size());
+        for (size_t p = 0; p < vals.size(); p++)
+        {
+            res.vals[p] = out_t(func(vals[p]));
+        }
+        return res;
+    }
+
+    // 只写入存储的元素
+    inline auto toDense() const
+    {
+        Qu_s<dim<M, N>, Arg> res;
+        forEach([&](size_t i, size_t j, const Arg &v) { res[i, j] = v; });
+        return res;
+    }
+
+    inline std::vector<double> toDouble() const
+    {
+        std::vector<double> res(elemSize, 0.0);
+        forEach([&](size_t i, size_t j, const Arg &v) { res[i + j * M] = v.toDouble(); });
+        return res;
+    }
+
+    // 按存储顺序遍历 func(i, j, val)
+    inline void forEach(const auto &func) const
+    {
+        for (size_t maj = 0; maj < majorSize; maj++)
+        {
+            for (size_t p = ptr[maj]; p < ptr[maj + 1]; p++)
+            {
+                if constexpr (byRows)
+                {
+                    func(maj, size_t(idx[p]), vals[p]);
+                }
+                else
+                {
+                    func(size_t(idx[p]), maj, vals[p]);
+                }
+            }
+        }
+    }
+
+    // rows 为 true 时按行压缩，否则按列压缩
+    template <bool rows>
+    inline QuSparseLines<Arg> lines() const
+    {
+        QuSparseLines<Arg> res;
+        if constexpr (rows == byRows)
+        {
+            res.ptr = ptr;
+            res.idx = idx;
+            res.vals = vals;
+        }
+        else
+        {
+            // 计数排序转置，每条线内的下标仍然递增
+            res.ownPtr.assign(minorSize + 1, 0);
+            for (const uint32_t min : idx)
+            {
+                res.ownPtr[min + 1]++;
+            }
+            for (size_t min = 0; min < minorSize; min++)
+            {
+                res.ownPtr[min + 1] += res.ownPtr[min];
+            }
+
+            std::vector<size_t> fill(res.ownPtr.begin(), res.ownPtr.end() - 1);
+            res.ownIdx.resize(idx.size());
+            res.ownVals.resize(vals.size());
+            for (size_t maj = 0; maj < majorSize; maj++)
+            {
+                for (size_t p = ptr[maj]; p < ptr[maj + 1]; p++)
+                {
+                    const size_t dst = fill[idx[p]]++;
+                    res.ownIdx[dst] = static_cast<uint32_t>(maj);
+                    res.ownVals[dst] = vals[p];
+                }
+            }
+
+            res.ptr = res.ownPtr;
+            res.idx = res.ownIdx;
+            res.vals = res.ownVals;
+        }
+        return res;
+    }
+
+    void display(std::string const &name = "") const
+    {
+        toDense().display(name);
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const Qu_s &val)
+    {
+        return os << val.toDense();
+    }
+
+private:
+    template <size_t lower, size_t upper>
+    inline static constexpr std::pair<size_t, size_t> bandOf(std::type_identity<Banded<lower, upper>>, size_t i)
+    {
+        const size_t first = i > lower ? i - lower : 0;
+        return {std::min(first, N), std::min(i + upper + 1, N)};
+    }
+
+    template <size_t blockRows, size_t blockCols>
+    inline static constexpr std::pair<size_t, size_t> bandOf(std::type_identity<BlockDiagonal<blockRows, blockCols>>, size_t i)
+    {
+        const size_t block = i / blockRows;
+        return {std::min(block * blockCols, N), std::min((block + 1) * blockCols, N)};
+    }
+
+    template <typename T>
+    inline static constexpr std::pair<size_t, size_t> bandOf(std::type_identity<T>, size_t)
+    {
+        return {0, N};
+    }
+
+    // 结构化布局中 (i, j) 在 vals 中的位置
+    inline size_t position(size_t i, size_t j) const
+    {
+        return ptr[i] + (j - band(i).first);
+    }
+
+    inline static bool isZero(const Arg &v)
+    {
+        return v == Arg();
+    }
+
+    inline static void checkCoordinate(const QuCoo<Arg> &e)
+    {
+        if (e.row >= M || e.col >= N)
+        {
+            throw std::invalid_argument("Coordinate (" + std::to_string(e.row) + ", " + std::to_string(e.col) + ") is out of range.");
+        }
+    }
+};
+
+template <typename T>
+inline constexpr bool isSparse = false;
+
+template <size_t M, size_t N, typename L, typename Arg>
+inline constexpr bool isSparse<Qu_s<dim<M, N>, layout<L>, Arg>> = isSparseLayout<L>;
+
+template <typename... Args, size_t M, size_t N, typename L>
+    requires isSparseLayout<L>
+struct QuInputHelper<dim<M, N>, layout<L>, Args...>
+{
+    using type = Qu_s<dim<M, N>, layout<L>, Qu<Args...>>;
+};
+
+// ------------------- Basic Operations -------------------
+struct FullPrec;
+
+template <typename... Args>
+struct MergerArgsWrapper_s
+{
+    using type = TypeList<Args...>;
+};
+
+template <typename... Args>
+struct MergerArgsWrapper_s<TypeList<Args...>>
+{
+    using type = TypeList<Args...>;
+};
+
+template <typename... Args>
+struct MergerArgsWrapper_s<MergerArgsWrapper_s<Args...>> : MergerArgsWrapper_s<Args...>
+{};
+
+template <int intB, int fracB, bool isS, typename QuM, typename OfM>
+struct MergerArgsWrapper_s<Qu_s<intBits<intB>, fracBits<fracB>, isSigned<isS>, QuMode<QuM>, OfMode<OfM>>> : MergerArgsWrapper_s<intBits<intB>, fracBits<fracB>, isSigned<isS>, QuMode<QuM>, OfMode<OfM>>
+{};
+
+// 影子类型作为目标类型时只取其定点格式
+template <typename RefT, typename... QuArgs>
+struct MergerArgsWrapper_s<Qu_s<Shadow<RefT>, Qu_s<QuArgs...>>> : MergerArgsWrapper_s<Qu_s<QuArgs...>>
+{};
+
+template <typename... Args>
+using MergerArgsWrapper = typename MergerArgsWrapper_s<Args...>::type;
+
+template <typename... Args>
+struct MulMerger;
+
+template <typename... toArgs, int fromInt1, int fromFrac1, bool fromIsSigned1, typename fromQuMode1, typename fromOfMode1, int fromInt2, int fromFrac2, bool fromIsSigned2, typename fromQuMode2, typename fromOfMode2>
+struct MulMerger<Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>>, Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>>, TypeList<toArgs...>>
+{
+    static inline constexpr bool fullPrecision = (std::is_same_v<FullPrec, toArgs> || ...);
+    using fromQuMode = std::conditional_t<std::is_same_v<fromQuMode1, fromQuMode2>, fromQuMode1, defaultQuMode>;
+    using fromOfMode = std::conditional_t<std::is_same_v<fromOfMode1, fromOfMode2>, fromOfMode1, defaultOfMode>;
+
+    static inline constexpr auto toInt = tagExtractor<intBits<fullPrecision ? fromInt1 + fromInt2 : std::max(fromInt1, fromInt2)>, toArgs...>::value;
+    static inline constexpr auto toFrac = tagExtractor<fracBits<fullPrecision ? fromFrac1 + fromFrac2 : std::max(fromFrac1, fromFrac2)>, toArgs...>::value;
+    static inline constexpr auto toIsSigned = tagExtractor<isSigned<fromIsSigned1 || fromIsSigned2>, toArgs...>::value;
+    using toQuMode = tagExtractor<QuMode<fromQuMode>, toArgs...>::type;
+    using toOfMode = tagExtractor<OfMode<fromOfMode>, toArgs...>::type;
+
+    using resType = Qu_s<intBits<toInt>, fracBits<toFrac>, isSigned<toIsSigned>, QuMode<toQuMode>, OfMode<toOfMode>>;
+};
+
+template <typename... Args>
+struct AddMerger;
+template <typename... toArgs, int fromInt1, int fromFrac1, bool fromIsSigned1, typename fromQuMode1, typename fromOfMode1, int fromInt2, int fromFrac2, bool fromIsSigned2, typename fromQuMode2, typename fromOfMode2>
+struct AddMerger<Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>>, Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>>, TypeList<toArgs...>>
+{
+    static inline constexpr bool fullPrecision = (std::is_same_v<FullPrec, toArgs> || ...);
+
+    using fromQuMode = std::conditional_t<std::is_same_v<fromQuMode1, fromQuMode2>, fromQuMode1, defaultQuMode>;
+    using fromOfMode = std::conditional_t<std::is_same_v<fromOfMode1, fromOfMode2>, fromOfMode1, defaultOfMode>;
+
+    static inline constexpr auto toInt = tagExtractor<intBits<fullPrecision ? std::max(fromInt1, fromInt2) + 1 : std::max(fromInt1, fromInt2)>, toArgs...>::value;
+    static inline constexpr auto toFrac = tagExtractor<fracBits<std::max(fromFrac1, fromFrac2)>, toArgs...>::value;
+    static inline constexpr auto toIsSigned = tagExtractor<isSigned<fromIsSigned1 || fromIsSigned2>, toArgs...>::value;
+    using toQuMode = tagExtractor<QuMode<fromQuMode>, toArgs...>::type;
+    using toOfMode = tagExtractor<OfMode<fromOfMode>, toArgs...>::type;
+
+    using resType = Qu_s<intBits<toInt>, fracBits<toFrac>, isSigned<toIsSigned>, QuMode<toQuMode>, OfMode<toOfMode>>;
+};
+
+// ------------------- Native kernels -------------------
+// 当输入、中间结果与输出都能放进 int32_t、int64_t 或 __int128_t 时，移位、舍入与溢出处理在原生整数上一次完成
+// 与 fracConvert / intConvert 逐位一致，只是不再经过逐步加宽的 ArbiInt 临时量
+
+template <size_t bits>
+using nativeInt_t = std::conditional_t<(bits <= 32), int32_t, std::conditional_t<(bits <= 64), int64_t, __int128_t>>;
+
+// 把原生整数 val（含 d 位要舍去的小数）按 QuMode 舍入，d <= 0 时左移
+template <int d, typename QuM, typename T>
+inline constexpr T nativeRound(T val)
+{
+    if constexpr (d <= 0)
+    {
+        return val << -d;
+    }
+    else
+    {
+        constexpr int signShift = static_cast<int>(sizeof(T) * 8) - 1;
+        constexpr T lowMask = (T(1) << d) - 1;
+        constexpr T half = T(1) << (d - 1);
+
+        const T Xh = val >> d;
+        const T Xl = val & lowMask;
+
+        // 进位写成 (Xl + 偏置) >> d，避免比较与布尔运算，便于向量化
+        if constexpr (std::is_same_v<QuM, RND::POS_INF>)
+        {
+            return Xh + ((Xl + half) >> d);
+        }
+        else if constexpr (std::is_same_v<QuM, RND::NEG_INF>)
+        {
+            return Xh + ((Xl + half - 1) >> d);
+        }
+        else if constexpr (std::is_same_v<QuM, RND::ZERO>)
+        {
+            const T isNegative = (val >> signShift) & 1;
+            return Xh + ((Xl + half - 1 + isNegative) >> d);
+        }
+        else if constexpr (std::is_same_v<QuM, RND::INF>)
+        {
+            const T isPositive = ((-val) >> signShift) & 1;
+            return Xh + ((Xl + half - 1 + isPositive) >> d);
+        }
+        else if constexpr (std::is_same_v<QuM, RND::CONV>)
+        {
+            return Xh + ((Xl + half - 1 + (Xh & 1)) >> d);
+        }
+        else if constexpr (std::is_same_v<QuM, TRN::TCPL>)
+        {
+            return Xh;
+        }
+        else
+        {
+            // TRN::SMGN, 向零截断：负数先加上 2^d - 1 再右移
+            return (val + ((val >> signShift) & lowMask)) >> d;
+        }
+    }
+}
+
+// 按 OfMode 把 val 限制到 toInt + toFrac 位（以及符号位）
+template <int toInt, int toFrac, bool toIsSigned, typename OfM, typename T>
+inline constexpr T nativeOverflow(T val)
+{
+    constexpr int valueBits = toInt + toFrac;
+    constexpr T hi = (T(1) << valueBits) - 1;
+    constexpr T lo = toIsSigned ? -(T(1) << valueBits) : T(0);
+
+    if constexpr (std::is_same_v<OfM, SAT::TCPL>)
+    {
+        return val > hi ? hi : (val < lo ? lo : val);
+    }
+    else if constexpr (std::is_same_v<OfM, SAT::ZERO>)
+    {
+        return (val > hi) | (val < lo) ? T(0) : val;
+    }
+    else if constexpr (std::is_same_v<OfM, SAT::SMGN>)
+    {
+        constexpr T loSMGN = toIsSigned ? lo + 1 : T(0);
+        return val > hi ? hi : (val < loSMGN ? loSMGN : val);
+    }
+    else
+    {
+        // WRP::TCPL
+        if constexpr (toIsSigned)
+        {
+            constexpr int shift = static_cast<int>(sizeof(T) * 8) - (valueBits + 1);
+            using U = std::conditional_t<(sizeof(T) > 8), __uint128_t, std::make_unsigned_t<std::conditional_t<(sizeof(T) > 8), int64_t, T>>>;
+            return static_cast<T>(static_cast<U>(val) << shift) >> shift;
+        }
+        else
+        {
+            return val & hi;
+        }
+    }
+}
+
+// 判断一次运算是否可以走原生整数：inBits 为对齐后的中间结果位宽，d 为需要舍去的小数位数
+template <size_t inBits, int d, int toInt, int toFrac, typename OfM>
+struct nativeKernel
+{
+    inline static constexpr size_t outBits = 1 + toInt + toFrac;
+    inline static constexpr size_t workBits = inBits + (d < 0 ? -d : 0) + 1;
+    inline static constexpr bool supportedMode = std::is_same_v<OfM, SAT::TCPL> || std::is_same_v<OfM, SAT::ZERO> || std::is_same_v<OfM, SAT::SMGN> || std::is_same_v<OfM, WRP::TCPL>;
+
+    // 多留一位，使 2^(toInt + toFrac) 也能在 type 中表示
+    using type = nativeInt_t<std::max(workBits, outBits + 1)>;
+
+    inline static constexpr bool enabled = supportedMode && outBits <= 64 && workBits <= 127 && d < static_cast<int>(sizeof(type) * 8) - 1;
+};
+
+template <typename... Args>
+struct Qmul_s;
+
+// specialization for both inputs being static Qu_s
+template <typename... toArgs, int fromInt1, int fromFrac1, bool fromIsSigned1, typename fromQuMode1, typename fromOfMode1, int fromInt2, int fromFrac2, bool fromIsSigned2, typename fromQuMode2, typename fromOfMode2>
+struct Qmul_s<Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>>, Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>>, TypeList<toArgs...>>
+{
+
+    using merger = MulMerger<Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>>, Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>>, TypeList<toArgs...>>;
+
+    inline static constexpr size_t N1 = 1 + fromInt1 + fromFrac1;
+    inline static constexpr size_t N2 = 1 + fromInt2 + fromFrac2;
+
+    using native = nativeKernel<N1 + N2, fromFrac1 + fromFrac2 - merger::toFrac, merger::toInt, merger::toFrac, typename merger::toOfMode>;
+    inline static constexpr bool useNative = native::enabled && N1 <= 64 && N2 <= 64;
+
+    inline static constexpr auto mul(const Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>> f1, const Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>> f2)
+    {
+        if constexpr (useNative)
+        {
+            return mulNative(f1, f2);
+        }
+        else
+        {
+            return mulWide(f1, f2);
+        }
+    }
+
+    // 单步融合的原生整数实现
+    inline static constexpr auto mulNative(const Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>> f1, const Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>> f2)
+    {
+        using T = typename native::type;
+
+        const T fullProduct = T(f1.data.data) * T(f2.data.data);
+        const T fracProduct = nativeRound<fromFrac1 + fromFrac2 - merger::toFrac, typename merger::toQuMode>(fullProduct);
+        const T intProduct = nativeOverflow<merger::toInt, merger::toFrac, merger::toIsSigned, typename merger::toOfMode>(fracProduct);
+        probeConvert<fromFrac1 + fromFrac2 - merger::toFrac, merger::toInt, merger::toFrac, merger::toIsSigned, typename merger::toQuMode, typename merger::toOfMode>(fullProduct, fracProduct, intProduct);
+
+        Qu_s<intBits<merger::toInt>, fracBits<merger::toFrac>, isSigned<merger::toIsSigned>, QuMode<typename merger::toQuMode>, OfMode<typename merger::toOfMode>> result;
+        result.data.data = static_cast<typename decltype(result.data)::data_t>(intProduct);
+        return result;
+    }
+
+    // 逐步加宽的 ArbiInt 实现
+    inline static constexpr auto mulWide(const Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>> f1, const Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>> f2)
+    {
+        // print the debug info
+        // std::cout << "mul: " << merger::toInt << " " << merger::toFrac << " " << std::endl;
+
+        auto fullProduct = f1.data * f2.data;
+
+        auto fracProduct = fracConvert<fromFrac1 + fromFrac2, merger::toFrac, QuMode<typename merger::toQuMode>>::convert(fullProduct);
+
+        auto intProduct = intConvert<merger::toInt, merger::toFrac, merger::toIsSigned, OfMode<typename merger::toOfMode>>::convert(fracProduct);
+        probeConvert<fromFrac1 + fromFrac2 - merger::toFrac, merger::toInt, merger::toFrac, merger::toIsSigned, typename merger::toQuMode, typename merger::toOfMode>(fullProduct, fracProduct, intProduct);
+
+        Qu_s<intBits<merger::toInt>, fracBits<merger::toFrac>, isSigned<merger::toIsSigned>, QuMode<typename merger::toQuMode>, OfMode<typename merger::toOfMode>> result;
+        result.data = intProduct;
+
+        // debug info
+        // std::cout << f1.toDouble() << " * " << f2.toDouble() << " = " << result.toDouble() << std::endl;
+
+        return result;
+    }
+};
+
+template <typename... Args>
+struct Qadd_s;
+
+// specialization for both inputs being static Qu_s
+template <typename... toArgs, int fromInt1, int fromFrac1, bool fromIsSigned1, typename fromQuMode1, typename fromOfMode1, int fromInt2, int fromFrac2, bool fromIsSigned2, typename fromQuMode2, typename fromOfMode2>
+struct Qadd_s<Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>>, Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>>, TypeList<toArgs...>>
+{
+    using merger = AddMerger<Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>>, Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>>, TypeList<toArgs...>>;
+
+    static inline constexpr int shiftA = fromFrac2 > fromFrac1 ? fromFrac2 - fromFrac1 : 0;
+    static inline constexpr int shiftB = fromFrac1 > fromFrac2 ? fromFrac1 - fromFrac2 : 0;
+
+    inline static constexpr size_t N1 = 1 + fromInt1 + fromFrac1;
+    inline static constexpr size_t N2 = 1 + fromInt2 + fromFrac2;
+
+    using native = nativeKernel<std::max(N1 + shiftA, N2 + shiftB) + 1, std::max(fromFrac1, fromFrac2) - merger::toFrac, merger::toInt, merger::toFrac, typename merger::toOfMode>;
+    inline static constexpr bool useNative = native::enabled && N1 <= 64 && N2 <= 64;
+
+    inline static constexpr auto add(const Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>> f1, const Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>> f2)
+    {
+        if constexpr (useNative)
+        {
+            return addNative(f1, f2);
+        }
+        else
+        {
+            return addWide(f1, f2);
+        }
+    }
+
+    // 单步融合的原生整数实现
+    inline static constexpr auto addNative(const Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>> f1, const Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>> f2)
+    {
+        using T = typename native::type;
+
+        const T fullSum = (T(f1.data.data) << shiftA) + (T(f2.data.data) << shiftB);
+        const T fracSum = nativeRound<std::max(fromFrac1, fromFrac2) - merger::toFrac, typename merger::toQuMode>(fullSum);
+        const T intSum = nativeOverflow<merger::toInt, merger::toFrac, merger::toIsSigned, typename merger::toOfMode>(fracSum);
+        probeConvert<std::max(fromFrac1, fromFrac2) - merger::toFrac, merger::toInt, merger::toFrac, merger::toIsSigned, typename merger::toQuMode, typename merger::toOfMode>(fullSum, fracSum, intSum);
+
+        Qu_s<intBits<merger::toInt>, fracBits<merger::toFrac>, isSigned<merger::toIsSigned>, QuMode<typename merger::toQuMode>, OfMode<typename merger::toOfMode>> result;
+        result.data.data = static_cast<typename decltype(result.data)::data_t>(intSum);
+        return result;
+    }
+
+    // 逐步加宽的 ArbiInt 实现
+    inline static constexpr auto addWide(const Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>> f1, const Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>> f2)
+    {
+        // print the requesting Quantization parameters for debugging
+        // std::cout << "add: " << merger::toInt << " " << merger::toFrac << " " << std::endl;
+
+        auto fullSum = staticShiftLeft<shiftA>(f1.data) + staticShiftLeft<shiftB>(f2.data);
+
+        auto fracSum = fracConvert<std::max(fromFrac1, fromFrac2), merger::toFrac, QuMode<typename merger::toQuMode>>::convert(fullSum);
+
+        auto intSum = intConvert<merger::toInt, merger::toFrac, merger::toIsSigned, OfMode<typename merger::toOfMode>>::convert(fracSum);
+        probeConvert<std::max(fromFrac1, fromFrac2) - merger::toFrac, merger::toInt, merger::toFrac, merger::toIsSigned, typename merger::toQuMode, typename merger::toOfMode>(fullSum, fracSum, intSum);
+
+        Qu_s<intBits<merger::toInt>, fracBits<merger::toFrac>, isSigned<merger::toIsSigned>, QuMode<typename merger::toQuMode>, OfMode<typename merger::toOfMode>> result;
+        result.data = intSum;
+
+        // debug info
+        // std::cout << f1.toDouble() << " + " << f2.toDouble() << " = " << result.toDouble() << std::endl;
+
+        return result;
+    }
+};
+
+template <typename... Args>
+struct Qsub_s;
+
+// specialization for both inputs being static Qu_s
+template <typename... toArgs, int fromInt1, int fromFrac1, bool fromIsSigned1, typename fromQuMode1, typename fromOfMode1, int fromInt2, int fromFrac2, bool fromIsSigned2, typename fromQuMode2, typename fromOfMode2>
+    requires(!isA<typename TypeList<toArgs...>::head, Qu_s<>>)
+struct Qsub_s<Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>>, Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>>, TypeList<toArgs...>>
+{
+    using merger = AddMerger<Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>>, Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>>, TypeList<toArgs...>>;
+
+    static inline constexpr int shiftA = fromFrac2 > fromFrac1 ? fromFrac2 - fromFrac1 : 0;
+    static inline constexpr int shiftB = fromFrac1 > fromFrac2 ? fromFrac1 - fromFrac2 : 0;
+
+    inline static constexpr size_t N1 = 1 + fromInt1 + fromFrac1;
+    inline static constexpr size_t N2 = 1 + fromInt2 + fromFrac2;
+
+    using native = nativeKernel<std::max(N1 + shiftA, N2 + shiftB) + 1, std::max(fromFrac1, fromFrac2) - merger::toFrac, merger::toInt, merger::toFrac, typename merger::toOfMode>;
+    inline static constexpr bool useNative = native::enabled && N1 <= 64 && N2 <= 64;
+
+    inline static constexpr auto sub(const Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>> f1, const Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>> f2)
+    {
+        if constexpr (useNative)
+        {
+            return subNative(f1, f2);
+        }
+        else
+        {
+            return subWide(f1, f2);
+        }
+    }
+
+    // 单步融合的原生整数实现
+    inline static constexpr auto subNative(const Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>> f1, const Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>> f2)
+    {
+        using T = typename native::type;
+
+        const T fullDiff = (T(f1.data.data) << shiftA) - (T(f2.data.data) << shiftB);
+        const T fracDiff = nativeRound<std::max(fromFrac1, fromFrac2) - merger::toFrac, typename merger::toQuMode>(fullDiff);
+        const T intDiff = nativeOverflow<merger::toInt, merger::toFrac, merger::toIsSigned, typename merger::toOfMode>(fracDiff);
+        probeConvert<std::max(fromFrac1, fromFrac2) - merger::toFrac, merger::toInt, merger::toFrac, merger::toIsSigned, typename merger::toQuMode, typename merger::toOfMode>(fullDiff, fracDiff, intDiff);
+
+        Qu_s<intBits<merger::toInt>, fracBits<merger::toFrac>, isSigned<merger::toIsSigned>, QuMode<typename merger::toQuMode>, OfMode<typename merger::toOfMode>> result;
+        result.data.data = static_cast<typename decltype(result.data)::data_t>(intDiff);
+        return result;
+    }
+
+    // 逐步加宽的 ArbiInt 实现
+    inline static constexpr auto subWide(const Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>> f1, const Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>> f2)
+    {
+        // // print the requesting Quantization parameters for debugging
+        // std::cout << "sub: " << merger::toInt << " " << merger::toFrac << " " << std::endl;
+
+        auto fullDiff = staticShiftLeft<shiftA>(f1.data) - staticShiftLeft<shiftB>(f2.data);
+
+        auto fracDiff = fracConvert<std::max(fromFrac1, fromFrac2), merger::toFrac, QuMode<typename merger::toQuMode>>::convert(fullDiff);
+
+        auto intDiff = intConvert<merger::toInt, merger::toFrac, merger::toIsSigned, OfMode<typename merger::toOfMode>>::convert(fracDiff);
+        probeConvert<std::max(fromFrac1, fromFrac2) - merger::toFrac, merger::toInt, merger::toFrac, merger::toIsSigned, typename merger::toQuMode, typename merger::toOfMode>(fullDiff, fracDiff, intDiff);
+
+        Qu_s<intBits<merger::toInt>, fracBits<merger::toFrac>, isSigned<merger::toIsSigned>, QuMode<typename merger::toQuMode>, OfMode<typename merger::toOfMode>> result;
+        result.data = intDiff;
+
+        return result;
+    }
+};
+
+template <typename... Args>
+struct Qdiv_s;
+
+// specialization for both inputs being static Qu_s
+template <typename... toArgs, int fromInt1, int fromFrac1, bool fromIsSigned1, typename fromQuMode1, typename fromOfMode1, int fromInt2, int fromFrac2, bool fromIsSigned2, typename fromQuMode2, typename fromOfMode2>
+    requires(!isA<typename TypeList<toArgs...>::head, Qu_s<>>)
+struct Qdiv_s<Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>>, Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>>, TypeList<toArgs...>>
+{
+    using merger = AddMerger<Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>>, Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>>, TypeList<toArgs...>>;
+
+    static inline constexpr int shiftA = fromFrac2 > fromFrac1 ? fromFrac2 - fromFrac1 : 0;
+    static inline constexpr int shiftB = fromFrac1 > fromFrac2 ? fromFrac1 - fromFrac2 : 0;
+
+    inline static constexpr auto div(const Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>> f1, const Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>> f2)
+    {
+        if (f2.data.isZero())
+        {
+            return Qu_s<intBits<merger::toInt>, fracBits<merger::toFrac>, isSigned<merger::toIsSigned>, QuMode<typename merger::toQuMode>, OfMode<typename merger::toOfMode>>();
+        }
+
+        const auto dividend = staticShiftLeft<shiftA + merger::toFrac>(f1.data);
+        const auto divisor = staticShiftLeft<shiftB>(f2.data);
+        auto fullQuotient = dividend / divisor;
+
+        auto intQuotient = intConvert<merger::toInt, merger::toFrac, merger::toIsSigned, OfMode<typename merger::toOfMode>>::convert(fullQuotient);
+        if constexpr (useProbe)
+        {
+            // 商向零截断，余数非零时舍去了非零的位
+            const bool inexact = !(dividend - fullQuotient * divisor).isZero();
+            probeResult<merger::toInt, merger::toFrac, merger::toIsSigned, typename merger::toQuMode, typename merger::toOfMode>(inexact, fullQuotient, intQuotient);
+        }
+
+        Qu_s<intBits<merger::toInt>, fracBits<merger::toFrac>, isSigned<merger::toIsSigned>, QuMode<typename merger::toQuMode>, OfMode<typename merger::toOfMode>> result;
+        result.data = intQuotient;
+
+        return result;
+    }
+};
+
+// abs
+template <typename... Args>
+struct Qabs_s;
+
+// specialization for static Qu_s
+template <typename... toArgs, int fromInt, int fromFrac, bool fromIsSigned, typename fromQuMode, typename fromOfMode>
+struct Qabs_s<Qu_s<intBits<fromInt>, fracBits<fromFrac>, isSigned<fromIsSigned>, QuMode<fromQuMode>, OfMode<fromOfMode>>, TypeList<toArgs...>>
+{
+
+    inline static constexpr auto abs(const Qu_s<intBits<fromInt>, fracBits<fromFrac>, isSigned<fromIsSigned>, QuMode<fromQuMode>, OfMode<fromOfMode>> f)
+    {
+        if constexpr (!fromIsSigned)
+        {
+            return f;
+        }
+        else
+        {
+
+            Qu_s<intBits<fromInt + 1>, fracBits<fromFrac>, isSigned<fromIsSigned>, QuMode<fromQuMode>, OfMode<fromOfMode>> result;
+
+            if (f.data.isNegative())
+            {
+                result.data = -f.data;
+            }
+            else
+            {
+                result.data = f.data;
+            }
+
+            return result;
+        }
+    }
+};
+
+// neg
+template <typename... Args>
+struct Qneg_s;
+
+// specialization for static Qu_s
+template <typename... toArgs, int fromInt, int fromFrac, bool fromIsSigned, typename fromQuMode, typename fromOfMode>
+struct Qneg_s<Qu_s<intBits<fromInt>, fracBits<fromFrac>, isSigned<fromIsSigned>, QuMode<fromQuMode>, OfMode<fromOfMode>>, TypeList<toArgs...>>
+{
+    inline static constexpr auto neg(const Qu_s<intBits<fromInt>, fracBits<fromFrac>, isSigned<fromIsSigned>, QuMode<fromQuMode>, OfMode<fromOfMode>> f)
+    {
+        Qu_s<intBits<fromInt + 1>, fracBits<fromFrac>, isSigned<fromIsSigned>, QuMode<fromQuMode>, OfMode<fromOfMode>> result;
+        result.data = -f.data;
+
+        return result;
+    }
+};
+
+// specialization for complex
+template <typename... toArgs, typename... realArgs, typename... imagArgs>
+struct Qneg_s<Qu_s<Qu_s<realArgs...>, Qu_s<imagArgs...>>, TypeList<toArgs...>>
+{
+    inline static auto neg(const Qu_s<Qu_s<realArgs...>, Qu_s<imagArgs...>> f)
+    {
+        auto realNeg = Qneg<toArgs...>(f.real);
+        auto imagNeg = Qneg<toArgs...>(f.imag);
+        return Qcomplex<decltype(realNeg), decltype(imagNeg)>(realNeg, imagNeg);
+    }
+};
+
+template <typename... Args>
+struct Qcmp_s;
+
+// specialization for static Qu_s
+template <typename... toArgs, int fromInt1, int fromFrac1, bool fromIsSigned1, typename fromQuMode1, typename fromOfMode1, int fromInt2, int fromFrac2, bool fromIsSigned2, typename fromQuMode2, typename fromOfMode2>
+struct Qcmp_s<Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>>, Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>>, TypeList<toArgs...>>
+{
+    static inline constexpr int shiftA = fromFrac2 > fromFrac1 ? fromFrac2 - fromFrac1 : 0;
+    static inline constexpr int shiftB = fromFrac1 > fromFrac2 ? fromFrac1 - fromFrac2 : 0;
+
+    inline static constexpr auto cmp(const Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>> f1, const Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>> f2)
+    {
+        return staticShiftLeft<shiftA>(f1.data) <=> staticShiftLeft<shiftB>(f2.data);
+    }
+};
+
+template <typename... Args>
+struct Qeq_s;
+template <typename... toArgs, int fromInt1, int fromFrac1, bool fromIsSigned1, typename fromQuMode1, typename fromOfMode1, int fromInt2, int fromFrac2, bool fromIsSigned2, typename fromQuMode2, typename fromOfMode2>
+struct Qeq_s<Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>>, Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>>, TypeList<toArgs...>>
+{
+    static inline constexpr int shiftA = fromFrac2 > fromFrac1 ? fromFrac2 - fromFrac1 : 0;
+    static inline constexpr int shiftB = fromFrac1 > fromFrac2 ? fromFrac1 - fromFrac2 : 0;
+
+    inline static constexpr auto eq(const Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>> f1, const Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>> f2)
+    {
+        return staticShiftLeft<shiftA>(f1.data) == staticShiftLeft<shiftB>(f2.data);
+    }
+};
+
+
+// specialization for complex
+template <typename... toArgs, typename... realArgs, typename... imagArgs>
+struct Qeq_s<Qu_s<Qu_s<realArgs...>, Qu_s<imagArgs...>>, Qu_s<Qu_s<realArgs...>, Qu_s<imagArgs...>>, TypeList<toArgs...>>
+{
+    inline static auto eq(const Qu_s<Qu_s<realArgs...>, Qu_s<imagArgs...>> f1, const Qu_s<Qu_s<realArgs...>, Qu_s<imagArgs...>> f2)
+    {
+        return Qeq<toArgs...>(f1.real, f2.real) && Qeq<toArgs...>(f1.imag, f2.imag);
+    }
+};
+
+
+
+// ------------------- Complex Operations -------------------
+// Basic complex multiplication, realized as (a+bi)(c+di) = (ac-bd) + (ad+bc)i
+template <typename... Args>
+struct BasicComplexMul;
+
+template <typename... Args>
+struct MergerArgsWrapper_s<BasicComplexMul<Args...>>
+{
+    using type = BasicComplexMul<Args...>;
+};
+
+template <typename... Args>
+struct acT
+{
+    using list = MergerArgsWrapper<Args...>;
+};
+
+template <typename... Args>
+struct bdT
+{
+    using list = MergerArgsWrapper<Args...>;
+};
+
+template <typename... Args>
+struct adT
+{
+    using list = MergerArgsWrapper<Args...>;
+};
+
+template <typename... Args>
+struct bcT
+{
+    using list = MergerArgsWrapper<Args...>;
+};
+
+template <typename... Args>
+struct acbdT
+{
+    using list = MergerArgsWrapper<Args...>;
+};
+
+template <typename... Args>
+struct adbcT
+{
+    using list = MergerArgsWrapper<Args...>;
+};
+
+// used for Qmul(c1, c2) without any additional arguments
+template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... imagArgs2>
+struct Qmul_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<>> : Qmul_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, BasicComplexMul<>>
+{};
+
+template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... imagArgs2, typename... toArgs>
+struct Qmul_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, BasicComplexMul<toArgs...>>
+{
+    using mulACType = tagExtractor<acT<toArgs...>, toArgs...>::type::list;
+    using mulBDType = tagExtractor<bdT<toArgs...>, toArgs...>::type::list;
+    using mulADType = tagExtractor<adT<toArgs...>, toArgs...>::type::list;
+    using mulBCType = tagExtractor<bcT<toArgs...>, toArgs...>::type::list;
+
+    using subACBDType = tagExtractor<acbdT<toArgs...>, toArgs...>::type::list;
+    using addADBCType = tagExtractor<adbcT<toArgs...>, toArgs...>::type::list;
+
+    inline static constexpr auto mul(const Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>> f1, const Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>> f2)
+    {
+        auto realPart = Qsub<subACBDType>(Qmul<mulACType>(f1.real, f2.real), Qmul<mulBDType>(f1.imag, f2.imag));
+        auto imagPart = Qadd<addADBCType>(Qmul<mulADType>(f1.real, f2.imag), Qmul<mulBCType>(f1.imag, f2.real));
+
+        // get the type of the real part and the imaginary part
+        Qcomplex<decltype(realPart), decltype(imagPart)> res(realPart, imagPart);
+        return res;
+    }
+};
+
+// Complex multiplication via 3 multiplications and 5 additions
+// x = a + bi, y = c + di
+// A = (a + b)c, B = (c + d)b, C = (b − a)d
+// xy = (A − B) + (B − C)i
+
+template <typename... Args>
+struct TFComplexMul;
+
+template <typename... Args>
+struct MergerArgsWrapper_s<TFComplexMul<Args...>>
+{
+    using type = TFComplexMul<Args...>;
+};
+
+template <typename... Args>
+struct abT
+{
+    using list = MergerArgsWrapper<Args...>;
+};
+
+template <typename... Args>
+struct cdT
+{
+    using list = MergerArgsWrapper<Args...>;
+};
+
+template <typename... Args>
+struct baT
+{
+    using list = MergerArgsWrapper<Args...>;
+};
+
+template <typename... Args>
+struct abcT
+{
+    using list = MergerArgsWrapper<Args...>;
+};
+
+template <typename... Args>
+struct cdbT
+{
+    using list = MergerArgsWrapper<Args...>;
+};
+
+template <typename... Args>
+struct badT
+{
+    using list = MergerArgsWrapper<Args...>;
+};
+
+template <typename... Args>
+struct ABT
+{
+    using list = MergerArgsWrapper<Args...>;
+};
+
+template <typename... Args>
+struct BCT
+{
+    using list = MergerArgsWrapper<Args...>;
+};
+
+template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... imagArgs2, typename... toArgs>
+struct Qmul_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TFComplexMul<toArgs...>>
+{
+    using addabType = tagExtractor<abT<toArgs...>, toArgs...>::type::list;
+    using addcdType = tagExtractor<cdT<toArgs...>, toArgs...>::type::list;
+    using subbaType = tagExtractor<baT<toArgs...>, toArgs...>::type;
+    using mulabcType = tagExtractor<abcT<toArgs...>, toArgs...>::type::list;
+    using mulcdbType = tagExtractor<cdbT<toArgs...>, toArgs...>::type::list;
+    using mulbadType = tagExtractor<badT<toArgs...>, toArgs...>::type::list;
+    using subABType = tagExtractor<ABT<toArgs...>, toArgs...>::type::list;
+    using subBCType = tagExtractor<BCT<toArgs...>, toArgs...>::type::list;
+
+    inline static constexpr auto mul(const Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>> f1, const Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>> f2)
+    {
+        auto A = Qmul<mulabcType>(Qadd<addabType>(f1.real, f1.imag), f2.real);
+        auto B = Qmul<mulbadType>(Qadd<addcdType>(f2.real, f2.imag), f1.imag);
+        auto C = Qmul<mulcdbType>(Qsub<subbaType>(f1.imag, f1.real), f2.imag);
+
+        auto realPart = Qsub<subABType>(A, B);
+        auto imagPart = Qsub<subBCType>(B, C);
+
+        // get the type of the real part and the imaginary part
+        Qcomplex<decltype(realPart), decltype(imagPart)> res(realPart, imagPart);
+        return res;
+    }
+};
+
+template <typename... Args>
+struct realT
+{
+    using list = MergerArgsWrapper<Args...>;
+};
+
+template <typename... Args>
+struct imagT
+{
+    using list = MergerArgsWrapper<Args...>;
+};
+
+template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... imagArgs2, typename... toArgs>
+struct Qadd_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<toArgs...>>
+{
+    using realType = tagExtractor<realT<toArgs...>, toArgs...>::type::list;
+    using imagType = tagExtractor<imagT<toArgs...>, toArgs...>::type::list;
+
+    inline static constexpr auto add(const Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>> f1, const Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>> f2)
+    {
+        auto realPart = Qadd<realType>(f1.real, f2.real);
+        auto imagPart = Qadd<imagType>(f1.imag, f2.imag);
+
+        // get the type of the real part and the imaginary part
+        Qcomplex<decltype(realPart), decltype(imagPart)> res(realPart, imagPart);
+        return res;
+    }
+};
+
+template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... imagArgs2, typename... QuArgs1, typename... QuArgs2>
+struct Qadd_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<Qu_s<QuArgs1...>, Qu_s<QuArgs2...>>> : Qadd_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<realT<QuArgs1...>, imagT<QuArgs2...>>>
+{};
+
+template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... imagArgs2, typename... toArgs>
+struct Qsub_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<toArgs...>>
+{
+    using realType = tagExtractor<realT<toArgs...>, toArgs...>::type::list;
+    using imagType = tagExtractor<imagT<toArgs...>, toArgs...>::type::list;
+
+    inline static constexpr auto sub(const Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>> f1, const Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>> f2)
+    {
+        auto realPart = Qsub<realType>(f1.real, f2.real);
+        auto imagPart = Qsub<imagType>(f1.imag, f2.imag);
+
+        // get the type of the real part and the imaginary part
+        Qcomplex<decltype(realPart), decltype(imagPart)> res(realPart, imagPart);
+        return res;
+    }
+};
+
+template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... imagArgs2, typename... QuArgs1, typename... QuArgs2>
+struct Qsub_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<Qu_s<QuArgs1...>, Qu_s<QuArgs2...>>> : Qsub_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<realT<QuArgs1...>, imagT<QuArgs2...>>>
+{};
+
+// 以一个复数类型作为目标，例如 Qreduce 的每层类型为 Qcomplex<r_t, i_t>
+template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... imagArgs2, typename... QuArgs1, typename... QuArgs2>
+struct Qadd_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<Qu_s<Qu_s<QuArgs1...>, Qu_s<QuArgs2...>>>> : Qadd_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<realT<QuArgs1...>, imagT<QuArgs2...>>>
+{};
+
+template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... imagArgs2, typename... QuArgs1, typename... QuArgs2>
+struct Qsub_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<Qu_s<Qu_s<QuArgs1...>, Qu_s<QuArgs2...>>>> : Qsub_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<realT<QuArgs1...>, imagT<QuArgs2...>>>
+{};
+
+template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... imagArgs2, typename... toArgs>
+struct Qdiv_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, toArgs...>
+{
+    inline static constexpr auto div(const Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>> f1, const Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>> f2)
+    {
+        throw std::runtime_error("Complex division is not supported yet.");
+    }
+};
+
+// ------------------- Real-Complex Operations -------------------
+
+// Real-Complex multiplication
+template <typename... realArgs1, typename... realArgs2, typename... imagArgs2, typename... toArgs>
+struct Qmul_s<Qu_s<realArgs1...>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<toArgs...>>
+{
+    using realMulType = tagExtractor<realT<toArgs...>, toArgs...>::type;
+    using imagMulType = tagExtractor<imagT<toArgs...>, toArgs...>::type;
+
+    inline static constexpr auto mul(const Qu_s<realArgs1...> f1, const Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>> f2)
+    {
+
+        auto realPart = Qmul<typename realMulType::list>(f1, f2.real);
+        auto imagPart = Qmul<typename imagMulType::list>(f1, f2.imag);
+
+        // get the type of the real part and the imaginary part
+        Qcomplex<decltype(realPart), decltype(imagPart)> res(realPart, imagPart);
+        return res;
+    }
+};
+
+template <typename... realArgs1, typename... realArgs2, typename... imagArgs2, typename... QuArgs1, typename... QuArgs2>
+struct Qmul_s<Qu_s<realArgs1...>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<Qu_s<QuArgs1...>, Qu_s<QuArgs2...>>> : Qmul_s<Qu_s<realArgs1...>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<realT<QuArgs1...>, imagT<QuArgs2...>>>
+{};
+
+template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... toArgs>
+struct Qmul_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<realArgs2...>, TypeList<toArgs...>>
+{
+    using realMulType = tagExtractor<realT<toArgs...>, toArgs...>::type;
+    using imagMulType = tagExtractor<imagT<toArgs...>, toArgs...>::type;
+
+    inline static constexpr auto mul(const Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>> f1, const Qu_s<realArgs2...> f2)
+    {
+        auto realPart = Qmul<typename realMulType::list>(f1.real, f2);
+        auto imagPart = Qmul<typename imagMulType::list>(f1.imag, f2);
+
+        // get the type of the real part and the imaginary part
+        Qcomplex<decltype(realPart), decltype(imagPart)> res(realPart, imagPart);
+        return res;
+    }
+};
+
+template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... QuArgs1, typename... QuArgs2>
+struct Qmul_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<realArgs2...>, TypeList<Qu_s<QuArgs1...>, Qu_s<QuArgs2...>>> : Qmul_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<realArgs2...>, TypeList<realT<QuArgs1...>, imagT<QuArgs2...>>>
+{};
+
+// Real-Complex addition
+template <typename... realArgs1, typename... realArgs2, typename... imagArgs2, typename... toArgs>
+struct Qadd_s<Qu_s<realArgs1...>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<toArgs...>>
+{
+
+    inline static constexpr auto add(const Qu_s<realArgs1...> f1, const Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>> f2)
+    {
+        auto realPart = Qadd<toArgs...>(f1, f2.real);
+        auto imagPart = f2.imag;
+
+        // get the type of the real part and the imaginary part
+        Qcomplex<decltype(realPart), decltype(imagPart)> res(realPart, imagPart);
+
+        return res;
+    }
+};
+
+template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... toArgs>
+struct Qadd_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<realArgs2...>, TypeList<toArgs...>>
+{
+    inline static constexpr auto add(const Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>> f1, const Qu_s<realArgs2...> f2)
+    {
+        auto realPart = Qadd<toArgs...>(f1.real, f2);
+        auto imagPart = f1.imag;
+
+        // get the type of the real part and the imaginary part
+        Qcomplex<decltype(realPart), decltype(imagPart)> res(realPart, imagPart);
+
+        return res;
+    }
+};
+
+// Real-Complex subtraction
+template <typename... realArgs1, typename... realArgs2, typename... imagArgs2, typename... toArgs>
+struct Qsub_s<Qu_s<realArgs1...>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<toArgs...>>
+{
+    inline static constexpr auto sub(const Qu_s<realArgs1...> f1, const Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>> f2)
+    {
+        auto realPart = Qsub<toArgs...>(f1, f2.real);
+        auto imagPart = Qsub<toArgs...>(Qu_s<realArgs1...>(), f2.imag);
+
+        // get the type of the real part and the imaginary part
+        Qcomplex<decltype(realPart), decltype(imagPart)> res(realPart, imagPart);
+
+        return res;
+    }
+};
+
+template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... toArgs>
+struct Qsub_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<realArgs2...>, TypeList<toArgs...>>
+{
+    inline static constexpr auto sub(const Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>> f1, const Qu_s<realArgs2...> f2)
+    {
+        auto realPart = Qsub<toArgs...>(f1.real, f2);
+        auto imagPart = f1.imag;
+
+        // get the type of the real part and the imaginary part
+        Qcomplex<decltype(realPart), decltype(imagPart)> res(realPart, imagPart);
+
+        return res;
+    }
+};
+
+// Real-Complex division
+template <typename... realArgs1, typename... realArgs2, typename... imagArgs2, typename... toArgs>
+struct Qdiv_s<Qu_s<realArgs1...>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<toArgs...>>
+{
+    inline static constexpr auto div(const Qu_s<realArgs1...> f1, const Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>> f2)
+    {
+        throw std::runtime_error("Real-Complex division is not supported yet.");
+    }
+};
+
+template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... toArgs>
+struct Qdiv_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<realArgs2...>, TypeList<toArgs...>>
+{
+    using realDivType = tagExtractor<realT<toArgs...>, toArgs...>::type;
+    using imagDivType = tagExtractor<imagT<toArgs...>, toArgs...>::type;
+
+    inline static constexpr auto div(const Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>> f1, const Qu_s<realArgs2...> f2)
+    {
+        auto realPart = Qdiv<typename realDivType::list>(f1.real, f2);
+        auto imagPart = Qdiv<typename imagDivType::list>(f1.imag, f2);
+
+        // get the type of the real part and the imaginary part
+        Qcomplex<decltype(realPart), decltype(imagPart)> res(realPart, imagPart);
+
+        return res;
+    }
+};
+
+template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... QuArgs1, typename... QuArgs2>
+struct Qdiv_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<realArgs2...>, TypeList<Qu_s<QuArgs1...>, Qu_s<QuArgs2...>>> : Qdiv_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<realArgs2...>, TypeList<realT<QuArgs1...>, imagT<QuArgs2...>>>
+{};
+
+// ------------------- Shadow operations -------------------
+// 定点部分按原来的 Qmul_s 等计算，参考值在 RefT 上计算，普通定点操作数的参考值为其数值；每个结果记入 QuShadow
+// compute 只计算不记录，供张量表达式整批计算时使用
+
+template <typename T1, typename T2>
+using shadowRef_t = typename std::conditional_t<isShadow<T1>, T1, T2>::ref_t;
+
+template <typename... toArgs, typename T1, typename T2>
+    requires(isShadow<T1> || isShadow<T2>)
+struct Qmul_s<T1, T2, TypeList<toArgs...>>
+{
+    using ref_t = shadowRef_t<T1, T2>;
+
+    inline static auto compute(const T1 &f1, const T2 &f2)
+    {
+        auto val = Qmul<toArgs...>(shadowValue(f1), shadowValue(f2));
+        return Qu_s<Shadow<ref_t>, decltype(val)>(val, shadowRef<ref_t>(f1) * shadowRef<ref_t>(f2));
+    }
+
+    inline static auto mul(const T1 &f1, const T2 &f2)
+    {
+        auto res = compute(f1, f2);
+        res.record();
+        return res;
+    }
+};
+
+template <typename... toArgs, typename T1, typename T2>
+    requires(isShadow<T1> || isShadow<T2>)
+struct Qadd_s<T1, T2, TypeList<toArgs...>>
+{
+    using ref_t = shadowRef_t<T1, T2>;
+
+    inline static auto compute(const T1 &f1, const T2 &f2)
+    {
+        auto val = Qadd<toArgs...>(shadowValue(f1), shadowValue(f2));
+        return Qu_s<Shadow<ref_t>, decltype(val)>(val, shadowRef<ref_t>(f1) + shadowRef<ref_t>(f2));
+    }
+
+    inline static auto add(const T1 &f1, const T2 &f2)
+    {
+        auto res = compute(f1, f2);
+        res.record();
+        return res;
+    }
+};
+
+template <typename... toArgs, typename T1, typename T2>
+    requires(isShadow<T1> || isShadow<T2>)
+struct Qsub_s<T1, T2, TypeList<toArgs...>>
+{
+    using ref_t = shadowRef_t<T1, T2>;
+
+    inline static auto compute(const T1 &f1, const T2 &f2)
+    {
+        auto val = Qsub<toArgs...>(shadowValue(f1), shadowValue(f2));
+        return Qu_s<Shadow<ref_t>, decltype(val)>(val, shadowRef<ref_t>(f1) - shadowRef<ref_t>(f2));
+    }
+
+    inline static auto sub(const T1 &f1, const T2 &f2)
+    {
+        auto res = compute(f1, f2);
+        res.record();
+        return res;
+    }
+};
+
+template <typename... toArgs, typename T1, typename T2>
+    requires(isShadow<T1> || isShadow<T2>)
+struct Qdiv_s<T1, T2, TypeList<toArgs...>>
+{
+    using ref_t = shadowRef_t<T1, T2>;
+
+    inline static auto compute(const T1 &f1, const T2 &f2)
+    {
+        auto val = Qdiv<toArgs...>(shadowValue(f1), shadowValue(f2));
+        return Qu_s<Shadow<ref_t>, decltype(val)>(val, shadowRef<ref_t>(f1) / shadowRef<ref_t>(f2));
+    }
+
+    inline static auto div(const T1 &f1, const T2 &f2)
+    {
+        auto res = compute(f1, f2);
+        res.record();
+        return res;
+    }
+};
+
+// ------------------- Basic tensor operations -------------------
+
+template <typename... Args>
+struct sizeMerger;
+
+template <typename QuT1, typename QuT2>
+    requires(!isScalar<QuT1>) && (!isScalar<QuT2>)
+struct sizeMerger<QuT1, QuT2>
+{
+    static_assert(std::is_same_v<typename QuT1::size, typename QuT2::size>, "The sizes of the tensors do not match.");
+    using size = typename QuT1::size;
+};
+
+template <typename QuT1, typename QuT2>
+    requires(!isScalar<QuT1>) && isScalar<QuT2>
+struct sizeMerger<QuT1, QuT2>
+{
+    using size = typename QuT1::size;
+};
+
+template <typename QuT1, typename QuT2>
+    requires isScalar<QuT1> && (!isScalar<QuT2>)
+struct sizeMerger<QuT1, QuT2>
+{
+    using size = typename QuT2::size;
+};
+
+// use [] to call the object if it is a tensor, otherwise just return the object
+template <typename T>
+inline auto autoCall(const T &obj, auto... index)
+{
+    if constexpr (isScalar<T>)
+    {
+        return obj;
+    }
+    else
+    {
+        return obj[index...];
+    }
+}
+
+template <typename... Args>
+class MulExpression;
+
+template <typename QuT1, typename QuT2, typename... toArgs>
+class MulExpression<QuT1, QuT2, toArgs...>
+{
+    const QuT1 &q1;
+    const QuT2 &q2;
+
+public:
+    using size = typename sizeMerger<QuT1, QuT2>::size;
+
+    MulExpression(const QuT1 &f1, const QuT2 &f2)
+        : q1(f1), q2(f2) {}
+
+    auto operator[](auto... index) const
+    {
+        return Qmul<toArgs...>(autoCall(q1, index...), autoCall(q2, index...));
+    }
+
+    // 影子元素的运算结果，不逐个记入 QuShadow，见 QuShadow::assign
+    auto unrecorded(auto... index) const
+    {
+        using T1 = std::remove_cvref_t<decltype(autoCall(q1, index...))>;
+        using T2 = std::remove_cvref_t<decltype(autoCall(q2, index...))>;
+        return Qmul_s<T1, T2, MergerArgsWrapper<toArgs...>>::compute(autoCall(q1, index...), autoCall(q2, index...));
+    }
+};
+
+template <typename... Args>
+struct QmulTensor_s;
+
+template <typename QuT1, typename QuT2, typename... toArgs>
+struct QmulTensor_s<QuT1, QuT2, toArgs...>
+{
+    inline static constexpr auto mul(const QuT1 &f1, const QuT2 &f2)
+    {
+        return MulExpression<QuT1, QuT2, toArgs...>(f1, f2);
+    }
+};
+
+template <typename... Args>
+class AddExpression;
+
+template <typename QuT1, typename QuT2, typename... toArgs>
+class AddExpression<QuT1, QuT2, toArgs...>
+{
+    const QuT1 &q1;
+    const QuT2 &q2;
+
+public:
+    using size = typename sizeMerger<QuT1, QuT2>::size;
+
+    AddExpression(const QuT1 &f1, const QuT2 &f2)
+        : q1(f1), q2(f2) {}
+
+    auto operator[](auto... index) const
+    {
+        return Qadd<toArgs...>(autoCall(q1, index...), autoCall(q2, index...));
+    }
+
+    // 影子元素的运算结果，不逐个记入 QuShadow，见 QuShadow::assign
+    auto unrecorded(auto... index) const
+    {
+        using T1 = std::remove_cvref_t<decltype(autoCall(q1, index...))>;
+        using T2 = std::remove_cvref_t<decltype(autoCall(q2, index...))>;
+        return Qadd_s<T1, T2, MergerArgsWrapper<toArgs...>>::compute(autoCall(q1, index...), autoCall(q2, index...));
+    }
+};
+
+template <typename... Args>
+struct QaddTensor_s;
+
+template <typename QuT1, typename QuT2, typename... toArgs>
+struct QaddTensor_s<QuT1, QuT2, toArgs...>
+{
+    inline static constexpr auto add(const QuT1 &f1, const QuT2 &f2)
+    {
+        return AddExpression<QuT1, QuT2, toArgs...>(f1, f2);
+    }
+};
+
+template <typename... Args>
+class SubExpression;
+
+template <typename QuT1, typename QuT2, typename... toArgs>
+class SubExpression<QuT1, QuT2, toArgs...>
+{
+    const QuT1 &q1;
+    const QuT2 &q2;
+
+public:
+    using size = typename sizeMerger<QuT1, QuT2>::size;
+
+    SubExpression(const QuT1 &f1, const QuT2 &f2)
+        : q1(f1), q2(f2) {}
+
+    auto operator[](auto... index) const
+    {
+        return Qsub<toArgs...>(autoCall(q1, index...), autoCall(q2, index...));
+    }
+
+    // 影子元素的运算结果，不逐个记入 QuShadow，见 QuShadow::assign
+    auto unrecorded(auto... index) const
+    {
+        using T1 = std::remove_cvref_t<decltype(autoCall(q1, index...))>;
+        using T2 = std::remove_cvref_t<decltype(autoCall(q2, index...))>;
+        return Qsub_s<T1, T2, MergerArgsWrapper<toArgs...>>::compute(autoCall(q1, index...), autoCall(q2, index...));
+    }
+};
+
+template <typename... Args>
+struct QsubTensor_s;
+
+template <typename QuT1, typename QuT2, typename... toArgs>
+struct QsubTensor_s<QuT1, QuT2, toArgs...>
+{
+    inline static constexpr auto sub(const QuT1 &f1, const QuT2 &f2)
+    {
+        return SubExpression<QuT1, QuT2, toArgs...>(f1, f2);
+    }
+};
+
+template <typename... Args>
+class DivExpression;
+
+template <typename QuT1, typename QuT2, typename... toArgs>
+class DivExpression<QuT1, QuT2, toArgs...>
+{
+    const QuT1 &q1;
+    const QuT2 &q2;
+
+public:
+    using size = typename sizeMerger<QuT1, QuT2>::size;
+
+    DivExpression(const QuT1 &f1, const QuT2 &f2)
+        : q1(f1), q2(f2) {}
+
+    auto operator[](auto... index) const
+    {
+        return Qdiv<toArgs...>(autoCall(q1, index...), autoCall(q2, index...));
+    }
+
+    // 影子元素的运算结果，不逐个记入 QuShadow，见 QuShadow::assign
+    auto unrecorded(auto... index) const
+    {
+        using T1 = std::remove_cvref_t<decltype(autoCall(q1, index...))>;
+        using T2 = std::remove_cvref_t<decltype(autoCall(q2, index...))>;
+        return Qdiv_s<T1, T2, MergerArgsWrapper<toArgs...>>::compute(autoCall(q1, index...), autoCall(q2, index...));
+    }
+};
+
+template <typename... Args>
+struct QdivTensor_s;
+
+template <typename QuT1, typename QuT2, typename... toArgs>
+struct QdivTensor_s<QuT1, QuT2, toArgs...>
+{
+    inline static constexpr auto div(const QuT1 &f1, const QuT2 &f2)
+    {
+        return DivExpression<QuT1, QuT2, toArgs...>(f1, f2);
+    }
+};
+
+template <typename... Args>
+class AbsExpression;
+
+template <typename QuT, typename... toArgs>
+class AbsExpression<QuT, toArgs...>
+{
+    const QuT &q;
+
+public:
+    using size = typename QuT::size;
+
+    AbsExpression(const QuT &f)
+        : q(f) {}
+
+    auto operator[](auto... index) const
+    {
+        return Qabs<toArgs...>(q[index...]);
+    }
+};
+
+template <typename... Args>
+struct QabsTensor_s;
+
+template <typename QuT, typename... toArgs>
+struct QabsTensor_s<QuT, toArgs...>
+{
+    inline static constexpr auto abs(const QuT &f)
+    {
+        return AbsExpression<QuT, toArgs...>(f);
+    }
+};
+
+template <typename... Args>
+class NegExpression;
+
+template <typename QuT, typename... toArgs>
+class NegExpression<QuT, toArgs...>
+{
+    const QuT &q;
+
+public:
+    using size = typename QuT::size;
+
+    NegExpression(const QuT &f)
+        : q(f) {}
+
+    auto operator[](auto... index) const
+    {
+        return Qneg<toArgs...>(q[index...]);
+    }
+};
+
+template <typename... Args>
+struct QnegTensor_s;
+
+template <typename QuT, typename... toArgs>
+struct QnegTensor_s<QuT, toArgs...>
+{
+    inline static constexpr auto neg(const QuT &f)
+    {
+        return NegExpression<QuT, toArgs...>(f);
+    }
+};
+
+// ------------------- Execution -------------------
+// 表达式模板的求值策略：QuExec<Serial> 或 QuExec<Parallel<threads>>，threads 为 0 时使用全部硬件线程
+
+struct Serial
+{
+};
+
+template <size_t threads = 0>
+struct Parallel
+{
+    static constexpr size_t value = threads;
+};
+
+template <typename Policy = Serial>
+struct QuExec
+{
+    using policy = Policy;
+};
+
+template <typename T>
+inline constexpr bool isParallel = false;
+
+template <size_t threads>
+inline constexpr bool isParallel<Parallel<threads>> = true;
+
+// 固定数量的工作线程，任务按块动态领取，调用线程同样参与计算
+// 每个元素的计算互相独立，因此结果与串行执行逐位一致
+class QuThreadPool
+{
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::mutex submitMutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    // 当前任务
+    void (*task)(void *, size_t, size_t) = nullptr;
+    void *context = nullptr;
+    size_t total = 0;
+    size_t grain = 1;
+    size_t helpers = 0;
+    std::atomic<size_t> next = 0;
+    std::exception_ptr error;
+
+    size_t generation = 0;
+    size_t pending = 0;
+    bool stopping = false;
+
+    inline static thread_local bool inWorker = false;
+
+    void runChunks()
+    {
+        try
+        {
+            for (size_t begin = next.fetch_add(grain); begin < total; begin = next.fetch_add(grain))
+            {
+                task(context, begin, std::min(begin + grain, total));
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard lock(mutex);
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+            next = total;
+        }
+    }
+
+    void workerLoop(size_t id)
+    {
+        inWorker = true;
+        size_t seen = 0;
+        while (true)
+        {
+            {
+                std::unique_lock lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping)
+                {
+                    return;
+                }
+                seen = generation;
+            }
+
+            if (id < helpers)
+            {
+                runChunks();
+            }
+
+            std::lock_guard lock(mutex);
+            if (--pending == 0)
+            {
+                done.notify_one();
+            }
+        }
+    }
+
+public:
+    explicit QuThreadPool(size_t numWorkers)
+    {
+        for (size_t i = 0; i < numWorkers; i++)
+        {
+            workers.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    QuThreadPool(const QuThreadPool &) = delete;
+    QuThreadPool &operator=(const QuThreadPool &) = delete;
+
+    ~QuThreadPool()
+    {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    static QuThreadPool &instance()
+    {
+        static QuThreadPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+        return pool;
+    }
+
+    inline size_t size() const
+    {
+        return workers.size() + 1;
+    }
+
+    // 将 [0, n) 划分为若干块并行执行 func(begin, end)，threads 为参与的线程总数（含调用线程）
+    template <typename Func>
+    void parallelFor(size_t n, size_t threads, Func &&func)
+    {
+        threads = std::min(threads == 0 ? size() : threads, size());
+
+        // 嵌套调用或者已有任务在执行时直接串行执行，避免死锁
+        std::unique_lock submit(submitMutex, std::defer_lock);
+        if (threads <= 1 || n < 2 || inWorker || !submit.try_lock())
+        {
+            func(size_t(0), n);
+            return;
+        }
+
+        {
+            std::lock_guard lock(mutex);
+            task = [](void *ctx, size_t begin, size_t end) { (*static_cast<std::remove_reference_t<Func> *>(ctx))(begin, end); };
+            context = &func;
+            total = n;
+            grain = std::max<size_t>(1, n / (threads * 8));
+            helpers = threads - 1;
+            next = 0;
+            error = nullptr;
+            pending = workers.size();
+            generation++;
+        }
+        wake.notify_all();
+
+        runChunks();
+
+        std::unique_lock lock(mutex);
+        done.wait(lock, [&] { return pending == 0; });
+        if (error)
+        {
+            std::rethrow_exception(std::exchange(error, nullptr));
+        }
+    }
+};
+
+// 将张量或表达式 src 按线性下标逐元素写入 dst
+template <typename Exec = QuExec<Serial>, typename DstT, typename SrcT>
+    requires isSquareBracketIndexable<SrcT>
+inline DstT &Qassign(DstT &dst, const SrcT &src)
+{
+    using policy = typename Exec::policy;
+    constexpr size_t elemSize = DstT::elemSize;
+
+    auto body = [&](size_t begin, size_t end) {
+        if constexpr (isShadowBatch<SrcT>)
+        {
+            // 每个线程整批记录自己的区间
+            QuShadow::assign(dst, src, begin, end);
+        }
+        else
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                dst[i] = src[i];
+            }
+        }
+    };
+
+    if constexpr (isParallel<policy>)
+    {
+        QuThreadPool::instance().parallelFor(elemSize, policy::value, body);
+    }
+    else
+    {
+        body(0, elemSize);
+    }
+    return dst;
+}
+
+// 用计数器随机数填充张量，每个线程填充互不相交的区间
+template <typename Exec = QuExec<Serial>, typename TensorT>
+inline TensorT &QfillRandom(TensorT &tensor, uint64_t seed, uint32_t stream = 0)
+{
+    using policy = typename Exec::policy;
+
+    auto body = [&](size_t begin, size_t end) {
+        tensor.fillRandom(seed, stream, begin, end);
+    };
+
+    if constexpr (isParallel<policy>)
+    {
+        QuThreadPool::instance().parallelFor(TensorT::elemSize, policy::value, body);
+    }
+    else
+    {
+        body(0, TensorT::elemSize);
+    }
+    return tensor;
+}
+
+// ------------------- Sweep -------------------
+// 字长探索：QuSweep<TypeList<候选...>, QuExec<...>> 把 (候选, 激励分片) 的所有组合分配到线程池上
+// 每个分片的激励只生成一次，所有候选以只读引用共享；分片可以按 QuSweepShards 分给多个进程，各自 save 后再 load 合并排名
+
+// 第 candidate 个候选在第 shard 个激励分片上的误差
+struct QuSweepSample
+{
+    size_t candidate;
+    size_t shard;
+    double error;
+};
+
+struct QuSweepResult
+{
+    size_t candidate;
+    std::string name;
+    size_t shards;
+    double meanError;
+    double maxError;
+};
+
+// 当前进程负责 shard % count == rank 的分片
+struct QuSweepShards
+{
+    size_t rank = 0;
+    size_t count = 1;
+};
+
+template <typename T>
+struct quTypeName_s
+{
+    inline static std::string name()
+    {
+        return typeid(T).name();
+    }
+};
+
+template <int intB, int fracB, bool isS, typename QuM, typename OfM>
+struct quTypeName_s<Qu_s<intBits<intB>, fracBits<fracB>, isSigned<isS>, QuMode<QuM>, OfMode<OfM>>>
+{
+    inline static std::string name()
+    {
+        return quFormatName<intB, fracB, isS, QuM, OfM>();
+    }
+};
+
+template <typename CandidateList, typename... Args>
+class QuSweep;
+
+template <typename... Candidates, typename... Args>
+class QuSweep<TypeList<Candidates...>, Args...>
+{
+public:
+    using policy = typename tagExtractor<QuExec<Parallel<>>, Args...>::type;
+
+    inline static constexpr size_t numCandidates = sizeof...(Candidates);
+
+    inline static std::array<std::string, numCandidates> names()
+    {
+        return {quTypeName_s<Candidates>::name()...};
+    }
+
+    // stimulus(shard) 生成激励，kernel(std::type_identity<C>(), stimulus) 以候选 C 计算，metric(stimulus, output) 给出误差
+    // 返回本进程负责的每个 (候选, 分片) 的误差，按候选、分片排序
+    template <typename StimulusGen, typename Kernel, typename Metric>
+    static std::vector<QuSweepSample> run(size_t shards, const StimulusGen &stimulus, const Kernel &kernel, const Metric &metric, QuSweepShards split = {})
+    {
+        using stim_t = std::remove_cvref_t<std::invoke_result_t<const StimulusGen &, size_t>>;
+
+        if (split.count == 0 || split.rank >= split.count)
+        {
+            throw std::invalid_argument("QuSweep: the shard rank must be less than a non-zero shard count.");
+        }
+
+        std::vector<size_t> owned;
+        for (size_t shard = split.rank; shard < shards; shard += split.count)
+        {
+            owned.push_back(shard);
+        }
+
+        std::vector<std::optional<stim_t>> stimuli(owned.size());
+        forEach(owned.size(), [&](size_t i) { stimuli[i].emplace(stimulus(owned[i])); });
+
+        std::vector<QuSweepSample> samples(numCandidates * owned.size());
+        forEach(samples.size(), [&](size_t idx) {
+            const size_t c = idx / owned.size();
+            const size_t i = idx % owned.size();
+            samples[idx] = {c, owned[i], evaluate(c, *stimuli[i], kernel, metric)};
+        });
+        return samples;
+    }
+
+    // 按平均误差从小到大排名，没有样本的候选排在最后
+    static std::vector<QuSweepResult> rank(const std::vector<QuSweepSample> &samples)
+    {
+        const auto candidateNames = names();
+
+        std::vector<QuSweepResult> results;
+        for (size_t c = 0; c < numCandidates; c++)
+        {
+            results.push_back({c, candidateNames[c], 0, 0.0, 0.0});
+        }
+        for (const auto &sample : samples)
+        {
+            auto &r = results.at(sample.candidate);
+            r.shards++;
+            r.meanError += sample.error;
+            r.maxError = std::max(r.maxError, sample.error);
+        }
+        for (auto &r : results)
+        {
+            r.meanError = r.shards == 0 ? std::numeric_limits<double>::infinity() : r.meanError / static_cast<double>(r.shards);
+        }
+
+        std::stable_sort(results.begin(), results.end(), [](const QuSweepResult &a, const QuSweepResult &b) { return a.meanError < b.meanError; });
+        return results;
+    }
+
+    // 每行一个样本：candidate shard error
+    static void save(const std::string &path, const std::vector<QuSweepSample> &samples)
+    {
+        std::ofstream file(path);
+        if (!file)
+        {
+            throw std::runtime_error("Cannot open " + path + " for writing.");
+        }
+        file << std::setprecision(17);
+        for (const auto &sample : samples)
+        {
+            file << sample.candidate << ' ' << sample.shard << ' ' << sample.error << '\n';
+        }
+    }
+
+    // 合并多个进程保存的样本
+    static std::vector<QuSweepSample> load(const std::vector<std::string> &paths)
+    {
+        std::vector<QuSweepSample> samples;
+        for (const auto &path : paths)
+        {
+            std::ifstream file(path);
+            if (!file)
+            {
+                throw std::runtime_error("Cannot open " + path + " for reading.");
+            }
+
+            QuSweepSample sample;
+            while (file >> sample.candidate >> sample.shard >> sample.error)
+            {
+                if (sample.candidate >= numCandidates)
+                {
+                    throw std::invalid_argument("Sweep sample in " + path + " refers to an unknown candidate.");
+                }
+                samples.push_back(sample);
+            }
+        }
+
+        std::sort(samples.begin(), samples.end(), [](const QuSweepSample &a, const QuSweepSample &b) { return std::tie(a.candidate, a.shard) < std::tie(b.candidate, b.shard); });
+        return samples;
+    }
+
+private:
+    template <typename Func>
+    static void forEach(size_t n, const Func &func)
+    {
+        auto body = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                func(i);
+            }
+        };
+
+        if constexpr (isParallel<policy>)
+        {
+            QuThreadPool::instance().parallelFor(n, policy::value, body);
+        }
+        else
+        {
+            body(0, n);
+        }
+    }
+
+    // 把运行时的候选序号分派到对应的类型
+    template <typename StimT, typename Kernel, typename Metric>
+    static double evaluate(size_t candidate, const StimT &stimulus, const Kernel &kernel, const Metric &metric)
+    {
+        double error = 0;
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            ((candidate == I ? (void)(error = static_cast<double>(metric(stimulus, kernel(std::type_identity<Candidates>(), stimulus)))) : void()), ...);
+        }(std::index_sequence_for<Candidates...>());
+        return error;
+    }
+};
+
+// ------------------- Functions -------------------
+
+// scalar functions
+
+template <typename... toArgs, typename QuT1, typename QuT2>
+    requires isScalar<QuT1> && isScalar<QuT2>
+inline constexpr auto Qmul(const QuT1 f1, const QuT2 f2)
+{
+    return Qmul_s<QuT1, QuT2, MergerArgsWrapper<toArgs...>>::mul(f1, f2);
+}
+
+template <typename... toArgs, typename QuT1, typename QuT2>
+    requires isScalar<QuT1> && isScalar<QuT2>
+inline constexpr auto Qadd(const QuT1 f1, const QuT2 f2)
+{
+    return Qadd_s<QuT1, QuT2, MergerArgsWrapper<toArgs...>>::add(f1, f2);
+}
+
+template <typename... toArgs, typename QuT1, typename QuT2>
+    requires isScalar<QuT1> && isScalar<QuT2>
+inline constexpr auto Qsub(const QuT1 f1, const QuT2 f2)
+{
+    return Qsub_s<QuT1, QuT2, MergerArgsWrapper<toArgs...>>::sub(f1, f2);
+}
+
+template <typename... toArgs, typename QuT1, typename QuT2>
+    requires isScalar<QuT1> && isScalar<QuT2>
+inline constexpr auto Qdiv(const QuT1 f1, const QuT2 f2)
+{
+    return Qdiv_s<QuT1, QuT2, MergerArgsWrapper<toArgs...>>::div(f1, f2);
+}
+
+template <typename... toArgs, typename QuT>
+    requires isScalar<QuT>
+inline constexpr auto Qabs(const QuT f)
+{
+    return Qabs_s<QuT, MergerArgsWrapper<toArgs...>>::abs(f);
+}
+
+template <typename... toArgs, typename QuT>
+    requires isScalar<QuT>
+inline constexpr auto Qneg(const QuT f)
+{
+    return Qneg_s<QuT, MergerArgsWrapper<toArgs...>>::neg(f);
+}
+
+template <typename... toArgs, typename QuT1, typename QuT2>
+    requires isScalar<QuT1> && isScalar<QuT2>
+inline constexpr auto Qeq(const QuT1 f1, const QuT2 f2)
+{
+    return Qeq_s<QuT1, QuT2, MergerArgsWrapper<toArgs...>>::eq(f1, f2);
+}
+
+// operator overloading
+template <typename... QuArgs1, typename... QuArgs2>
+    requires isScalar<Qu_s<QuArgs1...>> && isScalar<Qu_s<QuArgs2...>>
+inline constexpr auto operator*(const Qu_s<QuArgs1...> f1, const Qu_s<QuArgs2...> f2)
+{
+    return Qmul(f1, f2);
+}
+
+template <typename... QuArgs1, typename... QuArgs2>
+    requires isScalar<Qu_s<QuArgs1...>> && isScalar<Qu_s<QuArgs2...>>
+inline constexpr auto operator+(const Qu_s<QuArgs1...> f1, const Qu_s<QuArgs2...> f2)
+{
+    return Qadd(f1, f2);
+}
+
+template <typename... QuArgs1, typename... QuArgs2>
+    requires isScalar<Qu_s<QuArgs1...>> && isScalar<Qu_s<QuArgs2...>>
+inline constexpr auto operator-(const Qu_s<QuArgs1...> f1, const Qu_s<QuArgs2...> f2)
+{
+    return Qsub(f1, f2);
+}
+
+template <typename... QuArgs1, typename... QuArgs2>
+    requires isScalar<Qu_s<QuArgs1...>> && isScalar<Qu_s<QuArgs2...>>
+inline constexpr auto operator/(const Qu_s<QuArgs1...> f1, const Qu_s<QuArgs2...> f2)
+{
+    return Qdiv(f1, f2);
+}
+
+template <typename... QuArgs>
+    requires isScalar<Qu_s<QuArgs...>>
+inline constexpr auto operator-(const Qu_s<QuArgs...> f1)
+{
+    return Qneg(f1);
+}
+
+template <typename... QuArgs1, typename... QuArgs2>
+    requires isScalar<Qu_s<QuArgs1...>> && isScalar<Qu_s<QuArgs2...>>
+inline constexpr auto operator<=>(const Qu_s<QuArgs1...> f1, const Qu_s<QuArgs2...> f2)
+{
+    return Qcmp_s<Qu_s<QuArgs1...>, Qu_s<QuArgs2...>, MergerArgsWrapper<>>::cmp(f1, f2);
+}
+
+template <typename... QuArgs1, typename... QuArgs2>
+    requires isScalar<Qu_s<QuArgs1...>> && isScalar<Qu_s<QuArgs2...>>
+inline constexpr auto operator==(const Qu_s<QuArgs1...> f1, const Qu_s<QuArgs2...> f2)
+{
+    return Qeq(f1, f2);
+}
+
+// proxies of SoA tensors take part in the scalar functions through their values
+template <typename T1, typename T2>
+concept hasSoaRefOperand = (isSoaRef<T1> && (isSoaRef<T2> || isScalar<T2>)) || (isScalar<T1> && isSoaRef<T2>);
+
+template <typename... toArgs, typename T1, typename T2>
+    requires hasSoaRefOperand<T1, T2>
+inline constexpr auto Qmul(const T1 &f1, const T2 &f2)
+{
+    return Qmul<toArgs...>(unwrapRef(f1), unwrapRef(f2));
+}
+
+template <typename... toArgs, typename T1, typename T2>
+    requires hasSoaRefOperand<T1, T2>
+inline constexpr auto Qadd(const T1 &f1, const T2 &f2)
+{
+    return Qadd<toArgs...>(unwrapRef(f1), unwrapRef(f2));
+}
+
+template <typename... toArgs, typename T1, typename T2>
+    requires hasSoaRefOperand<T1, T2>
+inline constexpr auto Qsub(const T1 &f1, const T2 &f2)
+{
+    return Qsub<toArgs...>(unwrapRef(f1), unwrapRef(f2));
+}
+
+template <typename... toArgs, typename T1, typename T2>
+    requires hasSoaRefOperand<T1, T2>
+inline constexpr auto Qdiv(const T1 &f1, const T2 &f2)
+{
+    return Qdiv<toArgs...>(unwrapRef(f1), unwrapRef(f2));
+}
+
+template <typename... toArgs, typename T>
+    requires isSoaRef<T>
+inline constexpr auto Qabs(const T &f)
+{
+    return Qabs<toArgs...>(f.get());
+}
+
+template <typename... toArgs, typename T>
+    requires isSoaRef<T>
+inline constexpr auto Qneg(const T &f)
+{
+    return Qneg<toArgs...>(f.get());
+}
+
+template <typename T1, typename T2>
+    requires hasSoaRefOperand<T1, T2>
+inline constexpr auto operator*(const T1 &f1, const T2 &f2)
+{
+    return unwrapRef(f1) * unwrapRef(f2);
+}
+
+template <typename T1, typename T2>
+    requires hasSoaRefOperand<T1, T2>
+inline constexpr auto operator+(const T1 &f1, const T2 &f2)
+{
+    return unwrapRef(f1) + unwrapRef(f2);
+}
+
+template <typename T1, typename T2>
+    requires hasSoaRefOperand<T1, T2>
+inline constexpr auto operator-(const T1 &f1, const T2 &f2)
+{
+    return unwrapRef(f1) - unwrapRef(f2);
+}
+
+template <typename T1, typename T2>
+    requires hasSoaRefOperand<T1, T2>
+inline constexpr auto operator/(const T1 &f1, const T2 &f2)
+{
+    return unwrapRef(f1) / unwrapRef(f2);
+}
+
+template <typename T>
+    requires isSoaRef<T>
+inline constexpr auto operator-(const T &f)
+{
+    return -f.get();
+}
+
+template <typename T1, typename T2>
+    requires hasSoaRefOperand<T1, T2>
+inline constexpr auto operator<=>(const T1 &f1, const T2 &f2)
+{
+    return unwrapRef(f1) <=> unwrapRef(f2);
+}
+
+template <typename T1, typename T2>
+    requires hasSoaRefOperand<T1, T2>
+inline constexpr auto operator==(const T1 &f1, const T2 &f2)
+{
+    return unwrapRef(f1) == unwrapRef(f2);
+}
+
+// tensor functions
+template <typename... toArgs, typename... QuArgs1, typename... QuArgs2>
+    requires(!isScalar<Qu_s<QuArgs1...>>) || (!isScalar<Qu_s<QuArgs2...>>)
+inline constexpr auto Qmul(const Qu_s<QuArgs1...> &f1, const Qu_s<QuArgs2...> &f2)
+{
+    return QmulTensor_s<Qu_s<QuArgs1...>, Qu_s<QuArgs2...>, toArgs...>::mul(f1, f2);
+}
+
+template <typename... toArgs, typename... QuArgs1, typename... QuArgs2>
+    requires(!isScalar<Qu_s<QuArgs1...>>) || (!isScalar<Qu_s<QuArgs2...>>)
+inline constexpr auto Qadd(const Qu_s<QuArgs1...> &f1, const Qu_s<QuArgs2...> &f2)
+{
+    return QaddTensor_s<Qu_s<QuArgs1...>, Qu_s<QuArgs2...>, toArgs...>::add(f1, f2);
+}
+
+template <typename... toArgs, typename... QuArgs1, typename... QuArgs2>
+    requires(!isScalar<Qu_s<QuArgs1...>>) || (!isScalar<Qu_s<QuArgs2...>>)
+inline constexpr auto Qsub(const Qu_s<QuArgs1...> &f1, const Qu_s<QuArgs2...> &f2)
+{
+    return QsubTensor_s<Qu_s<QuArgs1...>, Qu_s<QuArgs2...>, toArgs...>::sub(f1, f2);
+}
+
+template <typename... toArgs, typename... QuArgs1, typename... QuArgs2>
+    requires(!isScalar<Qu_s<QuArgs1...>>) || (!isScalar<Qu_s<QuArgs2...>>)
+inline constexpr auto Qdiv(const Qu_s<QuArgs1...> &f1, const Qu_s<QuArgs2...> &f2)
+{
+    return QdivTensor_s<Qu_s<QuArgs1...>, Qu_s<QuArgs2...>, toArgs...>::div(f1, f2);
+}
+
+template <typename... toArgs, typename... QuArgs>
+    requires(!isScalar<Qu_s<QuArgs...>>)
+inline constexpr auto Qabs(const Qu_s<QuArgs...> &f)
+{
+    return QabsTensor_s<Qu_s<QuArgs...>, toArgs...>::abs(f);
+}
+
+template <typename... toArgs, typename... QuArgs>
+    requires(!isScalar<Qu_s<QuArgs...>>)
+inline constexpr auto Qneg(const Qu_s<QuArgs...> &f)
+{
+    return QnegTensor_s<Qu_s<QuArgs...>, toArgs...>::neg(f);
+}
+
+// operator overloading
+template <typename... QuArgs1, typename... QuArgs2>
+    requires(!isScalar<Qu_s<QuArgs1...>>) || (!isScalar<Qu_s<QuArgs2...>>)
+inline constexpr auto operator*(const Qu_s<QuArgs1...> &f1, const Qu_s<QuArgs2...> &f2)
+{
+    return Qmul(f1, f2);
+}
+
+template <typename... QuArgs1, typename... QuArgs2>
+    requires(!isScalar<Qu_s<QuArgs1...>>) || (!isScalar<Qu_s<QuArgs2...>>)
+inline constexpr auto operator+(const Qu_s<QuArgs1...> &f1, const Qu_s<QuArgs2...> &f2)
+{
+    return Qadd(f1, f2);
+}
+
+template <typename... QuArgs1, typename... QuArgs2>
+    requires(!isScalar<Qu_s<QuArgs1...>>) || (!isScalar<Qu_s<QuArgs2...>>)
+inline constexpr auto operator-(const Qu_s<QuArgs1...> &f1, const Qu_s<QuArgs2...> &f2)
+{
+    return Qsub(f1, f2);
+}
+
+template <typename... QuArgs1, typename... QuArgs2>
+    requires(!isScalar<Qu_s<QuArgs1...>>) || (!isScalar<Qu_s<QuArgs2...>>)
+inline constexpr auto operator/(const Qu_s<QuArgs1...> &f1, const Qu_s<QuArgs2...> &f2)
+{
+    return Qdiv(f1, f2);
+}
+
+template <typename... QuArgs>
+    requires(!isScalar<Qu_s<QuArgs...>>)
+inline constexpr auto operator-(const Qu_s<QuArgs...> &f1)
+{
+    return Qneg(f1);
+}
+
+// ------------------- Slice -------------------
+
+template <size_t... Args>
+struct sr;
+
+template <size_t targetDim, size_t lower, size_t upper>
+struct sr<targetDim, lower, upper>
+{
+    static constexpr size_t dim = targetDim;
+    static constexpr size_t start = lower;
+    static constexpr size_t end = upper;
+};
+
+template <size_t targetDim, size_t lower>
+struct sr<targetDim, lower>
+{
+    static constexpr size_t dim = targetDim;
+    static constexpr size_t start = lower;
+    static constexpr size_t end = lower + 1;
+};
+
+template <size_t targetDimIndex, typename... srs>
+struct dimExtractor
+{
+};
+
+template <size_t targetDimIndex, typename sr1, typename... srs>
+    requires(sr1::dim == targetDimIndex)
+struct dimExtractor<targetDimIndex, sr1, srs...>
+{
+    inline static constexpr size_t start = sr1::start;
+    inline static constexpr size_t end = sr1::end;
+};
+
+template <size_t targetDimIndex, typename sr1, typename... srs>
+    requires(sr1::dim != targetDimIndex)
+struct dimExtractor<targetDimIndex, sr1, srs...> : dimExtractor<targetDimIndex, srs...>
+{
+};
+
+template <size_t targetDimIndex>
+struct dimExtractor<targetDimIndex>
+{
+    inline static constexpr size_t start = 0;
+    inline static constexpr size_t end = 0;
+};
+
+template <typename targetTensorT, typename... Args>
+struct dimArrayExtractor : dimArrayExtractor<std::make_index_sequence<targetTensorT::size::dimSize>, targetTensorT, Args...>
+{
+};
+
+template <size_t... I, typename targetTensorT, typename... Args>
+struct dimArrayExtractor<std::index_sequence<I...>, targetTensorT, Args...>
+{
+    inline constexpr static std::array<size_t, targetTensorT::size::dimSize> toLower = {dimExtractor<I, Args...>::start...};
+    inline constexpr static std::array<size_t, targetTensorT::size::dimSize> toUpper = {dimExtractor<I, Args...>::end == 0 ? targetTensorT::size::dimArray[I] : dimExtractor<I, Args...>::end...};
+    inline constexpr static std::array<size_t, targetTensorT::size::dimSize> toDimSize = {toUpper[I] - toLower[I]...};
+};
+
+// ------------------- Strided view -------------------
+// 张量按列主序存储（第一维最快），视图只保存根张量的指针，
+// 起始偏移、各维长度与各维在根张量中的步长都在编译期确定，切片的切片仍直接指向根张量
+
+template <typename rootT, size_t offset, typename viewDim, typename viewStrides>
+class QuView;
+
+template <size_t... strides>
+struct viewStride
+{
+};
+
+template <typename rootT, size_t offset, size_t... dims, size_t... strides>
+    requires(sizeof...(dims) == sizeof...(strides))
+class QuView<rootT, offset, dim<dims...>, viewStride<strides...>>
+{
+public:
+    using view_t = QuView;
+    using root_t = rootT;
+    using size = dim<dims...>;
+    using elem_t = typename rootT::elem_t;
+    static constexpr size_t elemSize = size::elemSize;
+    static constexpr size_t dimSize = size::dimSize;
+
+    static constexpr size_t start = offset;
+    static constexpr std::array<size_t, dimSize> strideArray = {strides...};
+
+    // 从第一维开始在根张量中连续存放的元素个数，拷贝时按这个长度整段复制
+    static constexpr size_t contiguousRun = [] {
+        size_t run = 1;
+        for (size_t d = 0; d < dimSize && strideArray[d] == run; d++)
+        {
+            run *= size::dimArray[d];
+        }
+        return run;
+    }();
+
+    // SoA 张量没有连续的元素存储，只能逐元素读取
+    static constexpr bool rootContiguous = requires(const rootT &r) {
+        { *r.data.begin() } -> std::convertible_to<const elem_t &>;
+    };
+
+    const rootT *root;
+
+    constexpr explicit QuView(const rootT &rootTensor)
+        : root(&rootTensor) {}
+
+    // 视图的线性下标（列主序）到根张量的线性下标
+    static constexpr size_t rootIndex(size_t index)
+    {
+        size_t res = offset;
+        for (size_t d = 0; d < dimSize; d++)
+        {
+            res += (index % size::dimArray[d]) * strideArray[d];
+            index /= size::dimArray[d];
+        }
+        return res;
+    }
+
+    template <size_t... I>
+    static constexpr size_t rootIndexHelper(std::index_sequence<I...>, auto... index)
+    {
+        return offset + (0 + ... + (static_cast<size_t>(index) * strideArray[I]));
+    }
+
+    inline constexpr decltype(auto) operator[](size_t index) const
+    {
+        return (*root)[rootIndex(index)];
+    }
+
+    inline constexpr decltype(auto) operator[](auto... index) const
+        requires(sizeof...(index) == dimSize && dimSize > 1)
+    {
+        return (*root)[rootIndexHelper(std::make_index_sequence<dimSize>{}, index...)];
+    }
+
+    // 按列主序写出所有元素，连续的段直接 std::copy
+    template <typename OutputIt>
+    inline constexpr OutputIt copyTo(OutputIt out) const
+    {
+        if constexpr (rootContiguous)
+        {
+            for (size_t run = 0; run < elemSize; run += contiguousRun)
+            {
+                auto first = root->data.begin() + rootIndex(run);
+                out = std::copy(first, first + contiguousRun, out);
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < elemSize; i++)
+            {
+                *out++ = (*this)[i];
+            }
+        }
+        return out;
+    }
+
+    // 拷贝成一个独立的张量
+    inline auto toTensor() const
+    {
+        Qu_s<size, elem_t> res;
+        copyTo(res.data.begin());
+        return res;
+    }
+};
+
+template <typename T>
+concept isQuView = requires { typename T::view_t; } && std::is_base_of_v<typename T::view_t, T>;
+
+// 被切片对象（张量或视图）在根张量中的位置
+template <typename T>
+struct viewTraits;
+
+template <size_t... dims, typename... Args>
+struct viewTraits<Qu_s<dim<dims...>, Args...>>
+{
+    using root_t = Qu_s<dim<dims...>, Args...>;
+    static constexpr size_t offset = 0;
+
+    static constexpr std::array<size_t, sizeof...(dims)> strides = [] {
+        std::array<size_t, sizeof...(dims)> res{};
+        size_t stride = 1;
+        for (size_t d = 0; d < sizeof...(dims); d++)
+        {
+            res[d] = stride;
+            stride *= dim<dims...>::dimArray[d];
+        }
+        return res;
+    }();
+
+    static constexpr const root_t &rootOf(const root_t &tensor)
+    {
+        return tensor;
+    }
+};
+
+template <typename T>
+    requires isQuView<T>
+struct viewTraits<T>
+{
+    using root_t = typename T::root_t;
+    static constexpr size_t offset = T::start;
+    static constexpr auto strides = T::strideArray;
+
+    static constexpr const root_t &rootOf(const T &view)
+    {
+        return *view.root;
+    }
+};
+
+// 由 sr<...> 计算切片后的视图类型，长度为 1 的维度被去掉，全部为 1 时保留一个 dim<1>
+template <typename parentT, typename... srs>
+struct sliceView_s
+{
+    using traits = viewTraits<parentT>;
+    using extractor = dimArrayExtractor<parentT, srs...>;
+    static constexpr size_t fromDimSize = parentT::size::dimSize;
+
+    static_assert(((srs::dim < fromDimSize) && ...), "slice dimension out of range!");
+    static_assert(((srs::start < srs::end && srs::end <= parentT::size::dimArray[srs::dim]) && ...), "slice range out of bound!");
+
+    static constexpr size_t offset = [] {
+        size_t res = traits::offset;
+        for (size_t d = 0; d < fromDimSize; d++)
+        {
+            res += extractor::toLower[d] * traits::strides[d];
+        }
+        return res;
+    }();
+
+    static constexpr size_t keptDims = std::max<size_t>(1, std::count_if(extractor::toDimSize.begin(), extractor::toDimSize.end(), [](size_t n) { return n > 1; }));
+
+    // 保留下来的维度的长度与步长
+    static constexpr auto kept = [] {
+        std::array<std::pair<size_t, size_t>, keptDims> res{};
+        res.fill({1, 1});
+        for (size_t d = 0, k = 0; d < fromDimSize; d++)
+        {
+            if (extractor::toDimSize[d] > 1)
+            {
+                res[k++] = {extractor::toDimSize[d], traits::strides[d]};
+            }
+        }
+        return res;
+    }();
+
+    template <size_t... I>
+    static auto make(std::index_sequence<I...>) -> QuView<typename traits::root_t, offset, dim<kept[I].first...>, viewStride<kept[I].second...>>;
+
+    using type = decltype(make(std::make_index_sequence<keptDims>{}));
+};
+
+template <typename... Args>
+class SliceExpression;
+
+// SliceExpression<T, sr<...>...>(tensor) 是 Qslice 结果的具名类型
+template <typename targetTensorT, typename... Args>
+    requires(sizeof...(Args) >= 1)
+class SliceExpression<targetTensorT, Args...> : public sliceView_s<targetTensorT, Args...>::type
+{
+public:
+    using base_t = typename sliceView_s<targetTensorT, Args...>::type;
+
+    constexpr SliceExpression(const targetTensorT &targetTensor)
+        : base_t(viewTraits<targetTensorT>::rootOf(targetTensor)) {}
+};
+
+// Qslice<sr<0, 1, 3>, sr<2, 0>>(tensor) 得到一个引用 tensor 的视图，也可以对视图再切片
+template <typename... srs, typename T>
+    requires(sizeof...(srs) >= 1)
+inline constexpr auto Qslice(const T &target)
+{
+    using view_t = typename sliceView_s<T, srs...>::type;
+    return view_t(viewTraits<T>::rootOf(target));
+}
+
+// Dynamic slice
+
+template <>
+struct sr<>
+{
+    size_t dim;
+    size_t start;
+    size_t end;
+
+    sr(size_t _dim, size_t _start, size_t _end)
+        : dim(_dim), start(_start), end(_end) {}
+
+    sr(size_t _dim, size_t _start)
+        : dim(_dim), start(_start), end(_start + 1) {}
+
+    void display(std::string prefix = "")
+    {
+        std::cout << prefix << "dim: " << dim << " start: " << start << " end: " << end << '\n';
+    }
+};
+
+using srd = sr<>;
+
+template <typename targetTensorT>
+class SliceExpression<targetTensorT>
+{
+public:
+    const targetTensorT &targetTensor;
+
+    std::array<size_t, targetTensorT::size::dimSize> toLower;
+    std::array<size_t, targetTensorT::size::dimSize> toUpper;
+    std::array<size_t, targetTensorT::size::dimSize> toDimSize;
+
+    SliceExpression(const targetTensorT &f, auto... srs)
+        : targetTensor(f)
+    {
+
+        static auto updateTargetDim = [srs..., this]<size_t... Is>(size_t index, std::index_sequence<Is...>) {
+            toLower[index] = (0 + ... + (index == srs.dim ? srs.start : 0));
+            toUpper[index] = (0 + ... + (index == srs.dim ? srs.end : 0));
+            if (toUpper[index] == 0)
+            {
+                toUpper[index] = targetTensorT::size::dimArray[index];
+            }
+        };
+
+        [this]<size_t... Is>(std::index_sequence<Is...>) {
+            (updateTargetDim(Is, std::make_index_sequence<sizeof...(srs)>{}), ...);
+        }(std::make_index_sequence<targetTensorT::size::dimSize>{});
+    }
+
+    inline auto &operator[](auto... index)
+    {
+    }
+};
+
+// ------------------- Basic tensor operations -------------------
+
+// 元素与其原始比特之间的转换，BitStream 与 packed BitStream 共用
+template <typename... Args>
+struct PackedElement_s;
+
+// 实数元素：原始数据的低 width 位
+template <typename... QuArgs>
+    requires(!Qu_s<QuArgs...>::is_complex)
+struct PackedElement_s<Qu_s<QuArgs...>>
+{
+    using QuT = Qu_s<QuArgs...>;
+    inline static constexpr size_t width = QuT::width;
+    static_assert(width <= 64, "Packed BitStream only supports elements up to 64 bits.");
+
+    inline static constexpr uint64_t mask = width == 64 ? ~uint64_t(0) : (uint64_t(1) << width) - 1;
+
+    inline static constexpr uint64_t toBits(const QuT &val)
+    {
+        return wordAt(val.data, 0) & mask;
+    }
+
+    // 有符号类型需要从 width 位做符号扩展
+    inline static constexpr QuT fromBits(uint64_t bits)
+    {
+        QuT res;
+        int64_t raw = static_cast<int64_t>(bits & mask);
+        if constexpr (QuT::isS && width < 64 && width > 0)
+        {
+            raw = static_cast<int64_t>(bits << (64 - width)) >> (64 - width);
+        }
+        res.data = ArbiInt<1 + QuT::intB + QuT::fracB>(raw);
+        return res;
+    }
+};
+
+// 复数元素：实部在前、虚部在后
+template <typename realT, typename imagT>
+struct PackedElement_s<Qu_s<realT, imagT>>
+{
+    using QuT = Qu_s<realT, imagT>;
+    inline static constexpr size_t width = QuT::width;
+    static_assert(width <= 64, "Packed BitStream only supports elements up to 64 bits.");
+
+    inline static constexpr uint64_t toBits(const QuT &val)
+    {
+        return (PackedElement_s<realT>::toBits(val.real) << PackedElement_s<imagT>::width) | PackedElement_s<imagT>::toBits(val.imag);
+    }
+
+    inline static constexpr QuT fromBits(uint64_t bits)
+    {
+        QuT res;
+        res.real = PackedElement_s<realT>::fromBits(bits >> PackedElement_s<imagT>::width);
+        res.imag = PackedElement_s<imagT>::fromBits(bits);
+        return res;
+    }
+};
+
+// convert string to single complex
+template <typename Qcomplex_t>
+    requires(Qcomplex_t::is_complex)
+Qcomplex_t str2Qcomplex(std::string const &str)
+{
+    return PackedElement_s<Qcomplex_t>::fromBits(std::stoull(str.substr(0, Qcomplex_t::width), nullptr, 2));
+}
+
+// BitStream converter
+struct l2r
+{};
+
+template <size_t... in>
+    requires(sizeof...(in) <= 1)
+struct r2l;
+
+template <size_t in>
+struct r2l<in>
+{
+    inline static constexpr size_t index = in;
+};
+
+template <>
+struct r2l<> : r2l<1>
+{
+};
+
+// handle string to string
+template <typename... Args>
+struct SingleString_s;
+
+template <>
+struct SingleString_s<l2r>
+{
+    inline static constexpr auto convert(std::string_view str)
+    {
+        return std::string(str);
+    }
+
+    // from function, currently indentical to convert
+    inline static constexpr auto from(std::string_view str)
+    {
+        return convert(str);
+    }
+
+    // to function, currently indentical to convert
+    inline static constexpr auto to(std::string_view str)
+    {
+        return convert(str);
+    }
+};
+
+template <size_t... in>
+struct SingleString_s<r2l<in...>>
+{
+    inline static constexpr auto index = r2l<in...>::index;
+
+    inline static constexpr auto convert(std::string_view str)
+    {
+        if (str.size() % index != 0)
+        {
+            throw std::runtime_error("Invalid string length: Must be a multiple of " + std::to_string(index));
+        }
+
+        std::string res;
+        res.reserve(str.size());
+
+        // Reverse chunks of size Index directly
+        for (size_t i = str.size(); i >= index; i -= index)
+        {
+            res.append(str.data() + i - index, index);
+        }
+
+        return res;
+    }
+
+    // from function, currently indentical to convert
+    inline static constexpr auto from(std::string_view str)
+    {
+        return convert(str);
+    }
+
+    // to function, currently indentical to convert
+    inline static constexpr auto to(std::string_view str)
+    {
+        return convert(str);
+    }
+};
+
+template <typename... Args>
+struct TensorString_s;
+
+template <typename elemProcessT>
+struct TensorString_s<l2r, elemProcessT>
+{
+    // convert to std::array<std::string, size> with element string stored in l2r
+    // the input string is expected to be a single string containing all elements, each element has length of elemWidth
+    template <typename QuTensorT>
+    inline static constexpr auto fromString(std::string_view str)
+    {
+        using QuT = typename QuTensorT::elem_t;
+        static constexpr auto elemWidth = QuT::width;
+        static constexpr auto elemSize = QuTensorT::elemSize;
+        if (str.size() % elemWidth != 0)
+        {
+            throw std::runtime_error("Invalid string length: Must be a multiple of " + std::to_string(elemWidth));
+        }
+
+        std::array<std::string, elemSize> res;
+        for (size_t i = 0; i < res.size(); i++)
+        {
+            res[i] = SingleString_s<elemProcessT>::convert(str.substr(i * elemWidth, elemWidth));
+        }
+
+        return res;
+    }
+
+    template <size_t arrSize>
+    inline static constexpr auto toString(std::array<std::string, arrSize> arr)
+    {
+        std::string res;
+        res.reserve(arr.size() * arr[0].size());
+
+        for (size_t i = 0; i < arr.size(); i++)
+        {
+            res.append(SingleString_s<elemProcessT>::to(arr[i]));
+        }
+
+        return res;
+    }
+
+    // from QuBLAS type to std::array<std::string, size>
+    template <size_t... dims, typename QuT>
+    inline static constexpr auto fromQu(Qu_s<dim<dims...>, QuT> const &tensor)
+    {
+        std::array<std::string, dim<dims...>::elemSize> res;
+
+        for (size_t i = 0; i < dim<dims...>::elemSize; i++)
+        {
+            res[i] = SingleString_s<elemProcessT>::to(tensor[i].toString());
+        }
+        return res;
+    }
+
+    // from std::array<std::string, size> to QuBLAS type
+    template <typename QuTensorT>
+    inline static constexpr auto toQu(std::array<std::string, QuTensorT::elemSize> const &arr)
+    {
+        QuTensorT res;
+        using elem_t = QuTensorT::elem_t;
+
+        for (size_t i = 0; i < QuTensorT::elemSize; i++)
+        {
+            std::string str = SingleString_s<elemProcessT>::from(arr[i]);
+
+            // convert binary stored in str to integer
+            if constexpr (elem_t::is_complex)
+            {
+                res[i] = str2Qcomplex<elem_t>(str);
+            }
+            else
+            {
+                res[i] = PackedElement_s<elem_t>::fromBits(std::stoull(str, nullptr, 2));
+            }
+        }
+
+        return res;
+    }
+};
+
+template <typename elemProcessT, size_t... chunk>
+struct TensorString_s<r2l<chunk...>, elemProcessT>
+{
+    inline static constexpr auto index = r2l<chunk...>::index;
+
+    template <typename QuTensorT>
+    inline static constexpr auto fromString(std::string_view str)
+    {
+        using QuT = typename QuTensorT::elem_t;
+        static constexpr auto elemWidth = QuT::width;
+        static constexpr auto elemSize = QuTensorT::elemSize;
+        if (str.size() % elemWidth != 0)
+        {
+            throw std::runtime_error("Invalid string length: Must be a multiple of " + std::to_string(elemWidth));
+        }
+
+        std::array<std::string, elemSize> res;
+
+        // Reverse chunks of size Index directly
+        size_t in = 0;
+        for (size_t i = elemSize; i > 0; i = i - index)
+        {
+            for (size_t j = 0; j < index; j++)
+            {
+                res[in] = SingleString_s<elemProcessT>::convert(str.substr((i + j - index) * elemWidth, elemWidth));
+                in++;
+            }
+        }
+
+        return res;
+    }
+
+    template <size_t arrSize>
+    inline static constexpr auto toString(std::array<std::string, arrSize> arr)
+    {
+        std::string res;
+        res.reserve(arr.size() * arr[0].size());
+
+        // reverse the order of elements, with every Index elements as a chunk
+        for (size_t i = arr.size(); i > 0; i = i - index)
+        {
+            for (size_t j = 0; j < index; j++)
+            {
+                res.append(SingleString_s<elemProcessT>::to(arr[i + j - index]));
+            }
+        }
+        return res;
+    }
+};
+
+// scalar
+template <typename... Args>
+struct BitStream_s;
+
+template <typename... QuArgs, typename processT>
+struct BitStream_s<Qu_s<QuArgs...>, processT>
+{
+    inline static auto convert(std::string_view str)
+    {
+        using elem_t = Qu_s<QuArgs...>;
+        elem_t res;
+
+        auto is_bin_char = [](char ch) { return (ch == '0') || (ch == '1'); };
+        auto filtered_view = str | std::views::filter(is_bin_char);
+        std::string filtered_str(filtered_view.begin(), filtered_view.end());
+        std::string toStr = SingleString_s<processT>::from(filtered_str);
+
+        if constexpr (elem_t::is_complex)
+        {
+            res = str2Qcomplex<elem_t>(toStr);
+        }
+        else
+        {
+            res = PackedElement_s<elem_t>::fromBits(std::stoull(toStr, nullptr, 2));
+        }
+
+        return res;
+    }
+};
+
+template <typename processT>
+struct BitStream_s<processT>
+{
+    inline static auto convert(auto const &Qu)
+    {
+        return SingleString_s<processT>::to(Qu.toString());
+    }
+};
+
+// tensor
+template <typename QuT, size_t... dims, typename tensorProcessT, typename elemProcessT>
+struct BitStream_s<Qu_s<dim<dims...>, QuT>, tensorProcessT, elemProcessT>
+{
+    inline static auto convert(std::string_view str)
+    {
+        // use TensorString_s
+        auto is_bin_char = [](char ch) { return (ch == '0') || (ch == '1'); };
+        auto filtered_view = str | std::views::filter(is_bin_char);
+        std::string filtered_str(filtered_view.begin(), filtered_view.end());
+
+        auto arr = TensorString_s<tensorProcessT, elemProcessT>::template fromString<Qu_s<dim<dims...>, QuT>>(filtered_str);
+        return TensorString_s<l2r, l2r>::template toQu<Qu_s<dim<dims...>, QuT>>(arr);
+    }
+};
+
+template <typename tensorProcessT, typename elemProcessT>
+struct BitStream_s<tensorProcessT, elemProcessT>
+{
+    template <typename... QuArgs>
+    inline static auto convert(Qu_s<QuArgs...> const &Qu)
+    {
+        auto arr = TensorString_s<l2r, l2r>::fromQu(Qu);
+        return TensorString_s<tensorProcessT, elemProcessT>::toString(arr);
+    }
+
+    // 视图先拷贝成张量，连续段直接复制
+    template <typename ViewT>
+        requires isQuView<ViewT>
+    inline static auto convert(ViewT const &view)
+    {
+        return convert(view.toTensor());
+    }
+};
+
+template <typename... Args>
+inline auto BitStream(auto const &input)
+{
+    return BitStream_s<Args...>::convert(input);
+}
+
+// ------------------- Packed BitStream -------------------
+// 与 BitStream 相同的比特顺序，但每个比特只占一个比特：
+// 字符串中的第 p 个比特存放在第 p / w 个字（w 为字的位宽）中，字内高位在前，末尾不足一个字的部分补 0
+// 复数元素按实部、虚部的顺序拼接后再做元素内的处理，与 BitStream 解码时去掉非 0/1 字符后的结果一致
+
+template <typename Word>
+    requires std::is_same_v<Word, std::byte> || std::is_same_v<Word, uint8_t> || std::is_same_v<Word, uint64_t>
+class PackedBitWriter
+{
+    inline static constexpr size_t wordBits = sizeof(Word) * 8;
+
+    std::span<Word> out;
+    size_t wordIndex = 0;
+    size_t used = 0;
+    uint64_t current = 0;
+
+public:
+    explicit PackedBitWriter(std::span<Word> buffer) : out(buffer) {}
+
+    // 写入 value 的低 n 位，高位在前
+    inline void put(uint64_t value, size_t n)
+    {
+        while (n > 0)
+        {
+            const size_t take = std::min(n, wordBits - used);
+            const uint64_t bits = (value >> (n - take)) & (take == 64 ? ~uint64_t(0) : (uint64_t(1) << take) - 1);
+            current |= bits << (wordBits - used - take);
+            used += take;
+            n -= take;
+            if (used == wordBits)
+            {
+                flush();
+            }
+        }
+    }
+
+    inline void flush()
+    {
+        if (used != 0)
+        {
+            out[wordIndex++] = static_cast<Word>(current);
+            current = 0;
+            used = 0;
+        }
+    }
+};
+
+template <typename Word>
+    requires std::is_same_v<Word, std::byte> || std::is_same_v<Word, uint8_t> || std::is_same_v<Word, uint64_t>
+class PackedBitReader
+{
+    inline static constexpr size_t wordBits = sizeof(Word) * 8;
+
+    std::span<const Word> in;
+    size_t wordIndex = 0;
+    size_t used = 0;
+
+public:
+    explicit PackedBitReader(std::span<const Word> buffer) : in(buffer) {}
+
+    // 读出接下来的 n 位，高位在前
+    inline uint64_t get(size_t n)
+    {
+        uint64_t value = 0;
+        while (n > 0)
+        {
+            const size_t take = std::min(n, wordBits - used);
+            const uint64_t word = static_cast<uint64_t>(in[wordIndex]);
+            const uint64_t bits = (word >> (wordBits - used - take)) & (take == 64 ? ~uint64_t(0) : (uint64_t(1) << take) - 1);
+            value = take == 64 ? bits : (value << take) | bits;
+            used += take;
+            n -= take;
+            if (used == wordBits)
+            {
+                wordIndex++;
+                used = 0;
+            }
+        }
+        return value;
+    }
+};
+
+// 元素内的比特处理，l2r 不变，r2l<index> 以 index 位为一组反转顺序，两者都是自身的逆
+template <typename processT, size_t width>
+struct PackedElementOrder_s;
+
+template <size_t width>
+struct PackedElementOrder_s<l2r, width>
+{
+    inline static constexpr uint64_t apply(uint64_t bits)
+    {
+        return bits;
+    }
+};
+
+template <size_t... in, size_t width>
+struct PackedElementOrder_s<r2l<in...>, width>
+{
+    inline static constexpr size_t index = r2l<in...>::index;
+
+    static_assert(width % index == 0, "The element width must be a multiple of the r2l index.");
+
+    inline static constexpr uint64_t chunkMask = index == 64 ? ~uint64_t(0) : (uint64_t(1) << index) - 1;
+
+    inline static constexpr uint64_t apply(uint64_t bits)
+    {
+        uint64_t res = 0;
+        for (size_t c = 0; c < width / index; c++)
+        {
+            res = (index == 64 ? 0 : res << index) | ((bits >> (c * index)) & chunkMask);
+        }
+        return res;
+    }
+};
+
+// 元素的排列顺序，返回流中第 pos 个元素对应的张量下标
+template <typename processT, size_t elemSize>
+struct PackedTensorOrder_s;
+
+template <size_t elemSize>
+struct PackedTensorOrder_s<l2r, elemSize>
+{
+    inline static constexpr size_t at(size_t pos)
+    {
+        return pos;
+    }
+};
+
+template <size_t... in, size_t elemSize>
+struct PackedTensorOrder_s<r2l<in...>, elemSize>
+{
+    inline static constexpr size_t index = r2l<in...>::index;
+
+    static_assert(elemSize % index == 0, "The number of elements must be a multiple of the r2l index.");
+
+    inline static constexpr size_t at(size_t pos)
+    {
+        return (elemSize / index - 1 - pos / index) * index + pos % index;
+    }
+};
+
+template <typename... Args>
+struct BitPack_s;
+
+// tensor
+template <typename tensorProcessT, typename elemProcessT>
+struct BitPack_s<tensorProcessT, elemProcessT>
+{
+    template <typename QuT>
+    inline static constexpr size_t bits = QuT::elemSize * PackedElement_s<typename QuT::elem_t>::width;
+
+    // 写入 out，返回写入的比特数
+    template <typename QuT, typename Word>
+    inline static size_t pack(QuT const &tensor, std::span<Word> out)
+    {
+        using elem_t = typename QuT::elem_t;
+        using element = PackedElement_s<elem_t>;
+        using order = PackedElementOrder_s<elemProcessT, element::width>;
+        using tensorOrder = PackedTensorOrder_s<tensorProcessT, QuT::elemSize>;
+
+        if (out.size() * sizeof(Word) * 8 < bits<QuT>)
+        {
+            throw std::runtime_error("The buffer is too small: " + std::to_string(bits<QuT>) + " bits are required.");
+        }
+
+        PackedBitWriter<Word> writer(out);
+        for (size_t pos = 0; pos < QuT::elemSize; pos++)
+        {
+            writer.put(order::apply(element::toBits(tensor[tensorOrder::at(pos)])), element::width);
+        }
+        writer.flush();
+        return bits<QuT>;
+    }
+
+    // 直接解码到 tensor 中
+    template <typename QuT, typename Word>
+    inline static void unpack(std::span<const Word> in, QuT &tensor)
+    {
+        using elem_t = typename QuT::elem_t;
+        using element = PackedElement_s<elem_t>;
+        using order = PackedElementOrder_s<elemProcessT, element::width>;
+        using tensorOrder = PackedTensorOrder_s<tensorProcessT, QuT::elemSize>;
+
+        if (in.size() * sizeof(Word) * 8 < bits<QuT>)
+        {
+            throw std::runtime_error("The buffer is too small: " + std::to_string(bits<QuT>) + " bits are required.");
+        }
+
+        PackedBitReader<Word> reader(in);
+        for (size_t pos = 0; pos < QuT::elemSize; pos++)
+        {
+            tensor[tensorOrder::at(pos)] = element::fromBits(order::apply(reader.get(element::width)));
+        }
+    }
+};
+
+// scalar
+template <typename processT>
+struct BitPack_s<processT>
+{
+    template <typename QuT>
+    inline static constexpr size_t bits = PackedElement_s<QuT>::width;
+
+    template <typename QuT, typename Word>
+    inline static size_t pack(QuT const &val, std::span<Word> out)
+    {
+        using element = PackedElement_s<QuT>;
+        if (out.size() * sizeof(Word) * 8 < element::width)
+        {
+            throw std::runtime_error("The buffer is too small: " + std::to_string(element::width) + " bits are required.");
+        }
+
+        PackedBitWriter<Word> writer(out);
+        writer.put(PackedElementOrder_s<processT, element::width>::apply(element::toBits(val)), element::width);
+        writer.flush();
+        return element::width;
+    }
+
+    template <typename QuT, typename Word>
+    inline static void unpack(std::span<const Word> in, QuT &val)
+    {
+        using element = PackedElement_s<QuT>;
+        if (in.size() * sizeof(Word) * 8 < element::width)
+        {
+            throw std::runtime_error("The buffer is too small: " + std::to_string(element::width) + " bits are required.");
+        }
+
+        PackedBitReader<Word> reader(in);
+        val = element::fromBits(PackedElementOrder_s<processT, element::width>::apply(reader.get(element::width)));
+    }
+};
+
+// BitPack<r2l<3>, r2l<2>>(tensor, buffer) 按 BitStream 的顺序写入字节或 uint64_t 缓冲区
+template <typename... Args, typename QuT, typename Word>
+inline auto BitPack(QuT const &input, std::span<Word> out)
+{
+    return BitPack_s<Args...>::pack(input, out);
+}
+
+template <typename... Args, typename QuT, typename Word>
+inline auto BitPack(QuT const &input, std::vector<Word> &out)
+{
+    return BitPack_s<Args...>::pack(input, std::span<Word>(out));
+}
+
+// BitUnpack<r2l<3>, r2l<2>>(buffer, tensor) 从缓冲区直接解码
+template <typename... Args, typename QuT, typename Word>
+inline void BitUnpack(std::span<const Word> in, QuT &output)
+{
+    BitPack_s<Args...>::unpack(in, output);
+}
+
+template <typename... Args, typename QuT, typename Word>
+inline void BitUnpack(std::vector<Word> const &in, QuT &output)
+{
+    BitPack_s<Args...>::unpack(std::span<const Word>(in), output);
+}
+
+// 缓冲区所需的字数
+template <typename QuT, typename Word = std::byte>
+inline constexpr size_t BitPackWords = ([] {
+    if constexpr (isScalar<QuT>)
+    {
+        return PackedElement_s<QuT>::width;
+    }
+    else
+    {
+        return QuT::elemSize * PackedElement_s<typename QuT::elem_t>::width;
+    }
+}() + sizeof(Word) * 8 - 1) / (sizeof(Word) * 8);
+
+// ------------------- Tensor file I/O -------------------
+// 张量以原始整数比特写入文件，元素按列主序排列：
+//   npy: numpy 的 v1.0 格式，fortran_order 为 True。实数元素的 dtype 为 ArbiInt 的存储类型（<i4、<i8，超过 64 位时为 |V<字节数>），
+//        复数元素为 real、imag 两个字段的结构体。numpy 以 C 顺序保存的文件在读取时会转置
+//   raw: 64 字节对齐的头部记录元素的格式标签与各维长度，之后直接是元素对象本身，可以用 QuMapped 映射后零拷贝读取
+
+// 单个元素在 npy 中的 dtype 与编码
+template <typename QuT>
+struct QuFileElement_s
+{
+    inline static constexpr size_t itemSize = sizeof(QuT::data);
+    inline static constexpr std::array<int32_t, 5> tags = {QuT::intB, QuT::fracB, QuT::isS, QuT::QuM, QuT::OfM};
+
+    static std::string descr()
+    {
+        return itemSize <= 8 ? "'<i" + std::to_string(itemSize) + "'" : "'|V" + std::to_string(itemSize) + "'";
+    }
+
+    static void store(const QuT &val, std::byte *out)
+    {
+        std::memcpy(out, &val.data, itemSize);
+    }
+
+    static void load(const std::byte *in, QuT &val)
+    {
+        std::memcpy(&val.data, in, itemSize);
+    }
+};
+
+template <typename... realArgs, typename... imagArgs>
+struct QuFileElement_s<Qu_s<Qu_s<realArgs...>, Qu_s<imagArgs...>>>
+{
+    using real_t = QuFileElement_s<Qu_s<realArgs...>>;
+    using imag_t = QuFileElement_s<Qu_s<imagArgs...>>;
+
+    inline static constexpr size_t itemSize = real_t::itemSize + imag_t::itemSize;
+
+    static std::string descr()
     {
-        // 保存原始格式状态
-        std::ios_base::fmtflags original_flags = os.flags();
-        std::streamsize original_precision = os.precision();
+        return "[('real', " + real_t::descr() + "), ('imag', " + imag_t::descr() + ")]";
+    }
 
-        // 遍历以找出最大数字，以便设置输出宽度
-        int max_width = 0;
-        for (size_t i = 0; i < dim<dims...>::elemSize; i++)
+    static void store(const Qu_s<Qu_s<realArgs...>, Qu_s<imagArgs...>> &val, std::byte *out)
+    {
+        real_t::store(val.real, out);
+        imag_t::store(val.imag, out + real_t::itemSize);
+    }
+
+    static void load(const std::byte *in, Qu_s<Qu_s<realArgs...>, Qu_s<imagArgs...>> &val)
+    {
+        real_t::load(in, val.real);
+        imag_t::load(in + real_t::itemSize, val.imag);
+    }
+};
+
+template <typename TensorT>
+struct QuFile_s
+{
+    static_assert(std::endian::native == std::endian::little, "Tensor file I/O assumes a little-endian host.");
+
+    using elem_t = typename TensorT::elem_t;
+    using size = typename TensorT::size;
+    using element = QuFileElement_s<elem_t>;
+    static constexpr size_t elemSize = TensorT::elemSize;
+    static constexpr size_t dimSize = TensorT::dimSize;
+
+    // 编解码时每次处理的元素个数
+    static constexpr size_t chunkElems = 4096;
+
+    // npy 的元素与内存中的元素对象逐字节相同时，可以直接整段读写
+    static constexpr bool npyIsObject = element::itemSize == sizeof(elem_t);
+
+    struct headerInfo
+    {
+        QuFile format;
+        bool fortranOrder;
+        size_t payloadOffset;
+    };
+
+    template <typename T>
+    static void appendPod(std::string &str, T val)
+    {
+        str.append(reinterpret_cast<const char *>(&val), sizeof(T));
+    }
+
+    static std::string npyHeader()
+    {
+        std::string dict = "{'descr': " + element::descr() + ", 'fortran_order': True, 'shape': (";
+        for (size_t d = 0; d < dimSize; d++)
         {
-            std::stringstream ss;
-            ss << std::fixed << std::setprecision(4) << val.data[i].toDouble();
+            dict += std::to_string(size::dimArray[d]) + (d + 1 < dimSize ? ", " : (dimSize == 1 ? "," : ""));
+        }
+        dict += "), }";
+
+        // 头部总长度按 64 字节对齐，以换行结尾
+        const size_t total = 10 + dict.size() + 1;
+        dict.append((64 - total % 64) % 64, ' ');
+        dict += '\n';
+
+        std::string header("\x93NUMPY\x01\x00", 8);
+        appendPod(header, static_cast<uint16_t>(dict.size()));
+        return header + dict;
+    }
+
+    static std::string rawHeader()
+    {
+        std::string header("QuBLAS\x00\x01", 8);
+        appendPod(header, static_cast<uint32_t>(sizeof(elem_t)));
+        appendPod(header, static_cast<uint32_t>(elem_t::is_complex));
+        appendPod(header, static_cast<uint32_t>(dimSize));
+
+        // 实部与虚部的 intBits、fracBits、isSigned、QuMode、OfMode，实数的虚部为 0
+        std::array<int32_t, 10> tags{};
+        if constexpr (elem_t::is_complex)
+        {
+            std::copy_n(element::real_t::tags.begin(), 5, tags.begin());
+            std::copy_n(element::imag_t::tags.begin(), 5, tags.begin() + 5);
+        }
+        else
+        {
+            std::copy_n(element::tags.begin(), 5, tags.begin());
+        }
+        for (auto tag : tags)
+        {
+            appendPod(header, tag);
+        }
+
+        for (size_t d = 0; d < dimSize; d++)
+        {
+            appendPod(header, static_cast<uint64_t>(size::dimArray[d]));
+        }
+
+        header.append((64 - header.size() % 64) % 64, '\0');
+        return header;
+    }
+
+    // 由文件开头的若干字节得到头部的总长度，字节不足时返回所需的最小长度
+    static size_t headerLength(std::string_view prefix)
+    {
+        if (prefix.size() < 12)
+        {
+            return 12;
+        }
+        if (prefix.starts_with(std::string_view("\x93NUMPY", 6)))
+        {
+            if (prefix[6] == 1)
+            {
+                uint16_t len;
+                std::memcpy(&len, prefix.data() + 8, sizeof(len));
+                return 10 + len;
+            }
+            uint32_t len;
+            std::memcpy(&len, prefix.data() + 8, sizeof(len));
+            return 12 + len;
+        }
+        return rawHeader().size();
+    }
+
+    // 取出 npy 头部字典中 key 对应的值
+    static std::string_view npyValue(std::string_view dict, std::string_view key)
+    {
+        size_t pos = dict.find("'" + std::string(key) + "'");
+        if (pos == std::string_view::npos)
+        {
+            throw std::runtime_error("npy header has no " + std::string(key) + " field");
+        }
+        pos = dict.find(':', pos) + 1;
+        while (pos < dict.size() && dict[pos] == ' ')
+        {
+            pos++;
+        }
+
+        // 值可能是带有嵌套括号的结构体描述
+        size_t end = pos;
+        int depth = 0;
+        bool quoted = false;
+        for (; end < dict.size(); end++)
+        {
+            const char ch = dict[end];
+            if (ch == '\'')
+            {
+                quoted = !quoted;
+            }
+            else if (!quoted && (ch == '(' || ch == '['))
+            {
+                depth++;
+            }
+            else if (!quoted && (ch == ')' || ch == ']'))
+            {
+                depth--;
+            }
+            else if (!quoted && depth == 0 && (ch == ',' || ch == '}'))
+            {
+                break;
+            }
+        }
+        return dict.substr(pos, end - pos);
+    }
+
+    static std::string withoutSpaces(std::string_view str)
+    {
+        std::string res;
+        std::copy_if(str.begin(), str.end(), std::back_inserter(res), [](char ch) { return ch != ' '; });
+        return res;
+    }
+
+    // 检查头部与 TensorT 是否一致
+    static headerInfo checkHeader(std::string_view header)
+    {
+        if (header.starts_with(std::string_view("\x93NUMPY", 6)))
+        {
+            const std::string_view dict = header.substr(header[6] == 1 ? 10 : 12);
+
+            if (withoutSpaces(npyValue(dict, "descr")) != withoutSpaces(element::descr()))
+            {
+                throw std::runtime_error("npy dtype " + std::string(npyValue(dict, "descr")) + " does not match " + element::descr());
+            }
+
+            std::string shape = withoutSpaces(npyValue(dict, "shape"));
+            std::string expected = "(";
+            for (size_t d = 0; d < dimSize; d++)
+            {
+                expected += std::to_string(size::dimArray[d]) + (d + 1 < dimSize || dimSize == 1 ? "," : "");
+            }
+            expected += ")";
+            if (shape != expected)
+            {
+                throw std::runtime_error("npy shape " + shape + " does not match " + expected);
+            }
+
+            return {QuFile::npy, npyValue(dict, "fortran_order") == "True", header.size()};
+        }
+
+        const std::string expected = rawHeader();
+        if (header != expected)
+        {
+            throw std::runtime_error(header.starts_with(std::string_view(expected.data(), 8)) ? "raw tensor file has a different format or shape" : "not a npy or raw tensor file");
+        }
+        return {QuFile::raw, true, header.size()};
+    }
+
+    // numpy 以 C 顺序（最后一维最快）保存时，第 index 个元素在列主序中的位置
+    static size_t fromCOrder(size_t index)
+    {
+        size_t res = 0;
+        size_t stride = elemSize;
+        for (size_t d = dimSize; d-- > 0;)
+        {
+            stride /= size::dimArray[d];
+            res += (index % size::dimArray[d]) * stride;
+            index /= size::dimArray[d];
+        }
+        return res;
+    }
+
+    static void load(TensorT &tensor, const std::string &filename, QuFile format)
+    {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file)
+        {
+            throw std::runtime_error("Cannot open " + filename);
+        }
+
+        std::string header(12, '\0');
+        file.read(header.data(), header.size());
+        header.resize(headerLength(header));
+        file.read(header.data() + 12, header.size() - 12);
+        if (!file)
+        {
+            throw std::runtime_error("Truncated header in " + filename);
+        }
+
+        const headerInfo info = checkHeader(header);
+        if (info.format != format)
+        {
+            throw std::runtime_error(filename + (format == QuFile::npy ? " is not a npy file" : " is not a raw tensor file"));
+        }
+
+        if (info.format == QuFile::raw || (npyIsObject && info.fortranOrder))
+        {
+            // 直接读入张量的存储
+            file.read(reinterpret_cast<char *>(tensor.data.data()), elemSize * sizeof(elem_t));
+        }
+        else
+        {
+            std::vector<std::byte> buffer(chunkElems * element::itemSize);
+            for (size_t begin = 0; begin < elemSize && file; begin += chunkElems)
+            {
+                const size_t count = std::min(chunkElems, elemSize - begin);
+                file.read(reinterpret_cast<char *>(buffer.data()), count * element::itemSize);
+                for (size_t i = 0; i < count; i++)
+                {
+                    element::load(buffer.data() + i * element::itemSize, tensor.data[info.fortranOrder ? begin + i : fromCOrder(begin + i)]);
+                }
+            }
+        }
+
+        if (!file)
+        {
+            throw std::runtime_error("Truncated payload in " + filename);
+        }
+    }
+};
+
+// 按列主序分段写入张量文件，元素总数可以超过内存能容纳的大小
+// QuFileWriter<Qu<dim<1 << 16, 1 << 16>, T>> writer("big.npy", QuFile::npy); writer.write(chunk); ... writer.close();
+template <typename TensorT>
+class QuFileWriter
+{
+public:
+    using io_t = QuFile_s<TensorT>;
+    using elem_t = typename TensorT::elem_t;
+    static constexpr size_t elemSize = TensorT::elemSize;
+
+    QuFileWriter(const std::string &filename, QuFile fileFormat = QuFile::raw)
+        : file(filename, std::ios::binary | std::ios::trunc), format(fileFormat)
+    {
+        if (!file)
+        {
+            throw std::runtime_error("Cannot open " + filename);
+        }
+        const std::string header = fileFormat == QuFile::npy ? io_t::npyHeader() : io_t::rawHeader();
+        file.write(header.data(), header.size());
+    }
+
+    QuFileWriter(const QuFileWriter &) = delete;
+    QuFileWriter &operator=(const QuFileWriter &) = delete;
+
+    ~QuFileWriter()
+    {
+        if (file.is_open())
+        {
+            file.close();
+        }
+    }
+
+    // 追加接下来的一段元素
+    void write(std::span<const elem_t> chunk)
+    {
+        if (written + chunk.size() > elemSize)
+        {
+            throw std::invalid_argument("More elements written than the tensor holds.");
+        }
+
+        if (format == QuFile::raw || io_t::npyIsObject)
+        {
+            file.write(reinterpret_cast<const char *>(chunk.data()), chunk.size() * sizeof(elem_t));
+        }
+        else
+        {
+            using element = typename io_t::element;
+            std::vector<std::byte> buffer(std::min(chunk.size(), io_t::chunkElems) * element::itemSize);
+            for (size_t begin = 0; begin < chunk.size(); begin += io_t::chunkElems)
+            {
+                const size_t count = std::min(io_t::chunkElems, chunk.size() - begin);
+                for (size_t i = 0; i < count; i++)
+                {
+                    element::store(chunk[begin + i], buffer.data() + i * element::itemSize);
+                }
+                file.write(reinterpret_cast<const char *>(buffer.data()), count * element::itemSize);
+            }
+        }
+
+        if (!file)
+        {
+            throw std::runtime_error("Failed to write the tensor file.");
+        }
+        written += chunk.size();
+    }
+
+    // 写完所有元素后关闭文件
+    void close()
+    {
+        file.close();
+        if (written != elemSize)
+        {
+            throw std::runtime_error("Tensor file closed after " + std::to_string(written) + " of " + std::to_string(elemSize) + " elements.");
+        }
+        if (!file)
+        {
+            throw std::runtime_error("Failed to write the tensor file.");
+        }
+    }
+
+    size_t written = 0;
+
+private:
+    std::ofstream file;
+    QuFile format;
+};
+
+template <size_t... dims, typename Arg>
+    requires(isA<Arg, Qu_s<>>)
+inline void Qu_s<dim<dims...>, Arg>::toNpy(const std::string &filename) const
+{
+    QuFileWriter<Qu_s> writer(filename, QuFile::npy);
+    writer.write(data);
+    writer.close();
+}
+
+template <size_t... dims, typename Arg>
+    requires(isA<Arg, Qu_s<>>)
+inline void Qu_s<dim<dims...>, Arg>::fromNpy(const std::string &filename)
+{
+    QuFile_s<Qu_s>::load(*this, filename, QuFile::npy);
+}
+
+template <size_t... dims, typename Arg>
+    requires(isA<Arg, Qu_s<>>)
+inline void Qu_s<dim<dims...>, Arg>::toRaw(const std::string &filename) const
+{
+    QuFileWriter<Qu_s> writer(filename, QuFile::raw);
+    writer.write(data);
+    writer.close();
+}
+
+template <size_t... dims, typename Arg>
+    requires(isA<Arg, Qu_s<>>)
+inline void Qu_s<dim<dims...>, Arg>::fromRaw(const std::string &filename)
+{
+    QuFile_s<Qu_s>::load(*this, filename, QuFile::raw);
+}
+
+// 只读映射 raw 文件（或元素与内存布局相同、fortran_order 的 npy 文件），元素直接指向映射的内存
+template <typename TensorT>
+class QuMapped
+{
+public:
+    using io_t = QuFile_s<TensorT>;
+    using size = typename TensorT::size;
+    using elem_t = typename TensorT::elem_t;
+    static constexpr size_t elemSize = TensorT::elemSize;
+    static constexpr size_t dimSize = TensorT::dimSize;
+
+    explicit QuMapped(const std::string &filename)
+    {
+        const int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw std::runtime_error("Cannot open " + filename);
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size == 0)
+        {
+            ::close(fd);
+            throw std::runtime_error("Cannot map " + filename);
+        }
+
+        mappedBytes = static_cast<size_t>(st.st_size);
+        mapping = ::mmap(nullptr, mappedBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED)
+        {
+            mapping = nullptr;
+            throw std::runtime_error("Cannot map " + filename);
+        }
+
+        try
+        {
+            const std::string_view bytes(static_cast<const char *>(mapping), mappedBytes);
+            const size_t headerBytes = io_t::headerLength(bytes);
+            if (headerBytes > mappedBytes)
+            {
+                throw std::runtime_error("Truncated header in " + filename);
+            }
+
+            const auto info = io_t::checkHeader(bytes.substr(0, headerBytes));
+            if (info.format == QuFile::npy && !(io_t::npyIsObject && info.fortranOrder))
+            {
+                throw std::runtime_error(filename + " cannot be mapped, its elements differ from the in-memory layout");
+            }
+            if (info.payloadOffset + elemSize * sizeof(elem_t) > mappedBytes || info.payloadOffset % alignof(elem_t) != 0)
+            {
+                throw std::runtime_error("Truncated payload in " + filename);
+            }
+
+            elems = reinterpret_cast<const elem_t *>(static_cast<const std::byte *>(mapping) + info.payloadOffset);
+        }
+        catch (...)
+        {
+            ::munmap(mapping, mappedBytes);
+            throw;
+        }
+    }
+
+    QuMapped(const QuMapped &) = delete;
+    QuMapped &operator=(const QuMapped &) = delete;
+
+    QuMapped(QuMapped &&other) noexcept
+        : mapping(std::exchange(other.mapping, nullptr)), mappedBytes(other.mappedBytes), elems(std::exchange(other.elems, nullptr)) {}
+
+    ~QuMapped()
+    {
+        if (mapping)
+        {
+            ::munmap(mapping, mappedBytes);
+        }
+    }
+
+    inline const elem_t &operator[](size_t index) const
+    {
+        return elems[index];
+    }
+
+    inline const elem_t &operator[](auto... index) const
+        requires(sizeof...(index) == dimSize && dimSize > 1)
+    {
+        size_t linear = 0, stride = 1, d = 0;
+        ((linear += static_cast<size_t>(index) * stride, stride *= size::dimArray[d++]), ...);
+        return elems[linear];
+    }
+
+    inline std::span<const elem_t, elemSize> span() const
+    {
+        return std::span<const elem_t, elemSize>(elems, elemSize);
+    }
+
+    // 拷贝成张量时整段复制
+    template <typename OutputIt>
+    inline OutputIt copyTo(OutputIt out) const
+    {
+        return std::copy(elems, elems + elemSize, out);
+    }
+
+private:
+    void *mapping = nullptr;
+    size_t mappedBytes = 0;
+    const elem_t *elems = nullptr;
+};
+
+// ------------------- Pipeline -------------------
+// 流水线：各级在各自的线程上处理固定大小的块，级间通过有界的无锁环形队列传递预先分配的块
+// 每条边有 depth 个块，下一级用完后把块还给上一级，因此峰值内存由队列深度决定，与块的总数无关
+// 并行的级按序号依次提交，所有边上的块都保持源头产生的顺序，有状态的串行级（例如 Qfir）结果与逐块串行执行一致
+
+// 单生产者单消费者的有界队列，容量向上取整为 2 的幂
+template <typename T>
+class QuSpscRing
+{
+public:
+    explicit QuSpscRing(size_t capacity) : slots(std::bit_ceil(std::max<size_t>(capacity, 1))), mask(slots.size() - 1) {}
+
+    inline size_t capacity() const
+    {
+        return slots.size();
+    }
+
+    inline bool tryPush(const T &val)
+    {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == slots.size())
+        {
+            return false;
+        }
+        slots[t & mask] = val;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
 
-            max_width = std::max(max_width, static_cast<int>(ss.str().size()));
+    inline bool tryPop(T &val)
+    {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+        {
+            return false;
         }
+        val = slots[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
 
-        // 设置固定小数点表示法和小数点后两位
-        os << std::fixed << std::setprecision(4);
+private:
+    std::vector<T> slots;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head = 0;
+    alignas(64) std::atomic<size_t> tail = 0;
+};
 
-        os << "[";
-        if constexpr (dim<dims...>::dimSize == 2)
+// 多生产者多消费者的有界队列，每个槽位带序号，生产者与消费者各自用 CAS 领取位置
+template <typename T>
+class QuMpmcRing
+{
+public:
+    explicit QuMpmcRing(size_t capacity) : cells(std::bit_ceil(std::max<size_t>(capacity, 1))), mask(cells.size() - 1)
+    {
+        for (size_t i = 0; i < cells.size(); i++)
         {
-            size_t row = dim<dims...>::template dimAt<0>;
-            size_t col = dim<dims...>::template dimAt<1>;
-
-            for (size_t i = 0; i < row; i++)
-            {
-                if (i != 0)
-                {
-                    os << ' ';
-                }
-                for (size_t j = 0; j < col; j++)
-                {
-                    os << std::setw(max_width) << std::right << val[i, j].toDouble();
+            cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
 
-                    if (j != col - 1)
-                    {
-                        os << ", ";
-                    }
-                }
+    inline size_t capacity() const
+    {
+        return cells.size();
+    }
 
-                if (i != row - 1)
+    inline bool tryPush(const T &val)
+    {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        cell *c;
+        while (true)
+        {
+            c = &cells[pos & mask];
+            const auto diff = static_cast<std::ptrdiff_t>(c->seq.load(std::memory_order_acquire) - pos);
+            if (diff == 0)
+            {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
                 {
-                    os << '\n';
+                    break;
                 }
             }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
         }
-        else
+        c->value = val;
+        c->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    inline bool tryPop(T &val)
+    {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        cell *c;
+        while (true)
         {
-            for (size_t i = 0; i < dim<dims...>::elemSize; i++)
+            c = &cells[pos & mask];
+            const auto diff = static_cast<std::ptrdiff_t>(c->seq.load(std::memory_order_acquire) - (pos + 1));
+            if (diff == 0)
             {
-                os << val[i];
-                if (i != dim<dims...>::elemSize - 1)
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
                 {
-                    os << ", ";
+                    break;
                 }
             }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
         }
-        os << "]";
-
-        // 恢复原始格式状态
-        os.flags(original_flags);
-        os.precision(original_precision);
-
-        return os;
+        val = c->value;
+        c->seq.store(pos + mask + 1, std::memory_order_release);
+        return true;
     }
 
-    void toMatlab(std::string filename)
+private:
+    struct cell
     {
-        // 如果没有带后缀，自动加上.txt
-        if (filename.find('.') == std::string::npos)
-        {
-            filename += ".txt";
-        }
+        std::atomic<size_t> seq;
+        T value;
+    };
 
-        std::ofstream file(filename);
+    std::vector<cell> cells;
+    size_t mask;
+    alignas(64) std::atomic<size_t> enqueuePos = 0;
+    alignas(64) std::atomic<size_t> dequeuePos = 0;
+};
 
-        // output to file in the matlab format
-        file << "[";
-        if constexpr (dim<dims...>::dimSize == 2)
-        {
-            size_t row = dim<dims...>::template dimAt<0>;
-            size_t col = dim<dims...>::template dimAt<1>;
+// 每条边上的块数
+template <size_t depth>
+struct QpipelineDepth
+{
+};
 
-            for (size_t i = 0; i < row; i++)
-            {
-                if (i != 0)
-                {
-                    file << ' ';
-                }
-                for (size_t j = 0; j < col; j++)
-                {
-                    file << this->operator[](i, j).toDouble();
+// 一级的执行策略：QpipelineStage<QuExec<Parallel<3>>>(func) 用 3 个线程执行无状态的 func，不包装时为单个线程
+template <typename Exec, typename Func>
+struct QpipelineStage_s
+{
+    using policy = typename Exec::policy;
+    inline static constexpr bool serial = !isParallel<policy>;
 
-                    if (j != col - 1)
-                    {
-                        file << ", ";
-                    }
-                    else
-                    {
-                        file << ";";
-                    }
-                }
+    Func func;
 
-                if (i != row - 1)
-                {
-                    file << '\n';
-                }
-            }
+    inline static size_t workers()
+    {
+        if constexpr (serial)
+        {
+            return 1;
         }
         else
         {
-            for (size_t i = 0; i < dim<dims...>::elemSize; i++)
-            {
-                file << data[i].toDouble();
-                if (i != dim<dims...>::elemSize - 1)
-                {
-                    file << ", ";
-                }
-            }
+            return policy::value == 0 ? std::max(1u, std::thread::hardware_concurrency()) : policy::value;
         }
-        file << "]";
-        file.close();
     }
 };
 
-template <typename... Args, size_t... dims>
-struct QuInputHelper<dim<dims...>, Args...>
+template <typename Exec = QuExec<Serial>, typename Func>
+inline auto QpipelineStage(Func &&func)
 {
-    using type = Qu_s<dim<dims...>, Qu<Args...>>;
-};
+    return QpipelineStage_s<Exec, std::decay_t<Func>>{std::forward<Func>(func)};
+}
 
-template <typename... Args, size_t... dims>
-struct QuInputHelper<dim<dims...>, TypeList<Args...>>
+template <typename T>
+struct pipelineStage_s
 {
-    using type = Qu_s<dim<dims...>, TypeList<Args...>>;
+    using type = QpipelineStage_s<QuExec<Serial>, T>;
+
+    inline static type wrap(T func)
+    {
+        return type{std::move(func)};
+    }
 };
 
-template <typename T>
-struct isScalar_s
+template <typename Exec, typename Func>
+struct pipelineStage_s<QpipelineStage_s<Exec, Func>>
 {
-    static inline constexpr bool value = false;
+    using type = QpipelineStage_s<Exec, Func>;
+
+    inline static type wrap(type stage)
+    {
+        return stage;
+    }
 };
 
-template <int intBitsInput, int fracBitsInput, bool isSignedInput, typename QuModeInput, typename OfModeInput>
-struct isScalar_s<Qu_s<intBits<intBitsInput>, fracBits<fracBitsInput>, isSigned<isSignedInput>, QuMode<QuModeInput>, OfMode<OfModeInput>>>
+// 从函数签名取出块的类型：源 (size_t seq, Out &)，中间级 (const In &, Out &)，终点 (const In &)
+template <typename F>
+struct pipelineArgs_s : pipelineArgs_s<decltype(&F::operator())>
 {
-    static inline constexpr bool value = true;
 };
 
-template <typename... realArgs, typename... imagArgs>
-struct isScalar_s<Qu_s<Qu_s<realArgs...>, Qu_s<imagArgs...>>>
+template <typename R, typename... A>
+struct pipelineArgs_s<R (*)(A...)>
 {
-    static inline constexpr bool value = true;
+    inline static constexpr size_t arity = sizeof...(A);
+    using last = std::remove_cvref_t<typename decltype((std::type_identity<A>(), ...))::type>;
 };
 
-template <typename QuT, size_t... dims>
-struct isScalar_s<Qu_s<dim<dims...>, QuT>>
+template <typename C, typename R, typename... A>
+struct pipelineArgs_s<R (C::*)(A...)> : pipelineArgs_s<R (*)(A...)>
 {
-    static inline constexpr bool value = false;
 };
 
-template <typename T>
-inline constexpr bool isScalar = isScalar_s<T>::value;
-
-// ------------------- Basic Operations -------------------
-struct FullPrec;
-
-template <typename... Args>
-struct MergerArgsWrapper_s
+template <typename C, typename R, typename... A>
+struct pipelineArgs_s<R (C::*)(A...) const> : pipelineArgs_s<R (*)(A...)>
 {
-    using type = TypeList<Args...>;
 };
 
-template <typename... Args>
-struct MergerArgsWrapper_s<TypeList<Args...>>
+// 相邻两级之间的边：预先分配的块、对应的序号，以及已填好与空闲块的下标队列
+template <typename BlockT, bool single>
+struct QpipelineEdge
 {
-    using type = TypeList<Args...>;
-};
+    using ring_t = std::conditional_t<single, QuSpscRing<size_t>, QuMpmcRing<size_t>>;
 
-template <typename... Args>
-struct MergerArgsWrapper_s<MergerArgsWrapper_s<Args...>> : MergerArgsWrapper_s<Args...>
-{};
+    std::vector<BlockT> blocks;
+    std::vector<size_t> seqs;
+    ring_t ready;
+    ring_t free;
 
-template <int intB, int fracB, bool isS, typename QuM, typename OfM>
-struct MergerArgsWrapper_s<Qu_s<intBits<intB>, fracBits<fracB>, isSigned<isS>, QuMode<QuM>, OfMode<OfM>>> : MergerArgsWrapper_s<intBits<intB>, fracBits<fracB>, isSigned<isS>, QuMode<QuM>, OfMode<OfM>>
-{};
+    // 生产者已按顺序提交的块数
+    alignas(64) std::atomic<size_t> committed = 0;
 
-template <typename... Args>
-using MergerArgsWrapper = typename MergerArgsWrapper_s<Args...>::type;
+    explicit QpipelineEdge(size_t depth) : blocks(depth), seqs(depth), ready(depth), free(depth)
+    {
+        for (size_t i = 0; i < depth; i++)
+        {
+            free.tryPush(i);
+        }
+    }
+};
 
 template <typename... Args>
-struct MulMerger;
-
-template <typename... toArgs, int fromInt1, int fromFrac1, bool fromIsSigned1, typename fromQuMode1, typename fromOfMode1, int fromInt2, int fromFrac2, bool fromIsSigned2, typename fromQuMode2, typename fromOfMode2>
-struct MulMerger<Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>>, Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>>, TypeList<toArgs...>>
+class Qpipeline
 {
-    static inline constexpr bool fullPrecision = (std::is_same_v<FullPrec, toArgs> || ...);
-    using fromQuMode = std::conditional_t<std::is_same_v<fromQuMode1, fromQuMode2>, fromQuMode1, defaultQuMode>;
-    using fromOfMode = std::conditional_t<std::is_same_v<fromOfMode1, fromOfMode2>, fromOfMode1, defaultOfMode>;
+public:
+    inline static constexpr size_t depth = tagExtractor<QpipelineDepth<4>, Args...>::value;
 
-    static inline constexpr auto toInt = tagExtractor<intBits<fullPrecision ? fromInt1 + fromInt2 : std::max(fromInt1, fromInt2)>, toArgs...>::value;
-    static inline constexpr auto toFrac = tagExtractor<fracBits<fullPrecision ? fromFrac1 + fromFrac2 : std::max(fromFrac1, fromFrac2)>, toArgs...>::value;
-    static inline constexpr auto toIsSigned = tagExtractor<isSigned<fromIsSigned1 || fromIsSigned2>, toArgs...>::value;
-    using toQuMode = tagExtractor<QuMode<fromQuMode>, toArgs...>::type;
-    using toOfMode = tagExtractor<OfMode<fromOfMode>, toArgs...>::type;
+    static_assert(depth > 0, "The pipeline needs at least one block per edge.");
 
-    using resType = Qu_s<intBits<toInt>, fracBits<toFrac>, isSigned<toIsSigned>, QuMode<toQuMode>, OfMode<toOfMode>>;
-};
+    // 处理 blocks 个块：stages 依次为源、若干中间级与终点，任何一级抛出的异常在所有线程退出后重新抛出
+    template <typename... Stages>
+    static void run(size_t blocks, Stages &&...stages)
+    {
+        static_assert(sizeof...(Stages) >= 2, "A pipeline needs a source and a sink.");
 
-template <typename... Args>
-struct AddMerger;
-template <typename... toArgs, int fromInt1, int fromFrac1, bool fromIsSigned1, typename fromQuMode1, typename fromOfMode1, int fromInt2, int fromFrac2, bool fromIsSigned2, typename fromQuMode2, typename fromOfMode2>
-struct AddMerger<Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>>, Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>>, TypeList<toArgs...>>
-{
-    static inline constexpr bool fullPrecision = (std::is_same_v<FullPrec, toArgs> || ...);
+        std::tuple<typename pipelineStage_s<std::decay_t<Stages>>::type...> wrapped(pipelineStage_s<std::decay_t<Stages>>::wrap(std::forward<Stages>(stages))...);
+        execute(blocks, wrapped, std::make_index_sequence<sizeof...(Stages) - 1>());
+    }
 
-    using fromQuMode = std::conditional_t<std::is_same_v<fromQuMode1, fromQuMode2>, fromQuMode1, defaultQuMode>;
-    using fromOfMode = std::conditional_t<std::is_same_v<fromOfMode1, fromOfMode2>, fromOfMode1, defaultOfMode>;
+private:
+    template <typename StagesT, size_t E>
+    using edge_t = QpipelineEdge<typename pipelineArgs_s<decltype(std::tuple_element_t<E, StagesT>::func)>::last, std::tuple_element_t<E, StagesT>::serial && std::tuple_element_t<E + 1, StagesT>::serial>;
 
-    static inline constexpr auto toInt = tagExtractor<intBits<fullPrecision ? std::max(fromInt1, fromInt2) + 1 : std::max(fromInt1, fromInt2)>, toArgs...>::value;
-    static inline constexpr auto toFrac = tagExtractor<fracBits<std::max(fromFrac1, fromFrac2)>, toArgs...>::value;
-    static inline constexpr auto toIsSigned = tagExtractor<isSigned<fromIsSigned1 || fromIsSigned2>, toArgs...>::value;
-    using toQuMode = tagExtractor<QuMode<fromQuMode>, toArgs...>::type;
-    using toOfMode = tagExtractor<OfMode<fromOfMode>, toArgs...>::type;
+    struct control
+    {
+        std::atomic<bool> abort = false;
+        std::mutex mutex;
+        std::exception_ptr error;
+    };
 
-    using resType = Qu_s<intBits<toInt>, fracBits<toFrac>, isSigned<toIsSigned>, QuMode<toQuMode>, OfMode<toOfMode>>;
-};
+    // 队列为空时先自旋再让出时间片，其他级出错时放弃等待
+    template <typename Ring>
+    inline static bool popWait(Ring &ring, size_t &val, const control &ctl)
+    {
+        for (size_t spin = 0; !ring.tryPop(val); spin++)
+        {
+            if (ctl.abort.load(std::memory_order_relaxed))
+            {
+                return false;
+            }
+            if (spin > 64)
+            {
+                std::this_thread::yield();
+            }
+        }
+        return true;
+    }
 
-template <typename... Args>
-struct Qmul_s;
+    // 每条边的容量不小于块数，入队不会失败
+    template <typename Ring>
+    inline static void push(Ring &ring, size_t val)
+    {
+        while (!ring.tryPush(val))
+        {
+            std::this_thread::yield();
+        }
+    }
 
-// specialization for both inputs being static Qu_s
-template <typename... toArgs, int fromInt1, int fromFrac1, bool fromIsSigned1, typename fromQuMode1, typename fromOfMode1, int fromInt2, int fromFrac2, bool fromIsSigned2, typename fromQuMode2, typename fromOfMode2>
-struct Qmul_s<Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>>, Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>>, TypeList<toArgs...>>
-{
+    template <size_t I, typename StagesT, typename EdgesT>
+    static void worker(size_t blocks, StagesT &stages, EdgesT &edges, std::atomic<size_t> &tickets, control &ctl)
+    {
+        constexpr size_t last = std::tuple_size_v<StagesT> - 1;
+        auto &stage = std::get<I>(stages);
 
-    using merger = MulMerger<Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>>, Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>>, TypeList<toArgs...>>;
+        for (size_t t = tickets.fetch_add(1); t < blocks; t = tickets.fetch_add(1))
+        {
+            size_t outSlot = 0;
+            size_t inSlot = 0;
+            size_t seq = t;
+
+            // 先占住输出块再取输入，取到最早序号的线程一定能完成并提交
+            if constexpr (I < last)
+            {
+                if (!popWait(std::get<I>(edges)->free, outSlot, ctl))
+                {
+                    return;
+                }
+            }
+            if constexpr (I > 0)
+            {
+                auto &in = *std::get<I - 1>(edges);
+                if (!popWait(in.ready, inSlot, ctl))
+                {
+                    return;
+                }
+                seq = in.seqs[inSlot];
+            }
+
+            if constexpr (I == 0)
+            {
+                stage.func(seq, std::get<0>(edges)->blocks[outSlot]);
+            }
+            else if constexpr (I < last)
+            {
+                stage.func(std::as_const(std::get<I - 1>(edges)->blocks[inSlot]), std::get<I>(edges)->blocks[outSlot]);
+            }
+            else
+            {
+                stage.func(std::as_const(std::get<I - 1>(edges)->blocks[inSlot]));
+            }
+
+            if constexpr (I > 0)
+            {
+                push(std::get<I - 1>(edges)->free, inSlot);
+            }
+            if constexpr (I < last)
+            {
+                auto &out = *std::get<I>(edges);
+                out.seqs[outSlot] = seq;
+                while (out.committed.load(std::memory_order_acquire) != seq)
+                {
+                    if (ctl.abort.load(std::memory_order_relaxed))
+                    {
+                        return;
+                    }
+                    std::this_thread::yield();
+                }
+                push(out.ready, outSlot);
+                out.committed.store(seq + 1, std::memory_order_release);
+            }
+        }
+    }
 
-    inline static constexpr auto mul(const Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>> f1, const Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>> f2)
+    template <typename StagesT, size_t... E>
+    static void execute(size_t blocks, StagesT &stages, std::index_sequence<E...>)
     {
-        // print the debug info
-        // std::cout << "mul: " << merger::toInt << " " << merger::toFrac << " " << std::endl;
-
-        auto fullProduct = f1.data * f2.data;
+        constexpr size_t numStages = sizeof...(E) + 1;
 
-        auto fracProduct = fracConvert<fromFrac1 + fromFrac2, merger::toFrac, QuMode<typename merger::toQuMode>>::convert(fullProduct);
-
-        auto intProduct = intConvert<merger::toInt, merger::toFrac, merger::toIsSigned, OfMode<typename merger::toOfMode>>::convert(fracProduct);
+        // 原子量不能移动，边放在堆上
+        auto edges = std::make_tuple(std::make_unique<edge_t<StagesT, E>>(depth)...);
+        std::array<std::atomic<size_t>, numStages> tickets{};
+        control ctl;
 
-        Qu_s<intBits<merger::toInt>, fracBits<merger::toFrac>, isSigned<merger::toIsSigned>, QuMode<typename merger::toQuMode>, OfMode<typename merger::toOfMode>> result;
-        result.data = intProduct;
+        std::vector<std::thread> threads;
+        auto launch = [&]<size_t I>(std::integral_constant<size_t, I>) {
+            for (size_t w = 0; w < std::tuple_element_t<I, StagesT>::workers(); w++)
+            {
+                threads.emplace_back([&] {
+                    try
+                    {
+                        worker<I>(blocks, stages, edges, tickets[I], ctl);
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard lock(ctl.mutex);
+                        if (!ctl.error)
+                        {
+                            ctl.error = std::current_exception();
+                        }
+                        ctl.abort = true;
+                    }
+                });
+            }
+        };
 
-        // debug info
-        // std::cout << f1.toDouble() << " * " << f2.toDouble() << " = " << result.toDouble() << std::endl;
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            (launch(std::integral_constant<size_t, I>()), ...);
+        }(std::make_index_sequence<numStages>());
 
-        return result;
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+        if (ctl.error)
+        {
+            std::rethrow_exception(ctl.error);
+        }
     }
 };
 
-template <typename... Args>
-struct Qadd_s;
-
-// specialization for both inputs being static Qu_s
-template <typename... toArgs, int fromInt1, int fromFrac1, bool fromIsSigned1, typename fromQuMode1, typename fromOfMode1, int fromInt2, int fromFrac2, bool fromIsSigned2, typename fromQuMode2, typename fromOfMode2>
-struct Qadd_s<Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>>, Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>>, TypeList<toArgs...>>
+// 双缓冲的异步写出：调用线程填满一个缓冲区后与另一个交换，后台线程把交换出去的缓冲区交给 sink
+// sink 抛出的异常在下一次交换或 flush 时重新抛出
+template <typename T>
+class QuAsyncBuffer
 {
-    using merger = AddMerger<Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>>, Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>>, TypeList<toArgs...>>;
-
-    static inline constexpr int shiftA = fromFrac2 > fromFrac1 ? fromFrac2 - fromFrac1 : 0;
-    static inline constexpr int shiftB = fromFrac1 > fromFrac2 ? fromFrac1 - fromFrac2 : 0;
-
-    inline static constexpr auto add(const Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>> f1, const Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>> f2)
+public:
+    QuAsyncBuffer(size_t bufferCapacity, std::function<void(std::span<const T>)> bufferSink) : capacity(std::max<size_t>(bufferCapacity, 1)), sink(std::move(bufferSink))
     {
-        // print the requesting Quantization parameters for debugging
-        // std::cout << "add: " << merger::toInt << " " << merger::toFrac << " " << std::endl;
-
-        auto fullSum = staticShiftLeft<shiftA>(f1.data) + staticShiftLeft<shiftB>(f2.data);
-
-        auto fracSum = fracConvert<std::max(fromFrac1, fromFrac2), merger::toFrac, QuMode<typename merger::toQuMode>>::convert(fullSum);
+        front.reserve(capacity);
+        back.reserve(capacity);
+        thread = std::thread([this] { loop(); });
+    }
 
-        auto intSum = intConvert<merger::toInt, merger::toFrac, merger::toIsSigned, OfMode<typename merger::toOfMode>>::convert(fracSum);
+    QuAsyncBuffer(const QuAsyncBuffer &) = delete;
+    QuAsyncBuffer &operator=(const QuAsyncBuffer &) = delete;
 
-        Qu_s<intBits<merger::toInt>, fracBits<merger::toFrac>, isSigned<merger::toIsSigned>, QuMode<typename merger::toQuMode>, OfMode<typename merger::toOfMode>> result;
-        result.data = intSum;
+    // 与 flush 相同地写出剩余的数据，析构函数无法报告 sink 的异常，只能丢弃
+    ~QuAsyncBuffer()
+    {
+        try
+        {
+            flush();
+        }
+        catch (...)
+        {
+        }
 
-        // debug info
-        // std::cout << f1.toDouble() << " + " << f2.toDouble() << " = " << result.toDouble() << std::endl;
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        thread.join();
+    }
 
-        return result;
+    void push(std::span<const T> items)
+    {
+        while (!items.empty())
+        {
+            const size_t take = std::min(capacity - front.size(), items.size());
+            front.insert(front.end(), items.begin(), items.begin() + take);
+            items = items.subspan(take);
+            if (front.size() == capacity)
+            {
+                submit();
+            }
+        }
     }
-};
 
-template <typename... Args>
-struct Qsub_s;
+    // 交出剩余的数据并等待后台线程写完
+    void flush()
+    {
+        if (!front.empty())
+        {
+            submit();
+        }
+        std::unique_lock lock(mutex);
+        idle.wait(lock, [&] { return !busy; });
+        if (error)
+        {
+            std::rethrow_exception(std::exchange(error, nullptr));
+        }
+    }
 
-// specialization for both inputs being static Qu_s
-template <typename... toArgs, int fromInt1, int fromFrac1, bool fromIsSigned1, typename fromQuMode1, typename fromOfMode1, int fromInt2, int fromFrac2, bool fromIsSigned2, typename fromQuMode2, typename fromOfMode2>
-    requires(!isA<typename TypeList<toArgs...>::head, Qu_s<>>)
-struct Qsub_s<Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>>, Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>>, TypeList<toArgs...>>
-{
-    using merger = AddMerger<Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>>, Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>>, TypeList<toArgs...>>;
+private:
+    size_t capacity;
+    std::function<void(std::span<const T>)> sink;
+    std::vector<T> front;
+    std::vector<T> back;
 
-    static inline constexpr int shiftA = fromFrac2 > fromFrac1 ? fromFrac2 - fromFrac1 : 0;
-    static inline constexpr int shiftB = fromFrac1 > fromFrac2 ? fromFrac1 - fromFrac2 : 0;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    bool busy = false;
+    bool stopping = false;
+    std::exception_ptr error;
+    std::thread thread;
 
-    inline static constexpr auto sub(const Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>> f1, const Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>> f2)
+    void submit()
     {
-        // // print the requesting Quantization parameters for debugging
-        // std::cout << "sub: " << merger::toInt << " " << merger::toFrac << " " << std::endl;
-
-        auto fullDiff = staticShiftLeft<shiftA>(f1.data) - staticShiftLeft<shiftB>(f2.data);
-
-        auto fracDiff = fracConvert<std::max(fromFrac1, fromFrac2), merger::toFrac, QuMode<typename merger::toQuMode>>::convert(fullDiff);
+        {
+            std::unique_lock lock(mutex);
+            idle.wait(lock, [&] { return !busy; });
+            if (error)
+            {
+                std::rethrow_exception(std::exchange(error, nullptr));
+            }
+            std::swap(front, back);
+            busy = true;
+        }
+        front.clear();
+        wake.notify_one();
+    }
 
-        auto intDiff = intConvert<merger::toInt, merger::toFrac, merger::toIsSigned, OfMode<typename merger::toOfMode>>::convert(fracDiff);
+    void loop()
+    {
+        std::unique_lock lock(mutex);
+        while (true)
+        {
+            wake.wait(lock, [&] { return busy || stopping; });
+            if (!busy)
+            {
+                return;
+            }
 
-        Qu_s<intBits<merger::toInt>, fracBits<merger::toFrac>, isSigned<merger::toIsSigned>, QuMode<typename merger::toQuMode>, OfMode<typename merger::toOfMode>> result;
-        result.data = intDiff;
+            lock.unlock();
+            try
+            {
+                sink(std::span<const T>(back));
+            }
+            catch (...)
+            {
+                lock.lock();
+                error = std::current_exception();
+                lock.unlock();
+            }
+            lock.lock();
 
-        return result;
+            busy = false;
+            idle.notify_all();
+        }
     }
 };
 
-template <typename... Args>
-struct Qdiv_s;
-
-// specialization for both inputs being static Qu_s
-template <typename... toArgs, int fromInt1, int fromFrac1, bool fromIsSigned1, typename fromQuMode1, typename fromOfMode1, int fromInt2, int fromFrac2, bool fromIsSigned2, typename fromQuMode2, typename fromOfMode2>
-    requires(!isA<typename TypeList<toArgs...>::head, Qu_s<>>)
-struct Qdiv_s<Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>>, Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>>, TypeList<toArgs...>>
+// 与 QuFileWriter 接口相同，文件写入在后台线程中与下一段数据的生成重叠
+template <typename TensorT>
+class QuAsyncFileWriter
 {
-    using merger = AddMerger<Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>>, Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>>, TypeList<toArgs...>>;
+public:
+    using elem_t = typename TensorT::elem_t;
+    static constexpr size_t elemSize = TensorT::elemSize;
 
-    static inline constexpr int shiftA = fromFrac2 > fromFrac1 ? fromFrac2 - fromFrac1 : 0;
-    static inline constexpr int shiftB = fromFrac1 > fromFrac2 ? fromFrac1 - fromFrac2 : 0;
+    QuAsyncFileWriter(const std::string &filename, QuFile format = QuFile::raw, size_t bufferElems = QuFile_s<TensorT>::chunkElems)
+        : writer(filename, format), buffer(bufferElems, [this](std::span<const elem_t> chunk) { writer.write(chunk); })
+    {
+    }
 
-    inline static constexpr auto div(const Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>> f1, const Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>> f2)
+    void write(std::span<const elem_t> chunk)
     {
-        if (f2.data == 0)
+        if (written + chunk.size() > elemSize)
         {
-            return Qu_s<intBits<merger::toInt>, fracBits<merger::toFrac>, isSigned<merger::toIsSigned>, QuMode<typename merger::toQuMode>, OfMode<typename merger::toOfMode>>();
+            throw std::invalid_argument("More elements written than the tensor holds.");
         }
+        buffer.push(chunk);
+        written += chunk.size();
+    }
 
-        auto fullQuotient = staticShiftLeft<shiftA + merger::toFrac>(f1.data) / staticShiftLeft<shiftB>(f2.data);
-
-        auto intQuotient = intConvert<merger::toInt, merger::toFrac, merger::toIsSigned, OfMode<typename merger::toOfMode>>::convert(fullQuotient);
+    void close()
+    {
+        buffer.flush();
+        writer.close();
+    }
 
-        Qu_s<intBits<merger::toInt>, fracBits<merger::toFrac>, isSigned<merger::toIsSigned>, QuMode<typename merger::toQuMode>, OfMode<typename merger::toOfMode>> result;
-        result.data = intQuotient;
+    size_t written = 0;
 
-        return result;
-    }
+private:
+    QuFileWriter<TensorT> writer;
+    QuAsyncBuffer<elem_t> buffer;
 };
 
-// abs
-template <typename... Args>
-struct Qabs_s;
-
-// specialization for static Qu_s
-template <typename... toArgs, int fromInt, int fromFrac, bool fromIsSigned, typename fromQuMode, typename fromOfMode>
-struct Qabs_s<Qu_s<intBits<fromInt>, fracBits<fromFrac>, isSigned<fromIsSigned>, QuMode<fromQuMode>, OfMode<fromOfMode>>, TypeList<toArgs...>>
+// BitStream 字符串与 BitPack 缓冲区的异步写出
+class QuAsyncStream
 {
-
-    inline static constexpr auto abs(const Qu_s<intBits<fromInt>, fracBits<fromFrac>, isSigned<fromIsSigned>, QuMode<fromQuMode>, OfMode<fromOfMode>> f)
+public:
+    explicit QuAsyncStream(const std::string &filename, size_t bufferBytes = size_t(1) << 20)
+        : file(filename, std::ios::binary | std::ios::trunc), buffer(bufferBytes, [this](std::span<const char> bytes) {
+              file.write(bytes.data(), bytes.size());
+              if (!file)
+              {
+                  throw std::runtime_error("Failed to write the stream file.");
+              }
+          })
     {
-        if constexpr (!fromIsSigned)
+        if (!file)
         {
-            return f;
+            throw std::runtime_error("Cannot open " + filename);
         }
-        else
-        {
+    }
 
-            Qu_s<intBits<fromInt + 1>, fracBits<fromFrac>, isSigned<fromIsSigned>, QuMode<fromQuMode>, OfMode<fromOfMode>> result;
+    void write(std::string_view text)
+    {
+        buffer.push(std::span<const char>(text.data(), text.size()));
+    }
 
-            if (f.data.isNegative())
-            {
-                result.data = -f.data;
-            }
-            else
-            {
-                result.data = f.data;
-            }
+    template <typename Word>
+    void write(std::span<const Word> words)
+    {
+        buffer.push(std::span<const char>(reinterpret_cast<const char *>(words.data()), words.size_bytes()));
+    }
 
-            return result;
+    void close()
+    {
+        buffer.flush();
+        file.close();
+        if (!file)
+        {
+            throw std::runtime_error("Failed to write the stream file.");
         }
     }
+
+private:
+    std::ofstream file;
+    QuAsyncBuffer<char> buffer;
 };
 
-// neg
-template <typename... Args>
-struct Qneg_s;
+// ------------------- Advanced Nonlinear Universal Subprograms -------------------
+// the operations like lookup table, linear/polynomial fitting, etc. used to implement the non-linear operation in asic
+// note that the operations are not standard BLAS operations, use ANUS:: to get access to them
 
-// specialization for static Qu_s
-template <typename... toArgs, int fromInt, int fromFrac, bool fromIsSigned, typename fromQuMode, typename fromOfMode>
-struct Qneg_s<Qu_s<intBits<fromInt>, fracBits<fromFrac>, isSigned<fromIsSigned>, QuMode<fromQuMode>, OfMode<fromOfMode>>, TypeList<toArgs...>>
+namespace ANUS {
+
+// polynomial fitting
+template <auto a0>
+inline static constexpr auto Qpoly(auto x)
 {
-    inline static constexpr auto neg(const Qu_s<intBits<fromInt>, fracBits<fromFrac>, isSigned<fromIsSigned>, QuMode<fromQuMode>, OfMode<fromOfMode>> f)
-    {
-        Qu_s<intBits<fromInt + 1>, fracBits<fromFrac>, isSigned<fromIsSigned>, QuMode<fromQuMode>, OfMode<fromOfMode>> result;
-        result.data = -f.data;
+    return a0;
+}
 
-        return result;
+// return a0 + a1 * x + a2 * x^2 + ...
+template <auto a0, auto a1, auto... as>
+inline static constexpr auto Qpoly(auto x)
+{
+    return Qadd<decltype(a0)>(
+        a0,
+        Qmul<decltype(a0)>(
+            x,
+            Qpoly<a1, as...>(x)));
+}
+
+// segmented linear fitting
+template <double BreakPoint, auto... as>
+struct Segment
+{
+    static constexpr double breakpoint = BreakPoint;
+
+    inline static constexpr auto func(auto x)
+    {
+        return Qpoly<as...>(x);
     }
 };
 
-// specialization for complex
-template <typename... toArgs, typename... realArgs, typename... imagArgs>
-struct Qneg_s<Qu_s<Qu_s<realArgs...>, Qu_s<imagArgs...>>, TypeList<toArgs...>>
+// 分段选择器：断点预先量化为与输入同一刻度的整数，x < breakpoint 等价于 raw(x) < ceil(breakpoint * 2^fracB)
+// 于是选段只需在整数表上做一次二分查找，再通过函数指针表直接跳转到对应的分段
+template <typename InT, typename... Segments>
+struct QapproxDispatcher
 {
-    inline static auto neg(const Qu_s<Qu_s<realArgs...>, Qu_s<imagArgs...>> f)
+    inline static constexpr size_t segNum = sizeof...(Segments);
+    inline static constexpr size_t rawWidth = 1 + InT::intB + InT::fracB;
+
+    // 超过 63 位时退回到逐段比较 double
+    inline static constexpr bool rawCompare = rawWidth <= 63;
+
+    inline static constexpr std::array<double, segNum> breakpoints = {Segments::breakpoint...};
+
+    inline static constexpr int64_t quantizeBreakpoint(double bp)
     {
-        auto realNeg = Qneg<toArgs...>(f.real);
-        auto imagNeg = Qneg<toArgs...>(f.imag);
-        return Qcomplex<decltype(realNeg), decltype(imagNeg)>(realNeg, imagNeg);
+        double scaled = bp;
+        for (int i = 0; i < InT::fracB; i++)
+        {
+            scaled *= 2.0;
+        }
+        for (int i = 0; i > InT::fracB; i--)
+        {
+            scaled *= 0.5;
+        }
+
+        const double hi = static_cast<double>(int64_t(1) << (rawWidth - 1));
+        if (scaled != scaled || scaled >= hi)
+        {
+            return static_cast<int64_t>(hi);
+        }
+        if (scaled <= -hi)
+        {
+            return static_cast<int64_t>(-hi);
+        }
+        return static_cast<int64_t>(std::ceil(scaled));
     }
-};
 
-template <typename... Args>
-struct Qcmp_s;
+    // 取前缀最大值，使阈值单调，二分查找与原本的顺序比较结果一致
+    inline static constexpr std::array<int64_t, segNum> thresholds = [] {
+        std::array<int64_t, segNum> res{};
+        if constexpr (rawCompare)
+        {
+            for (size_t i = 0; i < segNum; i++)
+            {
+                res[i] = quantizeBreakpoint(breakpoints[i]);
+                if (i > 0)
+                {
+                    res[i] = std::max(res[i], res[i - 1]);
+                }
+            }
+        }
+        return res;
+    }();
 
-// specialization for static Qu_s
-template <typename... toArgs, int fromInt1, int fromFrac1, bool fromIsSigned1, typename fromQuMode1, typename fromOfMode1, int fromInt2, int fromFrac2, bool fromIsSigned2, typename fromQuMode2, typename fromOfMode2>
-struct Qcmp_s<Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>>, Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>>, TypeList<toArgs...>>
-{
-    static inline constexpr int shiftA = fromFrac2 > fromFrac1 ? fromFrac2 - fromFrac1 : 0;
-    static inline constexpr int shiftB = fromFrac1 > fromFrac2 ? fromFrac1 - fromFrac2 : 0;
+    // 第一个满足 x < breakpoint 的分段，全部不满足时使用最后一段
+    inline static constexpr size_t segmentIndex(const InT &x)
+    {
+        if constexpr (rawCompare)
+        {
+            // 无分支的二分查找，循环次数只取决于分段数，可编译为条件传送
+            const auto raw = static_cast<int64_t>(x.data.data);
+            const int64_t *base = thresholds.data();
+            size_t len = segNum - 1;
+            if (len == 0)
+            {
+                return 0;
+            }
+            while (len > 1)
+            {
+                const size_t half = len / 2;
+                base = base[half] <= raw ? base + half : base;
+                len -= half;
+            }
+            return static_cast<size_t>(base - thresholds.data()) + (*base <= raw);
+        }
+        else
+        {
+            const double val = x.toDouble();
+            for (size_t i = 0; i + 1 < segNum; i++)
+            {
+                if (val < breakpoints[i])
+                {
+                    return i;
+                }
+            }
+            return segNum - 1;
+        }
+    }
 
-    inline static constexpr auto cmp(const Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>> f1, const Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>> f2)
+    template <size_t I>
+    inline static constexpr InT evalSegment(InT x)
     {
-        return staticShiftLeft<shiftA>(f1.data) <=> staticShiftLeft<shiftB>(f2.data);
+        return InT{TypeAt<I, TypeList<Segments...>>::func(x)};
     }
-};
 
-template <typename... Args>
-struct Qeq_s;
-template <typename... toArgs, int fromInt1, int fromFrac1, bool fromIsSigned1, typename fromQuMode1, typename fromOfMode1, int fromInt2, int fromFrac2, bool fromIsSigned2, typename fromQuMode2, typename fromOfMode2>
-struct Qeq_s<Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>>, Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>>, TypeList<toArgs...>>
-{
-    static inline constexpr int shiftA = fromFrac2 > fromFrac1 ? fromFrac2 - fromFrac1 : 0;
-    static inline constexpr int shiftB = fromFrac1 > fromFrac2 ? fromFrac1 - fromFrac2 : 0;
+    inline static constexpr auto segmentTable = []<size_t... I>(std::index_sequence<I...>) {
+        return std::array<InT (*)(InT), segNum>{&evalSegment<I>...};
+    }(std::make_index_sequence<segNum>());
 
-    inline static constexpr auto eq(const Qu_s<intBits<fromInt1>, fracBits<fromFrac1>, isSigned<fromIsSigned1>, QuMode<fromQuMode1>, OfMode<fromOfMode1>> f1, const Qu_s<intBits<fromInt2>, fracBits<fromFrac2>, isSigned<fromIsSigned2>, QuMode<fromQuMode2>, OfMode<fromOfMode2>> f2)
+    inline static constexpr InT execute(InT x)
     {
-        return staticShiftLeft<shiftA>(f1.data) == staticShiftLeft<shiftB>(f2.data);
+        return segmentTable[segmentIndex(x)](x);
     }
 };
 
+template <typename... Segments, typename QuT>
+    requires isScalar<QuT>
+constexpr auto Qapprox(QuT x)
+{
+    return QapproxDispatcher<QuT, Segments...>::execute(x);
+}
 
-// specialization for complex
-template <typename... toArgs, typename... realArgs, typename... imagArgs>
-struct Qeq_s<Qu_s<Qu_s<realArgs...>, Qu_s<imagArgs...>>, Qu_s<Qu_s<realArgs...>, Qu_s<imagArgs...>>, TypeList<toArgs...>>
+// 张量版本：按块先算出所有元素的分段下标，再按分段分组求值，避免逐元素的间接跳转
+template <typename... Segments, typename QuT>
+    requires(!isScalar<QuT>)
+inline auto Qapprox(const QuT &x)
 {
-    inline static auto eq(const Qu_s<Qu_s<realArgs...>, Qu_s<imagArgs...>> f1, const Qu_s<Qu_s<realArgs...>, Qu_s<imagArgs...>> f2)
-    {
-        return Qeq<toArgs...>(f1.real, f2.real) && Qeq<toArgs...>(f1.imag, f2.imag);
-    }
-};
+    using elem_t = typename QuT::elem_t;
+    using dispatcher = QapproxDispatcher<elem_t, Segments...>;
+    constexpr size_t blockSize = 256;
+    constexpr size_t segNum = sizeof...(Segments);
 
+    Qu_s<typename QuT::size, elem_t> res;
+    std::array<uint32_t, blockSize> segIndex;
+    std::array<uint32_t, blockSize> order;
+    for (size_t begin = 0; begin < QuT::elemSize; begin += blockSize)
+    {
+        const size_t end = std::min(begin + blockSize, QuT::elemSize);
 
+        // 计数排序得到每个分段的元素列表
+        std::array<uint32_t, segNum + 1> offset{};
+        for (size_t i = begin; i < end; i++)
+        {
+            segIndex[i - begin] = static_cast<uint32_t>(dispatcher::segmentIndex(x[i]));
+            offset[segIndex[i - begin] + 1]++;
+        }
+        std::partial_sum(offset.begin(), offset.end(), offset.begin());
+        auto cursor = offset;
+        for (size_t i = 0; i < end - begin; i++)
+        {
+            order[cursor[segIndex[i]]++] = static_cast<uint32_t>(i);
+        }
 
-// ------------------- Complex Operations -------------------
-// Basic complex multiplication, realized as (a+bi)(c+di) = (ac-bd) + (ad+bc)i
-template <typename... Args>
-struct BasicComplexMul;
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            ((std::for_each(order.begin() + offset[I], order.begin() + offset[I + 1], [&](uint32_t i) {
+                 res[begin + i] = dispatcher::template evalSegment<I>(x[begin + i]);
+             })),
+             ...);
+        }(std::make_index_sequence<segNum>());
+    }
+    return res;
+}
 
 template <typename... Args>
-struct MergerArgsWrapper_s<BasicComplexMul<Args...>>
+struct Qapprox_s
 {
-    using type = BasicComplexMul<Args...>;
+    inline static constexpr auto execute(auto x)
+    {
+        return Qapprox<Args...>(x);
+    }
 };
 
-template <typename... Args>
-struct acT
-{
-    using list = MergerArgsWrapper<Args...>;
-};
+// ------------------- Qtable -------------------
+// 查找表：以输入的原始比特为下标，表中存放输出类型的原始整数
+// 位宽较小且函数可在编译期求值时整表在编译期生成，否则在第一次查表时生成一次
 
-template <typename... Args>
-struct bdT
-{
-    using list = MergerArgsWrapper<Args...>;
-};
+// predefined functions, 定义域之外的输入返回饱和值，以便在编译期求值
+inline constexpr auto rsqrtFunc = [](double x) { return x > 0 ? 1.0 / std::sqrt(x) : std::numeric_limits<double>::max(); };
+inline constexpr auto reciprocalFunc = [](double x) { return x != 0 ? 1.0 / x : std::numeric_limits<double>::max(); };
+inline constexpr auto sqrtFunc = [](double x) { return x > 0 ? std::sqrt(x) : 0.0; };
 
-template <typename... Args>
-struct adT
+// 只用输入的高 indexBits 位查表，低位在相邻两项之间线性插值，用于位宽较大的输入
+template <size_t indexBits>
+struct QtableIndexBits
 {
-    using list = MergerArgsWrapper<Args...>;
 };
 
-template <typename... Args>
-struct bcT
+template <auto Func, typename InT, typename OutT, typename... Args>
+struct Qtable_s
 {
-    using list = MergerArgsWrapper<Args...>;
-};
+    inline static constexpr size_t inWidth = InT::width;
+    inline static constexpr size_t indexBits = tagExtractor<QtableIndexBits<0>, Args...>::value == 0 ? inWidth : tagExtractor<QtableIndexBits<0>, Args...>::value;
 
-template <typename... Args>
-struct acbdT
-{
-    using list = MergerArgsWrapper<Args...>;
-};
+    static_assert(1 + InT::intB + InT::fracB <= 64, "Qtable only supports inputs up to 64 bits.");
+    static_assert(indexBits <= inWidth, "QtableIndexBits is wider than the input.");
+    static_assert(indexBits <= 20, "The table is too large, please use QtableIndexBits<> to build an interpolated table.");
 
-template <typename... Args>
-struct adbcT
-{
-    using list = MergerArgsWrapper<Args...>;
-};
+    inline static constexpr bool interpolated = indexBits < inWidth;
+    inline static constexpr size_t lowBits = inWidth - indexBits;
 
-// used for Qmul(c1, c2) without any additional arguments
-template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... imagArgs2>
-struct Qmul_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<>> : Qmul_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, BasicComplexMul<>>
-{};
+    // 插值表在末尾多存一个端点
+    inline static constexpr size_t tableSize = (size_t(1) << indexBits) + (interpolated ? 1 : 0);
+    inline static constexpr int64_t minRaw = InT::isS ? -(int64_t(1) << (inWidth - 1)) : 0;
 
-template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... imagArgs2, typename... toArgs>
-struct Qmul_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, BasicComplexMul<toArgs...>>
-{
-    using mulACType = tagExtractor<acT<toArgs...>, toArgs...>::type::list;
-    using mulBDType = tagExtractor<bdT<toArgs...>, toArgs...>::type::list;
-    using mulADType = tagExtractor<adT<toArgs...>, toArgs...>::type::list;
-    using mulBCType = tagExtractor<bcT<toArgs...>, toArgs...>::type::list;
+    using raw_t = decltype(OutT().data);
 
-    using subACBDType = tagExtractor<acbdT<toArgs...>, toArgs...>::type::list;
-    using addADBCType = tagExtractor<adbcT<toArgs...>, toArgs...>::type::list;
+    inline static constexpr double rawToDouble(int64_t raw)
+    {
+        double val = static_cast<double>(raw);
+        for (int i = 0; i < InT::fracB; i++)
+        {
+            val *= 0.5;
+        }
+        for (int i = 0; i > InT::fracB; i--)
+        {
+            val *= 2.0;
+        }
+        return val;
+    }
 
-    inline static constexpr auto mul(const Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>> f1, const Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>> f2)
+    template <typename Container>
+    inline static constexpr Container build()
     {
-        auto realPart = Qsub<subACBDType>(Qmul<mulACType>(f1.real, f2.real), Qmul<mulBDType>(f1.imag, f2.imag));
-        auto imagPart = Qadd<addADBCType>(Qmul<mulADType>(f1.real, f2.imag), Qmul<mulBCType>(f1.imag, f2.real));
+        Container table{};
+        if constexpr (!std::is_same_v<Container, std::array<raw_t, tableSize>>)
+        {
+            table.resize(tableSize);
+        }
+        for (size_t i = 0; i < tableSize; i++)
+        {
+            table[i] = OutT(Func(rawToDouble(minRaw + (static_cast<int64_t>(i) << lowBits)))).data;
+        }
+        return table;
+    }
 
-        // get the type of the real part and the imaginary part
-        Qcomplex<decltype(realPart), decltype(imagPart)> res(realPart, imagPart);
-        return res;
+    template <typename T = void>
+    inline static constexpr bool constexprBuildable = requires {
+        typename std::integral_constant<bool, (build<std::array<raw_t, tableSize>>(), true)>;
+    };
+
+    inline static constexpr bool compileTime = tableSize <= 4096 && constexprBuildable<>;
+
+    inline static constexpr std::array<raw_t, compileTime ? tableSize : 1> constTable = [] {
+        if constexpr (compileTime)
+        {
+            return build<std::array<raw_t, tableSize>>();
+        }
+        else
+        {
+            return std::array<raw_t, 1>{};
+        }
+    }();
+
+    inline static const std::vector<raw_t> &runtimeTable()
+    {
+        static const std::vector<raw_t> table = build<std::vector<raw_t>>();
+        return table;
     }
-};
 
-// Complex multiplication via 3 multiplications and 5 additions
-// x = a + bi, y = c + di
-// A = (a + b)c, B = (c + d)b, C = (b − a)d
-// xy = (A − B) + (B − C)i
+    inline static constexpr raw_t entry(size_t index)
+    {
+        if constexpr (compileTime)
+        {
+            return constTable[index];
+        }
+        else
+        {
+            return runtimeTable()[index];
+        }
+    }
 
-template <typename... Args>
-struct TFComplexMul;
+    inline static constexpr OutT execute(const InT &x)
+    {
+        // 只取低 inWidth 位作为下标
+        const auto index = static_cast<size_t>(static_cast<int64_t>(x.data.data) - minRaw) & ((size_t(1) << inWidth) - 1);
 
-template <typename... Args>
-struct MergerArgsWrapper_s<TFComplexMul<Args...>>
-{
-    using type = TFComplexMul<Args...>;
-};
+        OutT res;
+        if constexpr (!interpolated)
+        {
+            res.data = entry(index);
+        }
+        else
+        {
+            const raw_t y0 = entry(index >> lowBits);
+            const raw_t y1 = entry((index >> lowBits) + 1);
+            const ArbiInt<lowBits + 1> low(static_cast<int64_t>(index & ((size_t(1) << lowBits) - 1)));
+            const ArbiInt<lowBits + 1> half(int64_t(1) << (lowBits - 1));
 
-template <typename... Args>
-struct abT
-{
-    using list = MergerArgsWrapper<Args...>;
+            // y0 + round((y1 - y0) * low / 2^lowBits)
+            res.data = raw_t(y0 + staticShiftRight<lowBits>((y1 - y0) * low + half));
+        }
+        return res;
+    }
 };
 
-template <typename... Args>
-struct cdT
+// Qtable<Func>(x) 的输出类型与输入相同，Qtable<Func, OutT>(x) 指定输出类型
+template <auto Func, typename OutT = void, typename... Args>
+inline constexpr auto Qtable(const auto &x)
 {
-    using list = MergerArgsWrapper<Args...>;
-};
+    using InT = std::remove_cvref_t<decltype(x)>;
+    using resT = std::conditional_t<std::is_void_v<OutT>, InT, OutT>;
+    return Qtable_s<Func, InT, resT, Args...>::execute(x);
+}
 
-template <typename... Args>
-struct baT
-{
-    using list = MergerArgsWrapper<Args...>;
-};
+// ------------------- Qmemo -------------------
+// 记忆化：输入位宽不超过上限时，对全部 2^width 个原始比特把任意逐位精确的计算 F 求值一次，之后按原始比特查表
+// 与 Qtable 不同，表中存放 F 本身的结果（例如 Qabs、饱和转换、Qapprox、Qpoly 组成的链），与直接调用 F 逐位一致
+// 表在第一次使用时生成，多线程同时首次使用也只生成一次；位宽超过上限时直接调用 F
 
-template <typename... Args>
-struct abcT
-{
-    using list = MergerArgsWrapper<Args...>;
-};
+#if defined(QUBLAS_MEMO_MAX_BITS)
+inline constexpr size_t quMemoMaxBits = QUBLAS_MEMO_MAX_BITS;
+#else
+inline constexpr size_t quMemoMaxBits = 16;
+#endif
 
-template <typename... Args>
-struct cdbT
+// 单次调用覆盖 quMemoMaxBits
+template <size_t maxBits>
+struct QmemoMaxBits
 {
-    using list = MergerArgsWrapper<Args...>;
 };
 
-template <typename... Args>
-struct badT
+template <auto F, typename InT, typename... Args>
+struct Qmemo_s
 {
-    using list = MergerArgsWrapper<Args...>;
-};
+    using OutT = std::remove_cvref_t<decltype(F(std::declval<const InT &>()))>;
 
-template <typename... Args>
-struct ABT
-{
-    using list = MergerArgsWrapper<Args...>;
-};
+    inline static constexpr size_t maxBits = tagExtractor<QmemoMaxBits<quMemoMaxBits>, Args...>::value;
+    inline static constexpr size_t inWidth = InT::width;
 
-template <typename... Args>
-struct BCT
-{
-    using list = MergerArgsWrapper<Args...>;
-};
+    // 只对原始比特就是全部状态的实数标量生效
+    inline static constexpr bool memoized = requires { requires !InT::is_complex; requires std::is_integral_v<decltype(InT().data.data)>; } && inWidth <= maxBits;
 
-template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... imagArgs2, typename... toArgs>
-struct Qmul_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TFComplexMul<toArgs...>>
-{
-    using addabType = tagExtractor<abT<toArgs...>, toArgs...>::type::list;
-    using addcdType = tagExtractor<cdT<toArgs...>, toArgs...>::type::list;
-    using subbaType = tagExtractor<baT<toArgs...>, toArgs...>::type;
-    using mulabcType = tagExtractor<abcT<toArgs...>, toArgs...>::type::list;
-    using mulcdbType = tagExtractor<cdbT<toArgs...>, toArgs...>::type::list;
-    using mulbadType = tagExtractor<badT<toArgs...>, toArgs...>::type::list;
-    using subABType = tagExtractor<ABT<toArgs...>, toArgs...>::type::list;
-    using subBCType = tagExtractor<BCT<toArgs...>, toArgs...>::type::list;
+    inline static constexpr int64_t minRaw = [] {
+        if constexpr (memoized)
+        {
+            return InT::isS ? -(int64_t(1) << (inWidth - 1)) : int64_t(0);
+        }
+        else
+        {
+            return int64_t(0);
+        }
+    }();
+    inline static constexpr size_t tableSize = memoized ? size_t(1) << inWidth : 0;
 
-    inline static constexpr auto mul(const Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>> f1, const Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>> f2)
+    // 输出也是原生整数时只存原始整数，批量查表可以直接 gather
+    inline static constexpr bool rawOut = requires { requires !OutT::is_complex; requires std::is_integral_v<decltype(OutT().data.data)>; };
+
+    using entry_t = decltype([] {
+        if constexpr (rawOut)
+        {
+            return OutT().data.data;
+        }
+        else
+        {
+            return OutT();
+        }
+    }());
+
+    inline static const std::vector<entry_t> &table()
     {
-        auto A = Qmul<mulabcType>(Qadd<addabType>(f1.real, f1.imag), f2.real);
-        auto B = Qmul<mulbadType>(Qadd<addcdType>(f2.real, f2.imag), f1.imag);
-        auto C = Qmul<mulcdbType>(Qsub<subbaType>(f1.imag, f1.real), f2.imag);
+        static const std::vector<entry_t> entries = [] {
+            std::vector<entry_t> res(tableSize);
+            for (size_t i = 0; i < tableSize; i++)
+            {
+                InT x;
+                x.data.data = static_cast<decltype(x.data.data)>(minRaw + static_cast<int64_t>(i));
+                if constexpr (rawOut)
+                {
+                    res[i] = F(x).data.data;
+                }
+                else
+                {
+                    res[i] = F(x);
+                }
+            }
+            return res;
+        }();
+        return entries;
+    }
 
-        auto realPart = Qsub<subABType>(A, B);
-        auto imagPart = Qsub<subBCType>(B, C);
+    // 只取低 inWidth 位作为下标
+    inline static size_t index(const InT &x)
+    {
+        return static_cast<size_t>(static_cast<int64_t>(x.data.data) - minRaw) & (tableSize - 1);
+    }
 
-        // get the type of the real part and the imaginary part
-        Qcomplex<decltype(realPart), decltype(imagPart)> res(realPart, imagPart);
+    inline static OutT lookup(const std::vector<entry_t> &entries, size_t i)
+    {
+        if constexpr (rawOut)
+        {
+            OutT res;
+            res.data.data = entries[i];
+            return res;
+        }
+        else
+        {
+            return entries[i];
+        }
+    }
+
+    inline static OutT execute(const InT &x)
+    {
+        if constexpr (memoized)
+        {
+            return lookup(table(), index(x));
+        }
+        else
+        {
+            return F(x);
+        }
+    }
+
+    template <size_t... dims>
+    inline static auto execute(const Qu_s<dim<dims...>, InT> &x)
+    {
+        constexpr size_t n = dim<dims...>::elemSize;
+        Qu_s<dim<dims...>, OutT> res;
+
+        if constexpr (!memoized)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                res.data[i] = F(x.data[i]);
+            }
+        }
+        else
+        {
+            const auto &entries = table();
+            size_t i = 0;
+
+#if defined(__AVX2__)
+            // 先算出一组下标，再用一条 gather 指令取出原始整数
+            if constexpr (rawOut && (sizeof(entry_t) == 4 || sizeof(entry_t) == 8) && inWidth < 31)
+            {
+                constexpr size_t group = 32 / sizeof(entry_t);
+                alignas(32) int32_t idx[8];
+                alignas(32) entry_t out[group];
+                for (; i + group <= n; i += group)
+                {
+                    for (size_t l = 0; l < group; l++)
+                    {
+                        idx[l] = static_cast<int32_t>(index(x.data[i + l]));
+                    }
+
+                    if constexpr (sizeof(entry_t) == 4)
+                    {
+                        const __m256i v = _mm256_i32gather_epi32(reinterpret_cast<const int *>(entries.data()), _mm256_load_si256(reinterpret_cast<const __m256i *>(idx)), 4);
+                        _mm256_store_si256(reinterpret_cast<__m256i *>(out), v);
+                    }
+                    else
+                    {
+                        const __m256i v = _mm256_i32gather_epi64(reinterpret_cast<const long long *>(entries.data()), _mm_load_si128(reinterpret_cast<const __m128i *>(idx)), 8);
+                        _mm256_store_si256(reinterpret_cast<__m256i *>(out), v);
+                    }
+
+                    for (size_t l = 0; l < group; l++)
+                    {
+                        res.data[i + l].data.data = out[l];
+                    }
+                }
+            }
+#endif
+
+            for (; i < n; i++)
+            {
+                res.data[i] = lookup(entries, index(x.data[i]));
+            }
+        }
         return res;
     }
 };
 
-template <typename... Args>
-struct realT
+// Qmemo<F>(x)：x 为标量或张量，F 接受一个输入元素并返回任意 QuBLAS 结果
+template <auto F, typename... Args>
+inline auto Qmemo(const auto &x)
 {
-    using list = MergerArgsWrapper<Args...>;
-};
+    using T = std::remove_cvref_t<decltype(x)>;
+    if constexpr (requires { typename T::elem_t; typename T::size; })
+    {
+        return Qmemo_s<F, typename T::elem_t, Args...>::execute(x);
+    }
+    else
+    {
+        return Qmemo_s<F, T, Args...>::execute(x);
+    }
+}
 
-template <typename... Args>
-struct imagT
-{
-    using list = MergerArgsWrapper<Args...>;
-};
+} // namespace ANUS
 
-template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... imagArgs2, typename... toArgs>
-struct Qadd_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<toArgs...>>
+// ------------------- QuDyn -------------------
+// 运行时格式的定点数与张量，用于设计空间扫描时不必为每个格式重新编译
+// 舍入与溢出和 nativeRound / nativeOverflow 逐位一致，payload 为 int64_t，中间结果为 __int128_t
+// 因此格式最多 64 位（含符号位），中间结果放不进 __int128_t 时抛出 std::domain_error
+
+struct QuDynFormat
 {
-    using realType = tagExtractor<realT<toArgs...>, toArgs...>::type::list;
-    using imagType = tagExtractor<imagT<toArgs...>, toArgs...>::type::list;
+    int intB = defaultIntBits;
+    int fracB = defaultFracBits;
+    bool isS = defaultIsSigned;
+    int QuM = defaultQuMode::value;
+    int OfM = defaultOfMode::value;
 
-    inline static constexpr auto add(const Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>> f1, const Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>> f2)
+    template <typename QuT>
+    inline static constexpr QuDynFormat of()
     {
-        auto realPart = Qadd<realType>(f1.real, f2.real);
-        auto imagPart = Qadd<imagType>(f1.imag, f2.imag);
-
-        // get the type of the real part and the imaginary part
-        Qcomplex<decltype(realPart), decltype(imagPart)> res(realPart, imagPart);
-        return res;
+        return {QuT::intB, QuT::fracB, QuT::isS, QuT::QuM, QuT::OfM};
     }
-};
 
-template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... imagArgs2, typename... QuArgs1, typename... QuArgs2>
-struct Qadd_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<Qu_s<QuArgs1...>, Qu_s<QuArgs2...>>> : Qadd_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<realT<QuArgs1...>, imagT<QuArgs2...>>>
-{};
+    // 与 Qu_s::width 相同，符号位只在 isS 时计入
+    inline constexpr int width() const
+    {
+        return intB + fracB + static_cast<int>(isS);
+    }
 
-template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... imagArgs2, typename... toArgs>
-struct Qsub_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<toArgs...>>
-{
-    using realType = tagExtractor<realT<toArgs...>, toArgs...>::type::list;
-    using imagType = tagExtractor<imagT<toArgs...>, toArgs...>::type::list;
+    inline constexpr bool operator==(const QuDynFormat &) const = default;
 
-    inline static constexpr auto sub(const Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>> f1, const Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>> f2)
+    // OfM 只支持 SAT::TCPL 到 WRP::TCPL；WRP::TCPL_SAT<N> 的饱和位数 N 无法用 OfM 表示，不支持
+    inline void check() const
     {
-        auto realPart = Qsub<realType>(f1.real, f2.real);
-        auto imagPart = Qsub<imagType>(f1.imag, f2.imag);
+        if (intB + fracB < 0 || intB + fracB > 63)
+        {
+            throw std::invalid_argument("QuDyn: 1 + intB + fracB must be in [1, 64]");
+        }
+        if (QuM < RND::POS_INF::value || QuM > TRN::SMGN::value)
+        {
+            throw std::invalid_argument("QuDyn: unknown QuMode");
+        }
+        if (OfM < SAT::TCPL::value || OfM > WRP::TCPL::value)
+        {
+            throw std::invalid_argument("QuDyn: unsupported OfMode");
+        }
+    }
 
-        // get the type of the real part and the imaginary part
-        Qcomplex<decltype(realPart), decltype(imagPart)> res(realPart, imagPart);
-        return res;
+    // 与 MulMerger / AddMerger 的默认结果格式相同
+    inline static constexpr QuDynFormat mulFormat(const QuDynFormat &a, const QuDynFormat &b, bool fullPrecision = false)
+    {
+        return {fullPrecision ? a.intB + b.intB : std::max(a.intB, b.intB),
+                fullPrecision ? a.fracB + b.fracB : std::max(a.fracB, b.fracB),
+                a.isS || b.isS,
+                a.QuM == b.QuM ? a.QuM : defaultQuMode::value,
+                a.OfM == b.OfM ? a.OfM : defaultOfMode::value};
     }
-};
 
-template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... imagArgs2, typename... QuArgs1, typename... QuArgs2>
-struct Qsub_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<Qu_s<QuArgs1...>, Qu_s<QuArgs2...>>> : Qsub_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<realT<QuArgs1...>, imagT<QuArgs2...>>>
-{};
+    inline static constexpr QuDynFormat addFormat(const QuDynFormat &a, const QuDynFormat &b, bool fullPrecision = false)
+    {
+        return {fullPrecision ? std::max(a.intB, b.intB) + 1 : std::max(a.intB, b.intB),
+                std::max(a.fracB, b.fracB),
+                a.isS || b.isS,
+                a.QuM == b.QuM ? a.QuM : defaultQuMode::value,
+                a.OfM == b.OfM ? a.OfM : defaultOfMode::value};
+    }
 
-template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... imagArgs2, typename... toArgs>
-struct Qdiv_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, toArgs...>
-{
-    inline static constexpr auto div(const Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>> f1, const Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>> f2)
+    inline std::string toString() const
     {
-        throw std::runtime_error("Complex division is not supported yet.");
+        return "intBits<" + std::to_string(intB) + "> fracBits<" + std::to_string(fracB) + "> isSigned<" + std::to_string(isS) + "> QuMode<" + std::to_string(QuM) + "> OfMode<" + std::to_string(OfM) + ">";
     }
 };
 
-// ------------------- Real-Complex Operations -------------------
-
-// Real-Complex multiplication
-template <typename... realArgs1, typename... realArgs2, typename... imagArgs2, typename... toArgs>
-struct Qmul_s<Qu_s<realArgs1...>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<toArgs...>>
+// nativeRound 的运行时 d 版本，由 dynCheckKernel 保证 d 与 val 放得进 T
+template <typename QuM, typename T>
+inline constexpr T dynRound(T val, int d)
 {
-    using realMulType = tagExtractor<realT<toArgs...>, toArgs...>::type;
-    using imagMulType = tagExtractor<imagT<toArgs...>, toArgs...>::type;
-
-    inline static constexpr auto mul(const Qu_s<realArgs1...> f1, const Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>> f2)
+    if (d <= 0)
     {
+        return val << -d;
+    }
 
-        auto realPart = Qmul<typename realMulType::list>(f1, f2.real);
-        auto imagPart = Qmul<typename imagMulType::list>(f1, f2.imag);
+    constexpr int signShift = static_cast<int>(sizeof(T) * 8) - 1;
+    const T lowMask = (T(1) << d) - 1;
+    const T half = T(1) << (d - 1);
 
-        // get the type of the real part and the imaginary part
-        Qcomplex<decltype(realPart), decltype(imagPart)> res(realPart, imagPart);
-        return res;
-    }
-};
+    const T Xh = val >> d;
+    const T Xl = val & lowMask;
 
-template <typename... realArgs1, typename... realArgs2, typename... imagArgs2, typename... QuArgs1, typename... QuArgs2>
-struct Qmul_s<Qu_s<realArgs1...>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<Qu_s<QuArgs1...>, Qu_s<QuArgs2...>>> : Qmul_s<Qu_s<realArgs1...>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<realT<QuArgs1...>, imagT<QuArgs2...>>>
-{};
+    if constexpr (std::is_same_v<QuM, RND::POS_INF>)
+    {
+        return Xh + ((Xl + half) >> d);
+    }
+    else if constexpr (std::is_same_v<QuM, RND::NEG_INF>)
+    {
+        return Xh + ((Xl + half - 1) >> d);
+    }
+    else if constexpr (std::is_same_v<QuM, RND::ZERO>)
+    {
+        const T isNegative = (val >> signShift) & 1;
+        return Xh + ((Xl + half - 1 + isNegative) >> d);
+    }
+    else if constexpr (std::is_same_v<QuM, RND::INF>)
+    {
+        const T isPositive = ((-val) >> signShift) & 1;
+        return Xh + ((Xl + half - 1 + isPositive) >> d);
+    }
+    else if constexpr (std::is_same_v<QuM, RND::CONV>)
+    {
+        return Xh + ((Xl + half - 1 + (Xh & 1)) >> d);
+    }
+    else if constexpr (std::is_same_v<QuM, TRN::TCPL>)
+    {
+        return Xh;
+    }
+    else
+    {
+        return (val + ((val >> signShift) & lowMask)) >> d;
+    }
+}
 
-template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... toArgs>
-struct Qmul_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<realArgs2...>, TypeList<toArgs...>>
+// nativeOverflow 的运行时格式版本
+template <typename OfM, typename T>
+inline constexpr int64_t dynOverflow(T val, const QuDynFormat &to)
 {
-    using realMulType = tagExtractor<realT<toArgs...>, toArgs...>::type;
-    using imagMulType = tagExtractor<imagT<toArgs...>, toArgs...>::type;
+    const int valueBits = to.intB + to.fracB;
+    const T hi = (T(1) << valueBits) - 1;
+    const T lo = to.isS ? -(T(1) << valueBits) : T(0);
 
-    inline static constexpr auto mul(const Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>> f1, const Qu_s<realArgs2...> f2)
+    if constexpr (std::is_same_v<OfM, SAT::TCPL>)
     {
-        auto realPart = Qmul<typename realMulType::list>(f1.real, f2);
-        auto imagPart = Qmul<typename imagMulType::list>(f1.imag, f2);
-
-        // get the type of the real part and the imaginary part
-        Qcomplex<decltype(realPart), decltype(imagPart)> res(realPart, imagPart);
-        return res;
+        return static_cast<int64_t>(val > hi ? hi : (val < lo ? lo : val));
     }
-};
-
-template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... QuArgs1, typename... QuArgs2>
-struct Qmul_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<realArgs2...>, TypeList<Qu_s<QuArgs1...>, Qu_s<QuArgs2...>>> : Qmul_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<realArgs2...>, TypeList<realT<QuArgs1...>, imagT<QuArgs2...>>>
-{};
+    else if constexpr (std::is_same_v<OfM, SAT::ZERO>)
+    {
+        return static_cast<int64_t>((val > hi) | (val < lo) ? T(0) : val);
+    }
+    else if constexpr (std::is_same_v<OfM, SAT::SMGN>)
+    {
+        const T loSMGN = to.isS ? lo + 1 : T(0);
+        return static_cast<int64_t>(val > hi ? hi : (val < loSMGN ? loSMGN : val));
+    }
+    else
+    {
+        if (to.isS)
+        {
+            using U = std::conditional_t<(sizeof(T) > 8), __uint128_t, uint64_t>;
+            const int shift = static_cast<int>(sizeof(T) * 8) - (valueBits + 1);
+            return static_cast<int64_t>(static_cast<T>(static_cast<U>(val) << shift) >> shift);
+        }
+        return static_cast<int64_t>(val & hi);
+    }
+}
 
-// Real-Complex addition
-template <typename... realArgs1, typename... realArgs2, typename... imagArgs2, typename... toArgs>
-struct Qadd_s<Qu_s<realArgs1...>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<toArgs...>>
+// inBits 为对齐后含符号位的中间结果位宽，左移后放得进 __int128_t 且舍入的进位不溢出即可
+// 比 nativeKernel::enabled 少留一位，两个 64 位数的乘积也不必退回 ArbiInt
+// 返回值表示能否和 nativeKernel 一样用 int64_t 完成
+inline bool dynCheckKernel(int inBits, int d, const QuDynFormat &to)
 {
+    const int workBits = inBits + (d < 0 ? -d : 0);
+    if (workBits > 128 || d > 126)
+    {
+        throw std::domain_error("QuDyn: the intermediate result does not fit in __int128_t");
+    }
+    return workBits + 1 <= 64 && d < 63 && to.intB + to.fracB + 2 <= 64;
+}
 
-    inline static constexpr auto add(const Qu_s<realArgs1...> f1, const Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>> f2)
+// 张量核按中间结果的位宽选一次 int64_t 或 __int128_t
+template <typename F>
+inline void dynWidthDispatch(bool narrow, F &&body)
+{
+    if (narrow)
     {
-        auto realPart = Qadd<toArgs...>(f1, f2.real);
-        auto imagPart = f2.imag;
+        body.template operator()<int64_t>();
+    }
+    else
+    {
+        body.template operator()<__int128_t>();
+    }
+}
 
-        // get the type of the real part and the imaginary part
-        Qcomplex<decltype(realPart), decltype(imagPart)> res(realPart, imagPart);
+// 按运行时的 QuMode / OfMode 选出一次 body.template operator()<QuM, OfM>()，循环放在 body 里
+template <typename F>
+inline void dynModeDispatch(const QuDynFormat &to, F &&body)
+{
+    to.check();
 
-        return res;
+    auto withOf = [&]<typename QuM>() {
+        switch (to.OfM)
+        {
+        case SAT::TCPL::value:
+            return body.template operator()<QuM, SAT::TCPL>();
+        case SAT::ZERO::value:
+            return body.template operator()<QuM, SAT::ZERO>();
+        case SAT::SMGN::value:
+            return body.template operator()<QuM, SAT::SMGN>();
+        default:
+            return body.template operator()<QuM, WRP::TCPL>();
+        }
+    };
+
+    switch (to.QuM)
+    {
+    case RND::POS_INF::value:
+        return withOf.template operator()<RND::POS_INF>();
+    case RND::NEG_INF::value:
+        return withOf.template operator()<RND::NEG_INF>();
+    case RND::ZERO::value:
+        return withOf.template operator()<RND::ZERO>();
+    case RND::INF::value:
+        return withOf.template operator()<RND::INF>();
+    case RND::CONV::value:
+        return withOf.template operator()<RND::CONV>();
+    case TRN::TCPL::value:
+        return withOf.template operator()<TRN::TCPL>();
+    default:
+        return withOf.template operator()<TRN::SMGN>();
     }
-};
+}
 
-template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... toArgs>
-struct Qadd_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<realArgs2...>, TypeList<toArgs...>>
+// 与 doubleConvert::convert 相同：先在 toFrac + 2 位小数的缓冲里保留 sticky 位，再舍入两位并处理溢出
+template <typename QuM, typename OfM>
+inline int64_t dynFromDouble(double val, const QuDynFormat &to)
 {
-    inline static constexpr auto add(const Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>> f1, const Qu_s<realArgs2...> f2)
+    using T = __int128_t;
+
+    if (val == 0.0 || std::isnan(val) || std::isinf(val))
     {
-        auto realPart = Qadd<toArgs...>(f1.real, f2);
-        auto imagPart = f1.imag;
+        return 0;
+    }
 
-        // get the type of the real part and the imaginary part
-        Qcomplex<decltype(realPart), decltype(imagPart)> res(realPart, imagPart);
+    const uint64_t doubleAsUint64 = std::bit_cast<uint64_t>(val);
+    const bool sign = (doubleAsUint64 >> 63) != 0;
+    const int biasedExponent = static_cast<int>((doubleAsUint64 >> 52) & 0x7FF);
+    uint64_t mantissa = doubleAsUint64 & 0xFFFFFFFFFFFFFull;
 
-        return res;
+    int exponent = -1074;
+    if (biasedExponent != 0)
+    {
+        mantissa |= 0x10000000000000ull;
+        exponent = biasedExponent - 1075;
     }
-};
 
-// Real-Complex subtraction
-template <typename... realArgs1, typename... realArgs2, typename... imagArgs2, typename... toArgs>
-struct Qsub_s<Qu_s<realArgs1...>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<toArgs...>>
+    const int shift = exponent + to.fracB + 2;
+
+    T buffer;
+    if (shift >= 0)
+    {
+        if (std::bit_width(mantissa) + shift > 125)
+        {
+            if constexpr (std::is_same_v<OfM, WRP::TCPL>)
+            {
+                // 最低两位为零，舍入是精确的，回绕只看低 64 位
+                const __uint128_t magnitude = shift - 2 < 128 ? static_cast<__uint128_t>(mantissa) << (shift - 2) : 0;
+                return dynOverflow<OfM>(static_cast<T>(sign ? -magnitude : magnitude), to);
+            }
+            else
+            {
+                // 超出范围的值饱和的方式都一样
+                buffer = T(1) << 124;
+            }
+        }
+        else
+        {
+            buffer = static_cast<T>(mantissa) << shift;
+        }
+    }
+    else
+    {
+        const int rshift = -shift;
+        const uint64_t kept = rshift < 64 ? mantissa >> rshift : 0;
+        const bool sticky = rshift < 64 ? (mantissa & ((uint64_t(1) << rshift) - 1)) != 0 : true;
+        buffer = static_cast<T>(kept | static_cast<uint64_t>(sticky));
+    }
+
+    return dynOverflow<OfM>(dynRound<QuM>(sign ? -buffer : buffer, 2), to);
+}
+
+// 运行时格式的定点数，data 为 1 + intB + fracB 位的补码
+class QuDyn
 {
-    inline static constexpr auto sub(const Qu_s<realArgs1...> f1, const Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>> f2)
+public:
+    QuDynFormat format;
+    int64_t data = 0;
+
+    inline QuDyn() = default;
+
+    inline QuDyn(const QuDynFormat &fmt, double val) : format(fmt)
     {
-        auto realPart = Qsub<toArgs...>(f1, f2.real);
-        auto imagPart = Qsub<toArgs...>(Qu_s<realArgs1...>(), f2.imag);
+        dynModeDispatch(format, [&]<typename QuM, typename OfM>() { data = dynFromDouble<QuM, OfM>(val, format); });
+    }
 
-        // get the type of the real part and the imaginary part
-        Qcomplex<decltype(realPart), decltype(imagPart)> res(realPart, imagPart);
+    template <int intBitsFrom, int fracBitsFrom, bool isSignedFrom, typename QuModeFrom, typename OfModeFrom>
+    inline QuDyn(const Qu_s<intBits<intBitsFrom>, fracBits<fracBitsFrom>, isSigned<isSignedFrom>, QuMode<QuModeFrom>, OfMode<OfModeFrom>> &val)
+        : format(QuDynFormat::of<std::remove_cvref_t<decltype(val)>>()), data(static_cast<int64_t>(val.data.data))
+    {
+        static_assert(1 + intBitsFrom + fracBitsFrom <= 64, "QuDyn holds at most 64 bits");
+    }
 
+    inline static QuDyn fromRaw(const QuDynFormat &fmt, int64_t raw)
+    {
+        fmt.check();
+        QuDyn res;
+        res.format = fmt;
+        res.data = raw;
         return res;
     }
-};
 
-template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... toArgs>
-struct Qsub_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<realArgs2...>, TypeList<toArgs...>>
-{
-    inline static constexpr auto sub(const Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>> f1, const Qu_s<realArgs2...> f2)
+    // 与 Qu_s 之间的格式转换相同
+    inline QuDyn convert(const QuDynFormat &to) const
     {
-        auto realPart = Qsub<toArgs...>(f1.real, f2);
-        auto imagPart = f1.imag;
-
-        // get the type of the real part and the imaginary part
-        Qcomplex<decltype(realPart), decltype(imagPart)> res(realPart, imagPart);
+        dynCheckKernel(1 + format.intB + format.fracB, format.fracB - to.fracB, to);
 
+        QuDyn res;
+        res.format = to;
+        dynModeDispatch(to, [&]<typename QuM, typename OfM>() { res.data = dynOverflow<OfM>(dynRound<QuM>(__int128_t(data), format.fracB - to.fracB), to); });
         return res;
     }
-};
 
-// Real-Complex division
-template <typename... realArgs1, typename... realArgs2, typename... imagArgs2, typename... toArgs>
-struct Qdiv_s<Qu_s<realArgs1...>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>, TypeList<toArgs...>>
-{
-    inline static constexpr auto div(const Qu_s<realArgs1...> f1, const Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>> f2)
+    // 格式不同时先按 QuT 的模式转换
+    template <typename QuT>
+    inline QuT toStatic() const
     {
-        throw std::runtime_error("Real-Complex division is not supported yet.");
+        QuT res;
+        res.data.data = static_cast<typename decltype(res.data)::data_t>(convert(QuDynFormat::of<QuT>()).data);
+        return res;
     }
-};
-
-template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... toArgs>
-struct Qdiv_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<realArgs2...>, TypeList<toArgs...>>
-{
-    using realDivType = tagExtractor<realT<toArgs...>, toArgs...>::type;
-    using imagDivType = tagExtractor<imagT<toArgs...>, toArgs...>::type;
 
-    inline static constexpr auto div(const Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>> f1, const Qu_s<realArgs2...> f2)
+    inline double toDouble() const
     {
-        auto realPart = Qdiv<typename realDivType::list>(f1.real, f2);
-        auto imagPart = Qdiv<typename imagDivType::list>(f1.imag, f2);
+        return static_cast<double>(data) / std::pow(2, format.fracB);
+    }
 
-        // get the type of the real part and the imaginary part
-        Qcomplex<decltype(realPart), decltype(imagPart)> res(realPart, imagPart);
+    inline std::string toString() const
+    {
+        const int bits = format.intB + format.fracB + static_cast<int>(format.isS);
+        std::string binary = std::bitset<64>(static_cast<uint64_t>(data)).to_string();
+        return binary.substr(64 - bits, bits);
+    }
 
-        return res;
+    inline void display(const std::string &name = "") const
+    {
+        if (name != "")
+        {
+            std::cout << name << " :" << '\n';
+        }
+        std::cout << format.toString() << '\n';
+        std::cout << "Binary: " << toString() << '\n';
+        std::cout << "Decimal: " << toDouble() << '\n';
+        std::cout << '\n';
     }
 };
 
-template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... QuArgs1, typename... QuArgs2>
-struct Qdiv_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<realArgs2...>, TypeList<Qu_s<QuArgs1...>, Qu_s<QuArgs2...>>> : Qdiv_s<Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<realArgs2...>, TypeList<realT<QuArgs1...>, imagT<QuArgs2...>>>
-{};
+class QuDynTensor;
+inline void QdynConvert(QuDynTensor &out, const QuDynTensor &in);
 
-// ------------------- Basic tensor operations -------------------
+// 运行时格式的列主序张量
+class QuDynTensor
+{
+public:
+    QuDynFormat format;
+    std::vector<size_t> shape;
+    std::vector<int64_t> data;
 
-template <typename... Args>
-struct sizeMerger;
+    inline QuDynTensor() = default;
 
-template <size_t... dims1, typename QuT1, typename QuT2>
-struct sizeMerger<Qu_s<dim<dims1...>, QuT1>, Qu_s<dim<dims1...>, QuT2>>
-{
-    using size = dim<dims1...>;
-};
+    inline QuDynTensor(const QuDynFormat &fmt, std::vector<size_t> dims) : format(fmt), shape(std::move(dims))
+    {
+        format.check();
+        data.assign(std::accumulate(shape.begin(), shape.end(), size_t(1), std::multiplies<size_t>()), 0);
+    }
 
-template <size_t... dims1, typename QuT1, typename QuT2>
-    requires isScalar<QuT2>
-struct sizeMerger<Qu_s<dim<dims1...>, QuT1>, QuT2>
-{
-    using size = dim<dims1...>;
-};
+    template <size_t... dims, int intBitsFrom, int fracBitsFrom, bool isSignedFrom, typename QuModeFrom, typename OfModeFrom>
+    inline QuDynTensor(const Qu_s<dim<dims...>, Qu_s<intBits<intBitsFrom>, fracBits<fracBitsFrom>, isSigned<isSignedFrom>, QuMode<QuModeFrom>, OfMode<OfModeFrom>>> &val)
+        : format(QuDynFormat::of<typename std::remove_cvref_t<decltype(val)>::elem_t>()), shape{dims...}
+    {
+        static_assert(1 + intBitsFrom + fracBitsFrom <= 64, "QuDyn holds at most 64 bits");
 
-template <size_t... dims2, typename QuT2, typename QuT1>
-    requires isScalar<QuT1>
-struct sizeMerger<QuT1, Qu_s<dim<dims2...>, QuT2>>
-{
-    using size = dim<dims2...>;
-};
+        data.resize(val.elemSize);
+        for (size_t i = 0; i < val.elemSize; i++)
+        {
+            data[i] = static_cast<int64_t>(val.data[i].data.data);
+        }
+    }
 
-// use [] to call the object if it is a tensor, otherwise just return the object
-template <typename T>
-inline auto autoCall(const T &obj, auto... index)
-{
-    if constexpr (isScalar<T>)
+    inline size_t size() const
     {
-        return obj;
+        return data.size();
     }
-    else
+
+    inline QuDyn operator[](size_t i) const
     {
-        return obj[index...];
+        QuDyn res;
+        res.format = format;
+        res.data = data[i];
+        return res;
     }
-}
 
-template <typename... Args>
-class MulExpression;
+    // 元素格式不同时先按 QuT 的元素模式转换，形状必须相同
+    template <typename QuT>
+    inline QuT toStatic() const
+    {
+        using elem_t = typename QuT::elem_t;
 
-template <typename QuT1, typename QuT2, typename... toArgs>
-class MulExpression<QuT1, QuT2, toArgs...>
-{
-    const QuT1 &q1;
-    const QuT2 &q2;
+        if (!std::ranges::equal(shape, QuT::size::dimArray))
+        {
+            throw std::invalid_argument("QuDynTensor: shape mismatch");
+        }
 
-public:
-    using size = typename sizeMerger<QuT1, QuT2>::size;
+        QuDynTensor converted(QuDynFormat::of<elem_t>(), shape);
+        QdynConvert(converted, *this);
 
-    MulExpression(const QuT1 &f1, const QuT2 &f2)
-        : q1(f1), q2(f2) {}
+        QuT res;
+        for (size_t i = 0; i < QuT::elemSize; i++)
+        {
+            res.data[i].data.data = static_cast<typename decltype(res.data[i].data)::data_t>(converted.data[i]);
+        }
+        return res;
+    }
 
-    auto operator[](auto... index) const
+    inline void fromDouble(std::span<const double> values)
     {
-        return Qmul<toArgs...>(autoCall(q1, index...), autoCall(q2, index...));
-    }
-};
+        if (values.size() != data.size())
+        {
+            throw std::invalid_argument("QuDynTensor: size mismatch");
+        }
 
-template <typename... Args>
-struct QmulTensor_s;
+        dynModeDispatch(format, [&]<typename QuM, typename OfM>() {
+            for (size_t i = 0; i < data.size(); i++)
+            {
+                data[i] = dynFromDouble<QuM, OfM>(values[i], format);
+            }
+        });
+    }
 
-template <typename QuT1, typename QuT2, typename... toArgs>
-struct QmulTensor_s<QuT1, QuT2, toArgs...>
-{
-    inline static constexpr auto mul(const QuT1 &f1, const QuT2 &f2)
+    inline std::vector<double> toDouble() const
     {
-        return MulExpression<QuT1, QuT2, toArgs...>(f1, f2);
+        const double scale = std::pow(2, format.fracB);
+
+        std::vector<double> res(data.size());
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            res[i] = static_cast<double>(data[i]) / scale;
+        }
+        return res;
     }
 };
 
-template <typename... Args>
-class AddExpression;
+// ------------------- QuDyn operations -------------------
+// 标量与张量的运算都只在调用时按 out 的格式分派一次，逐元素循环里没有模式分支
+// 不给出 out 格式的标量版本使用与 Qmul / Qadd / Qsub 相同的默认格式
 
-template <typename QuT1, typename QuT2, typename... toArgs>
-class AddExpression<QuT1, QuT2, toArgs...>
+// 对齐移位与需要舍去的位数，与 Qmul_s / Qadd_s 的 native 路径相同
+struct dynPlan
 {
-    const QuT1 &q1;
-    const QuT2 &q2;
+    int shiftA = 0;
+    int shiftB = 0;
+    int d = 0;
+    bool narrow = false;
+};
 
-public:
-    using size = typename sizeMerger<QuT1, QuT2>::size;
+inline dynPlan dynMulPlan(const QuDynFormat &a, const QuDynFormat &b, const QuDynFormat &to)
+{
+    dynPlan plan{0, 0, a.fracB + b.fracB - to.fracB};
+    plan.narrow = dynCheckKernel(2 + a.intB + a.fracB + b.intB + b.fracB, plan.d, to);
+    return plan;
+}
 
-    AddExpression(const QuT1 &f1, const QuT2 &f2)
-        : q1(f1), q2(f2) {}
+inline dynPlan dynAddPlan(const QuDynFormat &a, const QuDynFormat &b, const QuDynFormat &to)
+{
+    dynPlan plan{std::max(b.fracB - a.fracB, 0), std::max(a.fracB - b.fracB, 0), std::max(a.fracB, b.fracB) - to.fracB};
+    plan.narrow = dynCheckKernel(std::max(1 + a.intB + a.fracB + plan.shiftA, 1 + b.intB + b.fracB + plan.shiftB) + 1, plan.d, to);
+    return plan;
+}
 
-    auto operator[](auto... index) const
+inline void dynCheckShapes(const QuDynTensor &out, const QuDynTensor &a, const QuDynTensor &b)
+{
+    if (a.shape != b.shape || out.shape != a.shape)
     {
-        return Qadd<toArgs...>(autoCall(q1, index...), autoCall(q2, index...));
+        throw std::invalid_argument("QuDynTensor: shape mismatch");
     }
-};
-
-template <typename... Args>
-struct QaddTensor_s;
+}
 
-template <typename QuT1, typename QuT2, typename... toArgs>
-struct QaddTensor_s<QuT1, QuT2, toArgs...>
+inline void QdynConvert(QuDynTensor &out, const QuDynTensor &in)
 {
-    inline static constexpr auto add(const QuT1 &f1, const QuT2 &f2)
+    if (out.shape != in.shape)
     {
-        return AddExpression<QuT1, QuT2, toArgs...>(f1, f2);
+        throw std::invalid_argument("QuDynTensor: shape mismatch");
     }
-};
 
-template <typename... Args>
-class SubExpression;
+    const int d = in.format.fracB - out.format.fracB;
+    const bool narrow = dynCheckKernel(1 + in.format.intB + in.format.fracB, d, out.format);
 
-template <typename QuT1, typename QuT2, typename... toArgs>
-class SubExpression<QuT1, QuT2, toArgs...>
-{
-    const QuT1 &q1;
-    const QuT2 &q2;
+    dynModeDispatch(out.format, [&]<typename QuM, typename OfM>() {
+        dynWidthDispatch(narrow, [&]<typename T>() {
+            for (size_t i = 0; i < out.data.size(); i++)
+            {
+                out.data[i] = dynOverflow<OfM>(dynRound<QuM>(T(in.data[i]), d), out.format);
+            }
+        });
+    });
+}
 
-public:
-    using size = typename sizeMerger<QuT1, QuT2>::size;
+inline void QdynMul(QuDynTensor &out, const QuDynTensor &a, const QuDynTensor &b)
+{
+    dynCheckShapes(out, a, b);
+    const dynPlan plan = dynMulPlan(a.format, b.format, out.format);
 
-    SubExpression(const QuT1 &f1, const QuT2 &f2)
-        : q1(f1), q2(f2) {}
+    dynModeDispatch(out.format, [&]<typename QuM, typename OfM>() {
+        dynWidthDispatch(plan.narrow, [&]<typename T>() {
+            for (size_t i = 0; i < out.data.size(); i++)
+            {
+                out.data[i] = dynOverflow<OfM>(dynRound<QuM>(T(a.data[i]) * T(b.data[i]), plan.d), out.format);
+            }
+        });
+    });
+}
 
-    auto operator[](auto... index) const
-    {
-        return Qsub<toArgs...>(autoCall(q1, index...), autoCall(q2, index...));
-    }
-};
+template <bool isSub>
+inline void dynAddSub(QuDynTensor &out, const QuDynTensor &a, const QuDynTensor &b)
+{
+    dynCheckShapes(out, a, b);
+    const dynPlan plan = dynAddPlan(a.format, b.format, out.format);
 
-template <typename... Args>
-struct QsubTensor_s;
+    dynModeDispatch(out.format, [&]<typename QuM, typename OfM>() {
+        dynWidthDispatch(plan.narrow, [&]<typename T>() {
+            for (size_t i = 0; i < out.data.size(); i++)
+            {
+                const T x = T(a.data[i]) << plan.shiftA;
+                const T y = T(b.data[i]) << plan.shiftB;
+                out.data[i] = dynOverflow<OfM>(dynRound<QuM>(isSub ? x - y : x + y, plan.d), out.format);
+            }
+        });
+    });
+}
 
-template <typename QuT1, typename QuT2, typename... toArgs>
-struct QsubTensor_s<QuT1, QuT2, toArgs...>
+inline void QdynAdd(QuDynTensor &out, const QuDynTensor &a, const QuDynTensor &b)
 {
-    inline static constexpr auto sub(const QuT1 &f1, const QuT2 &f2)
-    {
-        return SubExpression<QuT1, QuT2, toArgs...>(f1, f2);
-    }
-};
+    dynAddSub<false>(out, a, b);
+}
 
-template <typename... Args>
-class DivExpression;
+inline void QdynSub(QuDynTensor &out, const QuDynTensor &a, const QuDynTensor &b)
+{
+    dynAddSub<true>(out, a, b);
+}
 
-template <typename QuT1, typename QuT2, typename... toArgs>
-class DivExpression<QuT1, QuT2, toArgs...>
+inline QuDyn QdynMul(const QuDynFormat &to, const QuDyn &a, const QuDyn &b)
 {
-    const QuT1 &q1;
-    const QuT2 &q2;
+    const dynPlan plan = dynMulPlan(a.format, b.format, to);
 
-public:
-    using size = typename sizeMerger<QuT1, QuT2>::size;
+    QuDyn res;
+    res.format = to;
+    dynModeDispatch(to, [&]<typename QuM, typename OfM>() { res.data = dynOverflow<OfM>(dynRound<QuM>(__int128_t(a.data) * __int128_t(b.data), plan.d), to); });
+    return res;
+}
 
-    DivExpression(const QuT1 &f1, const QuT2 &f2)
-        : q1(f1), q2(f2) {}
+template <bool isSub>
+inline QuDyn dynAddSub(const QuDynFormat &to, const QuDyn &a, const QuDyn &b)
+{
+    const dynPlan plan = dynAddPlan(a.format, b.format, to);
+    const __int128_t x = __int128_t(a.data) << plan.shiftA;
+    const __int128_t y = __int128_t(b.data) << plan.shiftB;
 
-    auto operator[](auto... index) const
-    {
-        return Qdiv<toArgs...>(autoCall(q1, index...), autoCall(q2, index...));
-    }
-};
+    QuDyn res;
+    res.format = to;
+    dynModeDispatch(to, [&]<typename QuM, typename OfM>() { res.data = dynOverflow<OfM>(dynRound<QuM>(isSub ? x - y : x + y, plan.d), to); });
+    return res;
+}
 
-template <typename... Args>
-struct QdivTensor_s;
+inline QuDyn QdynAdd(const QuDynFormat &to, const QuDyn &a, const QuDyn &b)
+{
+    return dynAddSub<false>(to, a, b);
+}
 
-template <typename QuT1, typename QuT2, typename... toArgs>
-struct QdivTensor_s<QuT1, QuT2, toArgs...>
+inline QuDyn QdynSub(const QuDynFormat &to, const QuDyn &a, const QuDyn &b)
 {
-    inline static constexpr auto div(const QuT1 &f1, const QuT2 &f2)
-    {
-        return DivExpression<QuT1, QuT2, toArgs...>(f1, f2);
-    }
-};
+    return dynAddSub<true>(to, a, b);
+}
 
-template <typename... Args>
-class AbsExpression;
+inline QuDyn QdynMul(const QuDyn &a, const QuDyn &b)
+{
+    return QdynMul(QuDynFormat::mulFormat(a.format, b.format), a, b);
+}
 
-template <typename QuT, typename... toArgs>
-class AbsExpression<QuT, toArgs...>
+inline QuDyn QdynAdd(const QuDyn &a, const QuDyn &b)
 {
-    const QuT &q;
+    return QdynAdd(QuDynFormat::addFormat(a.format, b.format), a, b);
+}
 
-public:
-    using size = typename QuT::size;
+inline QuDyn QdynSub(const QuDyn &a, const QuDyn &b)
+{
+    return QdynSub(QuDynFormat::addFormat(a.format, b.format), a, b);
+}
 
-    AbsExpression(const QuT &f)
-        : q(f) {}
+// ===================== BLAS =====================
+// ------------------- Reducer -------------------
+// it's not a standard BLAS operation, but tree-based reduction is a common operation in asic design
 
-    auto operator[](auto... index) const
+template <typename... Args>
+struct Reducer
+{
+    template <bool condition, size_t layer>
+    struct ReducerTypeSelector;
+
+    // 递归展开的情况，满足条件
+    template <size_t layer>
+    struct ReducerTypeSelector<true, layer>
     {
-        return Qabs<toArgs...>(q[index...]);
-    }
-};
+        using type = TypeAt<layer >= sizeof...(Args) ? sizeof...(Args) - 1 : layer, TypeList<Args...>>;
+    };
 
-template <typename... Args>
-struct QabsTensor_s;
+    // 基础情况，不满足计算条件的部分
+    template <size_t layer>
+    struct ReducerTypeSelector<false, layer>
+    {
+        using type = std::nullptr_t;
+    };
 
-template <typename QuT, typename... toArgs>
-struct QabsTensor_s<QuT, toArgs...>
-{
-    inline static constexpr auto abs(const QuT &f)
+    // version for arbitrary input, please avoid using this version for efficiency consideration
+    template <size_t layer, typename... Ts, size_t... I>
+    static inline auto reduce_impl(std::index_sequence<I...>,
+                                   const Ts... quants)
     {
-        return AbsExpression<QuT, toArgs...>(f);
+        // (quants.display("layer " + std::to_string(layer)), ...);
+        if constexpr (sizeof...(quants) == 1)
+        {
+            return packIndex<0>(quants...);
+        }
+        else
+        {
+            using type = typename ReducerTypeSelector<sizeof...(Args) != 0, layer>::type;
+            if constexpr (sizeof...(quants) % 2 == 0)
+            {
+                return reduce_impl<layer + 1>(
+                    std::make_index_sequence<sizeof...(I) / 2>{},
+                    Qadd<type>(packIndex<I * 2>(quants...), packIndex<I * 2 + 1>(quants...))...);
+            }
+            else
+            {
+                auto res = reduce_impl<layer + 1>(
+                    std::make_index_sequence<sizeof...(I) / 2>{},
+                    Qadd<type>(packIndex<I * 2>(quants...), packIndex<I * 2 + 1>(quants...))...);
+
+                return Qadd<type>(res, packIndex<sizeof...(quants) - 1>(quants...));
+            }
+        }
     }
-};
 
-template <typename... Args>
-class NegExpression;
+    template <typename... Ts>
+    static auto reduce(const Ts... quants)
+    {
+        return reduce_impl<0>(std::make_index_sequence<sizeof...(Ts) / 2>{}, quants...);
+    }
 
-template <typename QuT, typename... toArgs>
-class NegExpression<QuT, toArgs...>
-{
-    const QuT &q;
+    // version for a tensor
+    // 深度优先地计算树上的单个节点：layer 为编译期的层号，index 为运行期的节点序号
+    // 每一层的长度都是编译期常量，因此无需任何中间张量，可重入且不分配内存
+    template <size_t layer, size_t len>
+    inline static constexpr size_t layerLength()
+    {
+        if constexpr (layer == 0)
+        {
+            return len;
+        }
+        else
+        {
+            return (layerLength<layer - 1, len>() + 1) / 2;
+        }
+    }
 
-public:
-    using size = typename QuT::size;
+    // base > 0 时 quants 已经是第 base 层的节点
+    template <size_t layer, size_t len, typename elem_t, size_t base = 0>
+    inline static constexpr auto reduce_node(const auto &quants, size_t index)
+    {
+        if constexpr (layer == base && base == 0)
+        {
+            return elem_t(quants[index]);
+        }
+        else if constexpr (layer == base)
+        {
+            return quants[index];
+        }
+        else
+        {
+            using type = typename ReducerTypeSelector<sizeof...(Args) != 0, layer - 1>::type;
+            using res_t = std::conditional_t<std::is_same_v<type, std::nullptr_t>, elem_t, shadowOf<elem_t, type>>;
 
-    NegExpression(const QuT &f)
-        : q(f) {}
+            constexpr size_t prevLen = layerLength<layer - 1, len>();
+            if (prevLen % 2 != 0 && index == prevLen / 2)
+            {
+                // 奇数长度时最后一个元素直接进入下一层
+                return res_t(reduce_node<layer - 1, len, elem_t, base>(quants, prevLen - 1));
+            }
+            return res_t(Qadd<type>(reduce_node<layer - 1, len, elem_t, base>(quants, index * 2),
+                                    reduce_node<layer - 1, len, elem_t, base>(quants, index * 2 + 1)));
+        }
+    }
 
-    auto operator[](auto... index) const
+    template <size_t layer, size_t len, typename elem_t, size_t base = 0>
+    inline static constexpr auto reduce_root(const auto &quants)
     {
-        return Qneg<toArgs...>(q[index...]);
+        if constexpr (layerLength<layer, len>() == 1)
+        {
+            return reduce_node<layer, len, elem_t, base>(quants, 0);
+        }
+        else
+        {
+            return reduce_root<layer + 1, len, elem_t, base>(quants);
+        }
     }
-};
 
-template <typename... Args>
-struct QnegTensor_s;
+    // 根所在的层号
+    template <size_t len>
+    inline static constexpr size_t rootLayer()
+    {
+        size_t layer = 0;
+        for (size_t n = len; n > 1; n = (n + 1) / 2)
+        {
+            layer++;
+        }
+        return layer;
+    }
 
-template <typename QuT, typename... toArgs>
-struct QnegTensor_s<QuT, toArgs...>
-{
-    inline static constexpr auto neg(const QuT &f)
+    // 第 layer 层上完整对齐的一段节点逐层两两相加，直到剩下一个节点
+    // 第 l 层的第 i 个节点恰好覆盖叶子 [i * 2^l, (i + 1) * 2^l)，奇数长度的直通只会出现在末尾不完整的段中，因此结果与 reduce_node 相同
+    template <size_t layer, typename T, size_t n>
+    inline static constexpr auto reduce_block(const std::array<T, n> &nodes)
     {
-        return NegExpression<QuT, toArgs...>(f);
+        if constexpr (n == 1)
+        {
+            return nodes[0];
+        }
+        else
+        {
+            using type = typename ReducerTypeSelector<sizeof...(Args) != 0, layer>::type;
+            using res_t = std::conditional_t<std::is_same_v<type, std::nullptr_t>, T, shadowOf<T, type>>;
+
+            std::array<res_t, n / 2> next;
+            for (size_t i = 0; i < n / 2; i++)
+            {
+                next[i] = res_t(Qadd<type>(nodes[i * 2], nodes[i * 2 + 1]));
+            }
+            return reduce_block<layer + 1>(next);
+        }
     }
-};
 
-// ------------------- Functions -------------------
+    // 多个长度相同的独立归约逐层同步计算，nodes[i * lanes + lane] 是第 lane 个归约在第 layer 层的第 i 个节点
+    // 同一层的内层循环只遍历 lane，每个归约的树结构与 reduce_node 相同
+    template <size_t layer, size_t len, typename elem_t, typename T>
+    inline static auto reduce_lanes(const std::vector<T> &nodes, size_t lanes)
+    {
+        constexpr size_t curLen = layerLength<layer, len>();
 
-// scalar functions
+        if constexpr (curLen == 1)
+        {
+            return nodes;
+        }
+        else
+        {
+            using type = typename ReducerTypeSelector<sizeof...(Args) != 0, layer>::type;
+            using res_t = std::conditional_t<std::is_same_v<type, std::nullptr_t>, elem_t, shadowOf<elem_t, type>>;
 
-template <typename... toArgs, typename QuT1, typename QuT2>
-    requires isScalar<QuT1> && isScalar<QuT2>
-inline constexpr auto Qmul(const QuT1 f1, const QuT2 f2)
-{
-    return Qmul_s<QuT1, QuT2, MergerArgsWrapper<toArgs...>>::mul(f1, f2);
-}
+            std::vector<res_t> next((curLen + 1) / 2 * lanes);
+            for (size_t i = 0; i < curLen / 2; i++)
+            {
+                const T *lhs = nodes.data() + i * 2 * lanes;
+                const T *rhs = lhs + lanes;
+                res_t *out = next.data() + i * lanes;
+                for (size_t lane = 0; lane < lanes; lane++)
+                {
+                    out[lane] = res_t(Qadd<type>(lhs[lane], rhs[lane]));
+                }
+            }
+            if constexpr (curLen % 2 != 0)
+            {
+                // 奇数长度时最后一个节点直接进入下一层
+                for (size_t lane = 0; lane < lanes; lane++)
+                {
+                    next[curLen / 2 * lanes + lane] = res_t(nodes[(curLen - 1) * lanes + lane]);
+                }
+            }
+            return reduce_lanes<layer + 1, len, elem_t>(next, lanes);
+        }
+    }
 
-template <typename... toArgs, typename QuT1, typename QuT2>
-    requires isScalar<QuT1> && isScalar<QuT2>
-inline constexpr auto Qadd(const QuT1 f1, const QuT2 f2)
-{
-    return Qadd_s<QuT1, QuT2, MergerArgsWrapper<toArgs...>>::add(f1, f2);
-}
+    // 运行期长度的归约：lens[l] 为第 l 层的长度，树的形状与每层的类型都与同样长度的 reduce_node 相同
+    template <size_t layer, typename elem_t>
+    inline static constexpr auto dynamic_node(const auto &quants, const size_t *lens, size_t index)
+    {
+        if constexpr (layer == 0)
+        {
+            return elem_t(quants[index]);
+        }
+        else
+        {
+            using type = typename ReducerTypeSelector<sizeof...(Args) != 0, layer - 1>::type;
+            using res_t = std::conditional_t<std::is_same_v<type, std::nullptr_t>, elem_t, shadowOf<elem_t, type>>;
 
-template <typename... toArgs, typename QuT1, typename QuT2>
-    requires isScalar<QuT1> && isScalar<QuT2>
-inline constexpr auto Qsub(const QuT1 f1, const QuT2 f2)
-{
-    return Qsub_s<QuT1, QuT2, MergerArgsWrapper<toArgs...>>::sub(f1, f2);
-}
+            const size_t prevLen = lens[layer - 1];
+            if (prevLen % 2 != 0 && index == prevLen / 2)
+            {
+                return res_t(dynamic_node<layer - 1, elem_t>(quants, lens, prevLen - 1));
+            }
+            return res_t(Qadd<type>(dynamic_node<layer - 1, elem_t>(quants, lens, index * 2),
+                                    dynamic_node<layer - 1, elem_t>(quants, lens, index * 2 + 1)));
+        }
+    }
 
-template <typename... toArgs, typename QuT1, typename QuT2>
-    requires isScalar<QuT1> && isScalar<QuT2>
-inline constexpr auto Qdiv(const QuT1 f1, const QuT2 f2)
-{
-    return Qdiv_s<QuT1, QuT2, MergerArgsWrapper<toArgs...>>::div(f1, f2);
-}
+    template <size_t layer, size_t maxLen, typename elem_t, typename out_t>
+    inline static constexpr out_t dynamic_root(const auto &quants, const size_t *lens, size_t root)
+    {
+        if constexpr (layer < rootLayer<maxLen>())
+        {
+            if (layer != root)
+            {
+                return dynamic_root<layer + 1, maxLen, elem_t, out_t>(quants, lens, root);
+            }
+        }
+        return out_t(dynamic_node<layer, elem_t>(quants, lens, 0));
+    }
 
-template <typename... toArgs, typename QuT>
-    requires isScalar<QuT>
-inline constexpr auto Qabs(const QuT f)
-{
-    return Qabs_s<QuT, MergerArgsWrapper<toArgs...>>::abs(f);
-}
+    // n 个叶子的树形和，n 只在运行期已知且不超过 maxLen，例如稀疏矩阵一行中的结构非零元
+    // 根的类型随 n 变化，因此结果转换为 out_t；n 为 0 时返回 out_t 的零
+    template <size_t maxLen, typename elem_t, typename out_t>
+    inline static constexpr out_t reduce_dynamic(const auto &quants, size_t n)
+    {
+        if (n == 0)
+        {
+            return out_t();
+        }
 
-template <typename... toArgs, typename QuT>
-    requires isScalar<QuT>
-inline constexpr auto Qneg(const QuT f)
-{
-    return Qneg_s<QuT, MergerArgsWrapper<toArgs...>>::neg(f);
-}
+        std::array<size_t, rootLayer<maxLen>() + 1> lens{n};
+        size_t root = 0;
+        while (lens[root] > 1)
+        {
+            lens[root + 1] = (lens[root] + 1) / 2;
+            root++;
+        }
+        return dynamic_root<0, maxLen, elem_t, out_t>(quants, lens.data(), root);
+    }
 
-template <typename... toArgs, typename QuT1, typename QuT2>
-    requires isScalar<QuT1> && isScalar<QuT2>
-inline constexpr auto Qeq(const QuT1 f1, const QuT2 f2)
-{
-    return Qeq_s<QuT1, QuT2, MergerArgsWrapper<toArgs...>>::eq(f1, f2);
-}
+    template <typename QuT>
+        requires(!isScalar<QuT>)
+    static auto reduce(const QuT &quants)
+    {
+        return reduce_root<0, QuT::elemSize, typename QuT::elem_t>(quants);
+    }
+};
 
-// operator overloading
-template <typename... QuArgs1, typename... QuArgs2>
-    requires isScalar<Qu_s<QuArgs1...>> && isScalar<Qu_s<QuArgs2...>>
-inline constexpr auto operator*(const Qu_s<QuArgs1...> f1, const Qu_s<QuArgs2...> f2)
+template <typename... Args>
+struct ReducerInputHelper : public Reducer<Args...>
 {
-    return Qmul(f1, f2);
-}
+};
 
-template <typename... QuArgs1, typename... QuArgs2>
-    requires isScalar<Qu_s<QuArgs1...>> && isScalar<Qu_s<QuArgs2...>>
-inline constexpr auto operator+(const Qu_s<QuArgs1...> f1, const Qu_s<QuArgs2...> f2)
+template <typename... Args>
+struct ReducerInputHelper<TypeList<Args...>> : public Reducer<Args...>
 {
-    return Qadd(f1, f2);
-}
+};
 
-template <typename... QuArgs1, typename... QuArgs2>
-    requires isScalar<Qu_s<QuArgs1...>> && isScalar<Qu_s<QuArgs2...>>
-inline constexpr auto operator-(const Qu_s<QuArgs1...> f1, const Qu_s<QuArgs2...> f2)
+template <typename... Args, typename... Ts>
+inline auto constexpr Qreduce(const Ts... quants)
 {
-    return Qsub(f1, f2);
+    return ReducerInputHelper<Args...>::reduce(quants...);
 }
 
-template <typename... QuArgs1, typename... QuArgs2>
-    requires isScalar<Qu_s<QuArgs1...>> && isScalar<Qu_s<QuArgs2...>>
-inline constexpr auto operator/(const Qu_s<QuArgs1...> f1, const Qu_s<QuArgs2...> f2)
-{
-    return Qdiv(f1, f2);
-}
+// ------------------- Axis-wise reduction -------------------
+// Qreduce<Axis<k>, ...>(tensor) 沿第 k 维归约，返回去掉第 k 维的张量，每个元素是一棵独立的加法树
+// 可在 Axis<k> 之后加 QuExec<...>，默认在线程池上并行
 
-template <typename... QuArgs>
-    requires isScalar<Qu_s<QuArgs...>>
-inline constexpr auto operator-(const Qu_s<QuArgs...> f1)
+template <size_t axis>
+struct Axis
 {
-    return Qneg(f1);
-}
+};
 
-template <typename... QuArgs1, typename... QuArgs2>
-    requires isScalar<Qu_s<QuArgs1...>> && isScalar<Qu_s<QuArgs2...>>
-inline constexpr auto operator<=>(const Qu_s<QuArgs1...> f1, const Qu_s<QuArgs2...> f2)
-{
-    return Qcmp_s<Qu_s<QuArgs1...>, Qu_s<QuArgs2...>, MergerArgsWrapper<>>::cmp(f1, f2);
-}
+// 去掉 dim<dims...> 的第 axis 维，只剩一维时为 dim<1>
+template <size_t axis, typename Dim>
+struct dimRemoveAxis_s;
 
-template <typename... QuArgs1, typename... QuArgs2>
-    requires isScalar<Qu_s<QuArgs1...>> && isScalar<Qu_s<QuArgs2...>>
-inline constexpr auto operator==(const Qu_s<QuArgs1...> f1, const Qu_s<QuArgs2...> f2)
+template <size_t axis, size_t... dims>
+struct dimRemoveAxis_s<axis, dim<dims...>>
 {
-    return Qeq(f1, f2);
-}
+    static_assert(axis < sizeof...(dims), "The axis is out of range.");
 
-// tensor functions
-template <typename... toArgs, typename... QuArgs1, typename... QuArgs2>
-    requires(!isScalar<Qu_s<QuArgs1...>>) || (!isScalar<Qu_s<QuArgs2...>>)
-inline constexpr auto Qmul(const Qu_s<QuArgs1...> &f1, const Qu_s<QuArgs2...> &f2)
-{
-    return QmulTensor_s<Qu_s<QuArgs1...>, Qu_s<QuArgs2...>, toArgs...>::mul(f1, f2);
-}
+    static constexpr std::array<size_t, sizeof...(dims)> extents{dims...};
 
-template <typename... toArgs, typename... QuArgs1, typename... QuArgs2>
-    requires(!isScalar<Qu_s<QuArgs1...>>) || (!isScalar<Qu_s<QuArgs2...>>)
-inline constexpr auto Qadd(const Qu_s<QuArgs1...> &f1, const Qu_s<QuArgs2...> &f2)
-{
-    return QaddTensor_s<Qu_s<QuArgs1...>, Qu_s<QuArgs2...>, toArgs...>::add(f1, f2);
-}
+    template <size_t... I>
+    static auto make(std::index_sequence<I...>) -> dim<extents[I < axis ? I : I + 1]...>;
 
-template <typename... toArgs, typename... QuArgs1, typename... QuArgs2>
-    requires(!isScalar<Qu_s<QuArgs1...>>) || (!isScalar<Qu_s<QuArgs2...>>)
-inline constexpr auto Qsub(const Qu_s<QuArgs1...> &f1, const Qu_s<QuArgs2...> &f2)
-{
-    return QsubTensor_s<Qu_s<QuArgs1...>, Qu_s<QuArgs2...>, toArgs...>::sub(f1, f2);
-}
+    using type = std::conditional_t<sizeof...(dims) == 1, dim<1>, decltype(make(std::make_index_sequence<sizeof...(dims) - 1>{}))>;
+};
 
-template <typename... toArgs, typename... QuArgs1, typename... QuArgs2>
-    requires(!isScalar<Qu_s<QuArgs1...>>) || (!isScalar<Qu_s<QuArgs2...>>)
-inline constexpr auto Qdiv(const Qu_s<QuArgs1...> &f1, const Qu_s<QuArgs2...> &f2)
+template <size_t axis, typename policy, typename reducer>
+struct QreduceAxis_s
 {
-    return QdivTensor_s<Qu_s<QuArgs1...>, Qu_s<QuArgs2...>, toArgs...>::div(f1, f2);
-}
+    // 一次同步计算的归约个数的下限
+    static constexpr size_t minLanes = 256;
 
-template <typename... toArgs, typename... QuArgs>
-    requires(!isScalar<Qu_s<QuArgs...>>)
-inline constexpr auto Qabs(const Qu_s<QuArgs...> &f)
-{
-    return QabsTensor_s<Qu_s<QuArgs...>, toArgs...>::abs(f);
-}
+    template <typename QuT>
+        requires(!isScalar<QuT>)
+    static auto reduce(const QuT &quants)
+    {
+        using elem_t = typename QuT::elem_t;
 
-template <typename... toArgs, typename... QuArgs>
-    requires(!isScalar<Qu_s<QuArgs...>>)
-inline constexpr auto Qneg(const Qu_s<QuArgs...> &f)
-{
-    return QnegTensor_s<Qu_s<QuArgs...>, toArgs...>::neg(f);
-}
+        constexpr size_t len = QuT::size::template dimAt<axis>;
+        constexpr size_t inner = [] {
+            size_t n = 1;
+            for (size_t i = 0; i < axis; i++)
+            {
+                n *= QuT::size::dimArray[i];
+            }
+            return n;
+        }();
+        constexpr size_t outer = QuT::elemSize / (inner * len);
 
-// operator overloading
-template <typename... QuArgs1, typename... QuArgs2>
-    requires(!isScalar<Qu_s<QuArgs1...>>) || (!isScalar<Qu_s<QuArgs2...>>)
-inline constexpr auto operator*(const Qu_s<QuArgs1...> &f1, const Qu_s<QuArgs2...> &f2)
-{
-    return Qmul(f1, f2);
-}
+        using res_t = decltype(reducer::template reduce_root<0, len, elem_t>(std::array<elem_t, len>{}));
+        using out_t = Qu_s<typename dimRemoveAxis_s<axis, typename QuT::size>::type, res_t>;
 
-template <typename... QuArgs1, typename... QuArgs2>
-    requires(!isScalar<Qu_s<QuArgs1...>>) || (!isScalar<Qu_s<QuArgs2...>>)
-inline constexpr auto operator+(const Qu_s<QuArgs1...> &f1, const Qu_s<QuArgs2...> &f2)
-{
-    return Qadd(f1, f2);
-}
+        // 列优先存储中第 k 维之前的维度连续，每个外层下标对应一块 inner * len 的数据，块内恰好是 nodes 的排布
+        // 第 0 维归约时 inner 为 1，多个外层下标拼在一起同步计算
+        constexpr size_t group = std::max<size_t>(1, minLanes / inner);
+        constexpr size_t groups = (outer + group - 1) / group;
 
-template <typename... QuArgs1, typename... QuArgs2>
-    requires(!isScalar<Qu_s<QuArgs1...>>) || (!isScalar<Qu_s<QuArgs2...>>)
-inline constexpr auto operator-(const Qu_s<QuArgs1...> &f1, const Qu_s<QuArgs2...> &f2)
-{
-    return Qsub(f1, f2);
-}
+        out_t res;
 
-template <typename... QuArgs1, typename... QuArgs2>
-    requires(!isScalar<Qu_s<QuArgs1...>>) || (!isScalar<Qu_s<QuArgs2...>>)
-inline constexpr auto operator/(const Qu_s<QuArgs1...> &f1, const Qu_s<QuArgs2...> &f2)
-{
-    return Qdiv(f1, f2);
-}
+        auto body = [&](size_t begin, size_t end) {
+            for (size_t g = begin; g < end; g++)
+            {
+                const size_t first = g * group;
+                const size_t count = std::min(group, outer - first);
+                const size_t lanes = count * inner;
 
-template <typename... QuArgs>
-    requires(!isScalar<Qu_s<QuArgs...>>)
-inline constexpr auto operator-(const Qu_s<QuArgs...> &f1)
-{
-    return Qneg(f1);
-}
+                std::vector<elem_t> nodes(len * lanes);
+                for (size_t o = 0; o < count; o++)
+                {
+                    for (size_t k = 0; k < len; k++)
+                    {
+                        for (size_t i = 0; i < inner; i++)
+                        {
+                            nodes[k * lanes + o * inner + i] = quants[i + inner * (k + len * (first + o))];
+                        }
+                    }
+                }
 
-// ------------------- Slice -------------------
+                const auto roots = reducer::template reduce_lanes<0, len, elem_t>(nodes, lanes);
+                for (size_t lane = 0; lane < lanes; lane++)
+                {
+                    res[first * inner + lane] = roots[lane];
+                }
+            }
+        };
 
-template <size_t... Args>
-struct sr;
+        if constexpr (isParallel<policy>)
+        {
+            QuThreadPool::instance().parallelFor(groups, policy::value, body);
+        }
+        else
+        {
+            body(0, groups);
+        }
+        return res;
+    }
+};
 
-template <size_t targetDim, size_t lower, size_t upper>
-struct sr<targetDim, lower, upper>
+template <size_t axis, typename... Args>
+struct ReducerInputHelper<Axis<axis>, Args...> : public QreduceAxis_s<axis, Parallel<>, ReducerInputHelper<Args...>>
 {
-    static constexpr size_t dim = targetDim;
-    static constexpr size_t start = lower;
-    static constexpr size_t end = upper;
 };
 
-template <size_t targetDim, size_t lower>
-struct sr<targetDim, lower>
+template <size_t axis, typename policy, typename... Args>
+struct ReducerInputHelper<Axis<axis>, QuExec<policy>, Args...> : public QreduceAxis_s<axis, policy, ReducerInputHelper<Args...>>
 {
-    static constexpr size_t dim = targetDim;
-    static constexpr size_t start = lower;
-    static constexpr size_t end = lower + 1;
 };
 
-template <size_t I, auto toDimSize>
-struct IndexLoader
-{
-    static constexpr size_t count1 = std::accumulate(toDimSize.begin(), toDimSize.begin() + I, 0, [](size_t a, size_t b) { return a + (b == 1); });
+// ------------------- Qdot / Qgemv -------------------
+// 乘法融合进归约树的第一层，整棵加法树在寄存器和栈上的小数组中完成，不生成乘积张量和每层的临时张量
+// 累加顺序与先 Qmul 再 Qreduce 完全一致
 
-    inline static auto execute(auto... index)
-    {
-        return packIndex<I - count1>(index...);
-    }
+template <typename... Args>
+struct QdotAddArgs
+{
+    using reducer = ReducerInputHelper<Args...>;
 };
 
-template <size_t targetDimIndex, typename... srs>
-struct dimExtractor
+template <typename... Args>
+struct QdotMulArgs
 {
+    using list = MergerArgsWrapper<Args...>;
 };
 
-template <size_t targetDimIndex, typename sr1, typename... srs>
-    requires(sr1::dim == targetDimIndex)
-struct dimExtractor<targetDimIndex, sr1, srs...>
+template <bool transposed>
+struct QgemvTransposedA
 {
-    inline static constexpr size_t start = sr1::start;
-    inline static constexpr size_t end = sr1::end;
 };
 
-template <size_t targetDimIndex, typename sr1, typename... srs>
-    requires(sr1::dim != targetDimIndex)
-struct dimExtractor<targetDimIndex, sr1, srs...> : dimExtractor<targetDimIndex, srs...>
+// 归约树的叶子，第 k 个叶子是 leaf(k)
+template <typename Leaf>
+struct QdotLeaves
 {
+    Leaf leaf;
+
+    inline constexpr auto operator[](size_t k) const
+    {
+        return leaf(k);
+    }
 };
 
-template <size_t targetDimIndex>
-struct dimExtractor<targetDimIndex>
+// a[k] * b[k] 的 K 个乘积的树形和，a 与 b 只需支持 operator[]，Qgemul 的每个输出元素也由此计算
+// 每 2^blockLayers 个叶子为一段：乘积写入栈上的小数组后逐层归约到一个节点，末尾不完整的段与段之上的各层按 reduce_node 深度优先计算
+template <typename reducer, typename mulList>
+struct QdotKernel
 {
-    inline static constexpr size_t start = 0;
-    inline static constexpr size_t end = 0;
+    static constexpr size_t blockLayers = 6;
+
+    template <size_t K, typename a_t, typename b_t>
+    inline static constexpr auto dot(const auto &a, const auto &b)
+    {
+        using prod_t = decltype(Qmul<mulList>(a_t(), b_t()));
+
+        return reduceLeaves<K, prod_t>([&](size_t k) { return Qmul<mulList>(a[k], b[k]); });
+    }
+
+    // 第 k 个乘积为 leaf(k) 的树形和，复数的平面实现也由此归约
+    template <size_t K, typename prod_t, typename Leaf>
+    inline static constexpr auto reduceLeaves(const Leaf &leaf)
+    {
+        const QdotLeaves<Leaf> leaves{leaf};
+
+        // 段不能高过根，否则会多出根之上的类型转换
+        constexpr size_t B = std::min(blockLayers, reducer::template rootLayer<K>());
+        constexpr size_t blockLen = size_t(1) << B;
+        constexpr size_t fullBlocks = K / blockLen;
+        constexpr size_t blocks = (K + blockLen - 1) / blockLen;
+
+        if constexpr (fullBlocks == 0)
+        {
+            return reducer::template reduce_root<0, K, prod_t>(leaves);
+        }
+        else
+        {
+            using node_t = decltype(reducer::template reduce_block<0>(std::array<prod_t, blockLen>{}));
+
+            std::array<node_t, blocks> nodes;
+            for (size_t blk = 0; blk < fullBlocks; blk++)
+            {
+                std::array<prod_t, blockLen> products;
+                for (size_t k = 0; k < blockLen; k++)
+                {
+                    products[k] = leaf(blk * blockLen + k);
+                }
+                nodes[blk] = reducer::template reduce_block<0>(products);
+            }
+            if constexpr (blocks != fullBlocks)
+            {
+                nodes[fullBlocks] = reducer::template reduce_node<B, K, prod_t>(leaves, fullBlocks);
+            }
+
+            return reducer::template reduce_root<B, K, prod_t, B>(nodes);
+        }
+    }
 };
 
-template <typename targetTensorT, typename... Args>
-struct dimArrayExtractor : dimArrayExtractor<std::make_index_sequence<targetTensorT::size::dimSize>, targetTensorT, Args...>
+// 复数矩阵乘法的平面实现：A 与 B 的实部、虚部以及乘法方法中只依赖一侧的预加各存为连续的实数平面
+// 例如 TFComplexMul 的 (a + b)、(b - a) 每个 A 元素只算一次，(c + d) 每个 B 元素只算一次，而不是每个输出都重算
+// 每个乘积仍按方法的各中间类型计算，因此与 Qmul_s<..., method>::mul 逐位一致
+template <typename method, typename a_t, typename b_t>
+struct QcomplexPlanes
 {
+    static constexpr bool enabled = false;
 };
 
-template <size_t... I, typename targetTensorT, typename... Args>
-struct dimArrayExtractor<std::index_sequence<I...>, targetTensorT, Args...>
+// 不指定方法时与 Qmul 一样使用 BasicComplexMul<>
+template <typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... imagArgs2>
+struct QcomplexPlanes<TypeList<>, Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>> : QcomplexPlanes<BasicComplexMul<>, Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>>
 {
-    inline constexpr static std::array<size_t, targetTensorT::size::dimSize> toLower = {dimExtractor<I, Args...>::start...};
-    inline constexpr static std::array<size_t, targetTensorT::size::dimSize> toUpper = {dimExtractor<I, Args...>::end == 0 ? targetTensorT::size::dimArray[I] : dimExtractor<I, Args...>::end...};
-    inline constexpr static std::array<size_t, targetTensorT::size::dimSize> toDimSize = {toUpper[I] - toLower[I]...};
 };
 
-template <typename... Args>
-class SliceExpression;
-
-// general case, try not to use this version for compile-time efficiency
-template <typename targetTensorT, typename... Args>
-    requires(targetTensorT::size::dimSize >= 3 && sizeof...(Args) >= 1)
-class SliceExpression<targetTensorT, Args...>
+template <typename... toArgs, typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... imagArgs2>
+struct QcomplexPlanes<BasicComplexMul<toArgs...>, Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>>
 {
-public:
-    // target tensor
-    const targetTensorT &targetTensor;
-    SliceExpression(const targetTensorT &targetTensor)
-        : targetTensor(targetTensor) {}
+    static constexpr bool enabled = true;
 
-    inline constexpr static auto fromDimSize = targetTensorT::size::dimSize;
-    inline constexpr static std::array<size_t, fromDimSize> toLower = dimArrayExtractor<targetTensorT, Args...>::toLower;
-    inline constexpr static std::array<size_t, fromDimSize> toUpper = dimArrayExtractor<targetTensorT, Args...>::toUpper;
-    inline constexpr static std::array<size_t, fromDimSize> toDimSize = dimArrayExtractor<targetTensorT, Args...>::toDimSize;
+    using a_t = Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>;
+    using b_t = Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>;
+    using op = Qmul_s<a_t, b_t, BasicComplexMul<toArgs...>>;
 
-    inline auto &operator[](auto... index)
+    // 第 i 行（或第 j 列）的 K 个元素连续存放
+    struct panelA
     {
-        return indexHelper(std::make_index_sequence<fromDimSize>{}, index...);
-    }
+        std::vector<Qu_s<realArgs1...>> a;
+        std::vector<Qu_s<imagArgs1...>> b;
+    };
 
-    // const version []
-    inline auto &operator[](auto... index) const
+    struct panelB
     {
-        return indexHelper(std::make_index_sequence<fromDimSize>{}, index...);
-    }
+        std::vector<Qu_s<realArgs2...>> c;
+        std::vector<Qu_s<imagArgs2...>> d;
+    };
 
-    template <size_t... I>
-    inline auto &indexHelper(std::index_sequence<I...>, auto... index)
+    inline static panelA packA(size_t n, const auto &get)
     {
-        return targetTensor[toDimSize[I] == 1 ? toLower[I] : (toLower[I] + IndexLoader<I, toDimSize>::execute(index...))...];
+        panelA p{std::vector<Qu_s<realArgs1...>>(n), std::vector<Qu_s<imagArgs1...>>(n)};
+        for (size_t i = 0; i < n; i++)
+        {
+            const a_t x = get(i);
+            p.a[i] = x.real;
+            p.b[i] = x.imag;
+        }
+        return p;
     }
 
-    inline auto &operator[](size_t index)
+    inline static panelB packB(size_t n, const auto &get)
     {
-        throw std::runtime_error("Not supported yet. Tell Niurx if you need this feature.");
-        return 0;
+        panelB p{std::vector<Qu_s<realArgs2...>>(n), std::vector<Qu_s<imagArgs2...>>(n)};
+        for (size_t i = 0; i < n; i++)
+        {
+            const b_t y = get(i);
+            p.c[i] = y.real;
+            p.d[i] = y.imag;
+        }
+        return p;
     }
 
-    inline auto &operator[](size_t index) const
+    // (a + bi)(c + di) = (ac - bd) + (ad + bc)i，与 op::mul 相同
+    inline static constexpr auto product(const panelA &A, size_t i, const panelB &B, size_t j)
     {
-        throw std::runtime_error("Not supported yet. Tell Niurx if you need this feature.");
-        return 0;
+        const auto ac = Qmul<typename op::mulACType>(A.a[i], B.c[j]);
+        const auto bd = Qmul<typename op::mulBDType>(A.b[i], B.d[j]);
+        const auto ad = Qmul<typename op::mulADType>(A.a[i], B.d[j]);
+        const auto bc = Qmul<typename op::mulBCType>(A.b[i], B.c[j]);
+
+        auto realPart = Qsub<typename op::subACBDType>(ac, bd);
+        auto imagPart = Qadd<typename op::addADBCType>(ad, bc);
+        return Qcomplex<decltype(realPart), decltype(imagPart)>(realPart, imagPart);
     }
 };
 
-// slice a matrix to a vector
-template <typename targetTensorT, size_t... Args>
-    requires(targetTensorT::size::dimSize == 2 && sr<Args...>::start == sr<Args...>::end - 1)
-class SliceExpression<targetTensorT, sr<Args...>>
+template <typename... toArgs, typename... realArgs1, typename... imagArgs1, typename... realArgs2, typename... imagArgs2>
+struct QcomplexPlanes<TFComplexMul<toArgs...>, Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>, Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>>
 {
-public:
-    using size = std::conditional_t<sr<Args...>::dim == 0, dim<1, targetTensorT::size::dimArray[1]>, dim<targetTensorT::size::dimArray[0]>>;
+    static constexpr bool enabled = true;
 
-    const targetTensorT &targetTensor;
-    SliceExpression(const targetTensorT &targetTensor)
-        : targetTensor(targetTensor) {}
+    using a_t = Qu_s<Qu_s<realArgs1...>, Qu_s<imagArgs1...>>;
+    using b_t = Qu_s<Qu_s<realArgs2...>, Qu_s<imagArgs2...>>;
+    using op = Qmul_s<a_t, b_t, TFComplexMul<toArgs...>>;
+
+    using ab_t = decltype(Qadd<typename op::addabType>(Qu_s<realArgs1...>(), Qu_s<imagArgs1...>()));
+    using ba_t = decltype(Qsub<typename op::subbaType>(Qu_s<imagArgs1...>(), Qu_s<realArgs1...>()));
+    using cd_t = decltype(Qadd<typename op::addcdType>(Qu_s<realArgs2...>(), Qu_s<imagArgs2...>()));
 
-    auto &operator[](size_t index)
+    // A 侧只需要 b、a + b 与 b - a，B 侧只需要 c、d 与 c + d
+    struct panelA
     {
-        if constexpr (sr<Args...>::dim == 0)
-        {
-            return targetTensor[sr<Args...>::start, index];
-        }
-        else
+        std::vector<Qu_s<imagArgs1...>> b;
+        std::vector<ab_t> ab;
+        std::vector<ba_t> ba;
+    };
+
+    struct panelB
+    {
+        std::vector<Qu_s<realArgs2...>> c;
+        std::vector<Qu_s<imagArgs2...>> d;
+        std::vector<cd_t> cd;
+    };
+
+    inline static panelA packA(size_t n, const auto &get)
+    {
+        panelA p{std::vector<Qu_s<imagArgs1...>>(n), std::vector<ab_t>(n), std::vector<ba_t>(n)};
+        for (size_t i = 0; i < n; i++)
         {
-            return targetTensor[index, sr<Args...>::start];
+            const a_t x = get(i);
+            p.b[i] = x.imag;
+            p.ab[i] = Qadd<typename op::addabType>(x.real, x.imag);
+            p.ba[i] = Qsub<typename op::subbaType>(x.imag, x.real);
         }
+        return p;
     }
 
-    auto &operator[](size_t index) const
+    inline static panelB packB(size_t n, const auto &get)
     {
-        if constexpr (sr<Args...>::dim == 0)
-        {
-            return targetTensor[sr<Args...>::start, index];
-        }
-        else
+        panelB p{std::vector<Qu_s<realArgs2...>>(n), std::vector<Qu_s<imagArgs2...>>(n), std::vector<cd_t>(n)};
+        for (size_t i = 0; i < n; i++)
         {
-            return targetTensor[index, sr<Args...>::start];
+            const b_t y = get(i);
+            p.c[i] = y.real;
+            p.d[i] = y.imag;
+            p.cd[i] = Qadd<typename op::addcdType>(y.real, y.imag);
         }
+        return p;
     }
-};
 
-template <typename targetTensorT, size_t... Args1, size_t... Args2>
-    requires(targetTensorT::size::dimSize == 2 && sr<Args2...>::start == sr<Args2...>::end - 1)
-class SliceExpression<targetTensorT, sr<Args1...>, sr<Args2...>> : public SliceExpression<targetTensorT, sr<Args2...>, sr<Args1...>>
-{
+    // A = (a + b)c，B = (c + d)b，C = (b - a)d，结果为 (A - B) + (B - C)i，与 op::mul 相同
+    inline static constexpr auto product(const panelA &A, size_t i, const panelB &B, size_t j)
+    {
+        const auto AA = Qmul<typename op::mulabcType>(A.ab[i], B.c[j]);
+        const auto BB = Qmul<typename op::mulbadType>(B.cd[j], A.b[i]);
+        const auto CC = Qmul<typename op::mulcdbType>(A.ba[i], B.d[j]);
+
+        auto realPart = Qsub<typename op::subABType>(AA, BB);
+        auto imagPart = Qsub<typename op::subBCType>(BB, CC);
+        return Qcomplex<decltype(realPart), decltype(imagPart)>(realPart, imagPart);
+    }
 };
 
-template <typename targetTensorT, size_t... Args1, size_t... Args2>
-    requires(targetTensorT::size::dimSize == 2 && sr<Args1...>::start == sr<Args1...>::end - 1)
-class SliceExpression<targetTensorT, sr<Args1...>, sr<Args2...>>
+template <typename... Args>
+struct Qdot_s
 {
-public:
-    using size = std::conditional_t<sr<Args1...>::dim == 0, dim<1, sr<Args2...>::end - sr<Args2...>::start>, dim<sr<Args2...>::end - sr<Args2...>::start>>;
+    using reducer = typename tagExtractor<QdotAddArgs<>, Args...>::type::reducer;
+    using mulList = typename tagExtractor<QdotMulArgs<>, Args...>::type::list;
+    using policy = typename tagExtractor<QuExec<Parallel<>>, Args...>::type;
+    static constexpr bool transA = tagExtractor<QgemvTransposedA<false>, Args...>::value;
 
-    const targetTensorT &targetTensor;
-    SliceExpression(const targetTensorT &targetTensor)
-        : targetTensor(targetTensor) {}
+    using kernel = QdotKernel<reducer, mulList>;
 
-    auto &operator[](size_t index)
+    template <typename QuTA, typename QuTB>
+    inline static constexpr auto dot(const QuTA &a, const QuTB &b)
     {
-        if constexpr (sr<Args1...>::dim == 0)
-        {
-            return targetTensor[sr<Args1...>::start, index + sr<Args2...>::start];
-        }
-        else
-        {
-            return targetTensor[index + sr<Args2...>::start, sr<Args1...>::start];
-        }
+        static_assert(QuTA::dimSize == 1 && QuTB::dimSize == 1, "Qdot only supports vectors.");
+        static_assert(QuTA::elemSize == QuTB::elemSize, "The lengths of the vectors do not match.");
+
+        return kernel::template dot<QuTA::elemSize, typename QuTA::elem_t, typename QuTB::elem_t>(a, b);
     }
 
-    auto &operator[](size_t index) const
+    template <typename QuTY, typename QuTA, typename QuTX>
+    static void gemv(QuTY &y, const QuTA &A, const QuTX &x)
     {
-        if constexpr (sr<Args1...>::dim == 0)
+        static_assert(QuTA::dimSize == 2 && QuTX::dimSize == 1 && QuTY::dimSize == 1, "Qgemv only supports a matrix and vectors.");
+
+        constexpr size_t M = QuTY::elemSize;
+        constexpr size_t K = QuTX::elemSize;
+
+        static_assert(QuTA::size::template dimAt<transA ? 1 : 0> == M, "The rows of A do not match the length of y.");
+        static_assert(QuTA::size::template dimAt<transA ? 0 : 1> == K, "The columns of A do not match the length of x.");
+
+        using a_t = typename QuTA::elem_t;
+        using x_t = typename QuTX::elem_t;
+        using planes = QcomplexPlanes<mulList, a_t, x_t>;
+
+        if constexpr (planes::enabled)
         {
-            return targetTensor[sr<Args1...>::start, index + sr<Args2...>::start];
+            // 复数按平面打包，A 的预加每个元素只算一次，x 的预加只算一次
+            const auto packA = planes::packA(M * K, [&](size_t idx) -> a_t {
+                if constexpr (transA)
+                {
+                    return A[idx % K, idx / K];
+                }
+                else
+                {
+                    return A[idx / K, idx % K];
+                }
+            });
+            const auto packX = planes::packB(K, [&](size_t k) -> x_t { return x[k]; });
+
+            auto body = [&](size_t begin, size_t end) {
+                using prod_t = decltype(Qmul<mulList>(a_t(), x_t()));
+                for (size_t i = begin; i < end; i++)
+                {
+                    y[i] = kernel::template reduceLeaves<K, prod_t>([&](size_t k) { return planes::product(packA, i * K + k, packX, k); });
+                }
+            };
+
+            if constexpr (isParallel<policy>)
+            {
+                QuThreadPool::instance().parallelFor(M, policy::value, body);
+            }
+            else
+            {
+                body(0, M);
+            }
         }
         else
         {
-            return targetTensor[index + sr<Args2...>::start, sr<Args1...>::start];
+            // x 与 A 的每一行先打包为连续数组，转置在打包时完成
+            std::vector<x_t> packX(K);
+            for (size_t k = 0; k < K; k++)
+            {
+                packX[k] = x[k];
+            }
+
+            // 每一行是独立的归约，各行之间可并行
+            auto body = [&](size_t begin, size_t end) {
+                std::vector<a_t> row(K);
+                for (size_t i = begin; i < end; i++)
+                {
+                    for (size_t k = 0; k < K; k++)
+                    {
+                        if constexpr (transA)
+                        {
+                            row[k] = A[k, i];
+                        }
+                        else
+                        {
+                            row[k] = A[i, k];
+                        }
+                    }
+                    y[i] = kernel::template dot<K, a_t, x_t>(row.data(), packX.data());
+                }
+            };
+
+            if constexpr (isParallel<policy>)
+            {
+                QuThreadPool::instance().parallelFor(M, policy::value, body);
+            }
+            else
+            {
+                body(0, M);
+            }
         }
     }
 };
 
-// slice a matrix to a matrix
-template <typename targetTensorT, size_t... Args>
-    requires(targetTensorT::size::dimSize == 2 && sr<Args...>::end - sr<Args...>::start > 1)
-class SliceExpression<targetTensorT, sr<Args...>>
+template <typename... Args, typename QuTA, typename QuTB>
+inline constexpr auto Qdot(const QuTA &a, const QuTB &b)
 {
-public:
-    inline static constexpr size_t row = sr<Args...>::dim == 0 ? sr<Args...>::end - sr<Args...>::start : targetTensorT::size::dimArray[0];
-    inline static constexpr size_t col = sr<Args...>::dim == 1 ? sr<Args...>::end - sr<Args...>::start : targetTensorT::size::dimArray[1];
-    using size = dim<row, col>;
+    return Qdot_s<Args...>::dot(a, b);
+}
 
-    const targetTensorT &targetTensor;
+template <typename... Args>
+struct QsparseBlas_s;
+
+// y = A * x，A 可以是稀疏矩阵
+template <typename... Args, typename QuTY, typename QuTA, typename QuTX>
+inline QuTY &Qgemv(QuTY &y, const QuTA &A, const QuTX &x)
+{
+    if constexpr (isSparse<QuTA>)
+    {
+        QsparseBlas_s<Args...>::gemv(y, A, x);
+    }
+    else
+    {
+        Qdot_s<Args...>::gemv(y, A, x);
+    }
+    return y;
+}
+
+// ------------------- Qgemul -------------------
+// C = A * B，每个输出元素先按 QgemulMulArgs 做乘法，再按 QgemulAddArgs 通过 Reducer 做树形累加
+// 累加顺序与 Qreduce 完全一致，结果与硬件逐位相同
+
+template <typename... Args>
+struct QgemulAddArgs
+{
+    using reducer = ReducerInputHelper<Args...>;
+};
+
+template <typename... Args>
+struct QgemulMulArgs
+{
+    using list = MergerArgsWrapper<Args...>;
+};
+
+template <bool transposed>
+struct QgemulTransposedA
+{
+};
+
+template <bool transposed>
+struct QgemulTransposedB
+{
+};
+
+template <typename... Args>
+struct Qgemul_s
+{
+    using reducer = typename tagExtractor<QgemulAddArgs<>, Args...>::type::reducer;
+    using mulList = typename tagExtractor<QgemulMulArgs<>, Args...>::type::list;
+    using policy = typename tagExtractor<QuExec<Parallel<>>, Args...>::type;
+    static constexpr bool transA = tagExtractor<QgemulTransposedA<false>, Args...>::value;
+    static constexpr bool transB = tagExtractor<QgemulTransposedB<false>, Args...>::value;
 
-    SliceExpression(const targetTensorT &targetTensor)
-        : targetTensor(targetTensor) {}
+    // 输出分块的目标大小，使一个分块对应的 A 行与 B 列能放进 L2
+    static constexpr size_t tileBytes = 256 * 1024;
 
-    auto &operator[](size_t index)
+    template <typename QuTC, typename QuTA, typename QuTB>
+    static void gemul(QuTC &C, const QuTA &A, const QuTB &B)
     {
-        // transfer 1-d index to 2-d index, col-major
-        size_t j = index / row;
-        size_t i = index % row;
+        static_assert(QuTA::dimSize == 2 && QuTB::dimSize == 2 && QuTC::dimSize == 2, "Qgemul only supports matrices.");
+
+        constexpr size_t M = QuTC::size::template dimAt<0>;
+        constexpr size_t N = QuTC::size::template dimAt<1>;
+        constexpr size_t K = QuTA::size::template dimAt<transA ? 0 : 1>;
+
+        static_assert(QuTA::size::template dimAt<transA ? 1 : 0> == M, "The rows of A do not match the rows of C.");
+        static_assert(QuTB::size::template dimAt<transB ? 0 : 1> == N, "The columns of B do not match the columns of C.");
+        static_assert(QuTB::size::template dimAt<transB ? 1 : 0> == K, "The inner dimensions of A and B do not match.");
+
+        using a_t = typename QuTA::elem_t;
+        using b_t = typename QuTB::elem_t;
+        using kernel = QdotKernel<reducer, mulList>;
+        using planes = QcomplexPlanes<mulList, a_t, b_t>;
+
+        // 按行打包 A、按列打包 B，转置在打包时完成，之后的内积都是连续访问
+        auto getA = [&](size_t idx) -> a_t {
+            if constexpr (transA)
+            {
+                return A[idx % K, idx / K];
+            }
+            else
+            {
+                return A[idx / K, idx % K];
+            }
+        };
+        auto getB = [&](size_t idx) -> b_t {
+            if constexpr (transB)
+            {
+                return B[idx / K, idx % K];
+            }
+            else
+            {
+                return B[idx % K, idx / K];
+            }
+        };
 
-        if constexpr (sr<Args...>::dim == 0)
+        constexpr size_t tile = std::clamp<size_t>(tileBytes / (K * (sizeof(a_t) + sizeof(b_t))), 4, 64);
+
+        if constexpr (planes::enabled)
         {
-            return targetTensor[i + sr<Args...>::start, j];
+            // 复数按平面打包，预加只在打包时计算一次
+            const auto packA = planes::packA(M * K, getA);
+            const auto packB = planes::packB(N * K, getB);
+
+            tiled<M, N, tile>([&](size_t i, size_t j) {
+                using prod_t = decltype(Qmul<mulList>(a_t(), b_t()));
+                C[i, j] = kernel::template reduceLeaves<K, prod_t>([&](size_t k) { return planes::product(packA, i * K + k, packB, j * K + k); });
+            });
         }
         else
         {
-            return targetTensor[i, j + sr<Args...>::start];
+            std::vector<a_t> packA(M * K);
+            std::vector<b_t> packB(N * K);
+            for (size_t idx = 0; idx < M * K; idx++)
+            {
+                packA[idx] = getA(idx);
+            }
+            for (size_t idx = 0; idx < N * K; idx++)
+            {
+                packB[idx] = getB(idx);
+            }
+
+            tiled<M, N, tile>([&](size_t i, size_t j) {
+                C[i, j] = kernel::template dot<K, a_t, b_t>(packA.data() + i * K, packB.data() + j * K);
+            });
         }
     }
 
-    auto &operator[](size_t index) const
+    // 按 tile x tile 的输出分块调用 body(i, j)，分块之间可并行
+    template <size_t M, size_t N, size_t tile>
+    static void tiled(const auto &element)
     {
-        // transfer 1-d index to 2-d index, col-major
-        size_t j = index / row;
-        size_t i = index % row;
+        constexpr size_t tilesM = (M + tile - 1) / tile;
+        constexpr size_t tilesN = (N + tile - 1) / tile;
+
+        auto body = [&](size_t begin, size_t end) {
+            for (size_t t = begin; t < end; t++)
+            {
+                const size_t i0 = (t % tilesM) * tile;
+                const size_t j0 = (t / tilesM) * tile;
+
+                for (size_t j = j0; j < std::min(j0 + tile, N); j++)
+                {
+                    for (size_t i = i0; i < std::min(i0 + tile, M); i++)
+                    {
+                        element(i, j);
+                    }
+                }
+            }
+        };
 
-        if constexpr (sr<Args...>::dim == 0)
+        if constexpr (isParallel<policy>)
         {
-            return targetTensor[i + sr<Args...>::start, j];
+            QuThreadPool::instance().parallelFor(tilesM * tilesN, policy::value, body);
         }
         else
         {
-            return targetTensor[i, j + sr<Args...>::start];
+            body(0, tilesM * tilesN);
         }
     }
+};
 
-    auto &operator[](size_t i, size_t j)
+// A 与 B 都可以是稀疏矩阵
+template <typename... Args, typename QuTC, typename QuTA, typename QuTB>
+inline QuTC &Qgemul(QuTC &C, const QuTA &A, const QuTB &B)
+{
+    if constexpr (isSparse<QuTA> || isSparse<QuTB>)
     {
-        if constexpr (sr<Args...>::dim == 0)
-        {
-            return targetTensor[i + sr<Args...>::start, j];
-        }
-        else
-        {
-            return targetTensor[i, j + sr<Args...>::start];
-        }
+        QsparseBlas_s<Args...>::gemul(C, A, B);
     }
-
-    auto &operator[](size_t i, size_t j) const
+    else
     {
-        if constexpr (sr<Args...>::dim == 0)
-        {
-            return targetTensor[i + sr<Args...>::start, j];
-        }
-        else
-        {
-            return targetTensor[i, j + sr<Args...>::start];
-        }
+        Qgemul_s<Args...>::gemul(C, A, B);
     }
-};
+    return C;
+}
 
-template <typename targetTensorT, size_t... Args1, size_t... Args2>
-    requires(targetTensorT::size::dimSize == 2 && sr<Args2...>::end - sr<Args2...>::start > 1 && sr<Args1...>::end - sr<Args1...>::start > 1)
-class SliceExpression<targetTensorT, sr<Args1...>, sr<Args2...>>
+// ------------------- Sparse BLAS -------------------
+// 稀疏矩阵参与的 Qgemv 与 Qgemul：每个输出元素只以两侧都不是结构零的位置作为叶子，按 Reducer::reduce_dynamic 逐层归约
+// 即硬件只把非零元送进加法树时的量化顺序；一行中没有结构零时与稠密的结果逐位相同
+// 标签与稠密版本相同，Qgemv 使用 Qdot_s 的标签，Qgemul 使用 Qgemul_s 的标签
+
+template <typename... Args>
+struct QsparseBlas_s
 {
-public:
-    inline static constexpr size_t row = sr<Args1...>::dim == 0 ? sr<Args1...>::end - sr<Args1...>::start : sr<Args2...>::end - sr<Args2...>::start;
-    inline static constexpr size_t col = sr<Args1...>::dim == 1 ? sr<Args1...>::end - sr<Args1...>::start : sr<Args2...>::end - sr<Args2...>::start;
-    using size = dim<row, col>;
+    template <typename QuTY, typename QuTA, typename QuTX>
+    static void gemv(QuTY &y, const QuTA &A, const QuTX &x)
+    {
+        using dense = Qdot_s<Args...>;
+        using reducer = typename dense::reducer;
+        using mulList = typename dense::mulList;
+        using policy = typename dense::policy;
+        constexpr bool transA = dense::transA;
 
-    inline static constexpr size_t rowStart = sr<Args1...>::dim == 0 ? sr<Args1...>::start : sr<Args2...>::start;
-    inline static constexpr size_t colStart = sr<Args1...>::dim == 1 ? sr<Args1...>::start : sr<Args2...>::start;
+        static_assert(QuTX::dimSize == 1 && QuTY::dimSize == 1, "Qgemv only supports a matrix and vectors.");
 
-    const targetTensorT &targetTensor;
+        constexpr size_t M = QuTY::elemSize;
+        constexpr size_t K = QuTX::elemSize;
 
-    SliceExpression(const targetTensorT &targetTensor)
-        : targetTensor(targetTensor) {}
+        static_assert(QuTA::size::template dimAt<transA ? 1 : 0> == M, "The rows of A do not match the length of y.");
+        static_assert(QuTA::size::template dimAt<transA ? 0 : 1> == K, "The columns of A do not match the length of x.");
 
-    auto &operator[](size_t index)
-    {
-        // transfer 1-d index to 2-d index, col-major
-        size_t j = index / row;
-        size_t i = index % row;
+        using a_t = typename QuTA::elem_t;
+        using x_t = typename QuTX::elem_t;
+        using y_t = typename QuTY::elem_t;
+        using prod_t = decltype(Qmul<mulList>(a_t(), x_t()));
 
-        return targetTensor[i + rowStart, j + colStart];
-    }
+        std::vector<x_t> packX(K);
+        for (size_t k = 0; k < K; k++)
+        {
+            packX[k] = x[k];
+        }
 
-    auto &operator[](size_t index) const
-    {
-        // transfer 1-d index to 2-d index, col-major
-        size_t j = index / row;
-        size_t i = index % row;
+        // op(A) 的每一行
+        const auto rows = A.template lines<!transA>();
 
-        return targetTensor[i + rowStart, j + colStart];
-    }
+        auto body = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                const size_t p = rows.ptr[i];
+                const QdotLeaves leaves{[&](size_t k) { return Qmul<mulList>(rows.vals[p + k], packX[rows.idx[p + k]]); }};
+                y[i] = reducer::template reduce_dynamic<K, prod_t, y_t>(leaves, rows.ptr[i + 1] - p);
+            }
+        };
 
-    auto &operator[](size_t i, size_t j)
-    {
-        return targetTensor[i + rowStart, j + colStart];
+        if constexpr (isParallel<policy>)
+        {
+            QuThreadPool::instance().parallelFor(M, policy::value, body);
+        }
+        else
+        {
+            body(0, M);
+        }
     }
 
-    auto &operator[](size_t i, size_t j) const
+    template <typename QuTC, typename QuTA, typename QuTB>
+    static void gemul(QuTC &C, const QuTA &A, const QuTB &B)
     {
-        return targetTensor[i + rowStart, j + colStart];
-    }
-};
-
-// Dynamic slice
+        using dense = Qgemul_s<Args...>;
+        using reducer = typename dense::reducer;
+        using mulList = typename dense::mulList;
+        constexpr bool transA = dense::transA;
+        constexpr bool transB = dense::transB;
 
-template <>
-struct sr<>
-{
-    size_t dim;
-    size_t start;
-    size_t end;
+        static_assert(QuTA::dimSize == 2 && QuTB::dimSize == 2 && QuTC::dimSize == 2, "Qgemul only supports matrices.");
 
-    sr(size_t _dim, size_t _start, size_t _end)
-        : dim(_dim), start(_start), end(_end) {}
+        constexpr size_t M = QuTC::size::template dimAt<0>;
+        constexpr size_t N = QuTC::size::template dimAt<1>;
+        constexpr size_t K = QuTA::size::template dimAt<transA ? 0 : 1>;
 
-    sr(size_t _dim, size_t _start)
-        : dim(_dim), start(_start), end(_start + 1) {}
+        static_assert(QuTA::size::template dimAt<transA ? 1 : 0> == M, "The rows of A do not match the rows of C.");
+        static_assert(QuTB::size::template dimAt<transB ? 0 : 1> == N, "The columns of B do not match the columns of C.");
+        static_assert(QuTB::size::template dimAt<transB ? 1 : 0> == K, "The inner dimensions of A and B do not match.");
 
-    void display(std::string prefix = "")
-    {
-        std::cout << prefix << "dim: " << dim << " start: " << start << " end: " << end << '\n';
-    }
-};
+        using a_t = typename QuTA::elem_t;
+        using b_t = typename QuTB::elem_t;
+        using c_t = typename QuTC::elem_t;
+        using prod_t = decltype(Qmul<mulList>(a_t(), b_t()));
 
-using srd = sr<>;
+        constexpr size_t tile = std::clamp<size_t>(dense::tileBytes / (K * (sizeof(a_t) + sizeof(b_t))), 4, 64);
 
-template <typename targetTensorT>
-class SliceExpression<targetTensorT>
-{
-public:
-    const targetTensorT &targetTensor;
+        if constexpr (isSparse<QuTA> && isSparse<QuTB>)
+        {
+            // op(A) 的行与 op(B) 的列按下标归并，只保留两侧都存储的位置
+            const auto rows = A.template lines<!transA>();
+            const auto cols = B.template lines<transB>();
 
-    std::array<size_t, targetTensorT::size::dimSize> toLower;
-    std::array<size_t, targetTensorT::size::dimSize> toUpper;
-    std::array<size_t, targetTensorT::size::dimSize> toDimSize;
+            dense::template tiled<M, N, tile>([&](size_t i, size_t j) {
+                thread_local std::vector<std::pair<size_t, size_t>> matched;
+                matched.clear();
+                size_t p = rows.ptr[i];
+                size_t q = cols.ptr[j];
+                while (p < rows.ptr[i + 1] && q < cols.ptr[j + 1])
+                {
+                    if (rows.idx[p] < cols.idx[q])
+                    {
+                        p++;
+                    }
+                    else if (rows.idx[p] > cols.idx[q])
+                    {
+                        q++;
+                    }
+                    else
+                    {
+                        matched.emplace_back(p++, q++);
+                    }
+                }
 
-    SliceExpression(const targetTensorT &f, auto... srs)
-        : targetTensor(f)
-    {
+                const QdotLeaves leaves{[&](size_t k) { return Qmul<mulList>(rows.vals[matched[k].first], cols.vals[matched[k].second]); }};
+                C[i, j] = reducer::template reduce_dynamic<K, prod_t, c_t>(leaves, matched.size());
+            });
+        }
+        else if constexpr (isSparse<QuTA>)
+        {
+            // B 按列打包，转置在打包时完成
+            std::vector<b_t> packB(N * K);
+            for (size_t idx = 0; idx < N * K; idx++)
+            {
+                if constexpr (transB)
+                {
+                    packB[idx] = B[idx / K, idx % K];
+                }
+                else
+                {
+                    packB[idx] = B[idx % K, idx / K];
+                }
+            }
+            const auto rows = A.template lines<!transA>();
 
-        static auto updateTargetDim = [srs..., this]<size_t... Is>(size_t index, std::index_sequence<Is...>) {
-            toLower[index] = (0 + ... + (index == srs.dim ? srs.start : 0));
-            toUpper[index] = (0 + ... + (index == srs.dim ? srs.end : 0));
-            if (toUpper[index] == 0)
+            dense::template tiled<M, N, tile>([&](size_t i, size_t j) {
+                const size_t p = rows.ptr[i];
+                const b_t *col = packB.data() + j * K;
+                const QdotLeaves leaves{[&](size_t k) { return Qmul<mulList>(rows.vals[p + k], col[rows.idx[p + k]]); }};
+                C[i, j] = reducer::template reduce_dynamic<K, prod_t, c_t>(leaves, rows.ptr[i + 1] - p);
+            });
+        }
+        else
+        {
+            // A 按行打包
+            std::vector<a_t> packA(M * K);
+            for (size_t idx = 0; idx < M * K; idx++)
             {
-                toUpper[index] = targetTensorT::size::dimArray[index];
+                if constexpr (transA)
+                {
+                    packA[idx] = A[idx % K, idx / K];
+                }
+                else
+                {
+                    packA[idx] = A[idx / K, idx % K];
+                }
             }
-        };
+            const auto cols = B.template lines<transB>();
 
-        [this]<size_t... Is>(std::index_sequence<Is...>) {
-            (updateTargetDim(Is, std::make_index_sequence<sizeof...(srs)>{}), ...);
-        }(std::make_index_sequence<targetTensorT::size::dimSize>{});
+            dense::template tiled<M, N, tile>([&](size_t i, size_t j) {
+                const size_t q = cols.ptr[j];
+                const a_t *row = packA.data() + i * K;
+                const QdotLeaves leaves{[&](size_t k) { return Qmul<mulList>(row[cols.idx[q + k]], cols.vals[q + k]); }};
+                C[i, j] = reducer::template reduce_dynamic<K, prod_t, c_t>(leaves, cols.ptr[j + 1] - q);
+            });
+        }
     }
+};
 
-    inline auto &operator[](auto... index)
-    {
-    }
+// ===================== Signal processing =====================
+// ------------------- Qfft -------------------
+// 定点 FFT，按时间抽取：输入按位反转重排后逐级计算蝶形，支持基 2 与基 4（log2 N 为奇数时第一级为基 2）
+// 每一级的输出只量化一次，对应 RTL 中每一级的寄存器：
+//   旋转因子乘法按 ComplexMulMethod 量化，蝶形的加减在全精度下完成，按 FftScaling 右移后再量化为该级的 StageTypes
+// 不指定 ComplexMulMethod 时乘法为全精度
+// 旋转因子表按 TwiddleT 量化，能在编译期求值时在编译期生成
+
+enum class FftScale
+{
+    none,      // 不缩放
+    stage,     // 每一级固定除以基数
+    blockFloat // 块浮点：每一级选择使整个块不溢出该级类型的最小右移
 };
 
-// ------------------- Basic tensor operations -------------------
+// 每一级输出的类型，可以是实数类型（实部与虚部相同）或复数类型，级数多于类型时沿用最后一个
+template <typename... Args>
+struct StageTypes
+{
+    using list = TypeList<Args...>;
+};
 
-// convert string to single complex
-template <typename Qcomplex_t>
-    requires(Qcomplex_t::is_complex)
-Qcomplex_t str2Qcomplex(std::string const &str)
+template <typename... Args>
+struct StageTypes<TypeList<Args...>>
 {
-    Qcomplex_t res;
-    int real_decimal = std::stoi(str.substr(0, Qcomplex_t::realWidth), nullptr, 2);
-    int imag_decimal = std::stoi(str.substr(Qcomplex_t::realWidth, Qcomplex_t::imagWidth), nullptr, 2);
-    res.fill(real_decimal, imag_decimal);
-    return res;
-}
+    using list = TypeList<Args...>;
+};
 
-// BitStream converter
-struct l2r
-{};
+template <typename T>
+struct TwiddleT
+{
+};
 
-template <size_t... in>
-    requires(sizeof...(in) <= 1)
-struct r2l;
+template <size_t radix>
+struct Radix
+{
+};
 
-template <size_t in>
-struct r2l<in>
+// BasicComplexMul<...> 或 TFComplexMul<...>
+template <typename Method>
+struct ComplexMulMethod
 {
-    inline static constexpr size_t index = in;
 };
 
-template <>
-struct r2l<> : r2l<1>
+template <FftScale scale>
+struct FftScaling
 {
 };
 
-// handle string to string
-template <typename... Args>
-struct SingleString_s;
+template <bool inverse>
+struct FftInverse
+{
+};
 
-template <>
-struct SingleString_s<l2r>
+template <size_t N, typename... Args>
+struct Qfft_s
 {
-    inline static constexpr auto convert(std::string_view str)
+    static_assert(N >= 2 && std::has_single_bit(N), "Qfft only supports power-of-two lengths.");
+
+    using stageList = typename tagExtractor<StageTypes<>, Args...>::type::list;
+    using twiddleArg = typename tagExtractor<TwiddleT<Qu<intBits<1>, fracBits<14>, QuMode<RND::INF>>>, Args...>::type;
+    using mulMethod = typename tagExtractor<ComplexMulMethod<BasicComplexMul<acT<FullPrec>, bdT<FullPrec>, adT<FullPrec>, bcT<FullPrec>, acbdT<FullPrec>, adbcT<FullPrec>>>, Args...>::type;
+    using policy = typename tagExtractor<QuExec<Parallel<>>, Args...>::type;
+    static constexpr size_t radix = tagExtractor<Radix<2>, Args...>::value;
+    static constexpr FftScale scaling = tagExtractor<FftScaling<FftScale::none>, Args...>::value;
+    static constexpr bool inverse = tagExtractor<FftInverse<false>, Args...>::value;
+
+    static constexpr bool hasStageTypes = stageList::size > 0;
+
+    static_assert(radix == 2 || radix == 4, "Qfft only supports Radix<2> and Radix<4>.");
+    static_assert(scaling != FftScale::blockFloat || hasStageTypes, "Block floating point needs StageTypes to decide the shifts.");
+
+    static constexpr size_t log2N = std::countr_zero(N);
+    static constexpr size_t stages = radix == 2 ? log2N : (log2N + 1) / 2;
+
+    inline static constexpr size_t stageRadix(size_t s)
     {
-        return std::string(str);
+        return radix == 2 || (s == 0 && log2N % 2 == 1) ? 2 : 4;
     }
 
-    // from function, currently indentical to convert
-    inline static constexpr auto from(std::string_view str)
+    // 第 s 级蝶形的跨度，即该级输出的子变换长度
+    inline static constexpr size_t stageSpan(size_t s)
     {
-        return convert(str);
+        size_t span = 1;
+        for (size_t i = 0; i <= s; i++)
+        {
+            span *= stageRadix(i);
+        }
+        return span;
     }
 
-    // to function, currently indentical to convert
-    inline static constexpr auto to(std::string_view str)
+    inline static constexpr size_t bitReverse(size_t i)
     {
-        return convert(str);
+        size_t res = 0;
+        for (size_t b = 0; b < log2N; b++)
+        {
+            res = (res << 1) | ((i >> b) & 1);
+        }
+        return res;
     }
-};
 
-template <size_t... in>
-struct SingleString_s<r2l<in...>>
-{
-    inline static constexpr auto index = r2l<in...>::index;
+    template <typename T>
+    struct complexOf_s
+    {
+        using type = Qcomplex<T, T>;
+    };
 
-    inline static constexpr auto convert(std::string_view str)
+    template <typename T>
+        requires(T::is_complex)
+    struct complexOf_s<T>
     {
-        if (str.size() % index != 0)
+        using type = T;
+    };
+
+    template <typename T>
+    using complexOf = typename complexOf_s<T>::type;
+
+    // ------------------- twiddles -------------------
+
+    using twiddle_t = complexOf<twiddleArg>;
+
+    // W_N^k = exp(-2 pi i k / N)，逆变换取共轭
+    template <typename Container>
+    inline static constexpr Container buildTwiddles()
+    {
+        Container table{};
+        if constexpr (!std::is_same_v<Container, std::array<twiddle_t, N>>)
         {
-            throw std::runtime_error("Invalid string length: Must be a multiple of " + std::to_string(index));
+            table.resize(N);
+        }
+        for (size_t k = 0; k < N; k++)
+        {
+            const double angle = (inverse ? 2.0 : -2.0) * std::numbers::pi * static_cast<double>(k) / static_cast<double>(N);
+            table[k] = twiddle_t(std::cos(angle), std::sin(angle));
         }
+        return table;
+    }
 
-        std::string res;
-        res.reserve(str.size());
+    template <typename T = void>
+    inline static constexpr bool constexprBuildable = requires {
+        typename std::integral_constant<bool, (buildTwiddles<std::array<twiddle_t, N>>(), true)>;
+    };
 
-        // Reverse chunks of size Index directly
-        for (size_t i = str.size(); i >= index; i -= index)
+    inline static constexpr bool compileTime = N <= 4096 && constexprBuildable<>;
+
+    inline static constexpr std::array<twiddle_t, compileTime ? N : 1> constTwiddles = [] {
+        if constexpr (compileTime)
         {
-            res.append(str.data() + i - index, index);
+            return buildTwiddles<std::array<twiddle_t, N>>();
         }
+        else
+        {
+            return std::array<twiddle_t, 1>{};
+        }
+    }();
 
-        return res;
+    inline static const twiddle_t &twiddle(size_t k)
+    {
+        if constexpr (compileTime)
+        {
+            return constTwiddles[k];
+        }
+        else
+        {
+            static const std::vector<twiddle_t> table = buildTwiddles<std::vector<twiddle_t>>();
+            return table[k];
+        }
     }
 
-    // from function, currently indentical to convert
-    inline static constexpr auto from(std::string_view str)
+    // ------------------- butterflies -------------------
+
+    // 原始整数不变、小数点左移 shift 位，即精确地除以 2^shift
+    template <int shift, typename QuT>
+    inline static constexpr auto scaleDown(const QuT &x)
     {
-        return convert(str);
+        if constexpr (QuT::is_complex)
+        {
+            auto realPart = scaleDown<shift>(x.real);
+            auto imagPart = scaleDown<shift>(x.imag);
+            return Qcomplex<decltype(realPart), decltype(imagPart)>(realPart, imagPart);
+        }
+        else
+        {
+            Qu_s<intBits<QuT::intB - shift>, fracBits<QuT::fracB + shift>, isSigned<QuT::isS>, QuMode<typename QuT::QuM_t>, OfMode<typename QuT::OfM_t>> res;
+            res.data = x.data;
+            return res;
+        }
     }
 
-    // to function, currently indentical to convert
-    inline static constexpr auto to(std::string_view str)
+    // 蝶形中的加减不舍入
+    template <typename A, typename B>
+    inline static constexpr auto exactAdd(const A &a, const B &b)
     {
-        return convert(str);
+        return Qadd<realT<FullPrec>, imagT<FullPrec>>(a, b);
     }
-};
 
-template <typename... Args>
-struct TensorString_s;
+    template <typename A, typename B>
+    inline static constexpr auto exactSub(const A &a, const B &b)
+    {
+        return Qsub<realT<FullPrec>, imagT<FullPrec>>(a, b);
+    }
 
-template <typename elemProcessT>
-struct TensorString_s<l2r, elemProcessT>
-{
-    // convert to std::array<std::string, size> with element string stored in l2r
-    // the input string is expected to be a single string containing all elements, each element has length of elemWidth
-    template <typename QuTensorT>
-    inline static constexpr auto fromString(std::string_view str)
+    // 乘以 -i（逆变换为 +i）只交换实部与虚部并取反，没有舍入
+    template <typename C>
+    inline static constexpr auto rotate(const C &x)
     {
-        using QuT = typename QuTensorT::elem_t;
-        static constexpr auto elemWidth = QuT::width;
-        static constexpr auto elemSize = QuTensorT::elemSize;
-        if (str.size() % elemWidth != 0)
+        if constexpr (inverse)
         {
-            throw std::runtime_error("Invalid string length: Must be a multiple of " + std::to_string(elemWidth));
+            auto realPart = Qneg(x.imag);
+            return Qcomplex<decltype(realPart), decltype(x.real)>(realPart, x.real);
         }
-
-        std::array<std::string, elemSize> res;
-        for (size_t i = 0; i < res.size(); i++)
+        else
         {
-            res[i] = SingleString_s<elemProcessT>::convert(str.substr(i * elemWidth, elemWidth));
+            auto imagPart = Qneg(x.real);
+            return Qcomplex<decltype(x.imag), decltype(imagPart)>(x.imag, imagPart);
         }
-
-        return res;
     }
 
-    template <size_t arrSize>
-    inline static constexpr auto toString(std::array<std::string, arrSize> arr)
+    // 能无损容纳所有输入的实部与虚部的复数类型
+    template <typename... Cs>
+    struct common_s
     {
-        std::string res;
-        res.reserve(arr.size() * arr[0].size());
+        static constexpr int intB = std::max({Cs::realType::intB..., Cs::imagType::intB...});
+        static constexpr int fracB = std::max({Cs::realType::fracB..., Cs::imagType::fracB...});
+        using part_t = Qu<intBits<intB>, fracBits<fracB>>;
+        using type = Qcomplex<part_t, part_t>;
+    };
 
-        for (size_t i = 0; i < arr.size(); i++)
-        {
-            res.append(SingleString_s<elemProcessT>::to(arr[i]));
-        }
+    template <size_t s, bool = hasStageTypes>
+    struct stageArg_s
+    {
+        using type = complexOf<TypeAt<std::min(s, stageList::size - 1), stageList>>;
+    };
 
-        return res;
-    }
+    template <size_t s>
+    struct stageArg_s<s, false>
+    {
+        using type = void;
+    };
 
-    // from QuBLAS type to std::array<std::string, size>
-    template <size_t... dims, typename QuT>
-    inline static constexpr auto fromQu(Qu_s<dim<dims...>, QuT> const &tensor)
+    template <size_t s, typename InT>
+    struct Stage
     {
-        std::array<std::string, dim<dims...>::elemSize> res;
+        static constexpr size_t r = stageRadix(s);
+        static constexpr size_t span = stageSpan(s);
+        static constexpr size_t quarter = span / r;
+        static constexpr int maxShift = r == 2 ? 1 : 2;
+        static constexpr int staticShift = scaling == FftScale::stage ? maxShift : 0;
 
-        for (size_t i = 0; i < dim<dims...>::elemSize; i++)
+        using prod_t = decltype(Qmul<mulMethod>(twiddle_t(), InT()));
+
+        // 蝶形全精度输出的公共类型
+        using full_t = std::conditional_t<r == 2,
+                                          typename common_s<decltype(exactAdd(InT(), prod_t())), decltype(exactSub(InT(), prod_t()))>::type,
+                                          typename common_s<decltype(exactAdd(exactAdd(InT(), prod_t()), exactAdd(prod_t(), prod_t()))),
+                                                            decltype(exactSub(exactAdd(InT(), prod_t()), exactAdd(prod_t(), prod_t()))),
+                                                            decltype(exactAdd(exactSub(InT(), prod_t()), rotate(exactSub(prod_t(), prod_t())))),
+                                                            decltype(exactSub(exactSub(InT(), prod_t()), rotate(exactSub(prod_t(), prod_t()))))>::type>;
+
+        using out_t = std::conditional_t<hasStageTypes, typename stageArg_s<s>::type, decltype(scaleDown<staticShift>(full_t()))>;
+
+        template <typename C>
+        inline static out_t finish(const C &x, int shift)
         {
-            res[i] = SingleString_s<elemProcessT>::to(tensor[i].toString());
+            if constexpr (!hasStageTypes)
+            {
+                return out_t(scaleDown<staticShift>(full_t(x)));
+            }
+            else if (shift == 0)
+            {
+                return out_t(x);
+            }
+            else if (shift == 1)
+            {
+                return out_t(scaleDown<1>(x));
+            }
+            else
+            {
+                return out_t(scaleDown<2>(x));
+            }
         }
-        return res;
-    }
-
-    // from std::array<std::string, size> to QuBLAS type
-    template <typename QuTensorT>
-    inline static constexpr auto toQu(std::array<std::string, QuTensorT::elemSize> const &arr)
-    {
-        QuTensorT res;
-        using elem_t = QuTensorT::elem_t;
 
-        for (size_t i = 0; i < QuTensorT::elemSize; i++)
+        // 对每个输出调用 emit(下标, 全精度的值)
+        template <typename Emit>
+        inline static void butterflies(const InT *in, Emit &&emit)
         {
-            std::string str = SingleString_s<elemProcessT>::from(arr[i]);
+            for (size_t base = 0; base < N; base += span)
+            {
+                for (size_t j = 0; j < quarter; j++)
+                {
+                    const size_t k = base + j;
+                    const size_t w = j * (N / span);
 
-            // convert binary stored in str to integer
-            if constexpr (elem_t::is_complex)
+                    if constexpr (r == 2)
+                    {
+                        const auto t = Qmul<mulMethod>(twiddle(w), in[k + quarter]);
+                        emit(k, exactAdd(in[k], t));
+                        emit(k + quarter, exactSub(in[k], t));
+                    }
+                    else
+                    {
+                        // 位反转顺序下第二、三个子变换分别乘以 W^2j 与 W^j
+                        const auto b = Qmul<mulMethod>(twiddle(2 * w), in[k + quarter]);
+                        const auto c = Qmul<mulMethod>(twiddle(w), in[k + 2 * quarter]);
+                        const auto d = Qmul<mulMethod>(twiddle(3 * w), in[k + 3 * quarter]);
+
+                        const auto apb = exactAdd(in[k], b);
+                        const auto amb = exactSub(in[k], b);
+                        const auto cpd = exactAdd(c, d);
+                        const auto rot = rotate(exactSub(c, d));
+
+                        emit(k, exactAdd(apb, cpd));
+                        emit(k + quarter, exactAdd(amb, rot));
+                        emit(k + 2 * quarter, exactSub(apb, cpd));
+                        emit(k + 3 * quarter, exactSub(amb, rot));
+                    }
+                }
+            }
+        }
+
+        // 返回这一级的右移位数
+        inline static int run(const InT *in, out_t *out)
+        {
+            if constexpr (scaling == FftScale::blockFloat)
             {
-                res[i] = str2Qcomplex<elem_t>(str);
+                std::vector<full_t> exact(N);
+                butterflies(in, [&](size_t i, const auto &x) { exact[i] = full_t(x); });
+
+                // 该级类型能表示的最大幅度
+                constexpr double limit = std::min(std::ldexp(1.0, out_t::realType::intB) - std::ldexp(1.0, -out_t::realType::fracB),
+                                                  std::ldexp(1.0, out_t::imagType::intB) - std::ldexp(1.0, -out_t::imagType::fracB));
+                double maxAbs = 0;
+                for (const auto &x : exact)
+                {
+                    maxAbs = std::max({maxAbs, std::abs(x.real.toDouble()), std::abs(x.imag.toDouble())});
+                }
+
+                int shift = 0;
+                while (shift < maxShift && maxAbs > std::ldexp(limit, shift))
+                {
+                    shift++;
+                }
+
+                for (size_t i = 0; i < N; i++)
+                {
+                    out[i] = finish(exact[i], shift);
+                }
+                return shift;
             }
             else
             {
-                int decimal = std::stoi(str, nullptr, 2);
-                res[i].fill(decimal);
+                butterflies(in, [&](size_t i, const auto &x) { out[i] = finish(x, staticShift); });
+                return staticShift;
             }
         }
+    };
 
-        return res;
-    }
-};
+    // 依次经过各级后的元素类型
+    template <size_t s, typename InT>
+    struct chain_s
+    {
+        using type = typename chain_s<s + 1, typename Stage<s, InT>::out_t>::type;
+    };
 
-template <typename elemProcessT, size_t index>
-struct TensorString_s<r2l<index>, elemProcessT>
-{
-    template <typename QuTensorT>
-    inline static constexpr auto fromString(std::string_view str)
+    template <typename InT>
+    struct chain_s<stages, InT>
     {
-        using QuT = typename QuTensorT::elem_t;
-        static constexpr auto elemWidth = QuT::width;
-        static constexpr auto elemSize = QuTensorT::elemSize;
-        if (str.size() % elemWidth != 0)
-        {
-            throw std::runtime_error("Invalid string length: Must be a multiple of " + std::to_string(elemWidth));
-        }
+        using type = InT;
+    };
 
-        std::array<std::string, elemSize> res;
+    template <typename InT>
+    using result_t = typename chain_s<0, InT>::type;
 
-        // Reverse chunks of size Index directly
-        size_t in = 0;
-        for (size_t i = elemSize; i > 0; i = i - index)
+    template <size_t s, typename InT, typename QuTO>
+    inline static int runStages(const std::vector<InT> &in, QuTO &out, size_t offset)
+    {
+        using stage = Stage<s, InT>;
+        std::vector<typename stage::out_t> next(N);
+        const int shift = stage::run(in.data(), next.data());
+
+        if constexpr (s + 1 == stages)
         {
-            for (size_t j = 0; j < index; j++)
+            for (size_t i = 0; i < N; i++)
             {
-                res[in] = SingleString_s<elemProcessT>::convert(str.substr((i + j - index) * elemWidth, elemWidth));
-                in++;
+                out[offset + i] = next[i];
             }
+            return shift;
+        }
+        else
+        {
+            return shift + runStages<s + 1>(next, out, offset);
         }
-
-        return res;
     }
 
-    template <size_t arrSize>
-    inline static constexpr auto toString(std::array<std::string, arrSize> arr)
+    // 变换 in 中从 offset 开始的 N 个元素，写入 out 的相同位置
+    template <typename QuTO, typename QuTI>
+    inline static int column(QuTO &out, const QuTI &in, size_t offset)
     {
-        std::string res;
-        res.reserve(arr.size() * arr[0].size());
+        using in_t = typename QuTI::elem_t;
+        static_assert(in_t::is_complex, "Qfft needs complex inputs.");
 
-        // reverse the order of elements, with every Index elements as a chunk
-        for (size_t i = arr.size(); i > 0; i = i - index)
+        std::vector<in_t> reordered(N);
+        for (size_t i = 0; i < N; i++)
         {
-            for (size_t j = 0; j < index; j++)
-            {
-                res.append(SingleString_s<elemProcessT>::to(arr[i + j - index]));
-            }
+            reordered[bitReverse(i)] = in[offset + i];
         }
-        return res;
+        return runStages<0>(reordered, out, offset);
     }
-};
 
-// scalar
-template <typename... Args>
-struct BitStream_s;
+    template <typename QuTO, typename QuTI>
+    inline static int fft(QuTO &out, const QuTI &in)
+    {
+        static_assert(QuTI::elemSize == N && QuTO::elemSize == N, "Qfft needs tensors of length N.");
+        return column(out, in, 0);
+    }
 
-template <typename... QuArgs, typename processT>
-struct BitStream_s<Qu_s<QuArgs...>, processT>
-{
-    inline static auto convert(std::string_view str)
+    // dim<N, symbols> 的每一列是一个独立的变换，各列之间并行
+    template <typename QuTO, typename QuTI>
+    inline static auto batch(QuTO &out, const QuTI &in)
     {
-        using elem_t = Qu_s<QuArgs...>;
-        elem_t res;
+        static_assert(QuTI::dimSize == 2 && QuTI::size::template dimAt<0> == N, "QfftBatch needs a dim<N, symbols> tensor.");
+        static_assert(QuTO::elemSize == QuTI::elemSize, "The output does not match the input.");
 
-        auto is_bin_char = [](char ch) { return (ch == '0') || (ch == '1'); };
-        auto filtered_view = str | std::views::filter(is_bin_char);
-        std::string filtered_str(filtered_view.begin(), filtered_view.end());
-        std::string toStr = SingleString_s<processT>::from(filtered_str);
+        constexpr size_t symbols = QuTI::size::template dimAt<1>;
+        std::array<int, symbols> exponents{};
 
-        if constexpr (elem_t::is_complex)
+        auto body = [&](size_t begin, size_t end) {
+            for (size_t b = begin; b < end; b++)
+            {
+                exponents[b] = column(out, in, b * N);
+            }
+        };
+
+        if constexpr (isParallel<policy>)
         {
-            res = str2Qcomplex<elem_t>(toStr);
+            QuThreadPool::instance().parallelFor(symbols, policy::value, body);
         }
         else
         {
-            int decimal = std::stoi(toStr, nullptr, 2);
-            res.fill(decimal);
+            body(0, symbols);
         }
-
-        return res;
-    }
-};
-
-template <typename processT>
-struct BitStream_s<processT>
-{
-    inline static auto convert(auto const &Qu)
-    {
-        return SingleString_s<processT>::to(Qu.toString());
-    }
-};
-
-// tensor
-template <typename QuT, size_t... dims, typename tensorProcessT, typename elemProcessT>
-struct BitStream_s<Qu_s<dim<dims...>, QuT>, tensorProcessT, elemProcessT>
-{
-    inline static auto convert(std::string_view str)
-    {
-        // use TensorString_s
-        auto is_bin_char = [](char ch) { return (ch == '0') || (ch == '1'); };
-        auto filtered_view = str | std::views::filter(is_bin_char);
-        std::string filtered_str(filtered_view.begin(), filtered_view.end());
-
-        auto arr = TensorString_s<tensorProcessT, elemProcessT>::template fromString<Qu_s<dim<dims...>, QuT>>(filtered_str);
-        return TensorString_s<l2r, l2r>::template toQu<Qu_s<dim<dims...>, QuT>>(arr);
+        return exponents;
     }
 };
 
-template <typename tensorProcessT, typename elemProcessT>
-struct BitStream_s<tensorProcessT, elemProcessT>
+// 返回结果的指数：真实结果为 out * 2^exponent，不缩放时为 0
+template <size_t N, typename... Args, typename QuTO, typename QuTI>
+inline int Qfft(QuTO &out, const QuTI &in)
 {
-    template <typename... QuArgs>
-    inline static auto convert(Qu_s<QuArgs...> const &Qu)
-    {
-        auto arr = TensorString_s<l2r, l2r>::fromQu(Qu);
-        return TensorString_s<tensorProcessT, elemProcessT>::toString(arr);
-    }
-};
+    return Qfft_s<N, Args...>::fft(out, in);
+}
 
-template <typename... Args>
-inline auto BitStream(auto const &input)
+// 对 dim<N, symbols> 的每一列做变换，返回每一列的指数
+template <typename... Args, typename QuTO, typename QuTI>
+inline auto QfftBatch(QuTO &out, const QuTI &in)
 {
-    return BitStream_s<Args...>::convert(input);
+    return Qfft_s<QuTI::size::template dimAt<0>, Args...>::batch(out, in);
 }
 
-// ------------------- Advanced Nonlinear Universal Subprograms -------------------
-// the operations like lookup table, linear/polynomial fitting, etc. used to implement the non-linear operation in asic
-// note that the operations are not standard BLAS operations, use ANUS:: to get access to them
+// Qfft 输出元素的类型
+template <size_t N, typename InT, typename... Args>
+using QfftResult = typename Qfft_s<N, Args...>::template result_t<InT>;
 
-namespace ANUS {
+// ------------------- Qfir / Qconv2d -------------------
+// Qfir 逐块处理不定长的输入流，每个输出是 h[k] * x[n - k] 的 Taps 个乘积经 QdotKernel 归约，与先 Qmul 再 Qreduce 逐位一致
+// 延迟线保存每个通道最后的 Taps - 1 个输入，每块只拷贝一次接到延迟线之后，窗口之间共享数据而不再逐个切片
 
-// polynomial fitting
-template <auto a0>
-inline static constexpr auto Qpoly(auto x)
+template <typename... Args>
+struct QfirMulArgs
 {
-    return a0;
-}
+    using list = MergerArgsWrapper<Args...>;
+};
 
-// return a0 + a1 * x + a2 * x^2 + ...
-template <auto a0, auto a1, auto... as>
-inline static constexpr auto Qpoly(auto x)
+template <typename... Args>
+struct QfirAddArgs
 {
-    return Qadd<decltype(a0)>(
-        a0,
-        Qmul<decltype(a0)>(
-            x,
-            Qpoly<a1, as...>(x)));
-}
+    using reducer = ReducerInputHelper<Args...>;
+};
 
-// segmented linear fitting
-template <double BreakPoint, auto... as>
-struct Segment
+// 从 ptr 开始倒序读取的窗口，第 k 个元素为 x[n - k]
+template <typename T>
+struct QfirWindow
 {
-    static constexpr double breakpoint = BreakPoint;
+    const T *ptr;
 
-    inline static constexpr auto func(auto x)
+    inline constexpr const T &operator[](size_t k) const
     {
-        return Qpoly<as...>(x);
+        return *(ptr - k);
     }
 };
 
-template <typename Segment1, typename... Rest>
-constexpr auto Qapprox(auto x)
+// CoefT 为 Qu<dim<Taps>, coef_t>，InT 为输入元素的类型；输入为 dim<B> 或 dim<B, channels>，每一列是一个通道
+template <typename CoefT, typename InT, typename... Args>
+class Qfir
 {
-    if (x.toDouble() < Segment1::breakpoint)
-    {
-        // return Segment1::func(x);
-        return decltype(x){Segment1::func(x)};
-    }
-    else
-    {
-        if constexpr (sizeof...(Rest) > 0)
-        {
-            return Qapprox<Rest...>(x);
-        }
-        else
-        {
-            // 如果超过最后一个分段点，使用最后一个函数
-            // return Segment1::func(x);
-            return decltype(x){Segment1::func(x)};
-        }
-    }
-}
+public:
+    static_assert(CoefT::dimSize == 1, "The coefficients of Qfir must be a vector.");
 
-template <typename... Args>
-struct Qapprox_s
-{
-    inline static constexpr auto execute(auto x)
-    {
-        return Qapprox<Args...>(x);
-    }
-};
+    using coef_t = typename CoefT::elem_t;
+    using in_t = InT;
+    using reducer = typename tagExtractor<QfirAddArgs<>, Args...>::type::reducer;
+    using mulList = typename tagExtractor<QfirMulArgs<>, Args...>::type::list;
+    using policy = typename tagExtractor<QuExec<Parallel<>>, Args...>::type;
+    using kernel = QdotKernel<reducer, mulList>;
 
-} // namespace ANUS
+    static constexpr size_t taps = CoefT::elemSize;
+    static constexpr size_t history = taps - 1;
 
-// ===================== BLAS =====================
-// ------------------- Reducer -------------------
-// it's not a standard BLAS operation, but tree-based reduction is a common operation in asic design
+    // 并行时每个任务计算的输出个数
+    static constexpr size_t blockOutputs = 256;
 
-template <typename... Args>
-struct Reducer
-{
-    template <bool condition, size_t layer>
-    struct ReducerTypeSelector;
+    using out_t = decltype(kernel::template dot<taps, coef_t, in_t>(std::declval<const coef_t *>(), QfirWindow<in_t>{nullptr}));
 
-    // 递归展开的情况，满足条件
-    template <size_t layer>
-    struct ReducerTypeSelector<true, layer>
+    inline Qfir(const CoefT &h, size_t channelCount = 1) : channels(channelCount), coefs(h.data.begin(), h.data.end()), delay(channelCount * history)
     {
-        using type = TypeAt<layer >= sizeof...(Args) ? sizeof...(Args) - 1 : layer, TypeList<Args...>>;
-    };
+    }
 
-    // 基础情况，不满足计算条件的部分
-    template <size_t layer>
-    struct ReducerTypeSelector<false, layer>
+    // 清空延迟线，之后的输出如同输入流从头开始
+    inline void reset()
     {
-        using type = std::nullptr_t;
-    };
+        std::fill(delay.begin(), delay.end(), in_t());
+    }
 
-    // version for arbitrary input, please avoid using this version for efficiency consideration
-    template <size_t layer, typename... Ts, size_t... I>
-    static inline auto reduce_impl(std::index_sequence<I...>,
-                                   const Ts... quants)
+    template <typename QuTY, typename QuTX>
+    void process(QuTY &y, const QuTX &x)
     {
-        // (quants.display("layer " + std::to_string(layer)), ...);
-        if constexpr (sizeof...(quants) == 1)
+        static_assert(std::is_same_v<typename QuTX::elem_t, in_t>, "The input element type does not match the filter.");
+        static_assert(QuTX::dimSize <= 2 && std::is_same_v<typename QuTX::size, typename QuTY::size>, "The input and output of Qfir must be dim<B> or dim<B, channels> of the same shape.");
+
+        constexpr size_t B = QuTX::size::template dimAt<0>;
+        constexpr size_t C = QuTX::elemSize / B;
+
+        if (C != channels)
         {
-            return packIndex<0>(quants...);
+            throw std::invalid_argument("Qfir: the number of channels does not match the filter.");
         }
-        else
-        {
-            using type = typename ReducerTypeSelector<sizeof...(Args) != 0, layer>::type;
-            if constexpr (sizeof...(quants) % 2 == 0)
-            {
-                return reduce_impl<layer + 1>(
-                    std::make_index_sequence<sizeof...(I) / 2>{},
-                    Qadd<type>(packIndex<I * 2>(quants...), packIndex<I * 2 + 1>(quants...))...);
-            }
-            else
-            {
-                auto res = reduce_impl<layer + 1>(
-                    std::make_index_sequence<sizeof...(I) / 2>{},
-                    Qadd<type>(packIndex<I * 2>(quants...), packIndex<I * 2 + 1>(quants...))...);
 
-                return Qadd<type>(res, packIndex<sizeof...(quants) - 1>(quants...));
-            }
+        // 每个通道为 [延迟线, 当前块]
+        constexpr size_t span = history + B;
+        std::vector<in_t> line(C * span);
+        for (size_t c = 0; c < C; c++)
+        {
+            std::copy(delay.begin() + c * history, delay.begin() + (c + 1) * history, line.begin() + c * span);
+            std::copy(x.data.begin() + c * B, x.data.begin() + (c + 1) * B, line.begin() + c * span + history);
         }
-    }
 
-    template <typename... Ts>
-    static auto reduce(const Ts... quants)
-    {
-        return reduce_impl<0>(std::make_index_sequence<sizeof...(Ts) / 2>{}, quants...);
-    }
+        constexpr size_t blocksPerChannel = (B + blockOutputs - 1) / blockOutputs;
 
-    // version for a vec
-    template <size_t layer, size_t len, typename... fromArgs>
-    static auto reduce_impl(const Qu_s<dim<len>, fromArgs...> &quants)
-    {
-        using type = typename ReducerTypeSelector<sizeof...(Args) != 0, layer>::type;
-        // quants.display("layer " + std::to_string(layer));
+        // 各输出相互独立，按通道与输出块并行
+        auto body = [&](size_t begin, size_t end) {
+            for (size_t t = begin; t < end; t++)
+            {
+                const size_t c = t / blocksPerChannel;
+                const size_t n0 = (t % blocksPerChannel) * blockOutputs;
+                const in_t *base = line.data() + c * span + history;
+
+                for (size_t n = n0; n < std::min(n0 + blockOutputs, B); n++)
+                {
+                    y.data[c * B + n] = kernel::template dot<taps, coef_t, in_t>(coefs.data(), QfirWindow<in_t>{base + n});
+                }
+            }
+        };
 
-        static Qu_s<dim<(len + 1) / 2>, typename std::conditional_t<std::is_same_v<type, std::nullptr_t>, Qu<fromArgs...>, type>> res;
-        if constexpr (len == 1)
+        if constexpr (isParallel<policy>)
         {
-            return quants.template get<0>();
+            QuThreadPool::instance().parallelFor(C * blocksPerChannel, policy::value, body);
         }
         else
         {
-            [&res = res, &quants = quants]<size_t... I>(std::index_sequence<I...>) {
-                ((res.template get<I>() = Qadd<type>(quants.template get<I * 2>(), quants.template get<I * 2 + 1>())), ...);
-            }(std::make_index_sequence<len / 2>());
-
-            if constexpr (len % 2 != 0)
-            {
-                res.template get<(len + 1) / 2 - 1>() = quants.template get<len - 1>();
-            }
-
-            return reduce_impl<layer + 1>(res);
+            body(0, C * blocksPerChannel);
         }
-    }
 
-    template <size_t len, typename... fromArgs>
-    static auto reduce(const Qu_s<dim<len>, fromArgs...> &quants)
-    {
-        return reduce_impl<0>(quants);
-    }
-
-    template <size_t... dims, typename... fromArgs>
-    static auto reduce(const Qu_s<dim<dims...>, fromArgs...> &quants)
-    {
-        static Qu_s<dim<dim<dims...>::elemSize>, fromArgs...> vec;
-        for (size_t i = 0; i < dim<dims...>::elemSize; i++)
+        // 最后的 Taps - 1 个输入成为新的延迟线
+        for (size_t c = 0; c < C; c++)
         {
-            vec[i] = quants[i];
+            std::copy(line.begin() + (c + 1) * span - history, line.begin() + (c + 1) * span, delay.begin() + c * history);
         }
-        return reduce(vec);
     }
+
+private:
+    size_t channels;
+    std::vector<coef_t> coefs;
+    std::vector<in_t> delay;
 };
 
-template <typename... Args>
-struct ReducerInputHelper : public Reducer<Args...>
+// Qconv2d 经 im2col 打包后调用 Qgemul，其余标签（QgemulMulArgs、QgemulAddArgs、QuExec）原样传给 Qgemul
+// 输入为 dim<H, W, Cin>，卷积核为 dim<KH, KW, Cin, Cout>，输出为 dim<OH, OW, Cout>
+// 第 k = kh + KH * (kw + KW * ci) 个乘积对应卷积核按列主序的第 k 个元素，因此卷积核直接就是 im2col 之后的 B 矩阵
+
+template <size_t Value>
+struct QconvStride
+{
+};
+
+template <size_t Value>
+struct QconvPadding
 {
 };
 
 template <typename... Args>
-struct ReducerInputHelper<TypeList<Args...>> : public Reducer<Args...>
+struct Qconv2d_s
 {
+    static constexpr size_t stride = tagExtractor<QconvStride<1>, Args...>::value;
+    static constexpr size_t padding = tagExtractor<QconvPadding<0>, Args...>::value;
+
+    template <typename QuTY, typename QuTX, typename QuTW>
+    static void conv(QuTY &y, const QuTX &x, const QuTW &w)
+    {
+        static_assert(QuTX::dimSize == 3 && QuTW::dimSize == 4 && QuTY::dimSize == 3, "Qconv2d only supports dim<H, W, Cin> inputs, dim<KH, KW, Cin, Cout> kernels and dim<OH, OW, Cout> outputs.");
+        static_assert(stride > 0, "The stride must be positive.");
+
+        constexpr size_t H = QuTX::size::template dimAt<0>;
+        constexpr size_t W = QuTX::size::template dimAt<1>;
+        constexpr size_t Cin = QuTX::size::template dimAt<2>;
+        constexpr size_t KH = QuTW::size::template dimAt<0>;
+        constexpr size_t KW = QuTW::size::template dimAt<1>;
+        constexpr size_t Cout = QuTW::size::template dimAt<3>;
+
+        static_assert(QuTW::size::template dimAt<2> == Cin, "The input channels of the kernel do not match the input.");
+        static_assert(H + 2 * padding >= KH && W + 2 * padding >= KW, "The kernel is larger than the padded input.");
+
+        constexpr size_t OH = (H + 2 * padding - KH) / stride + 1;
+        constexpr size_t OW = (W + 2 * padding - KW) / stride + 1;
+        constexpr size_t K = KH * KW * Cin;
+
+        static_assert(QuTY::size::template dimAt<0> == OH && QuTY::size::template dimAt<1> == OW && QuTY::size::template dimAt<2> == Cout, "The output shape does not match the convolution.");
+
+        using x_t = typename QuTX::elem_t;
+        using w_t = typename QuTW::elem_t;
+
+        // 第 p = oh + OH * ow 行为输出位置，填充处为 0
+        Qu_s<dim<OH * OW, K>, x_t> cols;
+        for (size_t ci = 0; ci < Cin; ci++)
+        {
+            for (size_t kw = 0; kw < KW; kw++)
+            {
+                for (size_t kh = 0; kh < KH; kh++)
+                {
+                    const size_t k = kh + KH * (kw + KW * ci);
+                    for (size_t ow = 0; ow < OW; ow++)
+                    {
+                        for (size_t oh = 0; oh < OH; oh++)
+                        {
+                            const size_t ih = oh * stride + kh;
+                            const size_t iw = ow * stride + kw;
+                            const bool inside = ih >= padding && ih < H + padding && iw >= padding && iw < W + padding;
+                            cols.data[oh + OH * ow + OH * OW * k] = inside ? x.data[(ih - padding) + H * ((iw - padding) + W * ci)] : x_t();
+                        }
+                    }
+                }
+            }
+        }
+
+        Qu_s<dim<K, Cout>, w_t> kernels;
+        std::copy(w.data.begin(), w.data.end(), kernels.data.begin());
+
+        // 列主序的 dim<OH * OW, Cout> 与 dim<OH, OW, Cout> 的内存排布相同
+        Qu_s<dim<OH * OW, Cout>, typename QuTY::elem_t> res;
+        Qgemul_s<Args...>::gemul(res, cols, kernels);
+        std::copy(res.data.begin(), res.data.end(), y.data.begin());
+    }
 };
 
-template <typename... Args, typename... Ts>
-inline auto constexpr Qreduce(const Ts... quants)
+template <typename... Args, typename QuTY, typename QuTX, typename QuTW>
+inline QuTY &Qconv2d(QuTY &y, const QuTX &x, const QuTW &w)
 {
-    return ReducerInputHelper<Args...>::reduce(quants...);
+    Qconv2d_s<Args...>::conv(y, x, w);
+    return y;
 }
 
+// ------------------- Precompiled instantiations -------------------
+// 常用宽度的 ArbiInt<1..128> 与默认模式的常用格式在 QuBLAS_instances 库（src/instances.cpp）中显式实例化一次
+// 链接该库时定义 QUBLAS_EXTERN_TEMPLATES，各翻译单元只声明这些实例化，不再各自生成它们的非内联成员
+
+#define QUBLAS_ARBIINT_8(X, base) X(ArbiInt<base + 1>) X(ArbiInt<base + 2>) X(ArbiInt<base + 3>) X(ArbiInt<base + 4>) X(ArbiInt<base + 5>) X(ArbiInt<base + 6>) X(ArbiInt<base + 7>) X(ArbiInt<base + 8>)
+
+// GCC 对第二个受约束的偏特化（N > 64）的显式实例化不生成成员，多字宽度只在其他编译器上预编译
+#if defined(__GNUC__) && !defined(__clang__)
+#define QUBLAS_ARBIINT_WIDE(X)
+#else
+#define QUBLAS_ARBIINT_WIDE(X) QUBLAS_ARBIINT_8(X, 64) QUBLAS_ARBIINT_8(X, 72) QUBLAS_ARBIINT_8(X, 80) QUBLAS_ARBIINT_8(X, 88) QUBLAS_ARBIINT_8(X, 96) QUBLAS_ARBIINT_8(X, 104) QUBLAS_ARBIINT_8(X, 112) QUBLAS_ARBIINT_8(X, 120)
+#endif
+
+#define QUBLAS_DEFAULT_FORMAT(X, intB, fracB) X(Qu_s<intBits<intB>, fracBits<fracB>, isSigned<defaultIsSigned>, QuMode<defaultQuMode>, OfMode<defaultOfMode>>)
+
+#define QUBLAS_PRECOMPILED_TYPES(X) \
+    QUBLAS_ARBIINT_8(X, 0) \
+    QUBLAS_ARBIINT_8(X, 8) \
+    QUBLAS_ARBIINT_8(X, 16) \
+    QUBLAS_ARBIINT_8(X, 24) \
+    QUBLAS_ARBIINT_8(X, 32) \
+    QUBLAS_ARBIINT_8(X, 40) \
+    QUBLAS_ARBIINT_8(X, 48) \
+    QUBLAS_ARBIINT_8(X, 56) \
+    QUBLAS_ARBIINT_WIDE(X) \
+    QUBLAS_DEFAULT_FORMAT(X, defaultIntBits, defaultFracBits) \
+    QUBLAS_DEFAULT_FORMAT(X, 0, 15) \
+    QUBLAS_DEFAULT_FORMAT(X, 0, 31) \
+    QUBLAS_DEFAULT_FORMAT(X, 16, 16)
+
+#if defined(QUBLAS_EXTERN_TEMPLATES)
+#define QUBLAS_EXTERN_TEMPLATE(...) extern template class __VA_ARGS__;
+QUBLAS_PRECOMPILED_TYPES(QUBLAS_EXTERN_TEMPLATE)
+#undef QUBLAS_EXTERN_TEMPLATE
+#endif
+
 } // namespace QuBLAS
\ No newline at end of file
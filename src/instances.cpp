@@ -0,0 +1,11 @@
+// QuBLAS_instances：QUBLAS_PRECOMPILED_TYPES 中各类型的显式实例化定义，链接该库的翻译单元通过 QUBLAS_EXTERN_TEMPLATES 复用这里的结果
+
+#include "QuBLAS.h"
+
+inline namespace QuBLAS {
+
+#define QUBLAS_INSTANTIATE(...) template class __VA_ARGS__;
+QUBLAS_PRECOMPILED_TYPES(QUBLAS_INSTANTIATE)
+#undef QUBLAS_INSTANTIATE
+
+} // namespace QuBLAS
@@ -0,0 +1,69 @@
+#include "QuBLAS.h"
+#include <gtest/gtest.h>
+
+using namespace QuBLAS;
+
+using x_t = Qu<intBits<3>, fracBits<8>>;
+using c_t = Qu<intBits<4>, fracBits<10>>;
+
+// 逐段比较 double 的参考实现
+template <typename Segment1, typename... Rest>
+auto referenceApprox(auto x)
+{
+    if constexpr (sizeof...(Rest) == 0)
+    {
+        return decltype(x){Segment1::func(x)};
+    }
+    else
+    {
+        return x.toDouble() < Segment1::breakpoint ? decltype(x){Segment1::func(x)} : referenceApprox<Rest...>(x);
+    }
+}
+
+template <typename... Segments>
+void expectSameAsReference()
+{
+    for (int64_t raw = -(1 << (x_t::width - 1)); raw < (1 << (x_t::width - 1)); raw++)
+    {
+        x_t x;
+        x.data.data = static_cast<int32_t>(raw);
+        ASSERT_EQ(ANUS::Qapprox<Segments...>(x).data.data, referenceApprox<Segments...>(x).data.data) << x.toDouble();
+    }
+}
+
+using seg0 = ANUS::Segment<-2.0, c_t(-1.0)>;
+using seg1 = ANUS::Segment<-0.3, c_t(0.5), c_t(0.75)>;
+using seg2 = ANUS::Segment<0.5, c_t(0.0), c_t(1.0)>;
+using seg3 = ANUS::Segment<1.25, c_t(0.125), c_t(0.75), c_t(0.25)>;
+using seg4 = ANUS::Segment<3.0, c_t(2.0)>;
+using segLast = ANUS::Segment<100.0, c_t(3.0), c_t(-0.5)>;
+
+TEST(Qapprox, matchesSequentialComparison)
+{
+    expectSameAsReference<seg0, seg1, seg2, seg3, seg4, segLast>();
+    expectSameAsReference<seg2>();
+    expectSameAsReference<seg1, seg3>();
+
+    // 断点乱序与超出范围
+    expectSameAsReference<ANUS::Segment<1.0, c_t(1.0)>, ANUS::Segment<-1.0, c_t(2.0)>, ANUS::Segment<-50.0, c_t(3.0)>, ANUS::Segment<2.0, c_t(4.0)>>();
+    expectSameAsReference<ANUS::Segment<-50.0, c_t(1.0)>, ANUS::Segment<50.0, c_t(2.0)>, ANUS::Segment<0.0, c_t(3.0)>>();
+}
+
+TEST(Qapprox, compileTime)
+{
+    constexpr x_t x = 0.75;
+    constexpr auto y = ANUS::Qapprox<seg0, seg1, seg2, seg3, seg4, segLast>(x);
+    static_assert(y.data.data == x_t(0.125 + 0.75 * (0.75 + 0.25 * 0.75)).data.data);
+}
+
+TEST(Qapprox, tensor)
+{
+    Qu<dim<1500>, x_t> vec;
+    vec.fill();
+
+    auto res = ANUS::Qapprox<seg0, seg1, seg2, seg3, seg4, segLast>(vec);
+    for (size_t i = 0; i < 1500; i++)
+    {
+        ASSERT_EQ(res[i].data.data, (referenceApprox<seg0, seg1, seg2, seg3, seg4, segLast>(vec[i]).data.data));
+    }
+}
@@ -0,0 +1,107 @@
+#include "QuBLAS.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace QuBLAS;
+
+using in_t = Qu<intBits<3>, fracBits<7>>;
+using u_t = Qu<intBits<4>, fracBits<6>, isSigned<false>>;
+using c_t = Qu<intBits<4>, fracBits<10>>;
+using out_t = Qu<intBits<2>, fracBits<5>, QuMode<RND::CONV>>;
+using wide_t = Qu<intBits<40>, fracBits<20>>;
+
+// |x| 经过多项式后再饱和到较窄的格式
+inline constexpr auto chain = [](const auto &x) {
+    return out_t(ANUS::Qpoly<c_t(0.125), c_t(0.75), c_t(-0.25)>(Qabs(x)));
+};
+
+// 输出为 ArbiInt 路径的全精度乘积
+inline constexpr auto square = [](const auto &x) { return Qmul<FullPrec>(x, x); };
+
+// 输出为 64 位原始整数
+inline constexpr auto widen = [](const auto &x) { return Qmul<wide_t>(x, x); };
+
+std::atomic<size_t> calls = 0;
+inline constexpr auto counted = [](const auto &x) {
+    calls++;
+    return Qabs(x);
+};
+
+template <auto F, typename InT, typename... Args>
+void expectExhaustive()
+{
+    using memo_t = ANUS::Qmemo_s<F, InT, Args...>;
+    for (int64_t raw = memo_t::minRaw; raw < memo_t::minRaw + (int64_t(1) << InT::width); raw++)
+    {
+        InT x;
+        x.data.data = static_cast<int32_t>(raw);
+        ASSERT_EQ((ANUS::Qmemo<F, Args...>(x).data.data), F(x).data.data) << x.toDouble();
+    }
+}
+
+TEST(Qmemo, bitExact)
+{
+    static_assert(ANUS::Qmemo_s<chain, in_t>::memoized);
+    static_assert(ANUS::Qmemo_s<chain, in_t>::rawOut);
+    static_assert(std::is_same_v<ANUS::Qmemo_s<chain, in_t>::OutT, out_t>);
+    expectExhaustive<chain, in_t>();
+    expectExhaustive<chain, u_t>();
+    expectExhaustive<square, in_t>();
+
+    // 限制位宽后不再查表，结果不变
+    static_assert(!ANUS::Qmemo_s<chain, in_t, ANUS::QmemoMaxBits<8>>::memoized);
+    expectExhaustive<chain, in_t, ANUS::QmemoMaxBits<8>>();
+
+    static_assert(!ANUS::Qmemo_s<chain, wide_t>::memoized);
+    wide_t w = -1.5;
+    EXPECT_EQ(ANUS::Qmemo<chain>(w).data.data, chain(w).data.data);
+}
+
+TEST(Qmemo, tensorGather)
+{
+    Qu<dim<37, 5>, in_t> x;
+    x.fillRandom(11);
+
+    const auto y = ANUS::Qmemo<chain>(x);
+    static_assert(std::is_same_v<std::remove_cvref_t<decltype(y)>, Qu<dim<37, 5>, out_t>>);
+    for (size_t i = 0; i < x.elemSize; i++)
+    {
+        ASSERT_EQ(y[i].data.data, chain(x[i]).data.data) << i;
+    }
+
+    const auto z = ANUS::Qmemo<square>(x);
+    for (size_t i = 0; i < x.elemSize; i++)
+    {
+        ASSERT_EQ(z[i].data.data, square(x[i]).data.data) << i;
+    }
+
+    static_assert(sizeof(ANUS::Qmemo_s<widen, in_t>::entry_t) == 8);
+    const auto v = ANUS::Qmemo<widen>(x);
+    for (size_t i = 0; i < x.elemSize; i++)
+    {
+        ASSERT_EQ(v[i].data.data, widen(x[i]).data.data) << i;
+    }
+}
+
+TEST(Qmemo, buildsOnce)
+{
+    calls = 0;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([t] {
+            in_t x = -0.5 * t;
+            EXPECT_EQ(ANUS::Qmemo<counted>(x).toDouble(), 0.5 * t);
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(calls, size_t(1) << in_t::width);
+    in_t x = 1.25;
+    EXPECT_EQ(ANUS::Qmemo<counted>(x).toDouble(), 1.25);
+    EXPECT_EQ(calls, size_t(1) << in_t::width);
+}
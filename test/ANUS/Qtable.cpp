@@ -0,0 +1,86 @@
+#include "QuBLAS.h"
+#include <gtest/gtest.h>
+
+using namespace QuBLAS;
+
+using in_t = Qu<intBits<3>, fracBits<6>, isSigned<false>>;
+using out_t = Qu<intBits<2>, fracBits<12>, QuMode<RND::CONV>>;
+
+inline constexpr auto expFunc = [](double x) { return std::exp(x); };
+
+// 非 constexpr 函数，只能在运行期生成表
+double runtimeLog(double x)
+{
+    return x > 0 ? std::log(x) : -4.0;
+}
+inline constexpr auto logFunc = [](double x) { return runtimeLog(x); };
+
+// 每次查表的结果都应与直接从 double 转换一致
+template <auto Func, typename InT, typename OutT>
+void expectDirect()
+{
+    using table_t = ANUS::Qtable_s<Func, InT, OutT>;
+    for (int64_t raw = table_t::minRaw; raw < table_t::minRaw + (int64_t(1) << InT::width); raw++)
+    {
+        InT x;
+        x.data.data = raw;
+        OutT expected = Func(x.toDouble());
+        ASSERT_EQ((ANUS::Qtable<Func, OutT>(x).data.data), expected.data.data) << x.toDouble();
+    }
+}
+
+TEST(Qtable, predefinedFunctions)
+{
+    static_assert(ANUS::Qtable_s<ANUS::rsqrtFunc, in_t, out_t>::compileTime);
+    static_assert(ANUS::Qtable_s<ANUS::sqrtFunc, in_t, out_t>::compileTime);
+    static_assert(ANUS::Qtable_s<ANUS::reciprocalFunc, in_t, out_t>::compileTime);
+
+    expectDirect<ANUS::rsqrtFunc, in_t, out_t>();
+    expectDirect<ANUS::sqrtFunc, in_t, out_t>();
+    expectDirect<ANUS::reciprocalFunc, in_t, out_t>();
+
+    // 默认输出与输入同类型
+    in_t x = 2.25;
+    EXPECT_EQ(ANUS::Qtable<ANUS::sqrtFunc>(x).toDouble(), 1.5);
+}
+
+TEST(Qtable, userDefinedAndRuntime)
+{
+    using s_t = Qu<intBits<2>, fracBits<4>>;
+    expectDirect<expFunc, s_t, out_t>();
+
+    // 无法在编译期求值的函数在第一次查表时生成
+    static_assert(!ANUS::Qtable_s<logFunc, in_t, out_t>::compileTime);
+    expectDirect<logFunc, in_t, out_t>();
+
+    using wide_t = Qu<intBits<4>, fracBits<11>, isSigned<false>>;
+    static_assert(!ANUS::Qtable_s<ANUS::sqrtFunc, wide_t, out_t>::compileTime);
+    expectDirect<ANUS::sqrtFunc, wide_t, out_t>();
+}
+
+TEST(Qtable, interpolated)
+{
+    using wide_t = Qu<intBits<6>, fracBits<18>, isSigned<false>>;
+    using sq_t = Qu<intBits<4>, fracBits<12>, QuMode<RND::CONV>>;
+    using t = ANUS::Qtable_s<ANUS::sqrtFunc, wide_t, sq_t, ANUS::QtableIndexBits<8>>;
+    static_assert(t::interpolated && t::tableSize == 257);
+
+    double maxErr = 0;
+    for (int i = 0; i < 20000; i++)
+    {
+        wide_t x;
+        x.data.data = static_cast<int32_t>(gen() % (1u << wide_t::width));
+        auto y = ANUS::Qtable<ANUS::sqrtFunc, sq_t, ANUS::QtableIndexBits<8>>(x);
+
+        // 节点上的取值精确
+        wide_t node;
+        node.data.data = x.data.data & ~((int64_t(1) << t::lowBits) - 1);
+        EXPECT_EQ((ANUS::Qtable<ANUS::sqrtFunc, sq_t, ANUS::QtableIndexBits<8>>(node).data.data), sq_t(std::sqrt(node.toDouble())).data.data);
+
+        if (x.toDouble() > 4)
+        {
+            maxErr = std::max(maxErr, std::abs(y.toDouble() - std::sqrt(x.toDouble())));
+        }
+    }
+    EXPECT_LT(maxErr, 1e-3);
+}
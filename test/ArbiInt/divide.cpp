@@ -0,0 +1,123 @@
+#include "QuBLAS.h"
+#include <gtest/gtest.h>
+
+using namespace QuBLAS;
+
+template <size_t N>
+__int128_t toInt128(const ArbiInt<N> &x)
+{
+    return static_cast<__int128_t>((static_cast<__uint128_t>(wordAt(x, 1)) << 64) | wordAt(x, 0));
+}
+
+template <size_t N>
+ArbiInt<N> fromInt128(__int128_t v)
+{
+    ArbiInt<N> x;
+    for (size_t i = 0; i < ArbiInt<N>::num_words; ++i)
+    {
+        x.data[i] = static_cast<uint64_t>(v >> std::min<size_t>(64 * i, 127));
+    }
+    return x;
+}
+
+__int128_t randomInt128(std::mt19937_64 &rng, int bits)
+{
+    __int128_t v = (static_cast<__int128_t>(rng()) << 64) | rng();
+    return v >> (128 - bits);
+}
+
+TEST(divide, againstInt128)
+{
+    std::mt19937_64 rng(7);
+
+    for (int i = 0; i < 5000; i++)
+    {
+        __int128_t a = randomInt128(rng, 126);
+        __int128_t b = randomInt128(rng, 1 + rng() % 125);
+        if (b == 0)
+        {
+            continue;
+        }
+
+        EXPECT_TRUE(toInt128(fromInt128<130>(a) / fromInt128<128>(b)) == a / b);
+
+        // single-word divisor
+        __int128_t c = b >> 60;
+        if (c != 0)
+        {
+            EXPECT_TRUE(toInt128(fromInt128<200>(a) / fromInt128<70>(c)) == a / c);
+        }
+    }
+}
+
+TEST(divide, wideRemainder)
+{
+    for (int i = 0; i < 500; i++)
+    {
+        auto a = ArbiInt<300>().fill();
+        auto b = ArbiInt<150>().fill();
+
+        // a = q * b + r with |r| < |b| and r taking the sign of a
+        auto q = a / b;
+        auto r = a - q * b;
+
+        auto absR = r.isNegative() ? ArbiInt<600>(-r) : ArbiInt<600>(r);
+        auto absB = b.isNegative() ? ArbiInt<600>(-b) : ArbiInt<600>(b);
+        EXPECT_TRUE(absR < absB);
+        EXPECT_TRUE(r.isZero() || r.isNegative() == a.isNegative());
+    }
+
+    EXPECT_TRUE(ArbiInt<128>::minimum() / ArbiInt<8>(-1) == -ArbiInt<128>::minimum());
+    EXPECT_THROW(ArbiInt<128>(5) / ArbiInt<100>(0), std::runtime_error);
+}
+
+TEST(divide, constexprDivision)
+{
+    constexpr auto q = ArbiInt<200>(-1000000007) / ArbiInt<100>(13);
+    constexpr auto s = staticDivide<13>(ArbiInt<200>(-1000000007));
+
+    EXPECT_TRUE(q == ArbiInt<64>(-1000000007 / 13));
+    EXPECT_TRUE(s == q);
+}
+
+template <auto d>
+void checkStaticDivide()
+{
+    // the divisor as a runtime ArbiInt, unsigned divisors are zero extended
+    auto divisor = fromInt128<66>(static_cast<__int128_t>(d));
+
+    for (int i = 0; i < 300; i++)
+    {
+        auto a = ArbiInt<250>().fill();
+        EXPECT_TRUE(staticDivide<d>(a) == a / divisor) << d;
+
+        auto b = ArbiInt<40>().fill();
+        EXPECT_TRUE(staticDivide<d>(b) == b / divisor) << d;
+    }
+}
+
+TEST(divide, staticDivide)
+{
+    checkStaticDivide<3>();
+    checkStaticDivide<-7>();
+    checkStaticDivide<10>();
+    checkStaticDivide<1024>();
+    checkStaticDivide<-(int64_t(1) << 40)>();
+    checkStaticDivide<uint64_t(0xFFFFFFFFFFFFFFC5ull)>();
+    checkStaticDivide<int64_t(0x123456789ABCDEFll)>();
+}
+
+TEST(divide, wideQdiv)
+{
+    using num_t = Qu<intBits<40>, fracBits<40>>;
+    using den_t = Qu<intBits<30>, fracBits<36>>;
+
+    for (double a : {123456.789, -98765.4321, 1e9, -0.000123})
+    {
+        for (double b : {3.25, -0.015625, 12345.5})
+        {
+            auto q = Qdiv<intBits<45>, fracBits<40>>(num_t(a), den_t(b));
+            EXPECT_NEAR(q.toDouble(), num_t(a).toDouble() / den_t(b).toDouble(), 1e-11 * std::max(1.0, std::abs(a / b)));
+        }
+    }
+}
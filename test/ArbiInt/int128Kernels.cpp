@@ -0,0 +1,120 @@
+#include "QuBLAS.h"
+#include <gtest/gtest.h>
+
+using namespace QuBLAS;
+
+template <size_t N>
+ArbiInt<N> fromInt128(__int128_t v)
+{
+    ArbiInt<N> x;
+    if constexpr (N <= 64)
+    {
+        x.data = static_cast<typename ArbiInt<N>::data_t>(v);
+    }
+    else
+    {
+        for (size_t i = 0; i < ArbiInt<N>::num_words; ++i)
+        {
+            x.data[i] = static_cast<uint64_t>(v >> std::min<size_t>(64 * i, 127));
+        }
+    }
+    return x;
+}
+
+__int128_t randomInt128(std::mt19937_64 &rng, int bits)
+{
+    __int128_t v = (static_cast<__int128_t>(rng()) << 64) | rng();
+    return v >> (128 - bits);
+}
+
+// the two-word operators against the word loops and the plain __int128_t result
+template <size_t N, size_t M>
+void checkArithmetic(std::mt19937_64 &rng)
+{
+    for (int i = 0; i < 1000; i++)
+    {
+        const __int128_t a = randomInt128(rng, N);
+        const __int128_t b = randomInt128(rng, M);
+
+        const auto A = fromInt128<N>(a);
+        const auto B = fromInt128<M>(b);
+
+        static_assert(std::is_same_v<decltype(A + B), ArbiInt<std::max(N, M) + 1>>);
+
+        EXPECT_TRUE(loadInt128(A + B) == a + b);
+        EXPECT_TRUE(loadInt128(A - B) == a - b);
+        EXPECT_TRUE(loadInt128(B - A) == b - a);
+        EXPECT_TRUE(loadInt128(-A) == -a);
+
+        EXPECT_TRUE((A + B) == (addSubWords<false, std::max(N, M) + 1>(A, B)));
+        EXPECT_TRUE((A - B) == (addSubWords<true, std::max(N, M) + 1>(A, B)));
+
+        if constexpr (N + M <= 128)
+        {
+            EXPECT_TRUE(loadInt128(A * B) == a * b);
+            EXPECT_TRUE((A * B) == (mulWords<N + M>(A, B)));
+        }
+
+        if (b != 0)
+        {
+            EXPECT_TRUE(loadInt128(A / B) == a / b);
+        }
+
+        EXPECT_EQ(A == B, a == b);
+        EXPECT_EQ(A < B, a < b);
+        EXPECT_EQ(A > B, a > b);
+        EXPECT_TRUE(A == A);
+        EXPECT_TRUE(A <= A);
+    }
+}
+
+TEST(int128Kernels, arithmetic)
+{
+    std::mt19937_64 rng(42);
+
+    checkArithmetic<100, 90>(rng);
+    checkArithmetic<127, 127>(rng);
+    checkArithmetic<65, 40>(rng);
+    checkArithmetic<40, 80>(rng);
+    checkArithmetic<70, 64>(rng);
+    checkArithmetic<64, 70>(rng);
+}
+
+TEST(int128Kernels, divideByZero)
+{
+    EXPECT_THROW(fromInt128<100>(5) / fromInt128<100>(0), std::runtime_error);
+    EXPECT_THROW(fromInt128<65>(-7) / fromInt128<40>(0), std::runtime_error);
+    EXPECT_THROW(fromInt128<126>(1) / fromInt128<64>(0), std::runtime_error);
+}
+
+TEST(int128Kernels, shifts)
+{
+    std::mt19937_64 rng(7);
+
+    for (int i = 0; i < 1000; i++)
+    {
+        const __int128_t a = randomInt128(rng, 90);
+        const auto A = fromInt128<90>(a);
+
+        EXPECT_TRUE(loadInt128(staticShiftLeft<5>(A)) == a * 32);
+        EXPECT_TRUE(loadInt128(staticShiftLeft<37>(A)) == a * (__int128_t(1) << 37));
+        EXPECT_TRUE(loadInt128(staticShiftRight<5>(A)) == a >> 5);
+        EXPECT_TRUE(loadInt128(staticShiftRight<40>(A)) == a >> 40);
+    }
+}
+
+TEST(int128Kernels, mixedWidthCompare)
+{
+    // the word above the shorter operand decides, e.g. 2^64 != 0 and 2^63 > 2^63 - 1
+    const auto big = fromInt128<100>(__int128_t(1) << 64);
+    const auto top = fromInt128<100>(__int128_t(1) << 63);
+    const auto wideBig = fromInt128<200>(__int128_t(1) << 64);
+
+    EXPECT_FALSE(big == ArbiInt<10>(0));
+    EXPECT_FALSE(ArbiInt<10>(0) == big);
+    EXPECT_TRUE(top > ArbiInt<64>::maximum());
+    EXPECT_TRUE(ArbiInt<64>::maximum() < top);
+    EXPECT_FALSE(wideBig == ArbiInt<100>(0));
+    EXPECT_TRUE(wideBig == big);
+    EXPECT_TRUE(fromInt128<200>(-1) == ArbiInt<70>(-1));
+}
\ No newline at end of file
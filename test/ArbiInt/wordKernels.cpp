@@ -0,0 +1,118 @@
+#include "QuBLAS.h"
+#include <gtest/gtest.h>
+
+using namespace QuBLAS;
+
+template <size_t N>
+__int128_t toInt128(const ArbiInt<N> &x)
+{
+    return static_cast<__int128_t>((static_cast<__uint128_t>(wordAt(x, 1)) << 64) | wordAt(x, 0));
+}
+
+template <size_t N>
+ArbiInt<N> fromInt128(__int128_t v)
+{
+    ArbiInt<N> x;
+    if constexpr (N <= 64)
+    {
+        x.data = static_cast<typename ArbiInt<N>::data_t>(v);
+    }
+    else
+    {
+        for (size_t i = 0; i < ArbiInt<N>::num_words; ++i)
+        {
+            x.data[i] = static_cast<uint64_t>(v >> std::min<size_t>(64 * i, 127));
+        }
+    }
+    return x;
+}
+
+__int128_t randomInt128(std::mt19937_64 &rng, int bits)
+{
+    __int128_t v = (static_cast<__int128_t>(rng()) << 64) | rng();
+    return v >> (128 - bits);
+}
+
+TEST(wordKernels, addSubMulAgainstInt128)
+{
+    std::mt19937_64 rng(42);
+
+    for (int i = 0; i < 2000; i++)
+    {
+        __int128_t a = randomInt128(rng, 62);
+        __int128_t b = randomInt128(rng, 62);
+        __int128_t c = randomInt128(rng, 40);
+
+        auto A = fromInt128<100>(a);
+        auto B = fromInt128<150>(b);
+        auto C = fromInt128<48>(c);
+
+        EXPECT_TRUE(toInt128(A + B) == a + b);
+        EXPECT_TRUE(toInt128(A - B) == a - b);
+        EXPECT_TRUE(toInt128(B - A) == b - a);
+        EXPECT_TRUE(toInt128(A + C) == a + c);
+        EXPECT_TRUE(toInt128(A - C) == a - c);
+        EXPECT_TRUE(toInt128(C - A) == c - a);
+        EXPECT_TRUE(toInt128(A * B) == a * b);
+        EXPECT_TRUE(toInt128(A * C) == a * c);
+        EXPECT_TRUE(toInt128(C * B) == c * b);
+    }
+}
+
+TEST(wordKernels, wideIdentities)
+{
+    for (int i = 0; i < 500; i++)
+    {
+        auto a = ArbiInt<200>().fill();
+        auto b = ArbiInt<130>().fill();
+        auto c = ArbiInt<70>().fill();
+
+        // distributivity and the inverse of the sum exercise the full carry chains
+        EXPECT_TRUE((a + b) * c == a * c + b * c);
+        EXPECT_TRUE((a + b) - b == a);
+        EXPECT_TRUE(a * b == b * a);
+        EXPECT_TRUE((-a) * b == -(a * b));
+    }
+}
+
+template <size_t N, size_t M, size_t L>
+void checkLanes()
+{
+    std::array<ArbiInt<N>, L> a;
+    std::array<ArbiInt<M>, L> b;
+    for (size_t l = 0; l < L; l++)
+    {
+        a[l].fill();
+        b[l].fill();
+    }
+    a[0] = ArbiInt<N>::minimum();
+    b[0] = ArbiInt<M>::minimum();
+
+    ArbiIntLanes<N, L> A;
+    ArbiIntLanes<M, L> B;
+    A.load(a.data());
+    B.load(b.data());
+
+    auto sum = A + B;
+    auto diff = A - B;
+    auto prod = A * B;
+
+    for (size_t l = 0; l < L; l++)
+    {
+        EXPECT_TRUE(A.get(l) == a[l]);
+        EXPECT_TRUE(sum.get(l) == a[l] + b[l]);
+        EXPECT_TRUE(diff.get(l) == a[l] - b[l]);
+        EXPECT_TRUE(prod.get(l) == a[l] * b[l]);
+    }
+}
+
+TEST(wordKernels, lanesMatchScalar)
+{
+    for (int i = 0; i < 20; i++)
+    {
+        checkLanes<100, 150, 13>();
+        checkLanes<200, 40, 8>();
+        checkLanes<64, 64, 5>();
+        checkLanes<128, 192, 16>();
+    }
+}
@@ -0,0 +1,160 @@
+#include "QuBLAS.h"
+#include <gtest/gtest.h>
+
+using namespace QuBLAS;
+
+using x_t = Qu<intBits<3>, fracBits<9>>;
+using h_t = Qu<intBits<1>, fracBits<12>, QuMode<RND::CONV>>;
+using mul_t = Qu<intBits<4>, fracBits<12>, QuMode<RND::INF>>;
+using l0_t = Qu<intBits<5>, fracBits<11>>;
+using l1_t = Qu<intBits<6>, fracBits<9>, QuMode<RND::CONV>>;
+using l2_t = Qu<intBits<8>, fracBits<7>, OfMode<SAT::TCPL>>;
+using y_t = Qu<intBits<8>, fracBits<7>>;
+
+// 对每个输出先生成乘积张量再 Qreduce，输入流开始之前为 0
+template <size_t Taps>
+std::vector<y_t> referenceFir(const Qu<dim<Taps>, h_t> &h, const std::vector<x_t> &x)
+{
+    std::vector<y_t> y(x.size());
+    for (size_t n = 0; n < x.size(); n++)
+    {
+        Qu<dim<Taps>, mul_t> products;
+        for (size_t k = 0; k < Taps; k++)
+        {
+            products[k] = Qmul<mul_t>(h[k], k <= n ? x[n - k] : x_t());
+        }
+        y[n] = Qreduce<l0_t, l1_t, l2_t>(products);
+    }
+    return y;
+}
+
+template <size_t Taps, size_t B, typename... Exec>
+void checkStream(size_t blocks)
+{
+    Qu<dim<Taps>, h_t> h;
+    h.fillRandom(7, 0);
+
+    Qu<dim<B * 8>, x_t> source;
+    source.fillRandom(7, 1);
+    std::vector<x_t> stream(source.data.begin(), source.data.begin() + B * blocks);
+
+    const auto ref = referenceFir<Taps>(h, stream);
+
+    Qfir<decltype(h), x_t, QfirMulArgs<mul_t>, QfirAddArgs<l0_t, l1_t, l2_t>, Exec...> fir(h);
+    for (size_t blk = 0; blk < blocks; blk++)
+    {
+        Qu<dim<B>, x_t> x;
+        std::copy(stream.begin() + blk * B, stream.begin() + (blk + 1) * B, x.data.begin());
+
+        Qu<dim<B>, y_t> y;
+        fir.process(y, x);
+        for (size_t n = 0; n < B; n++)
+        {
+            ASSERT_EQ(y[n].data.data, ref[blk * B + n].data.data) << "taps " << Taps << " block " << blk << " at " << n;
+        }
+    }
+}
+
+TEST(Qfir, matchesReduce)
+{
+    checkStream<1, 16>(3);
+    checkStream<7, 16>(4);
+    checkStream<33, 16>(5);   // 延迟线比块更长
+    checkStream<64, 100>(3);
+    checkStream<70, 600, QuExec<Parallel<3>>>(2);
+    checkStream<70, 600, QuExec<Serial>>(2);
+}
+
+TEST(Qfir, channelsAndReset)
+{
+    constexpr size_t Taps = 12, B = 40, C = 3;
+
+    Qu<dim<Taps>, h_t> h;
+    h.fillRandom(3, 0);
+
+    Qu<dim<B, C>, x_t> x1, x2;
+    x1.fillRandom(3, 1);
+    x2.fillRandom(3, 2);
+
+    Qfir<decltype(h), x_t, QfirMulArgs<mul_t>, QfirAddArgs<l0_t, l1_t, l2_t>> fir(h, C);
+    Qu<dim<B, C>, y_t> y1, y2;
+    fir.process(y1, x1);
+    fir.process(y2, x2);
+
+    for (size_t c = 0; c < C; c++)
+    {
+        std::vector<x_t> stream(x1.data.begin() + c * B, x1.data.begin() + (c + 1) * B);
+        stream.insert(stream.end(), x2.data.begin() + c * B, x2.data.begin() + (c + 1) * B);
+        const auto ref = referenceFir<Taps>(h, stream);
+
+        for (size_t n = 0; n < B; n++)
+        {
+            ASSERT_EQ((y1[n, c].data.data), ref[n].data.data) << "channel " << c << " at " << n;
+            ASSERT_EQ((y2[n, c].data.data), ref[B + n].data.data) << "channel " << c << " at " << n;
+        }
+    }
+
+    // reset 之后与新的滤波器相同
+    fir.reset();
+    Qu<dim<B, C>, y_t> y3;
+    fir.process(y3, x2);
+    Qfir<decltype(h), x_t, QfirMulArgs<mul_t>, QfirAddArgs<l0_t, l1_t, l2_t>> fresh(h, C);
+    Qu<dim<B, C>, y_t> y4;
+    fresh.process(y4, x2);
+    for (size_t i = 0; i < y3.elemSize; i++)
+    {
+        ASSERT_EQ(y3.data[i].data.data, y4.data[i].data.data) << "at " << i;
+    }
+
+    Qu<dim<B>, x_t> mono;
+    Qu<dim<B>, y_t> monoOut;
+    EXPECT_THROW(fir.process(monoOut, mono), std::invalid_argument);
+}
+
+// 逐个输出位置做乘积与 Qreduce 的参考实现
+template <size_t stride, size_t padding, size_t H, size_t W, size_t Cin, size_t KH, size_t KW, size_t Cout, size_t OH, size_t OW>
+void checkConv()
+{
+    Qu<dim<H, W, Cin>, x_t> x;
+    Qu<dim<KH, KW, Cin, Cout>, h_t> w;
+    x.fillRandom(5, 0);
+    w.fillRandom(5, 1);
+
+    Qu<dim<OH, OW, Cout>, y_t> y;
+    Qconv2d<QconvStride<stride>, QconvPadding<padding>, QgemulMulArgs<mul_t>, QgemulAddArgs<l0_t, l1_t, l2_t>>(y, x, w);
+
+    constexpr size_t K = KH * KW * Cin;
+    for (size_t co = 0; co < Cout; co++)
+    {
+        for (size_t ow = 0; ow < OW; ow++)
+        {
+            for (size_t oh = 0; oh < OH; oh++)
+            {
+                Qu<dim<K>, mul_t> products;
+                for (size_t ci = 0; ci < Cin; ci++)
+                {
+                    for (size_t kw = 0; kw < KW; kw++)
+                    {
+                        for (size_t kh = 0; kh < KH; kh++)
+                        {
+                            const long ih = long(oh * stride + kh) - long(padding);
+                            const long iw = long(ow * stride + kw) - long(padding);
+                            const bool inside = ih >= 0 && ih < long(H) && iw >= 0 && iw < long(W);
+                            products[kh + KH * (kw + KW * ci)] = Qmul<mul_t>(inside ? x[size_t(ih), size_t(iw), ci] : x_t(), w[kh, kw, ci, co]);
+                        }
+                    }
+                }
+                const y_t ref = Qreduce<l0_t, l1_t, l2_t>(products);
+                ASSERT_EQ((y[oh, ow, co].data.data), ref.data.data) << "at " << oh << " " << ow << " " << co;
+            }
+        }
+    }
+}
+
+TEST(Qconv2d, matchesReduce)
+{
+    checkConv<1, 0, 8, 7, 3, 3, 3, 4, 6, 5>();
+    checkConv<1, 1, 8, 7, 3, 3, 3, 4, 8, 7>();
+    checkConv<2, 1, 9, 9, 2, 3, 2, 5, 5, 5>();
+    checkConv<1, 0, 5, 5, 1, 1, 1, 2, 5, 5>();
+}
@@ -0,0 +1,136 @@
+#include "QuBLAS.h"
+#include <gtest/gtest.h>
+
+using namespace QuBLAS;
+
+using a_t = Qu<intBits<3>, fracBits<9>>;
+using b_t = Qu<intBits<2>, fracBits<10>, QuMode<RND::CONV>>;
+using mul_t = Qu<intBits<5>, fracBits<12>, QuMode<RND::INF>>;
+using l0_t = Qu<intBits<6>, fracBits<10>>;
+using l1_t = Qu<intBits<7>, fracBits<8>, QuMode<RND::CONV>>;
+using l2_t = Qu<intBits<9>, fracBits<6>, OfMode<SAT::TCPL>>;
+using y_t = Qu<intBits<9>, fracBits<6>>;
+
+// 先生成乘积张量再 Qreduce 的参考实现
+template <size_t K, typename AT, typename BT>
+auto referenceDot(const AT &a, const BT &b)
+{
+    Qu<dim<K>, mul_t> products;
+    for (size_t k = 0; k < K; k++)
+    {
+        products[k] = Qmul<mul_t>(a[k], b[k]);
+    }
+    return Qreduce<l0_t, l1_t, l2_t>(products);
+}
+
+template <size_t K>
+void checkDot()
+{
+    Qu<dim<K>, a_t> a;
+    Qu<dim<K>, b_t> b;
+    a.fill();
+    b.fill();
+
+    auto res = Qdot<QdotMulArgs<mul_t>, QdotAddArgs<l0_t, l1_t, l2_t>>(a, b);
+    auto ref = referenceDot<K>(a, b);
+
+    static_assert(std::is_same_v<decltype(res), decltype(ref)>);
+    EXPECT_EQ(res.data.data, ref.data.data) << "K " << K;
+}
+
+TEST(Qdot, matchesReduce)
+{
+    checkDot<1>();
+    checkDot<2>();
+    checkDot<7>();
+    checkDot<64>();
+    checkDot<100>();
+
+    // 多个完整的段，段之上有奇数长度的层，以及末尾不完整的段
+    checkDot<192>();
+    checkDot<200>();
+    checkDot<257>();
+}
+
+TEST(Qdot, typeListAndFullPrecision)
+{
+    constexpr size_t K = 33;
+    Qu<dim<K>, a_t> a;
+    Qu<dim<K>, b_t> b;
+    a.fill();
+    b.fill();
+
+    auto res = Qdot<QdotAddArgs<TypeList<l0_t, l1_t, l2_t>>, QdotMulArgs<mul_t>>(a, b);
+    EXPECT_EQ(res.data.data, referenceDot<K>(a, b).data.data);
+
+    // 不指定任何量化时乘法与加法都是全精度的
+    Qu<dim<K>, decltype(Qmul(a_t(), b_t()))> products;
+    for (size_t k = 0; k < K; k++)
+    {
+        products[k] = Qmul(a[k], b[k]);
+    }
+    auto full = Qdot(a, b);
+    EXPECT_EQ(full.toDouble(), Qreduce(products).toDouble());
+}
+
+template <bool transA, size_t M, size_t K, typename AT, typename XT>
+auto referenceGemv(const AT &A, const XT &x)
+{
+    Qu<dim<M>, y_t> y;
+    for (size_t i = 0; i < M; i++)
+    {
+        Qu<dim<K>, a_t> row;
+        for (size_t k = 0; k < K; k++)
+        {
+            row[k] = transA ? A[k, i] : A[i, k];
+        }
+        y[i] = referenceDot<K>(row, x);
+    }
+    return y;
+}
+
+TEST(Qgemv, matchesReference)
+{
+    constexpr size_t M = 37, K = 45;
+    Qu<dim<M, K>, a_t> A;
+    Qu<dim<K>, b_t> x;
+    A.fill();
+    x.fill();
+
+    auto ref = referenceGemv<false, M, K>(A, x);
+
+    Qu<dim<M>, y_t> y;
+    Qgemv<QdotMulArgs<mul_t>, QdotAddArgs<l0_t, l1_t, l2_t>>(y, A, x);
+
+    Qu<dim<M>, y_t> ySerial;
+    Qgemv<QuExec<Serial>, QdotMulArgs<mul_t>, QdotAddArgs<l0_t, l1_t, l2_t>>(ySerial, A, x);
+
+    Qu<dim<M>, y_t> yParallel;
+    Qgemv<QuExec<Parallel<3>>, QdotMulArgs<mul_t>, QdotAddArgs<l0_t, l1_t, l2_t>>(yParallel, A, x);
+
+    for (size_t i = 0; i < M; i++)
+    {
+        ASSERT_EQ(y[i].data.data, ref[i].data.data) << "at " << i;
+        ASSERT_EQ(ySerial[i].data.data, ref[i].data.data) << "at " << i;
+        ASSERT_EQ(yParallel[i].data.data, ref[i].data.data) << "at " << i;
+    }
+}
+
+TEST(Qgemv, transposed)
+{
+    constexpr size_t M = 8, K = 19;
+    Qu<dim<K, M>, a_t> At;
+    Qu<dim<K>, b_t> x;
+    At.fill();
+    x.fill();
+
+    auto ref = referenceGemv<true, M, K>(At, x);
+
+    Qu<dim<M>, y_t> y;
+    Qgemv<QgemvTransposedA<true>, QdotMulArgs<mul_t>, QdotAddArgs<l0_t, l1_t, l2_t>>(y, At, x);
+
+    for (size_t i = 0; i < M; i++)
+    {
+        ASSERT_EQ(y[i].data.data, ref[i].data.data) << "at " << i;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,244 @@
+#include "QuBLAS.h"
+#include <gtest/gtest.h>
+#include <complex>
+#include <random>
+
+using namespace QuBLAS;
+
+using in_t = Qcomplex<Qu<intBits<1>, fracBits<10>>, Qu<intBits<1>, fracBits<10>>>;
+using tw_t = Qu<intBits<1>, fracBits<12>, QuMode<RND::INF>>;
+using stage_t = Qu<intBits<8>, fracBits<8>, QuMode<RND::CONV>, OfMode<SAT::TCPL>>;
+using narrow_t = Qu<intBits<1>, fracBits<12>, QuMode<RND::INF>, OfMode<SAT::TCPL>>;
+
+template <size_t N>
+using vec_t = Qu<dim<N>, in_t>;
+
+template <size_t N>
+vec_t<N> randomInput(unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> dist(-0.9, 0.9);
+    vec_t<N> x;
+    for (size_t i = 0; i < N; i++)
+    {
+        x[i] = in_t(dist(rng), dist(rng));
+    }
+    return x;
+}
+
+template <size_t N, typename T>
+std::vector<std::complex<double>> referenceDft(const T &x, bool inverse = false)
+{
+    std::vector<std::complex<double>> res(N);
+    for (size_t k = 0; k < N; k++)
+    {
+        for (size_t n = 0; n < N; n++)
+        {
+            const double angle = (inverse ? 2.0 : -2.0) * std::numbers::pi * static_cast<double>(k * n % N) / N;
+            res[k] += std::complex<double>(x[n].real.toDouble(), x[n].imag.toDouble()) * std::polar(1.0, angle);
+        }
+    }
+    return res;
+}
+
+// 逐级手写的基 2 蝶形，每一级输出量化为 stage_t
+using c_t = Qcomplex<stage_t, stage_t>;
+
+template <typename C>
+c_t referenceFinish(const C &x, int shift)
+{
+    using scaled_t = Qcomplex<Qu<intBits<C::realType::intB - 1>, fracBits<C::realType::fracB + 1>>,
+                              Qu<intBits<C::imagType::intB - 1>, fracBits<C::imagType::fracB + 1>>>;
+    return shift ? c_t(scaled_t(x.real.toDouble() / 2, x.imag.toDouble() / 2)) : c_t(x);
+}
+
+template <size_t N, typename T>
+std::vector<c_t> referenceStage(const std::vector<T> &a, size_t span, int shift)
+{
+    using w_t = Qcomplex<tw_t, tw_t>;
+
+    std::vector<c_t> next(N);
+    for (size_t base = 0; base < N; base += span)
+    {
+        for (size_t j = 0; j < span / 2; j++)
+        {
+            const double angle = -2.0 * std::numbers::pi * static_cast<double>(j) / span;
+            const auto t = Qmul<BasicComplexMul<acT<FullPrec>, bdT<FullPrec>, adT<FullPrec>, bcT<FullPrec>, acbdT<FullPrec>, adbcT<FullPrec>>>(w_t(std::cos(angle), std::sin(angle)), a[base + j + span / 2]);
+            next[base + j] = referenceFinish(Qadd<realT<FullPrec>, imagT<FullPrec>>(a[base + j], t), shift);
+            next[base + j + span / 2] = referenceFinish(Qsub<realT<FullPrec>, imagT<FullPrec>>(a[base + j], t), shift);
+        }
+    }
+    return next;
+}
+
+template <size_t N>
+std::vector<c_t> referenceRadix2(const vec_t<N> &x, int shift)
+{
+    std::vector<in_t> a(N);
+    for (size_t i = 0; i < N; i++)
+    {
+        size_t r = 0;
+        for (size_t b = 0; b < std::countr_zero(N); b++)
+        {
+            r = (r << 1) | ((i >> b) & 1);
+        }
+        a[r] = x[i];
+    }
+
+    auto res = referenceStage<N>(a, 2, shift);
+    for (size_t span = 4; span <= N; span *= 2)
+    {
+        res = referenceStage<N>(res, span, shift);
+    }
+    return res;
+}
+
+template <size_t N, FftScale scale>
+void checkRadix2()
+{
+    const auto x = randomInput<N>(N);
+    Qu<dim<N>, Qcomplex<stage_t, stage_t>> y;
+
+    const int exponent = Qfft<N, StageTypes<stage_t>, TwiddleT<tw_t>, FftScaling<scale>>(y, x);
+    const auto ref = referenceRadix2<N>(x, scale == FftScale::stage);
+
+    EXPECT_EQ(exponent, scale == FftScale::stage ? std::countr_zero(N) : 0);
+    for (size_t i = 0; i < N; i++)
+    {
+        ASSERT_EQ(y[i].real.data.data, ref[i].real.data.data) << "N " << N << " at " << i;
+        ASSERT_EQ(y[i].imag.data.data, ref[i].imag.data.data) << "N " << N << " at " << i;
+    }
+}
+
+TEST(Qfft, radix2MatchesButterflies)
+{
+    checkRadix2<2, FftScale::none>();
+    checkRadix2<16, FftScale::none>();
+    checkRadix2<64, FftScale::none>();
+    checkRadix2<32, FftScale::stage>();
+}
+
+template <size_t N, size_t radix>
+void checkAgainstDft(double tolerance)
+{
+    const auto x = randomInput<N>(N + radix);
+    const auto ref = referenceDft<N>(x);
+
+    // 全精度的阶段类型，只有旋转因子被量化
+    Qu<dim<N>, QfftResult<N, in_t, Radix<radix>, TwiddleT<tw_t>>> y;
+    EXPECT_EQ((Qfft<N, Radix<radix>, TwiddleT<tw_t>>(y, x)), 0);
+
+    // 固定的阶段类型，每一级除以基数
+    Qu<dim<N>, Qcomplex<stage_t, stage_t>> z;
+    const int exponent = Qfft<N, Radix<radix>, TwiddleT<tw_t>, StageTypes<TypeList<stage_t>>, FftScaling<FftScale::stage>>(z, x);
+    EXPECT_EQ(exponent, std::countr_zero(N));
+
+    for (size_t k = 0; k < N; k++)
+    {
+        EXPECT_NEAR(y[k].real.toDouble(), ref[k].real(), tolerance) << "N " << N << " at " << k;
+        EXPECT_NEAR(y[k].imag.toDouble(), ref[k].imag(), tolerance) << "N " << N << " at " << k;
+        EXPECT_NEAR(std::ldexp(z[k].real.toDouble(), exponent), ref[k].real(), std::ldexp(N, -8)) << "N " << N << " at " << k;
+        EXPECT_NEAR(std::ldexp(z[k].imag.toDouble(), exponent), ref[k].imag(), std::ldexp(N, -8)) << "N " << N << " at " << k;
+    }
+}
+
+TEST(Qfft, radix4AndMixed)
+{
+    checkAgainstDft<16, 2>(0.02);
+    checkAgainstDft<16, 4>(0.02);
+    checkAgainstDft<8, 4>(0.02);  // 基 2 加一级基 4
+    checkAgainstDft<64, 4>(0.05);
+    checkAgainstDft<128, 4>(0.1);
+}
+
+TEST(Qfft, inverse)
+{
+    constexpr size_t N = 32;
+    const auto x = randomInput<N>(3);
+
+    Qu<dim<N>, QfftResult<N, in_t, Radix<4>>> X;
+    Qfft<N, Radix<4>>(X, x);
+
+    Qu<dim<N>, QfftResult<N, typename decltype(X)::elem_t, Radix<4>, FftInverse<true>>> back;
+    Qfft<N, Radix<4>, FftInverse<true>>(back, X);
+
+    for (size_t i = 0; i < N; i++)
+    {
+        EXPECT_NEAR(back[i].real.toDouble() / N, x[i].real.toDouble(), 2e-3) << "at " << i;
+        EXPECT_NEAR(back[i].imag.toDouble() / N, x[i].imag.toDouble(), 2e-3) << "at " << i;
+    }
+}
+
+TEST(Qfft, blockFloatingPoint)
+{
+    constexpr size_t N = 64;
+    auto x = randomInput<N>(11);
+
+    // 输入为常数时第一级就已溢出 narrow_t，每一级都需要右移
+    Qu<dim<N>, Qcomplex<narrow_t, narrow_t>> y;
+    const int exponent = Qfft<N, StageTypes<narrow_t>, FftScaling<FftScale::blockFloat>, Radix<4>>(y, x);
+    EXPECT_GT(exponent, 0);
+    EXPECT_LE(exponent, 6);
+
+    const auto ref = referenceDft<N>(x);
+    for (size_t k = 0; k < N; k++)
+    {
+        EXPECT_NEAR(std::ldexp(y[k].real.toDouble(), exponent), ref[k].real(), 0.05) << "at " << k;
+        EXPECT_NEAR(std::ldexp(y[k].imag.toDouble(), exponent), ref[k].imag(), 0.05) << "at " << k;
+    }
+
+    // 输入足够小时不需要右移
+    vec_t<N> tiny;
+    tiny[0] = in_t(0.25, -0.25);
+    Qu<dim<N>, Qcomplex<narrow_t, narrow_t>> impulse;
+    EXPECT_EQ((Qfft<N, StageTypes<narrow_t>, FftScaling<FftScale::blockFloat>>(impulse, tiny)), 0);
+    EXPECT_EQ(impulse[N - 1].real.toDouble(), 0.25);
+}
+
+TEST(Qfft, soaLayout)
+{
+    constexpr size_t N = 32;
+    const auto x = randomInput<N>(21);
+    Qu<dim<N>, layout<SoA>, in_t> xs = x;
+
+    Qu<dim<N>, c_t> ref;
+    Qu<dim<N>, layout<SoA>, c_t> y;
+    Qfft<N, StageTypes<stage_t>, Radix<4>>(ref, x);
+    Qfft<N, StageTypes<stage_t>, Radix<4>>(y, xs);
+
+    for (size_t i = 0; i < N; i++)
+    {
+        const c_t v = y[i];
+        ASSERT_EQ(v.real.data.data, ref[i].real.data.data) << "at " << i;
+        ASSERT_EQ(v.imag.data.data, ref[i].imag.data.data) << "at " << i;
+    }
+}
+
+TEST(Qfft, batchParallel)
+{
+    constexpr size_t N = 16, symbols = 9;
+    Qu<dim<N, symbols>, in_t> x;
+    x.fillRandom(5);
+
+    Qu<dim<N, symbols>, Qcomplex<stage_t, stage_t>> serial, parallel;
+    const auto es = QfftBatch<QuExec<Serial>, StageTypes<stage_t>, FftScaling<FftScale::stage>, Radix<4>>(serial, x);
+    const auto ep = QfftBatch<QuExec<Parallel<3>>, StageTypes<stage_t>, FftScaling<FftScale::stage>, Radix<4>>(parallel, x);
+    EXPECT_EQ(es, ep);
+
+    for (size_t b = 0; b < symbols; b++)
+    {
+        vec_t<N> column;
+        for (size_t i = 0; i < N; i++)
+        {
+            column[i] = x[i, b];
+        }
+        Qu<dim<N>, Qcomplex<stage_t, stage_t>> single;
+        Qfft<N, StageTypes<stage_t>, FftScaling<FftScale::stage>, Radix<4>>(single, column);
+
+        for (size_t i = 0; i < N; i++)
+        {
+            ASSERT_EQ(single[i].real.data.data, (serial[i, b].real.data.data)) << b << " " << i;
+            ASSERT_EQ(single[i].imag.data.data, (parallel[i, b].imag.data.data)) << b << " " << i;
+        }
+    }
+}
@@ -0,0 +1,203 @@
+#include "QuBLAS.h"
+#include <gtest/gtest.h>
+
+using namespace QuBLAS;
+
+using a_t = Qu<intBits<3>, fracBits<9>>;
+using b_t = Qu<intBits<2>, fracBits<10>, QuMode<RND::CONV>>;
+using mul_t = Qu<intBits<5>, fracBits<12>, QuMode<RND::INF>>;
+using l0_t = Qu<intBits<6>, fracBits<10>>;
+using l1_t = Qu<intBits<7>, fracBits<8>, QuMode<RND::CONV>>;
+using l2_t = Qu<intBits<9>, fracBits<6>, OfMode<SAT::TCPL>>;
+using c_t = Qu<intBits<9>, fracBits<6>>;
+
+// 逐元素调用 Qmul 和 Qreduce 的参考实现
+template <bool transA, bool transB, size_t M, size_t N, size_t K, typename AT, typename BT>
+auto referenceGemul(const AT &A, const BT &B)
+{
+    Qu<dim<M, N>, c_t> C;
+    for (size_t i = 0; i < M; i++)
+    {
+        for (size_t j = 0; j < N; j++)
+        {
+            Qu<dim<K>, mul_t> products;
+            for (size_t k = 0; k < K; k++)
+            {
+                auto a = transA ? A[k, i] : A[i, k];
+                auto b = transB ? B[j, k] : B[k, j];
+                products[k] = Qmul<mul_t>(a, b);
+            }
+            C[i, j] = Qreduce<l0_t, l1_t, l2_t>(products);
+        }
+    }
+    return C;
+}
+
+template <typename CT, typename RT>
+void expectSame(const CT &C, const RT &ref)
+{
+    for (size_t i = 0; i < CT::elemSize; i++)
+    {
+        ASSERT_EQ(C[i].data.data, ref[i].data.data) << "at " << i;
+    }
+}
+
+TEST(Qgemul, matchesReference)
+{
+    constexpr size_t M = 13, N = 70, K = 37;
+    Qu<dim<M, K>, a_t> A;
+    Qu<dim<K, N>, b_t> B;
+    A.fill();
+    B.fill();
+
+    Qu<dim<M, N>, c_t> C;
+    Qgemul<QgemulAddArgs<l0_t, l1_t, l2_t>, QgemulMulArgs<mul_t>>(C, A, B);
+    expectSame(C, referenceGemul<false, false, M, N, K>(A, B));
+
+    // TypeList 形式与串行执行
+    Qu<dim<M, N>, c_t> C2;
+    Qgemul<QuExec<Serial>, QgemulMulArgs<mul_t>, QgemulAddArgs<TypeList<l0_t, l1_t, l2_t>>>(C2, A, B);
+    expectSame(C2, C);
+}
+
+TEST(Qgemul, transposed)
+{
+    constexpr size_t M = 9, N = 5, K = 64;
+    Qu<dim<K, M>, a_t> At;
+    Qu<dim<N, K>, b_t> Bt;
+    At.fill();
+    Bt.fill();
+
+    Qu<dim<M, N>, c_t> C;
+    Qgemul<QgemulTransposedA<true>, QgemulTransposedB<true>, QgemulAddArgs<l0_t, l1_t, l2_t>, QgemulMulArgs<mul_t>>(C, At, Bt);
+    expectSame(C, referenceGemul<true, true, M, N, K>(At, Bt));
+
+    Qu<dim<M, K>, a_t> A;
+    for (size_t i = 0; i < M; i++)
+    {
+        for (size_t k = 0; k < K; k++)
+        {
+            A[i, k] = At[k, i];
+        }
+    }
+    Qu<dim<M, N>, c_t> C2;
+    Qgemul<QgemulTransposedB<true>, QgemulAddArgs<l0_t, l1_t, l2_t>, QgemulMulArgs<mul_t>>(C2, A, Bt);
+    expectSame(C2, C);
+}
+
+TEST(Qgemul, largeOnHeap)
+{
+    constexpr size_t M = 40, N = 40, K = 40;
+    Qu<dim<M, K>, a_t> A;
+    Qu<dim<K, N>, b_t> B;
+    A.fill();
+    B.fill();
+
+    Qu<dim<M, N>, c_t> C;
+    Qgemul<QuExec<Parallel<3>>, QgemulAddArgs<l0_t, l1_t, l2_t>, QgemulMulArgs<mul_t>>(C, A, B);
+    expectSame(C, referenceGemul<false, false, M, N, K>(A, B));
+}
+
+using ca_t = Qcomplex<a_t, Qu<intBits<2>, fracBits<10>>>;
+using cb_t = Qcomplex<b_t, Qu<intBits<3>, fracBits<8>, QuMode<RND::CONV>>>;
+using cl0_t = Qcomplex<l0_t, l0_t>;
+using cl1_t = Qcomplex<l1_t, Qu<intBits<7>, fracBits<7>>>;
+using cc_t = Qcomplex<c_t, c_t>;
+
+using tfMul = TFComplexMul<abT<intBits<4>, fracBits<9>>, cdT<intBits<3>, fracBits<10>, QuMode<RND::CONV>>, baT<intBits<4>, fracBits<9>>,
+                           abcT<intBits<6>, fracBits<12>, QuMode<RND::INF>>, cdbT<intBits<6>, fracBits<11>>, badT<intBits<6>, fracBits<12>>,
+                           ABT<intBits<6>, fracBits<11>>, BCT<intBits<6>, fracBits<11>, QuMode<RND::CONV>>>;
+using basicMul = BasicComplexMul<acT<intBits<5>, fracBits<12>>, bdT<intBits<5>, fracBits<11>, QuMode<RND::CONV>>, adT<intBits<5>, fracBits<12>>,
+                                 bcT<intBits<5>, fracBits<12>>, acbdT<intBits<6>, fracBits<11>>, adbcT<intBits<6>, fracBits<10>, QuMode<RND::INF>>>;
+
+template <typename QuT>
+void fillComplex(QuT &x, uint64_t seed)
+{
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> dist(-3.0, 3.0);
+    for (size_t i = 0; i < QuT::elemSize; i++)
+    {
+        x.data[i] = typename QuT::elem_t(dist(rng), dist(rng));
+    }
+}
+
+// 逐元素调用复数 Qmul 与 Qreduce 的参考实现
+template <typename method, bool transA, size_t M, size_t N, size_t K, typename AT, typename BT>
+auto referenceComplexGemul(const AT &A, const BT &B)
+{
+    using prod_t = decltype(Qmul<method>(ca_t(), cb_t()));
+
+    Qu<dim<M, N>, cc_t> C;
+    for (size_t i = 0; i < M; i++)
+    {
+        for (size_t j = 0; j < N; j++)
+        {
+            Qu<dim<K>, prod_t> products;
+            for (size_t k = 0; k < K; k++)
+            {
+                products[k] = Qmul<method>(transA ? A[k, i] : A[i, k], B[k, j]);
+            }
+            C[i, j] = Qreduce<cl0_t, cl1_t, cc_t>(products);
+        }
+    }
+    return C;
+}
+
+template <typename CT, typename RT>
+void expectSameComplex(const CT &C, const RT &ref)
+{
+    for (size_t i = 0; i < CT::elemSize; i++)
+    {
+        ASSERT_EQ(C[i].real.data.data, ref[i].real.data.data) << "real at " << i;
+        ASSERT_EQ(C[i].imag.data.data, ref[i].imag.data.data) << "imag at " << i;
+    }
+}
+
+TEST(Qgemul, complexPlanes)
+{
+    constexpr size_t M = 11, N = 23, K = 70;
+    Qu<dim<M, K>, ca_t> A;
+    Qu<dim<K, N>, cb_t> B;
+    fillComplex(A, 1);
+    fillComplex(B, 2);
+
+    Qu<dim<M, N>, cc_t> C;
+    Qgemul<QgemulMulArgs<tfMul>, QgemulAddArgs<cl0_t, cl1_t, cc_t>>(C, A, B);
+    expectSameComplex(C, referenceComplexGemul<tfMul, false, M, N, K>(A, B));
+
+    Qgemul<QuExec<Parallel<3>>, QgemulMulArgs<basicMul>, QgemulAddArgs<cl0_t, cl1_t, cc_t>>(C, A, B);
+    expectSameComplex(C, referenceComplexGemul<basicMul, false, M, N, K>(A, B));
+
+    // 不指定方法时为 BasicComplexMul<>
+    Qgemul<QgemulAddArgs<cl0_t, cl1_t, cc_t>>(C, A, B);
+    expectSameComplex(C, referenceComplexGemul<BasicComplexMul<>, false, M, N, K>(A, B));
+
+    Qu<dim<K, M>, ca_t> At;
+    for (size_t i = 0; i < M; i++)
+    {
+        for (size_t k = 0; k < K; k++)
+        {
+            At[k, i] = A[i, k];
+        }
+    }
+    Qgemul<QgemulTransposedA<true>, QgemulMulArgs<tfMul>, QgemulAddArgs<cl0_t, cl1_t, cc_t>>(C, At, B);
+    expectSameComplex(C, referenceComplexGemul<tfMul, true, M, N, K>(At, B));
+}
+
+TEST(Qgemv, complexPlanes)
+{
+    constexpr size_t M = 17, K = 45;
+    Qu<dim<M, K>, ca_t> A;
+    Qu<dim<K, 1>, cb_t> X;
+    fillComplex(A, 3);
+    fillComplex(X, 4);
+
+    Qu<dim<K>, cb_t> x;
+    std::copy(X.data.begin(), X.data.end(), x.data.begin());
+
+    const auto ref = referenceComplexGemul<tfMul, false, M, 1, K>(A, X);
+
+    Qu<dim<M>, cc_t> y;
+    Qgemv<QdotMulArgs<tfMul>, QdotAddArgs<cl0_t, cl1_t, cc_t>>(y, A, x);
+    expectSameComplex(y, ref);
+}
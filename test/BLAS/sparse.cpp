@@ -0,0 +1,231 @@
+#include "QuBLAS.h"
+#include <gtest/gtest.h>
+
+using namespace QuBLAS;
+
+using elem_t = Qu<intBits<3>, fracBits<8>>;
+using prod_t = Qu<intBits<6>, fracBits<10>>;
+using acc_t = Qu<intBits<8>, fracBits<6>, QuMode<RND::CONV>>;
+
+using l0_t = Qu<intBits<6>, fracBits<7>>;
+using l1_t = Qu<intBits<7>, fracBits<6>, QuMode<RND::CONV>>;
+using l2_t = Qu<intBits<8>, fracBits<5>>;
+
+using addList = QdotAddArgs<l0_t, l1_t, l2_t>;
+
+template <typename T, size_t M, size_t N>
+Qu<dim<M, N>, T> randomDense(uint32_t seed)
+{
+    Qu<dim<M, N>, T> res;
+    res.fillRandom(3, seed);
+    return res;
+}
+
+// 把不在 keep(i, j) 中的元素清零
+template <typename DenseT>
+void sparsify(DenseT &dense, const auto &keep)
+{
+    constexpr size_t M = DenseT::size::template dimAt<0>;
+    for (size_t i = 0; i < DenseT::elemSize; i++)
+    {
+        if (!keep(i % M, i / M))
+        {
+            dense[i] = 0;
+        }
+    }
+}
+
+template <typename A, typename B>
+void expectSameElements(const A &a, const B &b)
+{
+    static_assert(A::elemSize == B::elemSize);
+    for (size_t i = 0; i < A::elemSize; i++)
+    {
+        ASSERT_EQ(a[i].data.data, b[i].data.data) << "element " << i;
+    }
+}
+
+TEST(Sparse, construction)
+{
+    auto dense = randomDense<elem_t, 7, 9>(1);
+    sparsify(dense, [](size_t i, size_t j) { return (i * 3 + j) % 4 == 0; });
+
+    const Qu<dim<7, 9>, layout<CSR>, elem_t> csr(dense);
+    const Qu<dim<7, 9>, layout<CSC>, elem_t> csc(dense);
+    EXPECT_EQ(csr.nnz(), csc.nnz());
+    EXPECT_LT(csr.nnz(), dense.elemSize);
+
+    // 坐标表的顺序任意
+    std::vector<QuCoo<elem_t>> coo;
+    csr.forEach([&](size_t i, size_t j, const elem_t &v) { coo.push_back({i, j, v}); });
+    std::reverse(coo.begin(), coo.end());
+    const Qu<dim<7, 9>, layout<CSR>, elem_t> fromCoo(coo);
+    EXPECT_EQ(fromCoo.ptr, csr.ptr);
+    EXPECT_EQ(fromCoo.idx, csr.idx);
+
+    expectSameElements(csr, dense);
+    expectSameElements(csc, dense);
+    expectSameElements(fromCoo, dense);
+    expectSameElements(csr.toDense(), dense);
+    const auto ref = dense.toDouble();
+    EXPECT_EQ(csc.toDouble(), std::vector<double>(ref.begin(), ref.end()));
+
+    coo.push_back(coo.front());
+    EXPECT_THROW((Qu<dim<7, 9>, layout<CSC>, elem_t>(coo)), std::invalid_argument);
+    coo.back() = {7, 0, elem_t(1)};
+    EXPECT_THROW((Qu<dim<7, 9>, layout<CSR>, elem_t>(coo)), std::invalid_argument);
+
+    // 转置的视图指向自身持有的副本，只能移动
+    static_assert(!std::is_copy_constructible_v<QuSparseLines<elem_t>> && std::is_move_constructible_v<QuSparseLines<elem_t>>);
+    auto byCols = csr.lines<false>();
+    const auto moved = std::move(byCols);
+    EXPECT_EQ(moved.ptr.data(), moved.ownPtr.data());
+    EXPECT_TRUE(std::equal(moved.ptr.begin(), moved.ptr.end(), csc.ptr.begin(), csc.ptr.end()));
+    EXPECT_TRUE(std::equal(moved.idx.begin(), moved.idx.end(), csc.idx.begin(), csc.idx.end()));
+
+    // 零保持的逐元素函数
+    const auto neg = csr.apply([](const elem_t &v) { return Qneg(v); });
+    EXPECT_EQ(neg.idx, csr.idx);
+    for (size_t i = 0; i < dense.elemSize; i++)
+    {
+        EXPECT_EQ(neg[i].toDouble(), -dense[i].toDouble());
+    }
+}
+
+TEST(Sparse, structured)
+{
+    using banded_t = Qu<dim<6, 8>, layout<Banded<1, 2>>, elem_t>;
+    EXPECT_EQ(banded_t::band(0), (std::pair<size_t, size_t>(0, 3)));
+    EXPECT_EQ(banded_t::band(5), (std::pair<size_t, size_t>(4, 8)));
+    EXPECT_EQ(banded_t().nnz(), 3u + 4 + 4 + 4 + 4 + 4);
+
+    auto dense = randomDense<elem_t, 6, 8>(2);
+    sparsify(dense, [](size_t i, size_t j) { return banded_t::contains(i, j); });
+    const banded_t banded(dense);
+    expectSameElements(banded, dense);
+
+    dense[5, 0] = 1;
+    EXPECT_THROW((banded_t(dense)), std::invalid_argument);
+    EXPECT_THROW((banded_t(std::vector<QuCoo<elem_t>>{{5, 0, elem_t(1)}})), std::invalid_argument);
+
+    // 3 x 2 的块
+    using block_t = Qu<dim<9, 6>, layout<BlockDiagonal<3, 2>>, elem_t>;
+    EXPECT_EQ(block_t::band(4), (std::pair<size_t, size_t>(2, 4)));
+    const block_t blocks(std::vector<QuCoo<elem_t>>{{4, 3, elem_t(1.5)}, {8, 5, elem_t(-2)}});
+    EXPECT_EQ(blocks.nnz(), 18u);
+    EXPECT_EQ((blocks[4, 3].toDouble()), 1.5);
+    EXPECT_EQ((blocks[8, 5].toDouble()), -2.0);
+    EXPECT_EQ((blocks[8, 4].toDouble()), 0.0);
+}
+
+// 没有结构零时与稠密的 Qgemv 与 Qgemul 逐位相同
+TEST(Sparse, matchesDense)
+{
+    const auto A = randomDense<elem_t, 13, 37>(3);
+    const auto B = randomDense<elem_t, 37, 11>(4);
+    const auto x = randomDense<elem_t, 37, 1>(5);
+    Qu<dim<37>, elem_t> v;
+    for (size_t k = 0; k < 37; k++)
+    {
+        v[k] = x[k];
+    }
+
+    Qu<dim<13>, acc_t> yDense, ySparse;
+    Qgemv<addList, QdotMulArgs<prod_t>>(yDense, A, v);
+    Qgemv<addList, QdotMulArgs<prod_t>>(ySparse, Qu<dim<13, 37>, layout<CSR>, elem_t>(A), v);
+    expectSameElements(ySparse, yDense);
+    Qgemv<addList, QdotMulArgs<prod_t>, QuExec<Parallel<3>>>(ySparse, Qu<dim<13, 37>, layout<CSC>, elem_t>(A), v);
+    expectSameElements(ySparse, yDense);
+
+    using gemulAdd = QgemulAddArgs<l0_t, l1_t>;
+    Qu<dim<13, 11>, acc_t> CDense, CSparse;
+    Qgemul<gemulAdd, QgemulMulArgs<prod_t>>(CDense, A, B);
+
+    Qgemul<gemulAdd, QgemulMulArgs<prod_t>>(CSparse, Qu<dim<13, 37>, layout<CSR>, elem_t>(A), B);
+    expectSameElements(CSparse, CDense);
+    Qgemul<gemulAdd, QgemulMulArgs<prod_t>, QuExec<Parallel<2>>>(CSparse, A, Qu<dim<37, 11>, layout<CSC>, elem_t>(B));
+    expectSameElements(CSparse, CDense);
+    Qgemul<gemulAdd, QgemulMulArgs<prod_t>>(CSparse, Qu<dim<13, 37>, layout<CSC>, elem_t>(A), Qu<dim<37, 11>, layout<CSR>, elem_t>(B));
+    expectSameElements(CSparse, CDense);
+}
+
+// 每一行的结果等于把该行的非零乘积压紧后的 Qreduce
+TEST(Sparse, reducesNonZeros)
+{
+    constexpr size_t K = 29;
+    using sparse_t = Qu<dim<K, 10>, layout<CSC>, elem_t>;
+
+    auto dense = randomDense<elem_t, K, 10>(6);
+    sparsify(dense, [](size_t k, size_t i) { return (k * 7 + i * 5) % 3 != 0 || i == 4; });
+    for (size_t k = 0; k < K; k++)
+    {
+        dense[k, 9] = (k == 11) ? 1.25 : 0; // 一行只有一个非零元
+        dense[k, 8] = 0;                    // 全零的行
+    }
+    const sparse_t A(dense);
+    const auto x = randomDense<elem_t, K, 1>(7);
+    Qu<dim<K>, elem_t> v;
+    for (size_t k = 0; k < K; k++)
+    {
+        v[k] = x[k];
+    }
+
+    // y = A^T * v，A 的每一列是 op(A) 的一行
+    Qu<dim<10>, acc_t> y;
+    Qgemv<addList, QdotMulArgs<prod_t>, QgemvTransposedA<true>>(y, A, v);
+
+    for (size_t i = 0; i < 10; i++)
+    {
+        std::vector<prod_t> products;
+        for (size_t k = 0; k < K; k++)
+        {
+            if (!(dense[k, i] == elem_t()))
+            {
+                products.push_back(Qmul<prod_t>(dense[k, i], v[k]));
+            }
+        }
+        const acc_t expected = Reducer<l0_t, l1_t, l2_t>::reduce_dynamic<K, prod_t, acc_t>(products, products.size());
+        EXPECT_EQ(y[i].data.data, expected.data.data) << "row " << i;
+
+        // 第 4 行没有零，与稠密的 Qreduce 相同
+        if (i == 4)
+        {
+            ASSERT_EQ(products.size(), K);
+            Qu<dim<K>, prod_t> packed;
+            for (size_t k = 0; k < K; k++)
+            {
+                packed[k] = products[k];
+            }
+            EXPECT_EQ(y[i].data.data, acc_t(Qreduce<l0_t, l1_t, l2_t>(packed)).data.data);
+        }
+    }
+    EXPECT_EQ(y[8].toDouble(), 0.0);
+    EXPECT_EQ(y[9].data.data, acc_t(Qmul<prod_t>(elem_t(1.25), v[11])).data.data);
+}
+
+TEST(Sparse, structuredProducts)
+{
+    using banded_t = Qu<dim<16, 16>, layout<Banded<2, 1>>, elem_t>;
+    auto dense = randomDense<elem_t, 16, 16>(8);
+    sparsify(dense, [](size_t i, size_t j) { return banded_t::contains(i, j); });
+    const banded_t A(dense);
+    const auto B = randomDense<elem_t, 16, 5>(9);
+
+    using gemulAdd = QgemulAddArgs<l0_t>;
+    Qu<dim<16, 5>, acc_t> C;
+    Qgemul<gemulAdd, QgemulMulArgs<prod_t>>(C, A, B);
+    for (size_t i = 0; i < 16; i++)
+    {
+        const auto [first, last] = banded_t::band(i);
+        for (size_t j = 0; j < 5; j++)
+        {
+            std::vector<prod_t> products;
+            for (size_t k = first; k < last; k++)
+            {
+                products.push_back(Qmul<prod_t>(dense[i, k], B[k, j]));
+            }
+            const acc_t expected = Reducer<l0_t>::reduce_dynamic<16, prod_t, acc_t>(products, products.size());
+            ASSERT_EQ((C[i, j].data.data), expected.data.data) << i << ", " << j;
+        }
+    }
+}
@@ -0,0 +1,116 @@
+#include "QuBLAS.h"
+#include <gtest/gtest.h>
+
+using namespace QuBLAS;
+
+using type1 = Qu<intBits<4>, fracBits<5>>;
+using type2 = Qu<intBits<3>, fracBits<3>, isSigned<false>>;
+using cplx_t = Qcomplex<type1, type2>;
+
+// 把打包的比特展开成 0/1 字符串
+template <typename Word>
+std::string unpackToString(std::span<const Word> buf, size_t bits)
+{
+    std::string res;
+    constexpr size_t wordBits = sizeof(Word) * 8;
+    for (size_t p = 0; p < bits; p++)
+    {
+        res.push_back(((static_cast<uint64_t>(buf[p / wordBits]) >> (wordBits - 1 - p % wordBits)) & 1) ? '1' : '0');
+    }
+    return res;
+}
+
+template <typename tensorP, typename elemP, typename QuT>
+void expectSameAsString(QuT const &tensor)
+{
+    const std::string str = BitStream<tensorP, elemP>(tensor);
+
+    std::vector<std::byte> bytes(BitPackWords<QuT>);
+    EXPECT_EQ((BitPack<tensorP, elemP>(tensor, bytes)), str.size());
+    EXPECT_EQ(unpackToString<std::byte>(bytes, str.size()), str);
+
+    std::vector<uint64_t> words(BitPackWords<QuT, uint64_t>);
+    BitPack<tensorP, elemP>(tensor, words);
+    EXPECT_EQ(unpackToString<uint64_t>(words, str.size()), str);
+
+    // 解码回原张量，并与字符串解码一致
+    QuT fromBytes, fromWords;
+    BitUnpack<tensorP, elemP>(bytes, fromBytes);
+    BitUnpack<tensorP, elemP>(words, fromWords);
+    auto fromString = BitStream<QuT, tensorP, elemP>(str);
+    for (size_t i = 0; i < QuT::elemSize; i++)
+    {
+        ASSERT_EQ(fromBytes[i].data.data, tensor[i].data.data);
+        ASSERT_EQ(fromWords[i].data.data, tensor[i].data.data);
+        ASSERT_EQ(fromString[i].data.data, tensor[i].data.data);
+    }
+}
+
+TEST(BitPack, sameOrderAsString)
+{
+    Qu<dim<12>, type1> vec;
+
+    // 包含负数
+    for (size_t i = 0; i < 12; i++)
+    {
+        vec[i] = -7.75 + 1.3 * i;
+    }
+
+    expectSameAsString<l2r, l2r>(vec);
+    expectSameAsString<r2l<>, l2r>(vec);
+    expectSameAsString<r2l<3>, l2r>(vec);
+    expectSameAsString<l2r, r2l<>>(vec);
+    expectSameAsString<r2l<4>, r2l<5>>(vec);
+
+    Qu<dim<3, 5>, type2> mat;
+    for (size_t i = 0; i < 15; i++)
+    {
+        mat[i] = 0.375 * i;
+    }
+    expectSameAsString<r2l<5>, r2l<2>>(mat);
+}
+
+TEST(BitPack, complexAndScalar)
+{
+    Qu<dim<6>, cplx_t> vec;
+    for (size_t i = 0; i < 6; i++)
+    {
+        vec[i] = cplx_t(type1(-3.5 + i), type2(0.125 * i));
+    }
+
+    std::vector<std::byte> bytes(BitPackWords<decltype(vec)>);
+    BitPack<r2l<2>, l2r>(vec, bytes);
+
+    decltype(vec) res;
+    BitUnpack<r2l<2>, l2r>(bytes, res);
+    for (size_t i = 0; i < 6; i++)
+    {
+        EXPECT_EQ(res[i].real.toDouble(), vec[i].real.toDouble());
+        EXPECT_EQ(res[i].imag.toDouble(), vec[i].imag.toDouble());
+    }
+
+    // 实部在前，与字符串中去掉括号后的顺序一致
+    std::string expected;
+    for (size_t i : {4, 5, 2, 3, 0, 1})
+    {
+        expected += vec[i].real.toString() + vec[i].imag.toString();
+    }
+    EXPECT_EQ(unpackToString<std::byte>(bytes, expected.size()), expected);
+
+    type1 scalar = -2.25;
+    std::array<uint64_t, 1> word{};
+    BitPack<r2l<>>(scalar, std::span<uint64_t>(word));
+    EXPECT_EQ(unpackToString<uint64_t>(word, type1::width), BitStream<r2l<>>(scalar));
+
+    type1 back;
+    BitUnpack<r2l<>>(std::span<const uint64_t>(word), back);
+    EXPECT_EQ(back.toDouble(), -2.25);
+}
+
+TEST(BitPack, bufferTooSmall)
+{
+    Qu<dim<12>, type1> vec;
+    std::vector<std::byte> bytes(BitPackWords<decltype(vec)> - 1);
+    EXPECT_THROW((BitPack<l2r, l2r>(vec, bytes)), std::runtime_error);
+    EXPECT_THROW((BitUnpack<l2r, l2r>(bytes, vec)), std::runtime_error);
+}
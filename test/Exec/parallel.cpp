@@ -0,0 +1,66 @@
+#include "QuBLAS.h"
+#include <gtest/gtest.h>
+
+using namespace QuBLAS;
+
+using in_t = Qu<intBits<6>, fracBits<10>>;
+using out_t = Qu<intBits<8>, fracBits<6>, QuMode<RND::CONV>, OfMode<SAT::TCPL>>;
+
+TEST(Exec, poolCoversRangeOnce)
+{
+    QuThreadPool pool(3);
+    EXPECT_EQ(pool.size(), 4);
+
+    for (size_t n : {0, 1, 7, 1000, 65537})
+    {
+        std::vector<int> hits(n, 0);
+        pool.parallelFor(n, 0, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                hits[i]++;
+            }
+        });
+        EXPECT_TRUE(std::all_of(hits.begin(), hits.end(), [](int h) { return h == 1; }));
+    }
+}
+
+TEST(Exec, poolPropagatesExceptions)
+{
+    QuThreadPool pool(2);
+    EXPECT_THROW(pool.parallelFor(10000, 3, [](size_t begin, size_t end) {
+        if (begin <= 5000 && 5000 < end)
+        {
+            throw std::runtime_error("boom");
+        }
+    }),
+                 std::runtime_error);
+
+    // 异常之后线程池依然可用
+    std::atomic<size_t> count = 0;
+    pool.parallelFor(100, 3, [&](size_t begin, size_t end) { count += end - begin; });
+    EXPECT_EQ(count, 100);
+}
+
+TEST(Exec, bitIdenticalToSerial)
+{
+    Qu<dim<64, 48>, in_t> a, b;
+    a.fill();
+    b.fill();
+
+    Qu<dim<64, 48>, out_t> serial = Qmul<out_t>(a, b);
+    Qu<dim<64, 48>, out_t> parallel;
+    Qassign<QuExec<Parallel<4>>>(parallel, Qmul<out_t>(a, b));
+
+    for (size_t i = 0; i < 64 * 48; i++)
+    {
+        EXPECT_EQ(serial[i].data.data, parallel[i].data.data);
+    }
+
+    Qu<dim<64, 48>, layout<SoA>, out_t> soa;
+    Qassign<QuExec<Parallel<>>>(soa, Qsub<out_t>(a, b));
+    Qu<dim<64, 48>, out_t> ref = Qsub<out_t>(a, b);
+    for (size_t i = 0; i < 64 * 48; i++)
+    {
+        EXPECT_EQ(ref[i].data.data, soa[i].get().data.data);
+    }
+}
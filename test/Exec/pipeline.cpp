@@ -0,0 +1,251 @@
+#include "QuBLAS.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+
+using namespace QuBLAS;
+
+using in_t = Qu<intBits<2>, fracBits<10>>;
+using acc_t = Qu<intBits<6>, fracBits<10>>;
+using out_t = Qu<intBits<4>, fracBits<8>, QuMode<RND::CONV>>;
+
+using inBlock_t = Qu<dim<64>, in_t>;
+using accBlock_t = Qu<dim<64>, acc_t>;
+using outBlock_t = Qu<dim<64>, out_t>;
+
+// 源：按序号生成块
+void makeBlock(size_t seq, inBlock_t &out)
+{
+    out.fillRandom(5, static_cast<uint32_t>(seq));
+}
+
+// 有状态的级：逐块累加，结果依赖块的顺序
+struct runningSum
+{
+    accBlock_t state;
+
+    void operator()(const inBlock_t &in, accBlock_t &out)
+    {
+        for (size_t i = 0; i < in.elemSize; i++)
+        {
+            state[i] = Qadd<acc_t>(state[i], in[i]);
+        }
+        out = state;
+    }
+};
+
+// 无状态的级
+void scale(const accBlock_t &in, outBlock_t &out)
+{
+    for (size_t i = 0; i < in.elemSize; i++)
+    {
+        out[i] = Qmul<out_t>(in[i], in[i]);
+    }
+}
+
+std::vector<outBlock_t> serialReference(size_t blocks)
+{
+    std::vector<outBlock_t> res;
+    runningSum sum;
+    for (size_t seq = 0; seq < blocks; seq++)
+    {
+        inBlock_t a;
+        accBlock_t b;
+        outBlock_t c;
+        makeBlock(seq, a);
+        sum(a, b);
+        scale(b, c);
+        res.push_back(c);
+    }
+    return res;
+}
+
+template <typename Ring>
+void stressRing()
+{
+    constexpr size_t perProducer = 10000;
+    Ring ring(6);
+    EXPECT_EQ(ring.capacity(), 8u);
+
+    std::atomic<size_t> sum = 0;
+    std::atomic<size_t> popped = 0;
+    const size_t producers = std::is_same_v<Ring, QuSpscRing<size_t>> ? 1 : 3;
+
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; p++)
+    {
+        threads.emplace_back([&, p] {
+            for (size_t i = 1; i <= perProducer; i++)
+            {
+                while (!ring.tryPush(p * perProducer + i))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        threads.emplace_back([&] {
+            size_t val;
+            while (popped.load() < producers * perProducer)
+            {
+                if (ring.tryPop(val))
+                {
+                    sum += val;
+                    popped++;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    const size_t n = producers * perProducer;
+    EXPECT_EQ(popped, n);
+    EXPECT_EQ(sum, n * (n + 1) / 2);
+}
+
+TEST(Pipeline, rings)
+{
+    stressRing<QuSpscRing<size_t>>();
+    stressRing<QuMpmcRing<size_t>>();
+}
+
+TEST(Pipeline, matchesSerial)
+{
+    constexpr size_t blocks = 50;
+    const auto reference = serialReference(blocks);
+
+    // 并行的级之后仍按源头的顺序到达有状态的级与终点
+    std::vector<outBlock_t> results;
+    std::atomic<size_t> inFlight = 0;
+    size_t peak = 0;
+
+    Qpipeline<QpipelineDepth<3>>::run(
+        blocks,
+        QpipelineStage<QuExec<Parallel<2>>>([&](size_t seq, inBlock_t &out) {
+            inFlight++;
+            makeBlock(seq, out);
+        }),
+        runningSum(),
+        QpipelineStage<QuExec<Parallel<3>>>([](const accBlock_t &in, outBlock_t &out) { scale(in, out); }),
+        [&](const outBlock_t &in) {
+            peak = std::max(peak, inFlight.load());
+            inFlight--;
+            results.push_back(in);
+        });
+
+    ASSERT_EQ(results.size(), blocks);
+    for (size_t b = 0; b < blocks; b++)
+    {
+        for (size_t i = 0; i < outBlock_t::elemSize; i++)
+        {
+            ASSERT_EQ(results[b][i].data.data, reference[b][i].data.data) << "block " << b << " element " << i;
+        }
+    }
+
+    // 同时存在的块不超过各条边的块数之和
+    EXPECT_LE(peak, 3u * 3u);
+}
+
+TEST(Pipeline, propagatesErrors)
+{
+    std::atomic<size_t> sunk = 0;
+    // 第 7 个块出错，之前的块仍然到达终点
+    EXPECT_THROW(Qpipeline<>::run(
+                     1000,
+                     makeBlock,
+                     [counter = size_t(0)](const inBlock_t &in, accBlock_t &out) mutable {
+                         if (++counter == 7)
+                         {
+                             throw std::runtime_error("stage failed");
+                         }
+                         out = in;
+                     },
+                     [&](const accBlock_t &) { sunk++; }),
+                 std::runtime_error);
+    EXPECT_EQ(sunk, 6u);
+}
+
+TEST(Pipeline, asyncWriters)
+{
+    const auto dir = std::filesystem::temp_directory_path();
+    using tensor_t = Qu<dim<40, 25>, in_t>;
+
+    tensor_t x;
+    x.fillRandom(9);
+
+    // 每次写入 7 个元素，缓冲区为 64 个元素
+    const std::string npy = (dir / "qublas_async.npy").string();
+    {
+        QuAsyncFileWriter<tensor_t> writer(npy, QuFile::npy, 64);
+        for (size_t begin = 0; begin < x.elemSize; begin += 7)
+        {
+            writer.write(std::span<const in_t>(x.data.begin() + begin, std::min<size_t>(7, x.elemSize - begin)));
+        }
+        writer.close();
+    }
+    tensor_t y;
+    y.fromNpy(npy);
+    for (size_t i = 0; i < x.elemSize; i++)
+    {
+        ASSERT_EQ(y[i].data.data, x[i].data.data) << i;
+    }
+
+    const std::string bits = (dir / "qublas_async.txt").string();
+    std::string expected;
+    {
+        QuAsyncStream stream(bits, 100);
+        for (size_t seq = 0; seq < 20; seq++)
+        {
+            inBlock_t block;
+            makeBlock(seq, block);
+            const std::string text = BitStream<l2r, l2r>(block) + "\n";
+            stream.write(text);
+            expected += text;
+
+            std::vector<std::byte> packed(BitPackWords<inBlock_t>);
+            BitPack<l2r, l2r>(block, packed);
+            stream.write(std::span<const std::byte>(packed));
+            expected.append(reinterpret_cast<const char *>(packed.data()), packed.size());
+        }
+        stream.close();
+    }
+    std::ifstream in(bits, std::ios::binary);
+    const std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(content, expected);
+
+    std::filesystem::remove(npy);
+    std::filesystem::remove(bits);
+}
+
+// 不调用 close 就析构时仍然写出缓冲区中剩余的数据，sink 的异常被丢弃
+TEST(Pipeline, asyncDestroyWithoutClose)
+{
+    const std::string path = (std::filesystem::temp_directory_path() / "qublas_async_unclosed.txt").string();
+    {
+        QuAsyncStream stream(path, 16);
+        stream.write("hello");
+    }
+    std::ifstream in(path, std::ios::binary);
+    const std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(content, "hello");
+    std::filesystem::remove(path);
+
+    std::vector<int> sunk;
+    {
+        QuAsyncBuffer<int> buffer(4, [&](std::span<const int> items) { sunk.insert(sunk.end(), items.begin(), items.end()); });
+        const std::vector<int> items = {1, 2, 3, 4, 5, 6};
+        buffer.push(items);
+    }
+    EXPECT_EQ(sunk, (std::vector<int>{1, 2, 3, 4, 5, 6}));
+
+    {
+        QuAsyncBuffer<int> failing(4, [](std::span<const int>) { throw std::runtime_error("sink failed"); });
+        const std::vector<int> items = {1, 2};
+        failing.push(items);
+    }
+}
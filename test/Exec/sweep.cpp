@@ -0,0 +1,121 @@
+#include "QuBLAS.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+
+using namespace QuBLAS;
+
+using in_t = Qu<intBits<2>, fracBits<20>>;
+using stim_t = Qu<dim<256>, in_t>;
+
+using coarse_t = Qu<intBits<4>, fracBits<4>>;
+using medium_t = Qu<intBits<4>, fracBits<8>, QuMode<RND::CONV>>;
+using fine_t = Qu<intBits<4>, fracBits<12>, QuMode<RND::CONV>>;
+
+// 候选顺序与精度顺序相反，排名应把它们倒过来
+using sweep_t = QuSweep<TypeList<coarse_t, fine_t, medium_t>, QuExec<Parallel<4>>>;
+
+// 以候选格式计算 x * x，误差为与 double 结果的均方误差
+auto kernel = []<typename C>(std::type_identity<C>, const stim_t &x) {
+    std::array<double, 256> out;
+    for (size_t i = 0; i < 256; i++)
+    {
+        out[i] = Qmul<C>(C(x[i]), C(x[i])).toDouble();
+    }
+    return out;
+};
+
+auto metric = [](const stim_t &x, const std::array<double, 256> &out) {
+    double mse = 0;
+    for (size_t i = 0; i < 256; i++)
+    {
+        const double ref = x[i].toDouble() * x[i].toDouble();
+        mse += (out[i] - ref) * (out[i] - ref);
+    }
+    return mse / 256;
+};
+
+auto stimulus = [](size_t shard) {
+    stim_t x;
+    x.fillRandom(7, static_cast<uint32_t>(shard));
+    return x;
+};
+
+TEST(Sweep, ranksCandidates)
+{
+    constexpr size_t shards = 6;
+
+    std::atomic<size_t> generated = 0;
+    auto countingStimulus = [&](size_t shard) {
+        generated++;
+        return stimulus(shard);
+    };
+
+    const auto samples = sweep_t::run(shards, countingStimulus, kernel, metric);
+    EXPECT_EQ(generated, shards); // 每个分片只生成一次，所有候选共享
+    ASSERT_EQ(samples.size(), 3 * shards);
+
+    // 与逐个串行计算的结果一致
+    for (const auto &sample : samples)
+    {
+        const auto x = stimulus(sample.shard);
+        const double expected = sample.candidate == 0 ? metric(x, kernel(std::type_identity<coarse_t>(), x)) : sample.candidate == 1 ? metric(x, kernel(std::type_identity<fine_t>(), x)) : metric(x, kernel(std::type_identity<medium_t>(), x));
+        EXPECT_EQ(sample.error, expected);
+    }
+
+    const auto ranking = sweep_t::rank(samples);
+    ASSERT_EQ(ranking.size(), 3u);
+    EXPECT_EQ(ranking[0].candidate, 1u);
+    EXPECT_EQ(ranking[1].candidate, 2u);
+    EXPECT_EQ(ranking[2].candidate, 0u);
+    EXPECT_EQ(ranking[0].name, "Qu<intBits<4>, fracBits<12>, isSigned<true>, QuMode<RND::CONV>, OfMode<SAT::TCPL>>");
+    EXPECT_EQ(ranking[0].shards, shards);
+    EXPECT_LT(ranking[0].meanError, ranking[1].meanError);
+    EXPECT_LE(ranking[0].meanError, ranking[0].maxError);
+}
+
+TEST(Sweep, mergesShardedRuns)
+{
+    constexpr size_t shards = 7;
+    const auto dir = std::filesystem::temp_directory_path();
+    const std::vector<std::string> paths = {(dir / "qublas_sweep_0.txt").string(), (dir / "qublas_sweep_1.txt").string(), (dir / "qublas_sweep_2.txt").string()};
+
+    // 三个“进程”各自计算一部分分片并保存
+    for (size_t rank = 0; rank < paths.size(); rank++)
+    {
+        const auto part = QuSweep<TypeList<coarse_t, fine_t, medium_t>, QuExec<Serial>>::run(shards, stimulus, kernel, metric, {rank, paths.size()});
+        for (const auto &sample : part)
+        {
+            EXPECT_EQ(sample.shard % paths.size(), rank);
+        }
+        sweep_t::save(paths[rank], part);
+    }
+
+    const auto merged = sweep_t::load(paths);
+    const auto whole = sweep_t::run(shards, stimulus, kernel, metric);
+    ASSERT_EQ(merged.size(), whole.size());
+    for (size_t i = 0; i < whole.size(); i++)
+    {
+        EXPECT_EQ(merged[i].candidate, whole[i].candidate);
+        EXPECT_EQ(merged[i].shard, whole[i].shard);
+        EXPECT_EQ(merged[i].error, whole[i].error);
+    }
+
+    const auto a = sweep_t::rank(merged);
+    const auto b = sweep_t::rank(whole);
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        EXPECT_EQ(a[i].candidate, b[i].candidate);
+        EXPECT_EQ(a[i].meanError, b[i].meanError);
+    }
+
+    for (const auto &path : paths)
+    {
+        std::filesystem::remove(path);
+    }
+}
+
+TEST(Sweep, rejectsBadShards)
+{
+    EXPECT_THROW(sweep_t::run(7, stimulus, kernel, metric, {0, 0}), std::invalid_argument);
+    EXPECT_THROW(sweep_t::run(7, stimulus, kernel, metric, {3, 3}), std::invalid_argument);
+}
@@ -0,0 +1,222 @@
+#include "QuBLAS.h"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace QuBLAS;
+
+template <int intB, int fracB, bool isS>
+using in_t = Qu<intBits<intB>, fracBits<fracB>, isSigned<isS>>;
+
+template <typename QuT>
+QuT randomRaw(std::mt19937_64 &rng)
+{
+    constexpr int valueBits = QuT::intB + QuT::fracB;
+    const int64_t hi = valueBits == 63 ? std::numeric_limits<int64_t>::max() : (int64_t(1) << valueBits) - 1;
+    const int64_t lo = QuT::isS ? -hi - 1 : 0;
+
+    QuT x;
+    x.data = decltype(x.data)(std::uniform_int_distribution<int64_t>(lo, hi)(rng));
+    return x;
+}
+
+// 运行时格式的每个运算都要和静态类型逐位一致
+template <typename A, typename B, typename out_t>
+void checkOps(const A a, const B b)
+{
+    const QuDynFormat fmt = QuDynFormat::of<out_t>();
+    const QuDyn x(a), y(b);
+
+    EXPECT_EQ(QdynMul(fmt, x, y).data, static_cast<int64_t>(Qmul<out_t>(a, b).data.data)) << a.toDouble() << " * " << b.toDouble();
+    EXPECT_EQ(QdynAdd(fmt, x, y).data, static_cast<int64_t>(Qadd<out_t>(a, b).data.data)) << a.toDouble() << " + " << b.toDouble();
+    EXPECT_EQ(QdynSub(fmt, x, y).data, static_cast<int64_t>(Qsub<out_t>(a, b).data.data)) << a.toDouble() << " - " << b.toDouble();
+    EXPECT_EQ(x.convert(fmt).data, static_cast<int64_t>(out_t(a).data.data)) << a.toDouble();
+    EXPECT_EQ(x.template toStatic<out_t>().toString(), out_t(a).toString());
+}
+
+template <typename A, typename B, int toInt, int toFrac, bool toIsSigned, typename OfM>
+void checkAllQuModes(const A a, const B b)
+{
+    checkOps<A, B, Qu<intBits<toInt>, fracBits<toFrac>, isSigned<toIsSigned>, QuMode<RND::POS_INF>, OfMode<OfM>>>(a, b);
+    checkOps<A, B, Qu<intBits<toInt>, fracBits<toFrac>, isSigned<toIsSigned>, QuMode<RND::NEG_INF>, OfMode<OfM>>>(a, b);
+    checkOps<A, B, Qu<intBits<toInt>, fracBits<toFrac>, isSigned<toIsSigned>, QuMode<RND::ZERO>, OfMode<OfM>>>(a, b);
+    checkOps<A, B, Qu<intBits<toInt>, fracBits<toFrac>, isSigned<toIsSigned>, QuMode<RND::INF>, OfMode<OfM>>>(a, b);
+    checkOps<A, B, Qu<intBits<toInt>, fracBits<toFrac>, isSigned<toIsSigned>, QuMode<RND::CONV>, OfMode<OfM>>>(a, b);
+    checkOps<A, B, Qu<intBits<toInt>, fracBits<toFrac>, isSigned<toIsSigned>, QuMode<TRN::TCPL>, OfMode<OfM>>>(a, b);
+    checkOps<A, B, Qu<intBits<toInt>, fracBits<toFrac>, isSigned<toIsSigned>, QuMode<TRN::SMGN>, OfMode<OfM>>>(a, b);
+}
+
+template <typename A, typename B, int toInt, int toFrac, bool toIsSigned>
+void checkFormat()
+{
+    std::mt19937_64 rng(A::width * 1000 + B::width * 10 + toFrac);
+
+    for (int i = 0; i < 100; i++)
+    {
+        const A a = randomRaw<A>(rng);
+        const B b = randomRaw<B>(rng);
+        checkAllQuModes<A, B, toInt, toFrac, toIsSigned, SAT::TCPL>(a, b);
+        checkAllQuModes<A, B, toInt, toFrac, toIsSigned, SAT::ZERO>(a, b);
+        checkAllQuModes<A, B, toInt, toFrac, toIsSigned, SAT::SMGN>(a, b);
+        checkAllQuModes<A, B, toInt, toFrac, toIsSigned, WRP::TCPL>(a, b);
+    }
+}
+
+TEST(QuDyn, matchesStaticOps)
+{
+    checkFormat<in_t<4, 8, true>, in_t<3, 9, true>, 5, 6, true>();
+    checkFormat<in_t<4, 8, true>, in_t<3, 9, true>, 2, 3, true>();
+    checkFormat<in_t<4, 4, false>, in_t<4, 4, true>, 6, 4, false>();
+    checkFormat<in_t<10, -2, true>, in_t<-2, 10, true>, 6, 3, true>();
+    checkFormat<in_t<10, 2, true>, in_t<4, 6, true>, 12, -3, true>();
+    checkFormat<in_t<30, 30, true>, in_t<20, 40, false>, 40, 20, true>();
+    checkFormat<in_t<31, 32, true>, in_t<31, 32, true>, 31, 32, true>();
+}
+
+template <typename QuM, typename OfM>
+void checkDouble(const std::vector<double> &values)
+{
+    using t1 = Qu<intBits<5>, fracBits<7>, QuMode<QuM>, OfMode<OfM>>;
+    using t2 = Qu<intBits<20>, fracBits<-4>, isSigned<false>, QuMode<QuM>, OfMode<OfM>>;
+    using t3 = Qu<intBits<2>, fracBits<61>, QuMode<QuM>, OfMode<OfM>>;
+
+    for (const double v : values)
+    {
+        EXPECT_EQ(QuDyn(QuDynFormat::of<t1>(), v).data, static_cast<int64_t>(t1(v).data.data)) << v;
+        EXPECT_EQ(QuDyn(QuDynFormat::of<t2>(), v).data, static_cast<int64_t>(t2(v).data.data)) << v;
+        EXPECT_EQ(QuDyn(QuDynFormat::of<t3>(), v).data, static_cast<int64_t>(t3(v).data.data)) << v;
+        EXPECT_EQ(QuDyn(QuDynFormat::of<t1>(), v).toDouble(), t1(v).toDouble()) << v;
+    }
+}
+
+template <typename OfM>
+void checkDoubleQuModes(const std::vector<double> &values)
+{
+    checkDouble<RND::POS_INF, OfM>(values);
+    checkDouble<RND::NEG_INF, OfM>(values);
+    checkDouble<RND::ZERO, OfM>(values);
+    checkDouble<RND::INF, OfM>(values);
+    checkDouble<RND::CONV, OfM>(values);
+    checkDouble<TRN::TCPL, OfM>(values);
+    checkDouble<TRN::SMGN, OfM>(values);
+}
+
+TEST(QuDyn, fromDouble)
+{
+    std::mt19937_64 rng(3);
+    std::vector<double> values = {0.0, -0.0, 0.5, -0.5, 1.0 / 256, -1.0 / 256, 3.0 / 256, 31.99, -32.0, -32.5, 1e300, -1e300, 5e-324, -5e-324, 1e20, -1e20, std::numeric_limits<double>::infinity(), std::nan("")};
+    for (int i = 0; i < 200; i++)
+    {
+        values.push_back(std::ldexp(std::uniform_real_distribution<double>(-1, 1)(rng), std::uniform_int_distribution<int>(-70, 90)(rng)));
+    }
+
+    checkDoubleQuModes<SAT::TCPL>(values);
+    checkDoubleQuModes<SAT::ZERO>(values);
+    checkDoubleQuModes<SAT::SMGN>(values);
+    checkDoubleQuModes<WRP::TCPL>(values);
+}
+
+TEST(QuDyn, defaultFormats)
+{
+    using a_t = Qu<intBits<6>, fracBits<5>, QuMode<RND::CONV>>;
+    using b_t = Qu<intBits<3>, fracBits<9>, isSigned<false>, QuMode<RND::CONV>>;
+
+    const a_t a(-7.34);
+    const b_t b(2.718);
+
+    const auto mul = QdynMul(QuDyn(a), QuDyn(b));
+    EXPECT_EQ(mul.format, QuDynFormat::of<decltype(Qmul(a, b))>());
+    EXPECT_EQ(mul.data, static_cast<int64_t>(Qmul(a, b).data.data));
+
+    const auto add = QdynAdd(QuDyn(a), QuDyn(b));
+    EXPECT_EQ(add.format, QuDynFormat::of<decltype(Qadd(a, b))>());
+    EXPECT_EQ(add.data, static_cast<int64_t>(Qadd(a, b).data.data));
+
+    EXPECT_EQ(QuDynFormat::mulFormat(QuDynFormat::of<a_t>(), QuDynFormat::of<b_t>(), true), QuDynFormat::of<decltype(Qmul<FullPrec>(a, b))>());
+    EXPECT_EQ(QuDynFormat::addFormat(QuDynFormat::of<a_t>(), QuDynFormat::of<b_t>(), true), QuDynFormat::of<decltype(Qadd<FullPrec>(a, b))>());
+}
+
+TEST(QuDyn, tensorKernels)
+{
+    using a_t = Qu<intBits<4>, fracBits<10>>;
+    using b_t = Qu<intBits<6>, fracBits<6>, isSigned<false>>;
+    using out_t = Qu<intBits<5>, fracBits<8>, QuMode<RND::CONV>, OfMode<WRP::TCPL>>;
+
+    Qu<dim<7, 9>, a_t> A;
+    Qu<dim<7, 9>, b_t> B;
+    A.fillRandom(1, 0);
+    B.fillRandom(1, 1);
+
+    const QuDynTensor dA(A), dB(B);
+    EXPECT_EQ(dA.shape, (std::vector<size_t>{7, 9}));
+
+    QuDynTensor dOut(QuDynFormat::of<out_t>(), {7, 9});
+    QdynMul(dOut, dA, dB);
+    const Qu<dim<7, 9>, out_t> mul = Qmul<out_t>(A, B);
+    for (size_t i = 0; i < A.elemSize; i++)
+    {
+        ASSERT_EQ(dOut.data[i], static_cast<int64_t>(mul.data[i].data.data)) << "at " << i;
+    }
+
+    QdynSub(dOut, dA, dB);
+    const auto sub = dOut.toStatic<Qu<dim<7, 9>, out_t>>();
+    for (size_t i = 0; i < A.elemSize; i++)
+    {
+        ASSERT_EQ(sub.data[i].toString(), (Qsub<out_t>(A.data[i], B.data[i]).toString())) << "at " << i;
+    }
+
+    // 转成不同的元素格式
+    const auto back = dA.toStatic<Qu<dim<7, 9>, out_t>>();
+    for (size_t i = 0; i < A.elemSize; i++)
+    {
+        ASSERT_EQ(back.data[i].toString(), out_t(A.data[i]).toString()) << "at " << i;
+    }
+
+    std::vector<double> values = dA.toDouble();
+    QuDynTensor dC(QuDynFormat::of<out_t>(), {7, 9});
+    dC.fromDouble(values);
+    for (size_t i = 0; i < A.elemSize; i++)
+    {
+        ASSERT_EQ(dC[i].data, static_cast<int64_t>(out_t(values[i]).data.data)) << "at " << i;
+    }
+}
+
+TEST(QuDyn, wideTensorKernels)
+{
+    // 中间结果超过 64 位时走 __int128_t
+    using a_t = in_t<30, 30, true>;
+    using b_t = in_t<20, 40, false>;
+    using out_t = Qu<intBits<40>, fracBits<20>, QuMode<RND::ZERO>, OfMode<SAT::SMGN>>;
+
+    std::mt19937_64 rng(11);
+    Qu<dim<64>, a_t> A;
+    Qu<dim<64>, b_t> B;
+    for (size_t i = 0; i < A.elemSize; i++)
+    {
+        A.data[i] = randomRaw<a_t>(rng);
+        B.data[i] = randomRaw<b_t>(rng);
+    }
+
+    const QuDynTensor dA(A), dB(B);
+    QuDynTensor mul(QuDynFormat::of<out_t>(), {64}), add(QuDynFormat::of<out_t>(), {64});
+    QdynMul(mul, dA, dB);
+    QdynAdd(add, dA, dB);
+    for (size_t i = 0; i < A.elemSize; i++)
+    {
+        ASSERT_EQ(mul.data[i], static_cast<int64_t>(Qmul<out_t>(A.data[i], B.data[i]).data.data)) << "at " << i;
+        ASSERT_EQ(add.data[i], static_cast<int64_t>(Qadd<out_t>(A.data[i], B.data[i]).data.data)) << "at " << i;
+    }
+}
+
+TEST(QuDyn, invalidFormats)
+{
+    EXPECT_THROW(QuDyn(QuDynFormat{40, 30, true}, 1.0), std::invalid_argument);
+    EXPECT_THROW(QuDyn(QuDynFormat{8, 8, true, 9}, 1.0), std::invalid_argument);
+    EXPECT_THROW(QuDyn(QuDynFormat{8, 8, true, 0, WRP::TCPL_SAT<2>::value}, 1.0), std::invalid_argument);
+
+    QuDynTensor a(QuDynFormat{}, {4}), b(QuDynFormat{}, {5});
+    EXPECT_THROW(QdynAdd(a, a, b), std::invalid_argument);
+
+    // 对齐移位让中间结果超过 __int128_t
+    const QuDyn wide(QuDynFormat{62, 1, true}, 1.0), fine(QuDynFormat{-63, 126, true}, 0.0);
+    EXPECT_THROW(QdynAdd(QuDynFormat{62, 1, true}, wide, fine), std::domain_error);
+}
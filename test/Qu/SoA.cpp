@@ -0,0 +1,99 @@
+#include "QuBLAS.h"
+#include <gtest/gtest.h>
+
+using namespace QuBLAS;
+
+using real_t = Qu<intBits<6>, fracBits<10>>;
+using wide_t = Qu<intBits<40>, fracBits<60>>;
+using cplx_t = Qu_s<real_t, Qu<intBits<4>, fracBits<12>>>;
+
+TEST(SoA, planesAreContiguousAndAligned)
+{
+    Qu<dim<4, 5>, layout<SoA>, real_t> a;
+    Qu<dim<7>, layout<SoA>, wide_t> w;
+    Qu_s<dim<9>, layout<SoA>, cplx_t> c;
+
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(a.planes.plane(0)) % 64, 0u);
+    EXPECT_EQ(decltype(w.planes)::num_planes, 2u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(w.planes.plane(1)) % 64, 0u);
+
+    a[3] = 1.5;
+    w[2] = -3.25;
+    c[4] = cplx_t(0.5, -0.25);
+    c[5].imag = 2.0;
+
+    EXPECT_EQ(a.planes.plane(0)[3], real_t(1.5).data.data);
+    EXPECT_EQ(w.planes.plane(0)[2], wide_t(-3.25).data.data[0]);
+    EXPECT_EQ(w.planes.plane(1)[2], wide_t(-3.25).data.data[1]);
+    EXPECT_EQ(c.planes.real.plane(0)[4], real_t(0.5).data.data);
+    EXPECT_DOUBLE_EQ(c[5].imag.toDouble(), 2.0);
+    EXPECT_DOUBLE_EQ(c[5].real.toDouble(), 0.0);
+}
+
+TEST(SoA, sameResultsAsAoS)
+{
+    Qu<dim<3, 4>, real_t> a, b;
+    a.fill();
+    b.fill();
+
+    Qu<dim<3, 4>, layout<SoA>, real_t> sa = a, sb = b;
+
+    Qu<dim<3, 4>, real_t> ref = Qmul<intBits<12>, fracBits<10>>(a, b);
+    Qu<dim<3, 4>, layout<SoA>, real_t> res = Qmul<intBits<12>, fracBits<10>>(sa, sb);
+
+    for (size_t i = 0; i < 3; i++)
+    {
+        for (size_t j = 0; j < 4; j++)
+        {
+            EXPECT_DOUBLE_EQ((res[i, j].toDouble()), (ref[i, j].toDouble()));
+            EXPECT_DOUBLE_EQ((sa[i, j].toDouble()), (a[i, j].toDouble()));
+        }
+    }
+
+    // the proxies work in the scalar functions and operators
+    auto s = Qadd<intBits<8>, fracBits<10>>(sa[1], sb[2]);
+    auto r = Qadd<intBits<8>, fracBits<10>>(a[1], b[2]);
+    EXPECT_DOUBLE_EQ(s.toDouble(), r.toDouble());
+    EXPECT_DOUBLE_EQ((sa[1] * sb[2]).toDouble(), (a[1] * b[2]).toDouble());
+    EXPECT_TRUE(sa[0] == a[0]);
+
+    sa[0] = sb[1];
+    EXPECT_DOUBLE_EQ(sa[0].toDouble(), b[1].toDouble());
+
+    sa[2] += sb[2];
+    EXPECT_DOUBLE_EQ(sa[2].toDouble(), (a[2] += b[2]).toDouble());
+
+    Qu<dim<3, 4>, real_t> back = sa.toAoS();
+    EXPECT_DOUBLE_EQ(back[2].toDouble(), a[2].toDouble());
+}
+
+TEST(SoA, complexAndWide)
+{
+    Qu_s<dim<50>, cplx_t> a;
+    Qu<dim<50>, wide_t> b;
+    a.fill();
+    b.fill();
+
+    Qu_s<dim<50>, layout<SoA>, cplx_t> sa = a;
+    Qu<dim<50>, layout<SoA>, wide_t> sb = b;
+
+    Qu_s<dim<50>, layout<SoA>, cplx_t> sum = Qadd(sa, sa);
+    Qu<dim<50>, layout<SoA>, wide_t> prod = Qmul<wide_t>(sb, sb);
+
+    for (size_t i = 0; i < 50; i++)
+    {
+        EXPECT_EQ(sum[i].toDouble(), cplx_t(Qadd(a[i], a[i])).toDouble());
+        EXPECT_DOUBLE_EQ(prod[i].toDouble(), Qmul<wide_t>(b[i], b[i]).toDouble());
+    }
+}
+
+TEST(SoA, onHeap)
+{
+    Qu<dim<2000>, layout<SoA>, real_t> a;
+    EXPECT_TRUE(decltype(a)::onHeap);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(a.planes.plane(0)) % 64, 0u);
+
+    a[1999] = 2.5;
+    auto b = a;
+    EXPECT_DOUBLE_EQ(b[1999].toDouble(), 2.5);
+}
@@ -0,0 +1,163 @@
+#include "QuBLAS.h"
+#include <filesystem>
+#include <gtest/gtest.h>
+
+using namespace QuBLAS;
+
+using elem_t = Qu<intBits<8>, fracBits<4>>;
+using wide_t = Qu<intBits<60>, fracBits<20>, QuMode<RND::CONV>>;
+using complex_t = Qcomplex<elem_t, Qu<intBits<36>, fracBits<4>>>;
+
+static std::string tempFile(const std::string &name)
+{
+    return (std::filesystem::temp_directory_path() / ("QuBLAS_" + name)).string();
+}
+
+template <typename TensorT>
+void expectSameBits(const TensorT &a, const TensorT &b)
+{
+    for (size_t i = 0; i < TensorT::elemSize; i++)
+    {
+        ASSERT_EQ(a[i].toString(), b[i].toString()) << "at " << i;
+    }
+}
+
+template <typename TensorT>
+void checkRoundTrip(const std::string &name)
+{
+    TensorT t;
+    t.fill();
+
+    t.toNpy(tempFile(name + ".npy"));
+    TensorT fromNpy;
+    fromNpy.fromNpy(tempFile(name + ".npy"));
+    expectSameBits(t, fromNpy);
+
+    t.toRaw(tempFile(name + ".bin"));
+    TensorT fromRaw;
+    fromRaw.fromRaw(tempFile(name + ".bin"));
+    expectSameBits(t, fromRaw);
+}
+
+TEST(fileIO, roundTrip)
+{
+    checkRoundTrip<Qu<dim<5, 6>, elem_t>>("matrix");
+    checkRoundTrip<Qu<dim<7>, wide_t>>("wide");
+    checkRoundTrip<Qu<dim<3, 4, 2>, complex_t>>("complex");
+
+    // 存储在堆上的张量
+    checkRoundTrip<Qu<dim<64, 40>, elem_t>>("onHeap");
+    checkRoundTrip<Qu<dim<5000>, complex_t>>("complexOnHeap");
+}
+
+TEST(fileIO, npyHeader)
+{
+    using io_t = QuFile_s<Qu<dim<5, 6>, elem_t>>;
+    const std::string header = io_t::npyHeader();
+
+    EXPECT_EQ(header.size() % 64, 0u);
+    EXPECT_EQ(header.substr(0, 8), std::string("\x93NUMPY\x01\x00", 8));
+    EXPECT_EQ(header.back(), '\n');
+    EXPECT_NE(header.find("{'descr': '<i4', 'fortran_order': True, 'shape': (5, 6), }"), std::string::npos);
+
+    EXPECT_NE((QuFile_s<Qu<dim<7>, wide_t>>::npyHeader().find("'descr': '|V16', 'fortran_order': True, 'shape': (7,), }")), std::string::npos);
+    EXPECT_NE((QuFile_s<Qu<dim<2>, complex_t>>::npyHeader().find("[('real', '<i4'), ('imag', '<i8')]")), std::string::npos);
+}
+
+TEST(fileIO, cOrderNpy)
+{
+    // 按 numpy 默认的 C 顺序手写一个文件
+    Qu<dim<3, 4>, elem_t> t;
+    t.fill();
+
+    std::string dict = "{'descr': '<i4', 'fortran_order': False, 'shape': (3, 4), }";
+    dict.append(64 - (10 + dict.size() + 1) % 64, ' ');
+    dict += '\n';
+
+    std::ofstream file(tempFile("cOrder.npy"), std::ios::binary);
+    file.write("\x93NUMPY\x01\x00", 8);
+    const uint16_t len = dict.size();
+    file.write(reinterpret_cast<const char *>(&len), 2);
+    file << dict;
+    for (size_t i = 0; i < 3; i++)
+    {
+        for (size_t j = 0; j < 4; j++)
+        {
+            file.write(reinterpret_cast<const char *>(&t[i, j].data), 4);
+        }
+    }
+    file.close();
+
+    Qu<dim<3, 4>, elem_t> loaded;
+    loaded.fromNpy(tempFile("cOrder.npy"));
+    expectSameBits(t, loaded);
+
+    // C 顺序的文件不能直接映射
+    EXPECT_THROW((QuMapped<Qu<dim<3, 4>, elem_t>>(tempFile("cOrder.npy"))), std::runtime_error);
+}
+
+TEST(fileIO, mismatch)
+{
+    Qu<dim<5, 6>, elem_t> t;
+    t.fill();
+    t.toRaw(tempFile("mismatch.bin"));
+    t.toNpy(tempFile("mismatch.npy"));
+
+    Qu<dim<6, 5>, elem_t> otherShape;
+    EXPECT_THROW(otherShape.fromRaw(tempFile("mismatch.bin")), std::runtime_error);
+    EXPECT_THROW(otherShape.fromNpy(tempFile("mismatch.npy")), std::runtime_error);
+
+    // 存储相同但格式标签不同
+    Qu<dim<5, 6>, Qu<intBits<7>, fracBits<5>>> otherFormat;
+    EXPECT_THROW(otherFormat.fromRaw(tempFile("mismatch.bin")), std::runtime_error);
+
+    Qu<dim<5, 6>, wide_t> otherDtype;
+    EXPECT_THROW(otherDtype.fromNpy(tempFile("mismatch.npy")), std::runtime_error);
+
+    EXPECT_THROW(t.fromNpy(tempFile("mismatch.bin")), std::runtime_error);
+    EXPECT_THROW(t.fromRaw(tempFile("missing.bin")), std::runtime_error);
+}
+
+TEST(fileIO, mappedAndStreamed)
+{
+    using big_t = Qu<dim<300, 70>, elem_t>;
+    big_t t;
+    t.fill();
+
+    // 分段写入
+    for (QuFile format : {QuFile::raw, QuFile::npy})
+    {
+        const std::string name = tempFile(format == QuFile::raw ? "streamed.bin" : "streamed.npy");
+        {
+            QuFileWriter<big_t> writer(name, format);
+            for (size_t begin = 0; begin < big_t::elemSize; begin += 1000)
+            {
+                writer.write(std::span<const elem_t>(t.data).subspan(begin, std::min<size_t>(1000, big_t::elemSize - begin)));
+            }
+            writer.close();
+        }
+
+        QuMapped<big_t> mapped(name);
+        EXPECT_EQ((mapped[17, 42]).data, (t[17, 42]).data);
+        EXPECT_EQ(mapped[12345].data, t[12345].data);
+
+        big_t copied = mapped;
+        expectSameBits(t, copied);
+    }
+
+    QuFileWriter<big_t> incomplete(tempFile("incomplete.bin"));
+    incomplete.write(std::span<const elem_t>(t.data).first(10));
+    EXPECT_THROW(incomplete.write(t.data), std::invalid_argument);
+    EXPECT_THROW(incomplete.close(), std::runtime_error);
+}
+
+TEST(fileIO, soa)
+{
+    Qu<dim<4, 5>, layout<SoA>, elem_t> soa;
+    soa.fill();
+    soa.toNpy(tempFile("soa.npy"));
+
+    Qu<dim<4, 5>, elem_t> loaded;
+    loaded.fromNpy(tempFile("soa.npy"));
+    expectSameBits(soa.toAoS(), loaded);
+}
@@ -0,0 +1,112 @@
+#include "QuBLAS.h"
+#include <gtest/gtest.h>
+
+using namespace QuBLAS;
+
+using narrow_t = Qu<intBits<5>, fracBits<6>>;
+using unsigned_t = Qu<intBits<5>, fracBits<6>, isSigned<false>>;
+using wide_t = Qu<intBits<70>, fracBits<30>>;
+using complex_t = Qcomplex<narrow_t, wide_t>;
+
+TEST(fillRandom, philoxKnownAnswers)
+{
+    // Random123 的 philox4x32-10 测试向量
+    EXPECT_EQ(Philox4x32::block({0, 0, 0, 0}, {0, 0}), (Philox4x32::counter_t{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+    EXPECT_EQ(Philox4x32::block({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff}), (Philox4x32::counter_t{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}));
+    EXPECT_EQ(Philox4x32::block({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0}), (Philox4x32::counter_t{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}));
+}
+
+template <typename TensorT>
+void expectSameBits(const TensorT &a, const TensorT &b)
+{
+    for (size_t i = 0; i < TensorT::elemSize; i++)
+    {
+        ASSERT_EQ(a[i].toString(), b[i].toString()) << "at " << i;
+    }
+}
+
+template <typename TensorT>
+void checkReproducible()
+{
+    TensorT whole;
+    whole.fillRandom(42, 3);
+
+    // 任意划分区间
+    TensorT pieces;
+    pieces.fillRandom(42, 3, 700, TensorT::elemSize);
+    pieces.fillRandom(42, 3, 0, 13);
+    pieces.fillRandom(42, 3, 13, 700);
+    expectSameBits(whole, pieces);
+
+    TensorT parallel;
+    QfillRandom<QuExec<Parallel<4>>>(parallel, 42, 3);
+    expectSameBits(whole, parallel);
+
+    // 不同的 seed 与 stream 得到不同的序列
+    TensorT otherStream;
+    otherStream.fillRandom(42, 4);
+    TensorT otherSeed;
+    otherSeed.fillRandom(43, 3);
+
+    size_t sameStream = 0, sameSeed = 0;
+    for (size_t i = 0; i < TensorT::elemSize; i++)
+    {
+        sameStream += whole[i].toString() == otherStream[i].toString();
+        sameSeed += whole[i].toString() == otherSeed[i].toString();
+    }
+    EXPECT_LT(sameStream, TensorT::elemSize / 50);
+    EXPECT_LT(sameSeed, TensorT::elemSize / 50);
+}
+
+TEST(fillRandom, reproducible)
+{
+    checkReproducible<Qu<dim<40, 50>, narrow_t>>();
+    checkReproducible<Qu<dim<1500>, wide_t>>();
+    checkReproducible<Qu<dim<30, 40>, complex_t>>();
+}
+
+TEST(fillRandom, range)
+{
+    Qu<dim<20000>, narrow_t> s;
+    Qu<dim<20000>, unsigned_t> u;
+    s.fillRandom(1);
+    u.fillRandom(1);
+
+    // 覆盖格式的全部取值，且大致均匀
+    constexpr double maxVal = 32 - 1.0 / 64;
+    double sMin = 0, sMax = 0, sSum = 0, uMin = 100, uMax = 0, uSum = 0;
+    for (size_t i = 0; i < s.elemSize; i++)
+    {
+        const double sv = s[i].toDouble(), uv = u[i].toDouble();
+        sMin = std::min(sMin, sv);
+        sMax = std::max(sMax, sv);
+        uMin = std::min(uMin, uv);
+        uMax = std::max(uMax, uv);
+        sSum += sv;
+        uSum += uv;
+    }
+    EXPECT_EQ(sMin, -32);
+    EXPECT_EQ(sMax, maxVal);
+    EXPECT_EQ(uMin, 0);
+    EXPECT_EQ(uMax, maxVal);
+    EXPECT_NEAR(sSum / s.elemSize, 0, 0.5);
+    EXPECT_NEAR(uSum / u.elemSize, 16, 0.5);
+
+    // 多字的原始值是合法的 ArbiInt，即最高字正确地符号扩展
+    Qu<dim<1000>, wide_t> w;
+    w.fillRandom(5);
+    for (size_t i = 0; i < w.elemSize; i++)
+    {
+        const int64_t top = static_cast<int64_t>(w[i].data.data[1]);
+        ASSERT_EQ(top, static_cast<int64_t>(static_cast<uint64_t>(top) << 27) >> 27) << "at " << i;
+    }
+}
+
+TEST(fillRandom, soaMatchesAoS)
+{
+    Qu<dim<17, 9>, complex_t> aos;
+    Qu<dim<17, 9>, layout<SoA>, complex_t> soa;
+    aos.fillRandom(9, 1);
+    soa.fillRandom(9, 1);
+    expectSameBits(aos, soa.toAoS());
+}
@@ -0,0 +1,114 @@
+#include "QuBLAS.h"
+#include <gtest/gtest.h>
+
+using namespace QuBLAS;
+
+// compare the compact conversion with the 2400-bit reference one
+template <int intB, int fracB, bool isS, typename QuM, typename OfM>
+void checkAgainstWide(double val)
+{
+    using convert_t = doubleConvert<intB, fracB, isS, QuMode<QuM>, OfMode<OfM>>;
+
+    EXPECT_EQ(convert_t::convert(val).toBinary(), convert_t::convertWide(val).toBinary()) << "intB " << intB << " fracB " << fracB << " isS " << isS << " QuM " << QuM::value << " OfM " << OfM::value << " val " << val;
+}
+
+template <int intB, int fracB, bool isS, typename OfM>
+void checkAllQuModes(double val)
+{
+    checkAgainstWide<intB, fracB, isS, RND::POS_INF, OfM>(val);
+    checkAgainstWide<intB, fracB, isS, RND::NEG_INF, OfM>(val);
+    checkAgainstWide<intB, fracB, isS, RND::ZERO, OfM>(val);
+    checkAgainstWide<intB, fracB, isS, RND::INF, OfM>(val);
+    checkAgainstWide<intB, fracB, isS, RND::CONV, OfM>(val);
+    checkAgainstWide<intB, fracB, isS, TRN::TCPL, OfM>(val);
+    checkAgainstWide<intB, fracB, isS, TRN::SMGN, OfM>(val);
+}
+
+template <int intB, int fracB, bool isS>
+void checkAllModes(double val)
+{
+    checkAllQuModes<intB, fracB, isS, SAT::TCPL>(val);
+    checkAllQuModes<intB, fracB, isS, SAT::ZERO>(val);
+    checkAllQuModes<intB, fracB, isS, SAT::SMGN>(val);
+    checkAllQuModes<intB, fracB, isS, WRP::TCPL>(val);
+}
+
+// random values around the range of the format, the exact ties of the format and the values beyond the range
+template <int intB, int fracB, bool isS>
+void checkFormat()
+{
+    std::mt19937_64 rng(intB * 1000 + fracB);
+    std::uniform_real_distribution<double> uni(-1.0, 1.0);
+    std::uniform_int_distribution<int> expo(-fracB - 4, intB + 4);
+    std::uniform_int_distribution<int64_t> raw(-(int64_t(1) << std::min(intB + fracB + 3, 60)), int64_t(1) << std::min(intB + fracB + 3, 60));
+
+    for (int i = 0; i < 200; i++)
+    {
+        checkAllModes<intB, fracB, isS>(std::ldexp(uni(rng), expo(rng)));
+
+        // ties and grid points of the target format
+        checkAllModes<intB, fracB, isS>(std::ldexp(static_cast<double>(raw(rng)), -fracB - 1));
+    }
+
+    for (double val : {0.0, -0.0, 1e-300, -1e-300, 4.9e-324, -4.9e-324, 1e300, -1e300, 0.5, -0.5, 0.25, -0.25, 0.75, -0.75})
+    {
+        checkAllModes<intB, fracB, isS>(val);
+    }
+}
+
+TEST(fromDouble, smallFormats)
+{
+    checkFormat<3, 5, true>();
+    checkFormat<8, 8, true>();
+    checkFormat<4, 4, false>();
+}
+
+TEST(fromDouble, negativeFracBits)
+{
+    checkFormat<10, -2, true>();
+    checkFormat<-2, 10, true>();
+}
+
+TEST(fromDouble, wideFormats)
+{
+    checkFormat<20, 30, true>();
+    checkFormat<40, 40, true>();
+    checkFormat<30, 33, false>();
+}
+
+TEST(fromDouble, farBeyondRange)
+{
+    // 右移后保留的位仍然放不进紧凑缓冲
+    for (double val : {3049798110.9661636, -5873404281038.3799, 183097862193918.0, -4117727957982.4775})
+    {
+        checkAllModes<5, 7, true>(val);
+        checkAllModes<20, -4, false>(val);
+    }
+}
+
+TEST(fromDouble, tensor)
+{
+    using elem_t = Qu<intBits<4>, fracBits<6>, QuMode<RND::CONV>>;
+    using cplx_t = Qu_s<elem_t, elem_t>;
+
+    std::array<double, 6> vals = {0.1, -0.2, 3.3, -7.9, 100.0, 1.0 / 128};
+
+    Qu_s<dim<2, 3>, elem_t> real;
+    real.fromDoubles(vals);
+
+    Qu_s<dim<3>, cplx_t> cplx;
+    cplx.fromDoubles(vals);
+
+    for (size_t i = 0; i < 6; i++)
+    {
+        EXPECT_DOUBLE_EQ(real[i].toDouble(), elem_t(vals[i]).toDouble());
+    }
+
+    for (size_t i = 0; i < 3; i++)
+    {
+        EXPECT_DOUBLE_EQ(cplx[i].real.toDouble(), elem_t(vals[2 * i]).toDouble());
+        EXPECT_DOUBLE_EQ(cplx[i].imag.toDouble(), elem_t(vals[2 * i + 1]).toDouble());
+    }
+
+    EXPECT_THROW(real.fromDoubles(std::span<const double>(vals.data(), 5)), std::invalid_argument);
+}
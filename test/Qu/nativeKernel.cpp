@@ -0,0 +1,130 @@
+#include "QuBLAS.h"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace QuBLAS;
+
+template <int intB, int fracB, bool isS>
+using in_t = Qu<intBits<intB>, fracBits<fracB>, isSigned<isS>>;
+
+// 生成格式内合法的原始值
+template <typename QuT>
+QuT randomRaw(std::mt19937_64 &rng)
+{
+    constexpr int valueBits = QuT::intB + QuT::fracB;
+    const int64_t hi = (int64_t(1) << valueBits) - 1;
+    const int64_t lo = QuT::isS ? -(int64_t(1) << valueBits) : 0;
+
+    QuT x;
+    x.data = decltype(x.data)(std::uniform_int_distribution<int64_t>(lo, hi)(rng));
+    return x;
+}
+
+// compare the fused native kernels with the widening ArbiInt ones
+template <typename A, typename B, typename... toArgs>
+void checkAgainstWide(const A a, const B b)
+{
+    using mul_t = Qmul_s<A, B, MergerArgsWrapper<toArgs...>>;
+    using add_t = Qadd_s<A, B, MergerArgsWrapper<toArgs...>>;
+    using sub_t = Qsub_s<A, B, MergerArgsWrapper<toArgs...>>;
+
+    static_assert(mul_t::useNative && add_t::useNative && sub_t::useNative);
+
+    EXPECT_EQ(mul_t::mulNative(a, b).toString(), mul_t::mulWide(a, b).toString()) << a.toDouble() << " * " << b.toDouble();
+    EXPECT_EQ(add_t::addNative(a, b).toString(), add_t::addWide(a, b).toString()) << a.toDouble() << " + " << b.toDouble();
+    EXPECT_EQ(sub_t::subNative(a, b).toString(), sub_t::subWide(a, b).toString()) << a.toDouble() << " - " << b.toDouble();
+}
+
+template <typename A, typename B, int toInt, int toFrac, bool toIsSigned, typename OfM>
+void checkAllQuModes(const A a, const B b)
+{
+    checkAgainstWide<A, B, intBits<toInt>, fracBits<toFrac>, isSigned<toIsSigned>, QuMode<RND::POS_INF>, OfMode<OfM>>(a, b);
+    checkAgainstWide<A, B, intBits<toInt>, fracBits<toFrac>, isSigned<toIsSigned>, QuMode<RND::NEG_INF>, OfMode<OfM>>(a, b);
+    checkAgainstWide<A, B, intBits<toInt>, fracBits<toFrac>, isSigned<toIsSigned>, QuMode<RND::ZERO>, OfMode<OfM>>(a, b);
+    checkAgainstWide<A, B, intBits<toInt>, fracBits<toFrac>, isSigned<toIsSigned>, QuMode<RND::INF>, OfMode<OfM>>(a, b);
+    checkAgainstWide<A, B, intBits<toInt>, fracBits<toFrac>, isSigned<toIsSigned>, QuMode<RND::CONV>, OfMode<OfM>>(a, b);
+    checkAgainstWide<A, B, intBits<toInt>, fracBits<toFrac>, isSigned<toIsSigned>, QuMode<TRN::TCPL>, OfMode<OfM>>(a, b);
+    checkAgainstWide<A, B, intBits<toInt>, fracBits<toFrac>, isSigned<toIsSigned>, QuMode<TRN::SMGN>, OfMode<OfM>>(a, b);
+}
+
+template <typename A, typename B, int toInt, int toFrac, bool toIsSigned>
+void checkAllModes(const A a, const B b)
+{
+    checkAllQuModes<A, B, toInt, toFrac, toIsSigned, SAT::TCPL>(a, b);
+    checkAllQuModes<A, B, toInt, toFrac, toIsSigned, SAT::ZERO>(a, b);
+    checkAllQuModes<A, B, toInt, toFrac, toIsSigned, SAT::SMGN>(a, b);
+    checkAllQuModes<A, B, toInt, toFrac, toIsSigned, WRP::TCPL>(a, b);
+}
+
+template <typename A, typename B, int toInt, int toFrac, bool toIsSigned>
+void checkFormat()
+{
+    std::mt19937_64 rng(A::width * 1000 + B::width * 10 + toFrac);
+
+    for (int i = 0; i < 200; i++)
+    {
+        checkAllModes<A, B, toInt, toFrac, toIsSigned>(randomRaw<A>(rng), randomRaw<B>(rng));
+    }
+
+    // 边界值
+    A aMax = randomRaw<A>(rng), aMin = randomRaw<A>(rng);
+    aMax.data = decltype(aMax.data)((int64_t(1) << (A::intB + A::fracB)) - 1);
+    aMin.data = decltype(aMin.data)(A::isS ? -(int64_t(1) << (A::intB + A::fracB)) : 0);
+    B bMax = randomRaw<B>(rng), bMin = randomRaw<B>(rng);
+    bMax.data = decltype(bMax.data)((int64_t(1) << (B::intB + B::fracB)) - 1);
+    bMin.data = decltype(bMin.data)(B::isS ? -(int64_t(1) << (B::intB + B::fracB)) : 0);
+
+    checkAllModes<A, B, toInt, toFrac, toIsSigned>(aMax, bMax);
+    checkAllModes<A, B, toInt, toFrac, toIsSigned>(aMax, bMin);
+    checkAllModes<A, B, toInt, toFrac, toIsSigned>(aMin, bMax);
+    checkAllModes<A, B, toInt, toFrac, toIsSigned>(aMin, bMin);
+}
+
+TEST(nativeKernel, smallFormats)
+{
+    checkFormat<in_t<4, 8, true>, in_t<3, 9, true>, 5, 6, true>();
+    checkFormat<in_t<4, 8, true>, in_t<3, 9, true>, 2, 3, true>();
+    checkFormat<in_t<4, 4, false>, in_t<4, 4, true>, 6, 4, false>();
+    checkFormat<in_t<8, 8, true>, in_t<8, 8, true>, 8, 12, true>();
+}
+
+TEST(nativeKernel, negativeFracBits)
+{
+    checkFormat<in_t<10, -2, true>, in_t<-2, 10, true>, 6, 3, true>();
+    checkFormat<in_t<10, 2, true>, in_t<4, 6, true>, 12, -3, true>();
+}
+
+TEST(nativeKernel, wideFormats)
+{
+    // 33 位乘 33 位，中间结果需要 __int128_t
+    checkFormat<in_t<16, 16, true>, in_t<16, 16, true>, 20, 24, true>();
+    checkFormat<in_t<30, 30, true>, in_t<20, 40, false>, 40, 20, true>();
+    checkFormat<in_t<20, 20, true>, in_t<10, 20, true>, 30, 33, true>();
+}
+
+TEST(nativeKernel, fullPrecision)
+{
+    std::mt19937_64 rng(7);
+
+    for (int i = 0; i < 200; i++)
+    {
+        checkAgainstWide<in_t<12, 12, true>, in_t<8, 10, false>>(randomRaw<in_t<12, 12, true>>(rng), randomRaw<in_t<8, 10, false>>(rng));
+    }
+}
+
+TEST(nativeKernel, dispatch)
+{
+    using a_t = Qu<intBits<12>, fracBits<12>>;
+    using out_t = Qu<intBits<10>, fracBits<10>>;
+
+    a_t a(3.140625);
+    a_t b(-2.71875);
+
+    EXPECT_EQ((Qmul<out_t>(a, b).toString()), (Qmul_s<a_t, a_t, MergerArgsWrapper<out_t>>::mulWide(a, b).toString()));
+    EXPECT_EQ((Qadd<out_t>(a, b).toString()), (Qadd_s<a_t, a_t, MergerArgsWrapper<out_t>>::addWide(a, b).toString()));
+    EXPECT_EQ((Qsub<out_t>(a, b).toString()), (Qsub_s<a_t, a_t, MergerArgsWrapper<out_t>>::subWide(a, b).toString()));
+
+    // 输出超过 64 位时退回 ArbiInt 实现
+    using wide_t = Qu<intBits<40>, fracBits<40>>;
+    static_assert(!Qmul_s<wide_t, wide_t, MergerArgsWrapper<>>::useNative);
+}
\ No newline at end of file
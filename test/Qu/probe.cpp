@@ -0,0 +1,181 @@
+#define QUBLAS_PROBE
+#include "QuBLAS.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace QuBLAS;
+
+using sat_t = Qu<intBits<2>, fracBits<4>>;
+using wrp_t = Qu<intBits<2>, fracBits<4>, OfMode<WRP::TCPL>>;
+using wide_t = Qu<intBits<40>, fracBits<40>>;
+
+const std::string satName = "Qu<intBits<2>, fracBits<4>, isSigned<true>, QuMode<TRN::TCPL>, OfMode<SAT::TCPL>>";
+const std::string wrpName = "Qu<intBits<2>, fracBits<4>, isSigned<true>, QuMode<TRN::TCPL>, OfMode<WRP::TCPL>>";
+
+QuProbeStats find(const std::vector<std::pair<std::string, QuProbeStats>> &entries, const std::string &name)
+{
+    for (const auto &[key, stats] : entries)
+    {
+        if (key == name)
+        {
+            return stats;
+        }
+    }
+    return QuProbeStats();
+}
+
+TEST(Probe, fromDouble)
+{
+    QuProbe::reset();
+
+    sat_t a = 1.5;   // 精确
+    sat_t b = 0.1;   // 舍弃非零小数位
+    sat_t c = 10.0;  // 饱和
+    sat_t d = -20.0; // 饱和
+    wrp_t e = 5.0;   // 回绕
+
+    const auto sat = find(QuProbe::formats(), satName);
+    EXPECT_EQ(sat.conversions, 4u);
+    EXPECT_EQ(sat.saturations, 2u);
+    EXPECT_EQ(sat.wraps, 0u);
+    EXPECT_EQ(sat.inexact, 1u);
+    EXPECT_EQ(sat.maxMagnitude, 20.0);
+
+    const auto wrp = find(QuProbe::formats(), wrpName);
+    EXPECT_EQ(wrp.conversions, 1u);
+    EXPECT_EQ(wrp.saturations, 0u);
+    EXPECT_EQ(wrp.wraps, 1u);
+    EXPECT_EQ(wrp.maxMagnitude, 5.0);
+
+    EXPECT_EQ(a.toDouble() + b.toDouble() + c.toDouble() + d.toDouble() + e.toDouble(), 1.5 + 0.0625 + 3.9375 - 4.0 - 3.0);
+}
+
+TEST(Probe, arithmeticAndSites)
+{
+    wide_t x = 3.0;
+    wide_t y = 0.75;
+    const sat_t s = 1.0 / 16;
+
+    QuProbe::reset();
+    {
+        QuProbeSite site("mixer");
+
+        // 原生整数路径与 ArbiInt 路径都计数
+        auto p = Qmul<sat_t>(x, y);
+        auto q = Qadd<intBits<2>, fracBits<4>>(x, x);
+        auto r = Qmul<fracBits<2>>(s, s);
+        EXPECT_EQ(p.toDouble(), 2.25);
+        EXPECT_EQ(q.toDouble(), 3.9375);
+        EXPECT_EQ(r.toDouble(), 0.0);
+
+        {
+            QuProbeSite inner("mixer.out");
+            auto t = Qsub<sat_t>(x, y);
+            EXPECT_EQ(t.toDouble(), 2.25);
+        }
+    }
+    auto outside = Qmul<sat_t>(x, x);
+    EXPECT_EQ(outside.toDouble(), 3.9375);
+
+    const auto sat = find(QuProbe::formats(), satName);
+    EXPECT_EQ(sat.conversions, 4u);
+    EXPECT_EQ(sat.saturations, 2u);
+    EXPECT_EQ(sat.maxMagnitude, 9.0);
+
+    const auto mixer = find(QuProbe::sites(), "mixer");
+    EXPECT_EQ(mixer.conversions, 3u);
+    EXPECT_EQ(mixer.saturations, 1u);
+    EXPECT_EQ(mixer.inexact, 1u);
+
+    const auto inner = find(QuProbe::sites(), "mixer.out");
+    EXPECT_EQ(inner.conversions, 1u);
+    EXPECT_EQ(inner.saturations, 0u);
+}
+
+// 除法的商被截断时余数非零，计为不精确
+TEST(Probe, division)
+{
+    const sat_t one = 1.0;
+    const sat_t three = 3.0;
+    const sat_t half = 0.5;
+
+    QuProbe::reset();
+    auto inexact = Qdiv<sat_t>(one, three);
+    auto exact = Qdiv<sat_t>(one, half);
+    EXPECT_EQ(inexact.toDouble(), 0.3125);
+    EXPECT_EQ(exact.toDouble(), 2.0);
+
+    const auto sat = find(QuProbe::formats(), satName);
+    EXPECT_EQ(sat.conversions, 2u);
+    EXPECT_EQ(sat.inexact, 1u);
+    EXPECT_EQ(sat.saturations, 0u);
+}
+
+TEST(Probe, mergesThreads)
+{
+    QuProbe::reset();
+
+    auto work = [] {
+        for (int i = 0; i < 100; i++)
+        {
+            sat_t v = 4.0 + i;
+            (void)v;
+        }
+    };
+
+    // 已退出的线程与仍在运行的线程池线程都计入
+    std::thread t1(work);
+    std::thread t2(work);
+    t1.join();
+    t2.join();
+
+    QuThreadPool pool(3);
+    pool.parallelFor(1000, 0, [](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            sat_t v = (i % 2) ? 0.5 : 0.25;
+            (void)v;
+        }
+    });
+
+    const auto sat = find(QuProbe::formats(), satName);
+    EXPECT_EQ(sat.conversions, 1200u);
+    EXPECT_EQ(sat.saturations, 200u);
+    EXPECT_EQ(sat.inexact, 0u);
+    EXPECT_EQ(sat.maxMagnitude, 103.0);
+}
+
+TEST(Probe, json)
+{
+    QuProbe::reset();
+    {
+        QuProbeSite site("agc");
+        sat_t v = 100.0;
+        (void)v;
+    }
+
+    const std::string json = QuProbe::toJson();
+    EXPECT_NE(json.find("\"formats\""), std::string::npos);
+    EXPECT_NE(json.find("\"" + satName + "\": {\"conversions\": 1, \"saturations\": 1, \"wraps\": 0, \"inexact\": 0, \"maxMagnitude\": 100}"), std::string::npos) << json;
+    EXPECT_NE(json.find("\"agc\": {\"conversions\": 1"), std::string::npos) << json;
+}
+
+// 静态线程池在程序退出时才析构，此时工作线程退出仍要把计数并入 QuProbe
+TEST(ProbeDeathTest, staticPoolAtExit)
+{
+    GTEST_FLAG_SET(death_test_style, "threadsafe");
+    EXPECT_EXIT(
+        {
+            static QuThreadPool pool(2);
+            pool.parallelFor(64, 0, [](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++)
+                {
+                    sat_t v = 4.0;
+                    (void)v;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            });
+            std::exit(find(QuProbe::formats(), satName).conversions == 64 ? 0 : 1);
+        },
+        testing::ExitedWithCode(0), "");
+}
@@ -0,0 +1,189 @@
+#include "QuBLAS.h"
+#include <gtest/gtest.h>
+
+using namespace QuBLAS;
+
+using a_t = Qu<intBits<4>, fracBits<6>>;
+using b_t = Qu<intBits<3>, fracBits<8>, QuMode<RND::CONV>>;
+using out_t = Qu<intBits<5>, fracBits<6>, QuMode<RND::INF>>;
+
+using as_t = Qu<intBits<4>, fracBits<6>, Shadow<double>>;
+using bs_t = Qu<intBits<3>, fracBits<8>, QuMode<RND::CONV>, Shadow<double>>;
+
+TEST(Shadow, typesAndZeroOverhead)
+{
+    static_assert(std::is_same_v<as_t, Qu_s<Shadow<double>, a_t>>);
+    static_assert(std::is_same_v<Qu<as_t>, as_t>);
+    static_assert(std::is_same_v<Qu<a_t, Shadow<double>>, as_t>);
+    static_assert(isScalar<as_t>);
+
+    // 不带 Shadow 的类型与运算结果都不变
+    static_assert(std::is_same_v<decltype(Qmul<out_t>(a_t(), b_t())), out_t>);
+    static_assert(sizeof(Qu<dim<8>, a_t>) == sizeof(std::array<a_t, 8>));
+}
+
+TEST(Shadow, valuesMatchPlainOperations)
+{
+    QuShadow::reset();
+
+    const double x = 3.14159, y = -1.41421;
+    as_t a = x;
+    bs_t b = y;
+
+    EXPECT_EQ(a.value.data.data, a_t(x).data.data);
+    EXPECT_EQ(a.ref, x);
+
+    auto prod = Qmul<out_t>(a, b);
+    auto sum = Qadd<out_t>(a, b);
+    auto diff = Qsub<out_t>(a, b);
+    auto quot = Qdiv<out_t>(a, b);
+    auto mixed = Qmul<out_t>(a, b_t(y));
+
+    static_assert(std::is_same_v<decltype(prod), Qu_s<Shadow<double>, out_t>>);
+
+    EXPECT_EQ(prod.value.data.data, Qmul<out_t>(a_t(x), b_t(y)).data.data);
+    EXPECT_EQ(sum.value.data.data, Qadd<out_t>(a_t(x), b_t(y)).data.data);
+    EXPECT_EQ(diff.value.data.data, Qsub<out_t>(a_t(x), b_t(y)).data.data);
+    EXPECT_EQ(quot.value.data.data, Qdiv<out_t>(a_t(x), b_t(y)).data.data);
+    EXPECT_EQ(mixed.value.data.data, prod.value.data.data);
+
+    // 参考值由未量化的输入直接计算
+    EXPECT_DOUBLE_EQ(prod.ref, x * y);
+    EXPECT_DOUBLE_EQ(sum.ref, x + y);
+    EXPECT_DOUBLE_EQ(diff.ref, x - y);
+    EXPECT_DOUBLE_EQ(quot.ref, x / y);
+    EXPECT_DOUBLE_EQ(mixed.ref, x * b_t(y).toDouble());
+
+    // 只记录 5 个运算结果，a 与 b 的构造不计入
+    const auto stats = QuShadow::stats();
+    EXPECT_EQ(stats.count, 5u);
+    EXPECT_EQ(stats.overflows, 0u);
+    EXPECT_GE(stats.maxAbsError, std::abs(prod.error()));
+    EXPECT_GT(stats.sqnr(), 20.0);
+}
+
+TEST(Shadow, overflowAndConversion)
+{
+    QuShadow::reset();
+
+    using small_t = Qu<intBits<2>, fracBits<4>, OfMode<SAT::TCPL>, Shadow<double>>;
+    as_t a = 3.75;
+    auto s = Qadd<small_t>(a, a); // 超出 [-4, 4)，饱和
+    EXPECT_EQ(s.toDouble(), 4.0 - 1.0 / 16);
+    EXPECT_EQ(s.ref, 7.5);
+    EXPECT_EQ(QuShadow::stats().count, 1u);
+    EXPECT_EQ(QuShadow::stats().overflows, 1u);
+    EXPECT_DOUBLE_EQ(QuShadow::stats().maxAbsError, 7.5 - s.toDouble());
+
+    // 格式转换不是运算结果，不计入
+    small_t t = a;
+    small_t u = s;
+    EXPECT_EQ(t.ref, 3.75);
+    EXPECT_EQ(u.ref, 7.5);
+    EXPECT_EQ(QuShadow::stats().count, 1u);
+}
+
+TEST(Shadow, reduceAndTensors)
+{
+    using l0_t = Qu<intBits<6>, fracBits<4>>;
+    using l1_t = Qu<intBits<7>, fracBits<2>, QuMode<RND::CONV>>;
+
+    constexpr size_t K = 37;
+    Qu<dim<K>, as_t> v;
+    Qu<dim<K>, a_t> plain;
+    double exact = 0;
+    for (size_t i = 0; i < K; i++)
+    {
+        const double x = std::sin(static_cast<double>(i)) * 7;
+        v[i] = as_t(x);
+        plain[i] = a_t(x);
+        exact += x;
+    }
+
+    auto res = Qreduce<l0_t, l1_t>(v);
+    static_assert(std::is_same_v<decltype(res), Qu_s<Shadow<double>, l1_t>>);
+    EXPECT_EQ(res.value.data.data, (Qreduce<l0_t, l1_t>(plain).data.data));
+    EXPECT_NEAR(res.ref, exact, 1e-9);
+
+    // 张量表达式逐元素经过影子运算
+    Qu<dim<K>, as_t> w = Qadd<a_t>(v, v);
+    for (size_t i = 0; i < K; i++)
+    {
+        EXPECT_DOUBLE_EQ(w[i].ref, 2 * v[i].ref);
+    }
+
+    Qu<dim<K, 2>, as_t> m;
+    for (size_t i = 0; i < K; i++)
+    {
+        m[i, 0] = v[i];
+        m[i, 1] = w[i];
+    }
+    auto columns = Qreduce<Axis<0>, l0_t, l1_t>(m);
+    EXPECT_EQ(columns[0].value.data.data, res.value.data.data);
+    EXPECT_NEAR(columns[1].ref, 2 * exact, 1e-9);
+}
+
+TEST(Shadow, batchesAndThreads)
+{
+    constexpr size_t K = 1500;
+    Qu<dim<K>, as_t> a, b;
+    for (size_t i = 0; i < K; i++)
+    {
+        a[i] = as_t(std::sin(static_cast<double>(i)) * 7);
+        b[i] = as_t(std::cos(static_cast<double>(i)) * 3);
+    }
+
+    // 逐个标量运算的参考统计
+    QuShadow::reset();
+    for (size_t i = 0; i < K; i++)
+    {
+        auto r = Qadd<out_t>(a[i], b[i]);
+        (void)r;
+    }
+    const auto scalar = QuShadow::stats();
+    EXPECT_EQ(scalar.count, K);
+
+    // 表达式写入张量时整批记录，每个元素一个结果
+    QuShadow::reset();
+    Qu<dim<K>, Qu<out_t, Shadow<double>>> y = Qadd<out_t>(a, b);
+    auto batched = QuShadow::stats();
+    EXPECT_EQ(batched.count, K);
+    EXPECT_EQ(batched.overflows, scalar.overflows);
+    EXPECT_EQ(batched.maxAbsError, scalar.maxAbsError);
+    EXPECT_NEAR(batched.sumSqError, scalar.sumSqError, 1e-9 * scalar.sumSqError);
+    EXPECT_NEAR(batched.sumSqRef, scalar.sumSqRef, 1e-9 * scalar.sumSqRef);
+
+    // 并行的 Qassign 记入各工作线程，stats() 合并所有线程
+    QuShadow::reset();
+    Qassign<QuExec<Parallel<4>>>(y, Qadd<out_t>(a, b));
+    batched = QuShadow::stats();
+    EXPECT_EQ(batched.count, K);
+    EXPECT_NEAR(batched.sumSqError, scalar.sumSqError, 1e-9 * scalar.sumSqError);
+
+    // 已退出线程的统计保留下来
+    std::thread t([&] { auto r = Qmul<out_t>(a[0], b[0]); (void)r; });
+    t.join();
+    EXPECT_EQ(QuShadow::stats().count, K + 1);
+
+    QuShadow::reset();
+    EXPECT_EQ(QuShadow::stats().count, 0u);
+}
+
+// 静态线程池在程序退出时才析构，此时工作线程退出仍要把统计并入 QuShadow
+TEST(ShadowDeathTest, staticPoolAtExit)
+{
+    GTEST_FLAG_SET(death_test_style, "threadsafe");
+    EXPECT_EXIT(
+        {
+            static QuThreadPool pool(2);
+            pool.parallelFor(64, 0, [](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++)
+                {
+                    (void)Qmul<out_t>(as_t(0.5), as_t(0.25));
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            });
+            std::exit(QuShadow::stats().count == 64 ? 0 : 1);
+        },
+        testing::ExitedWithCode(0), "");
+}
@@ -0,0 +1,147 @@
+#include "QuBLAS.h"
+#include <gtest/gtest.h>
+
+using namespace QuBLAS;
+
+using elem_t = Qu<intBits<8>, fracBits<4>>;
+
+TEST(Slice, matrix)
+{
+    Qu<dim<5, 6>, elem_t> m;
+    m.fill();
+
+    // 一行、一列与一个子矩阵
+    auto row = Qslice<sr<0, 2>>(m);
+    auto col = Qslice<sr<1, 3>>(m);
+    auto sub = Qslice<sr<0, 1, 4>, sr<1, 2, 5>>(m);
+
+    static_assert(std::is_same_v<decltype(row)::size, dim<6>>);
+    static_assert(std::is_same_v<decltype(col)::size, dim<5>>);
+    static_assert(std::is_same_v<decltype(sub)::size, dim<3, 3>>);
+    static_assert(decltype(col)::contiguousRun == 5 && decltype(row)::contiguousRun == 1);
+
+    for (size_t j = 0; j < 6; j++)
+    {
+        EXPECT_EQ(row[j].data, (m[2, j]).data);
+    }
+    for (size_t i = 0; i < 5; i++)
+    {
+        EXPECT_EQ(col[i].data, (m[i, 3]).data);
+    }
+    for (size_t j = 0; j < 3; j++)
+    {
+        for (size_t i = 0; i < 3; i++)
+        {
+            EXPECT_EQ((sub[i, j]).data, (m[i + 1, j + 2]).data);
+            EXPECT_EQ(sub[i + 3 * j].data, (m[i + 1, j + 2]).data);
+        }
+    }
+
+    // 与原来的 SliceExpression 写法等价
+    SliceExpression<decltype(m), sr<1, 2, 5>, sr<0, 1, 4>> expr(m);
+    static_assert(std::is_same_v<decltype(expr)::size, dim<3, 3>>);
+    EXPECT_EQ((expr[2, 1]).data, (sub[2, 1]).data);
+}
+
+TEST(Slice, highDim)
+{
+    Qu<dim<4, 3, 5>, elem_t> t;
+    t.fill();
+
+    auto view = Qslice<sr<1, 1, 3>, sr<2, 1, 4>>(t);
+    static_assert(std::is_same_v<decltype(view)::size, dim<4, 2, 3>>);
+    static_assert(decltype(view)::contiguousRun == 8);
+
+    auto plane = Qslice<sr<2, 3>>(t);
+    static_assert(std::is_same_v<decltype(plane)::size, dim<4, 3>>);
+
+    for (size_t k = 0; k < 3; k++)
+    {
+        for (size_t j = 0; j < 2; j++)
+        {
+            for (size_t i = 0; i < 4; i++)
+            {
+                EXPECT_EQ((view[i, j, k]).data, (t[i, j + 1, k + 1]).data);
+            }
+        }
+    }
+
+    for (size_t j = 0; j < 3; j++)
+    {
+        for (size_t i = 0; i < 4; i++)
+        {
+            EXPECT_EQ((plane[i, j]).data, (t[i, j, 3]).data);
+        }
+    }
+}
+
+TEST(Slice, sliceOfSlice)
+{
+    Qu<dim<4, 3, 5>, elem_t> t;
+    t.fill();
+
+    auto view = Qslice<sr<0, 1, 4>, sr<2, 1, 5>>(t);
+    auto inner = Qslice<sr<0, 2>, sr<2, 1, 3>>(view);
+
+    // 组合后仍直接指向根张量
+    static_assert(std::is_same_v<decltype(inner)::root_t, decltype(t)>);
+    static_assert(std::is_same_v<decltype(inner)::size, dim<3, 2>>);
+    EXPECT_EQ(inner.root, &t);
+
+    for (size_t k = 0; k < 2; k++)
+    {
+        for (size_t j = 0; j < 3; j++)
+        {
+            EXPECT_EQ((inner[j, k]).data, (t[3, j, k + 2]).data);
+        }
+    }
+}
+
+TEST(Slice, copyToTensor)
+{
+    Qu<dim<6, 4, 3>, elem_t> t;
+    t.fill();
+
+    auto view = Qslice<sr<0, 1, 5>, sr<2, 1>>(t);
+    Qu<dim<4, 4>, elem_t> copied = view;
+
+    auto wholeRuns = Qslice<sr<2, 0, 2>>(t);
+    Qu<dim<6, 4, 2>, elem_t> copiedRuns = wholeRuns;
+
+    for (size_t i = 0; i < 16; i++)
+    {
+        EXPECT_EQ(copied[i].data, view[i].data);
+    }
+    for (size_t i = 0; i < 48; i++)
+    {
+        EXPECT_EQ(copiedRuns[i].data, t[i].data);
+    }
+
+    // 不同元素类型时逐元素转换
+    Qu<dim<4, 4>, Qu<intBits<10>, fracBits<6>>> converted = view;
+    for (size_t i = 0; i < 16; i++)
+    {
+        EXPECT_EQ(converted[i].toDouble(), view[i].toDouble());
+    }
+
+    // SoA 张量的视图逐元素读取
+    Qu<dim<6, 4, 3>, layout<SoA>, elem_t> soa = t;
+    auto soaView = Qslice<sr<0, 1, 5>, sr<2, 1>>(soa);
+    Qu<dim<4, 4>, elem_t> fromSoa = soaView;
+    for (size_t i = 0; i < 16; i++)
+    {
+        EXPECT_EQ(fromSoa[i].data, copied[i].data);
+    }
+}
+
+TEST(Slice, bitStream)
+{
+    Qu<dim<5, 6>, elem_t> m;
+    m.fill();
+
+    auto sub = Qslice<sr<0, 1, 4>, sr<1, 2, 5>>(m);
+    Qu<dim<3, 3>, elem_t> copied = sub;
+
+    EXPECT_EQ((BitStream<r2l<3>, l2r>(sub)), (BitStream<r2l<3>, l2r>(copied)));
+    EXPECT_EQ((BitStream<l2r, l2r>(sub)), (BitStream<l2r, l2r>(copied)));
+}
@@ -0,0 +1,206 @@
+#define QUBLAS_HEAP_THRESHOLD 64
+#include "QuBLAS.h"
+#include <gtest/gtest.h>
+
+using namespace QuBLAS;
+
+using elem_t = Qu<intBits<4>, fracBits<8>>;
+using wide_t = Qu<intBits<6>, fracBits<12>, QuMode<RND::CONV>>;
+using c_t = Qu<intBits<9>, fracBits<6>>;
+using cplx_t = Qcomplex<elem_t, elem_t>;
+
+// 统计经过的分配次数，作为 QuArena 的上游
+class countingResource : public std::pmr::memory_resource
+{
+public:
+    size_t allocations = 0;
+
+private:
+    void *do_allocate(size_t bytes, size_t alignment) override
+    {
+        allocations++;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override
+    {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+TEST(Storage, threshold)
+{
+    EXPECT_EQ(quHeapThreshold, 64u);
+    EXPECT_FALSE((Qu<dim<64>, elem_t>::onHeap));
+    EXPECT_TRUE((Qu<dim<65>, elem_t>::onHeap));
+    EXPECT_TRUE((Qu<dim<8, 9>, elem_t>::onHeap));
+    EXPECT_TRUE((Qu<dim<65>, layout<SoA>, elem_t>::onHeap));
+}
+
+TEST(Storage, copyAndMove)
+{
+    Qu<dim<10, 20>, elem_t> a;
+    for (size_t i = 0; i < a.elemSize; i++)
+    {
+        EXPECT_EQ(a[i].toDouble(), 0.0); // 默认构造仍然清零
+    }
+    a.fillRandom(3);
+
+    Qu<dim<10, 20>, elem_t> b = a;
+    EXPECT_NE(b.data.data(), a.data.data());
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(b.data.data()) % 64, 0u);
+
+    // 被移动走后再赋值会重新分配
+    Qu<dim<10, 20>, elem_t> moved = std::move(b);
+    b = a;
+    Qu<dim<10, 20>, wide_t> widened = std::move(moved);
+    moved = widened;
+
+    for (size_t i = 0; i < a.elemSize; i++)
+    {
+        EXPECT_EQ(b[i].toDouble(), a[i].toDouble());
+        EXPECT_EQ(widened[i].toDouble(), a[i].toDouble());
+        EXPECT_EQ(moved[i].toDouble(), a[i].toDouble());
+    }
+}
+
+TEST(Storage, arenaSteadyState)
+{
+    Qu<dim<16, 24>, elem_t> A;
+    Qu<dim<24, 16>, elem_t> B;
+    A.fillRandom(1);
+    B.fillRandom(2);
+
+    countingResource upstream;
+    QuArena arena(1 << 16, &upstream);
+    EXPECT_EQ(upstream.allocations, 1u);
+
+    std::vector<double> first;
+    for (int iter = 0; iter < 8; iter++)
+    {
+        {
+            QuMemoryScope scope(arena);
+
+            Qu<dim<16, 16>, c_t> C;
+            Qgemul<QuExec<Serial>, QgemulMulArgs<wide_t>>(C, A, B);
+            Qu<dim<16, 24>, wide_t> copy = A;
+            Qu<dim<16, 16>, c_t> D = C;
+
+            std::vector<double> out(D.elemSize);
+            D.toDouble(out);
+            if (iter == 0)
+            {
+                first = out;
+            }
+            EXPECT_EQ(out, first);
+            EXPECT_EQ(copy[5].toDouble(), A[5].toDouble());
+        }
+        EXPECT_GT(arena.used(), 0u);
+        arena.reset();
+    }
+
+    // 所有张量都落在预先申请的内存中
+    EXPECT_EQ(upstream.allocations, 1u);
+    EXPECT_EQ(arena.overflows(), 0u);
+    EXPECT_LE(arena.peak(), arena.capacity());
+
+    // 作用域外回到默认资源
+    EXPECT_EQ(QuMemory::resource(), std::pmr::new_delete_resource());
+}
+
+TEST(Storage, arenaOverflow)
+{
+    countingResource upstream;
+    QuArena arena(256, &upstream);
+    {
+        QuMemoryScope scope(arena);
+        Qu<dim<300>, elem_t> a;
+        a.fillRandom(4);
+        Qu<dim<300>, elem_t> b = a;
+        EXPECT_EQ(b[299].toDouble(), a[299].toDouble());
+    }
+    EXPECT_EQ(arena.overflows(), 2u);
+    EXPECT_EQ(upstream.allocations, 3u);
+}
+
+TEST(Storage, hugePages)
+{
+    QuHugePageResource pages;
+    Qu<dim<512, 512>, elem_t> a;
+    {
+        QuMemoryScope scope(pages);
+        a.fillRandom(5);
+        Qu<dim<512, 512>, elem_t> b = a;
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(b.data.data()) % 4096, 0u);
+        EXPECT_EQ(b[512 * 512 - 1].toDouble(), a[512 * 512 - 1].toDouble());
+    }
+}
+
+TEST(Storage, bulkToDouble)
+{
+    Qu<dim<70>, elem_t> a;
+    a.fillRandom(6);
+
+    std::vector<double> out(70);
+    a.toDouble(out);
+    const auto ref = a.toDouble();
+    static_assert(std::is_same_v<std::remove_cvref_t<decltype(ref)>, std::vector<double>>);
+    EXPECT_EQ(out, ref);
+    EXPECT_THROW(a.toDouble(std::span<double>(out.data(), 69)), std::invalid_argument);
+
+    Qu<dim<8>, cplx_t> z;
+    std::vector<double> in(16);
+    for (size_t i = 0; i < in.size(); i++)
+    {
+        in[i] = 0.25 * i - 2;
+    }
+    z.fromDoubles(in);
+    std::vector<double> back(16);
+    z.toDouble(back);
+    EXPECT_EQ(back, in);
+}
+
+// SoA 的平面与 AoS 的元素一样从 QuMemory::resource() 分配
+TEST(Storage, soaPlanes)
+{
+    countingResource upstream;
+    QuArena arena(1 << 16, &upstream);
+    {
+        QuMemoryScope scope(arena);
+
+        Qu<dim<10, 20>, layout<SoA>, elem_t> a;
+        EXPECT_EQ(a[199].toDouble(), 0.0);
+        a.fillRandom(7);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(a.planes.plane(0)) % 64, 0u);
+
+        const Qu<dim<10, 20>, layout<SoA>, elem_t> b = a;
+        EXPECT_NE(b.planes.plane(0), a.planes.plane(0));
+
+        const auto ref = a.toDouble();
+        static_assert(std::is_same_v<std::remove_cvref_t<decltype(ref)>, std::vector<double>>);
+        EXPECT_EQ(ref, a.toAoS().toDouble());
+
+        std::vector<double> out(a.elemSize);
+        b.toDouble(out);
+        EXPECT_EQ(out, ref);
+        EXPECT_THROW(b.toDouble(std::span<double>(out.data(), 199)), std::invalid_argument);
+    }
+    EXPECT_EQ(upstream.allocations, 1u);
+    EXPECT_GT(arena.used(), 0u);
+
+    Qu<dim<8>, layout<SoA>, cplx_t> z;
+    std::vector<double> in(16);
+    for (size_t i = 0; i < in.size(); i++)
+    {
+        in[i] = 2 - 0.25 * i;
+    }
+    z.fromDoubles(in);
+    std::vector<double> back(16);
+    z.toDouble(back);
+    EXPECT_EQ(back, in);
+}
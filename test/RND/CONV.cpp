@@ -54,4 +54,18 @@ TEST(CONV, case4)
     target_t target = from;
 
     EXPECT_DOUBLE_EQ(target.toDouble(), 1.75);
-}
\ No newline at end of file
+}
+
+TEST(CONV, drop32Bits)
+{
+    // 舍去恰好 32 位时的掩码
+    using from_t = Qu<intBits<20>, fracBits<40>>;
+
+    using target_t = Qu<intBits<20>, fracBits<8>, QuMode<RND::CONV>>;
+
+    from_t from = -123.4567;
+
+    target_t target = from;
+
+    EXPECT_DOUBLE_EQ(target.toDouble(), std::round(-123.4567 * 256) / 256);
+}
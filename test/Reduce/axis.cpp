@@ -0,0 +1,103 @@
+#include "QuBLAS.h"
+#include <gtest/gtest.h>
+
+using namespace QuBLAS;
+
+using in_t = Qu<intBits<4>, fracBits<8>>;
+using l0_t = Qu<intBits<5>, fracBits<7>, QuMode<RND::CONV>>;
+using l1_t = Qu<intBits<6>, fracBits<6>>;
+using l2_t = Qu<intBits<8>, fracBits<4>, OfMode<SAT::TCPL>>;
+
+// 对 dim<D0, D1, D2> 沿 axis 逐个拷贝出向量再做标量 Qreduce
+template <size_t axis, size_t D0, size_t D1, size_t D2, typename... Ls, typename QuT, typename ResT>
+void checkAgainstCopies(const QuT &t, const ResT &res)
+{
+    constexpr std::array<size_t, 3> extents{D0, D1, D2};
+    constexpr size_t len = extents[axis];
+
+    for (size_t a = 0; a < D0; a++)
+    {
+        for (size_t b = 0; b < D1; b++)
+        {
+            for (size_t c = 0; c < D2; c++)
+            {
+                std::array<size_t, 3> idx{a, b, c};
+                if (idx[axis] != 0)
+                {
+                    continue;
+                }
+
+                Qu<dim<len>, in_t> line;
+                for (size_t k = 0; k < len; k++)
+                {
+                    idx[axis] = k;
+                    line[k] = t[idx[0], idx[1], idx[2]];
+                }
+                idx[axis] = 0;
+
+                // 输出去掉 axis 维后的线性下标
+                size_t out = 0, stride = 1;
+                for (size_t d = 0; d < 3; d++)
+                {
+                    if (d != axis)
+                    {
+                        out += idx[d] * stride;
+                        stride *= extents[d];
+                    }
+                }
+
+                const auto ref = Qreduce<Ls...>(line);
+                static_assert(std::is_same_v<std::remove_cvref_t<decltype(res[0])>, std::remove_cvref_t<decltype(ref)>>);
+                ASSERT_EQ(res[out].data.data, ref.data.data) << "axis " << axis << " at " << a << " " << b << " " << c;
+            }
+        }
+    }
+}
+
+TEST(Reduce, axisMatchesScalarReduce)
+{
+    constexpr size_t D0 = 7, D1 = 5, D2 = 300;
+    Qu<dim<D0, D1, D2>, in_t> t;
+    t.fillRandom(1);
+
+    auto r0 = Qreduce<Axis<0>, l0_t, l1_t, l2_t>(t);
+    auto r1 = Qreduce<Axis<1>, TypeList<l0_t, l1_t, l2_t>>(t);
+    auto r2 = Qreduce<Axis<2>, QuExec<Serial>, l0_t, l1_t, l2_t>(t);
+
+    static_assert(std::is_same_v<typename decltype(r0)::size, dim<D1, D2>>);
+    static_assert(std::is_same_v<typename decltype(r1)::size, dim<D0, D2>>);
+    static_assert(std::is_same_v<typename decltype(r2)::size, dim<D0, D1>>);
+
+    checkAgainstCopies<0, D0, D1, D2, l0_t, l1_t, l2_t>(t, r0);
+    checkAgainstCopies<1, D0, D1, D2, l0_t, l1_t, l2_t>(t, r1);
+    checkAgainstCopies<2, D0, D1, D2, l0_t, l1_t, l2_t>(t, r2);
+}
+
+TEST(Reduce, axisParallelAndVector)
+{
+    Qu<dim<9, 1000>, in_t> m;
+    m.fillRandom(2);
+
+    auto serial = Qreduce<Axis<0>, QuExec<Serial>, l0_t, l1_t>(m);
+    auto parallel = Qreduce<Axis<0>, QuExec<Parallel<3>>, l0_t, l1_t>(m);
+    for (size_t i = 0; i < 1000; i++)
+    {
+        ASSERT_EQ(serial[i].data.data, parallel[i].data.data) << "at " << i;
+    }
+
+    // 向量沿唯一的维度归约得到 dim<1>
+    Qu<dim<37>, in_t> v;
+    v.fillRandom(3);
+    auto one = Qreduce<Axis<0>, l0_t, l1_t, l2_t>(v);
+    static_assert(std::is_same_v<typename decltype(one)::size, dim<1>>);
+    EXPECT_EQ(one[0].data.data, (Qreduce<l0_t, l1_t, l2_t>(v).data.data));
+
+    // 长度为 1 的维度只做类型不变的拷贝
+    Qu<dim<1, 4>, in_t> flat;
+    flat.fillRandom(4);
+    auto same = Qreduce<Axis<0>, l0_t>(flat);
+    for (size_t i = 0; i < 4; i++)
+    {
+        EXPECT_EQ(same[i].data.data, flat[i].data.data);
+    }
+}
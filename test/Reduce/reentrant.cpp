@@ -0,0 +1,109 @@
+#include "QuBLAS.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace QuBLAS;
+
+using in_t = Qu<intBits<4>, fracBits<8>>;
+using l0_t = Qu<intBits<5>, fracBits<7>>;
+using l1_t = Qu<intBits<6>, fracBits<6>>;
+using l2_t = Qu<intBits<8>, fracBits<4>>;
+
+// 按层逐级求和的参考实现
+template <typename... Ls, typename T>
+double referenceReduce(std::vector<T> layer)
+{
+    using types = TypeList<Ls...>;
+    size_t depth = 0;
+    auto step = [&]<size_t L>() {
+        using type = TypeAt<L >= sizeof...(Ls) ? sizeof...(Ls) - 1 : L, types>;
+        std::vector<double> next;
+        for (size_t i = 0; i + 1 < layer.size(); i += 2)
+        {
+            next.push_back(type(layer[i] + layer[i + 1]).toDouble());
+        }
+        if (layer.size() % 2 != 0)
+        {
+            next.push_back(type(layer.back()).toDouble());
+        }
+        layer = next;
+    };
+    while (layer.size() > 1)
+    {
+        switch (depth++)
+        {
+        case 0: step.template operator()<0>(); break;
+        case 1: step.template operator()<1>(); break;
+        default: step.template operator()<2>(); break;
+        }
+    }
+    return layer[0];
+}
+
+TEST(Reduce, matchesLayerByLayer)
+{
+    Qu<dim<37>, in_t> vec;
+    vec.fill();
+
+    std::vector<double> values;
+    for (size_t i = 0; i < 37; i++)
+    {
+        values.push_back(vec[i].toDouble());
+    }
+
+    auto res = Qreduce<l0_t, l1_t, l2_t>(vec);
+    static_assert(std::is_same_v<decltype(res), l2_t>);
+    EXPECT_DOUBLE_EQ(res.toDouble(), (referenceReduce<l0_t, l1_t, l2_t>(values)));
+}
+
+TEST(Reduce, multiDimAndSingle)
+{
+    Qu<dim<3, 5>, in_t> mat;
+    mat.fill();
+
+    Qu<dim<15>, in_t> flat;
+    for (size_t i = 0; i < 15; i++)
+    {
+        flat[i] = mat[i];
+    }
+    EXPECT_EQ(Qreduce<l0_t>(mat).toDouble(), Qreduce<l0_t>(flat).toDouble());
+
+    Qu<dim<1>, in_t> one;
+    one.fill();
+    EXPECT_EQ(Qreduce(one).toDouble(), one[0].toDouble());
+}
+
+TEST(Reduce, concurrentCalls)
+{
+    constexpr size_t len = 2048;
+    using acc_t = Qu<intBits<16>, fracBits<8>>;
+
+    std::vector<Qu<dim<len>, in_t>> inputs(4);
+    std::vector<double> expected;
+    for (auto &in : inputs)
+    {
+        in.fill();
+        expected.push_back(Qreduce<acc_t>(in).toDouble());
+    }
+
+    std::vector<double> results(inputs.size());
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < inputs.size(); t++)
+    {
+        threads.emplace_back([&, t] {
+            for (int rep = 0; rep < 50; rep++)
+            {
+                results[t] = Qreduce<acc_t>(inputs[t]).toDouble();
+                if (results[t] != expected[t])
+                {
+                    break;
+                }
+            }
+        });
+    }
+    for (auto &th : threads)
+    {
+        th.join();
+    }
+    EXPECT_EQ(results, expected);
+}